@@ -30,7 +30,8 @@ const QByteArray Version = "2.5.1";
 typedef enum SdrType {
     soundcard_t=0,
     network_t=1,
-    afedri_t=2
+    afedri_t=2,
+    iqfile_t=3
 } SdrType;
 
 typedef struct uiSize {
@@ -311,6 +312,22 @@ const bool s_sdr_swap_network_def=false;
 const QString s_sdr_swap_soundcard="swapiq_soundcard";
 const bool s_sdr_swap_soundcard_def=false;
 
+// IQ file replay: file name, pacing, and IF offset/swap read from the file header
+const QString s_sdr_iqfile="iqfile";
+const QString s_sdr_iqfile_def="";
+
+const QString s_sdr_iqfile_realtime="iqfile_realtime";
+const bool s_sdr_iqfile_realtime_def=true;
+
+const QString s_sdr_iqfile_loop="iqfile_loop";
+const bool s_sdr_iqfile_loop_def=false;
+
+const QString s_sdr_offset_iqfile="offset_iqfile";
+const int s_sdr_offset_iqfile_def=0;
+
+const QString s_sdr_swap_iqfile="swapiq_iqfile";
+const bool s_sdr_swap_iqfile_def=false;
+
 const QString s_sdr_scale="scale";
 const int s_sdr_scale_def=1;
 
@@ -0,0 +1,273 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QDataStream>
+#include <QDebug>
+#include <QMutexLocker>
+#include "iqfile.h"
+
+IQFileWriter::IQFileWriter(QObject *parent) : QObject(parent)
+{
+    freq=0;
+    sizes.advance_size=0;
+    sizes.chunk_size=0;
+}
+
+IQFileWriter::~IQFileWriter()
+{
+    close();
+}
+
+/*! create file and write header
+ */
+bool IQFileWriter::open(const QString &fileName, const IQFileHeader &h, sampleSizes s)
+{
+    QMutexLocker locker(&mutex);
+    if (file.isOpen()) file.close();
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        emit(error("IQ record: can't open "+fileName));
+        return false;
+    }
+    sizes=s;
+    freq=h.centerFreq;
+    QDataStream ds(&file);
+    ds.setByteOrder(QDataStream::LittleEndian);
+    ds.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    ds.writeRawData(IQFILE_MAGIC,8);
+    ds << IQFILE_VERSION << h.sampleFreq << h.bits << h.speed << (quint32)sizes.advance_size
+       << h.offset << (quint32)(h.swapIQ ? 1 : 0) << h.startTime << h.centerFreq;
+    clock.start();
+    return true;
+}
+
+void IQFileWriter::close()
+{
+    QMutexLocker locker(&mutex);
+    if (file.isOpen()) file.close();
+}
+
+bool IQFileWriter::isOpen()
+{
+    QMutexLocker locker(&mutex);
+    return file.isOpen();
+}
+
+/*! center frequency recorded with the following blocks
+ */
+void IQFileWriter::setCenterFreq(double f)
+{
+    QMutexLocker locker(&mutex);
+    freq=f;
+}
+
+/*! write the newest spectrum advance. bptr is the ring position following it,
+ * as emitted by SdrDataSource::ready
+ */
+void IQFileWriter::writeBlock(unsigned char *data, unsigned char bptr)
+{
+    QMutexLocker locker(&mutex);
+    if (!file.isOpen() || sizes.advance_size==0) return;
+    unsigned int bpmax=sizes.chunk_size/sizes.advance_size;
+    unsigned int j=((bptr+bpmax-1)%bpmax)*sizes.advance_size;
+
+    QDataStream ds(&file);
+    ds.setByteOrder(QDataStream::LittleEndian);
+    ds.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    ds << (qint64)clock.nsecsElapsed()/1000 << freq;
+    if (ds.writeRawData((const char*)&data[j],sizes.advance_size)!=(int)sizes.advance_size) {
+        file.close();
+        locker.unlock();
+        emit(error("IQ record: write error, recording stopped"));
+    }
+}
+
+IQFileSource::IQFileSource(QString settingsFile, QObject *parent) : SdrDataSource(settingsFile,parent)
+{
+    buff=0;
+    bpmax=0;
+    bptr=0;
+    loop=false;
+    realTime=true;
+    waiting=false;
+    freq=0;
+    nextFreq=0;
+    firstTime=0;
+    nextTime=0;
+    nBlocks=0;
+    timer.setParent(this);
+    timer.setSingleShot(true);
+    connect(&timer,SIGNAL(timeout()),this,SLOT(readBlock()));
+}
+
+IQFileSource::~IQFileSource()
+{
+    if (buff) {
+        delete [] buff;
+    }
+}
+
+bool IQFileSource::readHeader(const QString &fileName, IQFileHeader &h)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    return readHeader(f,h);
+}
+
+/*! read and check header; leaves f positioned at the first block
+ */
+bool IQFileSource::readHeader(QFile &f, IQFileHeader &h)
+{
+    QDataStream ds(&f);
+    ds.setByteOrder(QDataStream::LittleEndian);
+    ds.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    char magic[8];
+    if (ds.readRawData(magic,8)!=8 || qstrncmp(magic,IQFILE_MAGIC,8)!=0) return false;
+    quint32 swap;
+    ds >> h.version >> h.sampleFreq >> h.bits >> h.speed >> h.blockSize >> h.offset >> swap
+       >> h.startTime >> h.centerFreq;
+    h.swapIQ=(swap!=0);
+    return (ds.status()==QDataStream::Ok && h.version==IQFILE_VERSION && h.blockSize>0);
+}
+
+void IQFileSource::initialize()
+{
+    if (file.isOpen()) file.close();
+    file.setFileName(settings->value(s_sdr_iqfile,s_sdr_iqfile_def).toString());
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit(error("IQ file: can't open "+file.fileName()));
+        return;
+    }
+    if (!readHeader(file,header)) {
+        emit(error("IQ file: "+file.fileName()+" is not a so2sdr IQ recording"));
+        file.close();
+        return;
+    }
+    if (header.blockSize!=sizes.advance_size || sizes.chunk_size%sizes.advance_size) {
+        emit(error("IQ file: block size does not match bandmap settings"));
+        file.close();
+        return;
+    }
+    realTime=settings->value(s_sdr_iqfile_realtime,s_sdr_iqfile_realtime_def).toBool();
+    loop=settings->value(s_sdr_iqfile_loop,s_sdr_iqfile_loop_def).toBool();
+    bpmax=sizes.chunk_size/sizes.advance_size;
+    bptr=0;
+    if (buff) {
+        delete [] buff;
+    }
+    buff=new unsigned char[sizes.chunk_size];
+    for (unsigned long i=0;i<sizes.chunk_size;i++) {
+        buff[i]=0;
+    }
+    freq=0;
+    nBlocks=0;
+    waiting=false;
+    if (!readNext()) {
+        emit(error("IQ file: "+file.fileName()+" has no data"));
+        file.close();
+        return;
+    }
+    firstTime=nextTime;
+    mutex.lock();
+    running=true;
+    initialized=true;
+    mutex.unlock();
+    clock.start();
+    replayTime.start();
+    schedule();
+}
+
+/*! read time and frequency of the next block. Returns false at end of file
+ */
+bool IQFileSource::readNext()
+{
+    QDataStream ds(&file);
+    ds.setByteOrder(QDataStream::LittleEndian);
+    ds.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    ds >> nextTime >> nextFreq;
+    if (ds.status()!=QDataStream::Ok) return false;
+    return (file.bytesAvailable()>=header.blockSize);
+}
+
+/*! start timer for the next block. In real time mode the recorded time stamps
+ *  are followed; otherwise the next block is sent as soon as the previous one
+ *  has been processed
+ */
+void IQFileSource::schedule()
+{
+    if (realTime) {
+        qint64 due=(nextTime-firstTime)/1000-clock.elapsed();
+        timer.start(due>0 ? due : 0);
+    } else if (!waiting) {
+        timer.start(0);
+    }
+}
+
+/*! called when the spectrum processor has finished with a block
+ */
+void IQFileSource::processed()
+{
+    if (realTime || !waiting) return;
+    waiting=false;
+    if (isRunning()) schedule();
+}
+
+void IQFileSource::readBlock()
+{
+    if (!isRunning()) return;
+    if (file.read((char*)&buff[bptr*sizes.advance_size],header.blockSize)!=header.blockSize) {
+        emit(error("IQ file: read error"));
+        stop();
+        return;
+    }
+    nBlocks++;
+    bptr++;
+    bptr=bptr%bpmax;
+    if (nextFreq!=freq) {
+        freq=nextFreq;
+        emit(centerFreqChanged(freq));
+    }
+    if (!realTime) waiting=true;
+    emit(ready(buff,bptr));
+
+    if (!readNext()) {
+        qDebug("IQ file: replayed %d blocks in %lld ms",nBlocks,replayTime.elapsed());
+        if (!loop) {
+            stop();
+            return;
+        }
+        file.seek(IQFILE_HEADER_SIZE);
+        if (!readNext()) {
+            stop();
+            return;
+        }
+        clock.start();
+        nBlocks=0;
+        replayTime.start();
+    }
+    schedule();
+}
+
+void IQFileSource::stop()
+{
+    mutex.lock();
+    running=false;
+    initialized=false;
+    mutex.unlock();
+    emit(stopped());
+}
@@ -0,0 +1,145 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef IQFILE_H
+#define IQFILE_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include "defines.h"
+#include "sdrdatasource.h"
+
+/*
+  IQ file format, all values little-endian:
+
+  header
+    char[8]  "SO2SDRIQ"
+    quint32  version
+    quint32  sample frequency (Hz)
+    quint32  bits (as s_sdr_bits: 0=16 bit, 1=24 bit, 2=32 bit)
+    quint32  speed (FFT size multiplier)
+    quint32  block size (bytes, one spectrum advance)
+    qint32   IF offset (Hz)
+    quint32  IQ swapped (0/1)
+    qint64   start time (ms since epoch, UTC)
+    double   center frequency at start (Hz)
+
+  followed by blocks
+    qint64   time since start (us)
+    double   center frequency (Hz)
+    char[block size]  raw IQ samples as delivered by the SDR
+*/
+const char IQFILE_MAGIC[]="SO2SDRIQ";
+const quint32 IQFILE_VERSION=1;
+const int IQFILE_HEADER_SIZE=8+7*4+8+8;
+const int IQFILE_BLOCK_HEADER_SIZE=8+8;
+
+typedef struct IQFileHeader {
+    quint32 version;
+    quint32 sampleFreq;
+    quint32 bits;
+    quint32 speed;
+    quint32 blockSize;
+    qint32  offset;
+    bool    swapIQ;
+    qint64  startTime;
+    double  centerFreq;
+} IQFileHeader;
+
+/*!
+   Records raw IQ from any SdrDataSource.
+
+   writeBlock should be connected to SdrDataSource::ready with a direct connection,
+   so that each block is written from the SDR thread before the ring buffer is reused.
+ */
+class IQFileWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit IQFileWriter(QObject *parent = 0);
+    ~IQFileWriter();
+    void close();
+    bool isOpen();
+    bool open(const QString &fileName, const IQFileHeader &h, sampleSizes s);
+    void setCenterFreq(double f);
+
+signals:
+    void error(const QString &);
+
+public slots:
+    void writeBlock(unsigned char *data, unsigned char bptr);
+
+private:
+    double        freq;
+    QElapsedTimer clock;
+    QFile         file;
+    QMutex        mutex;
+    sampleSizes   sizes;
+};
+
+/*!
+   SDR data source replaying a file recorded by IQFileWriter, either paced by the
+   recorded time stamps or as fast as the spectrum processor can take the data.
+ */
+class IQFileSource : public SdrDataSource
+{
+    Q_OBJECT
+public:
+    IQFileSource(QString settingsFile, QObject *parent = 0);
+    ~IQFileSource();
+    static bool readHeader(QFile &f, IQFileHeader &h);
+    static bool readHeader(const QString &fileName, IQFileHeader &h);
+
+signals:
+    void centerFreqChanged(double);
+
+public slots:
+    void initialize();
+    void processed();
+    void stop();
+
+private slots:
+    void readBlock();
+
+private:
+    bool          loop;
+    bool          realTime;
+    bool          waiting;
+    double        freq;
+    double        nextFreq;
+    qint64        firstTime;
+    qint64        nextTime;
+    int           nBlocks;
+    unsigned char *buff;
+    unsigned int  bpmax;
+    unsigned int  bptr;
+    IQFileHeader  header;
+    QElapsedTimer clock;
+    QElapsedTimer replayTime;
+    QFile         file;
+    QTimer        timer;
+
+    bool readNext();
+    void schedule();
+};
+
+#endif // IQFILE_H
@@ -0,0 +1,120 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QDateTime>
+#include <QFileDialog>
+#include <QFileInfo>
+#include "iqfile.h"
+#include "iqfilesetup.h"
+#include "utils.h"
+
+/*!
+ * \brief IQFileSetup::IQFileSetup
+ *     Dialog to select an IQ recording for replay
+ * \param s
+ *     global settings object
+ * \param parent
+ */
+IQFileSetup::IQFileSetup(QSettings &s,uiSize sizes,QWidget *parent) : QDialog(parent),settings(s)
+{
+    setupUi(this);
+    fileLineEdit->setMinimumWidth(sizes.width*30);
+    adjustSize();
+
+    updateFromSettings();
+    connect(browsePushButton,SIGNAL(clicked()),this,SLOT(browse()));
+    connect(fileLineEdit,SIGNAL(editingFinished()),this,SLOT(showInfo()));
+    connect(buttonBox,SIGNAL(accepted()),this,SLOT(updateIQFile()));
+    connect(buttonBox,SIGNAL(rejected()),this,SLOT(rejectChanges()));
+}
+
+/*! IF offset and IQ swap are those in effect when the file was recorded
+ */
+double IQFileSetup::offset() const
+{
+    return settings.value(s_sdr_offset_iqfile,s_sdr_offset_iqfile_def).toDouble();
+}
+
+bool IQFileSetup::invert() const
+{
+    return settings.value(s_sdr_swap_iqfile,s_sdr_swap_iqfile_def).toBool();
+}
+
+void IQFileSetup::browse()
+{
+    QString dir=fileLineEdit->text().isEmpty() ? userDirectory() : QFileInfo(fileLineEdit->text()).path();
+    QString f=QFileDialog::getOpenFileName(this,"IQ recording",dir,"IQ recordings (*.iq);;All files (*)");
+    if (!f.isEmpty()) {
+        fileLineEdit->setText(f);
+        showInfo();
+    }
+}
+
+/*!
+ * \brief IQFileSetup::showInfo
+ *  show sample rate, start time, and frequency of the selected file
+ */
+void IQFileSetup::showInfo()
+{
+    IQFileHeader h;
+    if (fileLineEdit->text().isEmpty()) {
+        infoLabel->clear();
+    } else if (IQFileSource::readHeader(fileLineEdit->text(),h)) {
+        QFileInfo fi(fileLineEdit->text());
+        double sec=(fi.size()-IQFILE_HEADER_SIZE)/(double)(h.blockSize+IQFILE_BLOCK_HEADER_SIZE)*(h.blockSize/(2*(h.bits+2)))/h.sampleFreq;
+        infoLabel->setText(QString::number(h.sampleFreq/1000)+" kHz, "+QString::number(16+8*h.bits)+" bit, "+
+                           QString::number(h.centerFreq/1000,'f',1)+" kHz, "+
+                           QDateTime::fromMSecsSinceEpoch(h.startTime).toUTC().toString("yyyy-MM-dd hh:mm")+"z, "+
+                           QString::number(sec,'f',0)+" s");
+    } else {
+        infoLabel->setText("not a so2sdr IQ recording");
+    }
+}
+
+/*!
+ * \brief IQFileSetup::updateFromSettings
+   update widgets from settings object
+*/
+void IQFileSetup::updateFromSettings()
+{
+    fileLineEdit->setText(settings.value(s_sdr_iqfile,s_sdr_iqfile_def).toString());
+    checkBoxRealTime->setChecked(settings.value(s_sdr_iqfile_realtime,s_sdr_iqfile_realtime_def).toBool());
+    checkBoxLoop->setChecked(settings.value(s_sdr_iqfile_loop,s_sdr_iqfile_loop_def).toBool());
+    showInfo();
+}
+
+/*!
+ * \brief IQFileSetup::updateIQFile
+ *  update settings from widgets
+ */
+void IQFileSetup::updateIQFile()
+{
+    settings.setValue(s_sdr_iqfile,fileLineEdit->text());
+    settings.setValue(s_sdr_iqfile_realtime,checkBoxRealTime->isChecked());
+    settings.setValue(s_sdr_iqfile_loop,checkBoxLoop->isChecked());
+}
+
+/*!
+ * \brief IQFileSetup::rejectChanges
+  called when cancel is clicked; reset widgets to values from settings
+*/
+void IQFileSetup::rejectChanges()
+{
+    updateFromSettings();
+    reject();
+}
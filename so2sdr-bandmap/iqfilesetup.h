@@ -0,0 +1,46 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef IQFILESETUP_H
+#define IQFILESETUP_H
+
+#include "defines.h"
+#include <QDialog>
+#include <QSettings>
+#include "ui_iqfilesetup.h"
+
+class IQFileSetup : public QDialog, public Ui::iqFileSetup
+{
+    Q_OBJECT
+public:
+    explicit IQFileSetup(QSettings &s, uiSize sizes, QWidget *parent = 0);
+    double offset() const;
+    bool invert() const;
+
+private slots:
+    void browse();
+    void showInfo();
+    void updateIQFile();
+    void rejectChanges();
+
+private:
+    QSettings &settings;
+    void updateFromSettings();
+};
+
+#endif // IQFILESETUP_H
@@ -43,6 +43,7 @@ SDRDialog::SDRDialog(QSettings &s, uiSize sizes, QWidget *parent) : QDialog(pare
     comboBoxSdrType->addItem("Soundcard");
     comboBoxSdrType->addItem("SDR-IP SDR");
     comboBoxSdrType->addItem("Afedri Net SDR");
+    comboBoxSdrType->addItem("IQ File");
     connect(configureButton,SIGNAL(clicked()),this,SLOT(launchConfigure()));
     soundcard=new SoundCardSetup(settings,sizes,this);
     connect(soundcard,SIGNAL(PortAudioError(QString)),this,SIGNAL(setupErrors(QString)));
@@ -53,6 +54,8 @@ SDRDialog::SDRDialog(QSettings &s, uiSize sizes, QWidget *parent) : QDialog(pare
     network=new NetworkSetup(settings,sizes,this);
     connect(network,SIGNAL(networkError(QString)),this,SIGNAL(setupErrors(QString)));
     network->hide();
+    iqfile=new IQFileSetup(settings,sizes,this);
+    iqfile->hide();
     connect(buttonBox, SIGNAL(accepted()), this, SLOT(updateSDR()));
     connect(buttonBox, SIGNAL(rejected()), this, SLOT(rejectChanges()));
     updateFromSettings();
@@ -70,6 +73,9 @@ double SDRDialog::offset(int band) const
     case 2:
         return afedri->offset(band);
         break;
+    case 3:
+        return iqfile->offset();
+        break;
     default:
         return 0;
     }
@@ -87,6 +93,9 @@ bool SDRDialog::invert(int band) const
     case 2:
         return afedri->invert(band);
         break;
+    case 3:
+        return iqfile->invert();
+        break;
     default:
         return false;
     }
@@ -114,6 +123,9 @@ void SDRDialog::launchConfigure()
     case 2:
         afedri->show();
         break;
+    case 3:
+        iqfile->show();
+        break;
     }
 }
 
@@ -145,6 +157,10 @@ void SDRDialog::updateFromSettings()
         settings.setValue(s_sdr_offset,settings.value(s_sdr_offset_network,s_sdr_offset_network_def).toInt());
         settings.setValue(s_sdr_swapiq,settings.value(s_sdr_swap_network,s_sdr_swap_network_def).toBool());
         break;
+    case iqfile_t:
+        settings.setValue(s_sdr_offset,settings.value(s_sdr_offset_iqfile,s_sdr_offset_iqfile_def).toInt());
+        settings.setValue(s_sdr_swapiq,settings.value(s_sdr_swap_iqfile,s_sdr_swap_iqfile_def).toBool());
+        break;
     }
 }
 
@@ -153,6 +169,7 @@ SDRDialog::~SDRDialog()
     delete afedri;
     delete soundcard;
     delete network;
+    delete iqfile;
 }
 
 /*!
@@ -184,6 +201,10 @@ void SDRDialog::updateSDR()
         settings.setValue(s_sdr_offset,settings.value(s_sdr_offset_network,s_sdr_offset_network_def).toInt());
         settings.setValue(s_sdr_swapiq,settings.value(s_sdr_swap_network,s_sdr_swap_network_def).toBool());
         break;
+    case iqfile_t:
+        settings.setValue(s_sdr_offset,settings.value(s_sdr_offset_iqfile,s_sdr_offset_iqfile_def).toInt());
+        settings.setValue(s_sdr_swapiq,settings.value(s_sdr_swap_iqfile,s_sdr_swap_iqfile_def).toBool());
+        break;
     }
     emit(update());
 
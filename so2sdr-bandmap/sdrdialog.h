@@ -27,6 +27,7 @@
 #include "soundcardsetup.h"
 #include "afedrisetup.h"
 #include "networksetup.h"
+#include "iqfilesetup.h"
 #include "ui_sdrdialog.h"
 
 class SDRDialog : public QDialog, public Ui::SDRDialog
@@ -56,6 +57,7 @@ private slots:
 private:
     QSettings          &settings;
     AfedriSetup        *afedri;
+    IQFileSetup        *iqfile;
     NetworkSetup       *network;
     void updateFromSettings();
 };
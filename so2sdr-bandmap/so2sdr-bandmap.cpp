@@ -39,6 +39,7 @@
 #include "afedri.h"
 #include "network.h"
 #include "audioreader_portaudio.h"
+#include "iqfile.h"
 
 /*! returns true if initialization was successful
  */
@@ -166,6 +167,11 @@ So2sdrBandmap::So2sdrBandmap(QStringList args, QWidget *parent) : QMainWindow(pa
 
     iqShowData = new QAction("IQ Balance", this);
     connect(iqShowData, SIGNAL(triggered()), this, SLOT(showIQData()));
+    recordIQ = new QAction("&Record IQ", this);
+    recordIQ->setCheckable(true);
+    recordIQ->setToolTip("Record raw IQ data to a file in "+userDirectory());
+    connect(recordIQ, SIGNAL(triggered(bool)), this, SLOT(setRecordIQ(bool)));
+    connect(&iqRecorder, SIGNAL(error(QString)), &errorBox, SLOT(showMessage(QString)));
     connect(&checkBoxMark, SIGNAL(clicked()), this, SLOT(emitParams()));
     connect(deleteAct, SIGNAL(triggered()), this, SLOT(deleteCallMouse()));
     showToolBar->setCheckable(true);
@@ -200,19 +206,14 @@ So2sdrBandmap::So2sdrBandmap(QStringList args, QWidget *parent) : QMainWindow(pa
     case network_t:
         sdrSource = new NetworkSDR(settingsFile);
         break;
+    case iqfile_t:
+        sdrSource = new IQFileSource(settingsFile);
+        break;
     }
     setSdrType();
-    sdrSource->moveToThread(&sdrThread);
-    connect(actionSetup,SIGNAL(triggered()),sdrSource,SLOT(stop()),Qt::DirectConnection);
-    connect(&sdrThread,SIGNAL(started()),sdrSource,SLOT(initialize()));
-    connect(sdrSource,SIGNAL(stopped()),&sdrThread,SLOT(quit()));
-    connect(sdrSource,SIGNAL(stopped()),this,SLOT(disconnectSignals()));
-    connect(sdrSource,SIGNAL(error(QString)),&errorBox,SLOT(showMessage(QString)));
-
     connect(spectrumProcessor, SIGNAL(spectrumReady(unsigned char*, unsigned char)), display,
             SLOT(plotSpectrum(unsigned char*, unsigned char)));
-    connect(sdrSource, SIGNAL(ready(unsigned char *, unsigned char)),spectrumProcessor,
-            SLOT(processData(unsigned char *, unsigned char)),Qt::QueuedConnection);
+    connectSdrSource();
     connect(iqDialog, SIGNAL(closed(bool)), spectrumProcessor, SLOT(setPlotPoints(bool)));
     connect(iqDialog, SIGNAL(restart()), spectrumProcessor, SLOT(clearIQ()));
     connect(spectrumProcessor, SIGNAL(qsy(double)), this, SLOT(findQsy(double)));
@@ -250,6 +251,7 @@ So2sdrBandmap::~So2sdrBandmap()
     iqDialog->close();
     delete iqDialog;
     delete iqShowData;
+    delete recordIQ;
     delete sdrSetup;
     delete scaleX1;
     delete scaleX2;
@@ -317,8 +319,20 @@ void So2sdrBandmap::restartSdr()
     case network_t:
         sdrSource = new NetworkSDR(settingsFile);
         break;
+    case iqfile_t:
+        sdrSource = new IQFileSource(settingsFile);
+        break;
     }
     setSdrType();
+    connectSdrSource();
+}
+
+/*!
+ * \brief So2sdrBandmap::connectSdrSource
+ *   move a newly created sdrSource to its thread and connect its signals
+ */
+void So2sdrBandmap::connectSdrSource()
+{
     sdrSource->moveToThread(&sdrThread);
     connect(actionSetup,SIGNAL(triggered()),sdrSource,SLOT(stop()),Qt::DirectConnection);
     connect(&sdrThread,SIGNAL(started()),sdrSource,SLOT(initialize()));
@@ -326,7 +340,19 @@ void So2sdrBandmap::restartSdr()
     connect(sdrSource,SIGNAL(stopped()),this,SLOT(disconnectSignals()));
     connect(sdrSource,SIGNAL(error(QString)),&errorBox,SLOT(showMessage(QString)));
     connect(sdrSource, SIGNAL(ready(unsigned char *, unsigned char)),spectrumProcessor,
-            SLOT(processData(unsigned char *, unsigned char)));
+            SLOT(processData(unsigned char *, unsigned char)),Qt::QueuedConnection);
+
+    // file replay follows the recorded frequency. When not replaying in real
+    // time the next block is read only after the previous one is processed
+    IQFileSource *iqSource=qobject_cast<IQFileSource*>(sdrSource);
+    if (iqSource) {
+        connect(iqSource,SIGNAL(centerFreqChanged(double)),this,SLOT(setCenterFreq(double)));
+        connect(spectrumProcessor,SIGNAL(spectrumReady(unsigned char*, unsigned char)),iqSource,SLOT(processed()));
+    }
+    if (iqRecorder.isOpen()) {
+        connect(sdrSource,SIGNAL(ready(unsigned char *, unsigned char)),&iqRecorder,
+                SLOT(writeBlock(unsigned char *, unsigned char)),Qt::DirectConnection);
+    }
 }
 
 /*!
@@ -336,6 +362,12 @@ void So2sdrBandmap::restartSdr()
 void So2sdrBandmap::setSdrType()
 {
     int speed=1;
+
+    // a recording can't change format
+    if (iqRecorder.isOpen()) {
+        recordIQ->setChecked(false);
+        setRecordIQ(false);
+    }
     switch ((SdrType)settings->value(s_sdr_type,s_sdr_type_def).toInt()) {
     case soundcard_t:
         iqShowData->setEnabled(true);
@@ -358,6 +390,21 @@ void So2sdrBandmap::setSdrType()
         settings->setValue(s_sdr_udp_port,settings->value(s_sdr_net_udp_port,s_sdr_net_udp_port_def).toInt());
         speed=settings->value(s_sdr_net_speed,s_sdr_net_speed_def).toInt();
         break;
+    case iqfile_t:
+    {
+        // format is set by the recording
+        iqShowData->setEnabled(true);
+        IQFileHeader h;
+        if (IQFileSource::readHeader(settings->value(s_sdr_iqfile,s_sdr_iqfile_def).toString(),h)) {
+            settings->setValue(s_sdr_sample_freq,h.sampleFreq);
+            settings->setValue(s_sdr_bits,h.bits);
+            settings->setValue(s_sdr_offset_iqfile,h.offset);
+            settings->setValue(s_sdr_swap_iqfile,h.swapIQ);
+            speed=h.speed;
+            if (centerFreq==0) centerFreq=h.centerFreq;
+        }
+        break;
+    }
     }
     settings->setValue(s_sdr_offset,sdrSetup->offset(getBand(centerFreq)));
     settings->setValue(s_sdr_swapiq,sdrSetup->invert(getBand(centerFreq)));
@@ -690,6 +737,7 @@ void So2sdrBandmap::mousePressEvent(QMouseEvent *event)
             menu.addAction(deleteAct);
             menu.addSeparator();
             menu.addAction(iqShowData);
+            menu.addAction(recordIQ);
             menu.exec(event->globalPos());
         } else if (event->button() == Qt::LeftButton && (event->x() < (FreqLabel->width() + display->width() +
                                                                        SIG_SYMBOL_X + 4 * SIG_SYMBOL_RAD))) {
@@ -890,6 +938,7 @@ void So2sdrBandmap::initPointers()
     iqDialog  = 0;
     deleteAct = 0;
     iqShowData = 0;
+    recordIQ = 0;
     scaleX1 = 0;
     scaleX2 = 0;
     spectrumProcessor = 0;
@@ -1021,36 +1070,7 @@ void So2sdrBandmap::readData()
         switch (cmd) {
         case BANDMAP_CMD_SET_FREQ: // set frequency
             f=data.toDouble(&ok);
-            if  (ok && centerFreq!=f) {
-                centerFreq=f;
-                spectrumProcessor->setTuning(true);
-                tuningTimer.start(TUNING_TIMEOUT);
-                int b=getBand(f);
-                if (b==BAND_NONE) return;
-                setBandName(b);
-                endFreqs[0] = centerFreq-
-                        settings->value(s_sdr_sample_freq,s_sdr_sample_freq_def).toInt()/2
-                        -settings->value(s_sdr_offset,s_sdr_offset_def).toInt();
-                endFreqs[1] = centerFreq+
-                        settings->value(s_sdr_sample_freq,s_sdr_sample_freq_def).toInt()/2
-                        -settings->value(s_sdr_offset,s_sdr_offset_def).toInt();
-
-                setWindowTitle("Bandmap "+bandName+" ["+QString::number(endFreqs[0]/1000)+"-"+QString::number(endFreqs[1]/1000)+"]");
-                if (band != b) {
-                    // if band changed, clear all signals
-                    spectrumProcessor->clearSigs();
-                    spectrumProcessor->clearCQ();
-                    settings->setValue(s_sdr_offset,sdrSetup->offset(getBand(centerFreq)));
-                    settings->setValue(s_sdr_swapiq,sdrSetup->invert(getBand(centerFreq)));
-                    spectrumProcessor->updateParams();
-                    band=b;
-                }
-                spectrumProcessor->setFreq(centerFreq, endFreqs[0], endFreqs[1]);
-                spectrumProcessor->resetAvg();
-                makeFreqScaleAbsolute();
-                FreqLabel->setPixmap(freqPixmap);
-                FreqLabel->update();
-            }
+            if (ok && !setCenterFreq(f)) return;
             break;
         case BANDMAP_CMD_SET_LOWER_FREQ: // set freq finder lower limit
             ff=data.toDouble(&ok);
@@ -1285,6 +1305,78 @@ void So2sdrBandmap::setBandName(int b)
     }
 }
 
+/*!
+ * \brief So2sdrBandmap::setRecordIQ
+ *   start or stop recording raw IQ data from the current SDR
+ */
+void So2sdrBandmap::setRecordIQ(bool b)
+{
+    if (!b) {
+        disconnect(sdrSource,SIGNAL(ready(unsigned char *, unsigned char)),&iqRecorder,
+                   SLOT(writeBlock(unsigned char *, unsigned char)));
+        iqRecorder.close();
+        return;
+    }
+    IQFileHeader h;
+    h.version    = IQFILE_VERSION;
+    h.sampleFreq = settings->value(s_sdr_sample_freq,s_sdr_sample_freq_def).toInt();
+    h.bits       = settings->value(s_sdr_bits,s_sdr_bits_def).toInt();
+    h.speed      = settings->value(s_sdr_speed,s_sdr_speed_def).toInt();
+    h.blockSize  = sizes.advance_size;
+    h.offset     = settings->value(s_sdr_offset,s_sdr_offset_def).toInt();
+    h.swapIQ     = settings->value(s_sdr_swapiq,s_sdr_swapiq_def).toBool();
+    h.startTime  = QDateTime::currentMSecsSinceEpoch();
+    h.centerFreq = centerFreq;
+    QString fileName=userDirectory()+"/"+bandMapName+"-"+QDateTime::currentDateTimeUtc().toString("yyyyMMdd-hhmmss")+".iq";
+    if (iqRecorder.open(fileName,h,sizes)) {
+        connect(sdrSource,SIGNAL(ready(unsigned char *, unsigned char)),&iqRecorder,
+                SLOT(writeBlock(unsigned char *, unsigned char)),Qt::DirectConnection);
+    } else {
+        recordIQ->setChecked(false);
+    }
+}
+
+/*!
+ * \brief So2sdrBandmap::setCenterFreq
+ *   set new center frequency, from the connected program or an IQ file replay.
+ *   Returns false if f is outside the ham bands
+ */
+bool So2sdrBandmap::setCenterFreq(double f)
+{
+    if (centerFreq==f) return true;
+
+    centerFreq=f;
+    iqRecorder.setCenterFreq(f);
+    spectrumProcessor->setTuning(true);
+    tuningTimer.start(TUNING_TIMEOUT);
+    int b=getBand(f);
+    if (b==BAND_NONE) return false;
+    setBandName(b);
+    endFreqs[0] = centerFreq-
+            settings->value(s_sdr_sample_freq,s_sdr_sample_freq_def).toInt()/2
+            -settings->value(s_sdr_offset,s_sdr_offset_def).toInt();
+    endFreqs[1] = centerFreq+
+            settings->value(s_sdr_sample_freq,s_sdr_sample_freq_def).toInt()/2
+            -settings->value(s_sdr_offset,s_sdr_offset_def).toInt();
+
+    setWindowTitle("Bandmap "+bandName+" ["+QString::number(endFreqs[0]/1000)+"-"+QString::number(endFreqs[1]/1000)+"]");
+    if (band != b) {
+        // if band changed, clear all signals
+        spectrumProcessor->clearSigs();
+        spectrumProcessor->clearCQ();
+        settings->setValue(s_sdr_offset,sdrSetup->offset(getBand(centerFreq)));
+        settings->setValue(s_sdr_swapiq,sdrSetup->invert(getBand(centerFreq)));
+        spectrumProcessor->updateParams();
+        band=b;
+    }
+    spectrumProcessor->setFreq(centerFreq, endFreqs[0], endFreqs[1]);
+    spectrumProcessor->resetAvg();
+    makeFreqScaleAbsolute();
+    FreqLabel->setPixmap(freqPixmap);
+    FreqLabel->update();
+    return true;
+}
+
 /* slot called from spectrumProcessor with qsy frequency.
  * this frequency is returned to the connected program through tcp
 */
@@ -1295,6 +1387,7 @@ void So2sdrBandmap::findQsy(double f)
 
     // update bandmap with new frequency
     centerFreq=f;
+    iqRecorder.setCenterFreq(f);
     endFreqs[0] = centerFreq-
             settings->value(s_sdr_sample_freq,s_sdr_sample_freq_def).toInt()/2
             -settings->value(s_sdr_offset,s_sdr_offset_def).toInt();
@@ -1380,6 +1473,7 @@ void So2sdrBandmap::xmlParseN1MM()
                 f=xmlReader.readElementText().toInt(&ok)*10;
                 if (ok && f>0 && nr==settings->value(s_sdr_nrig,s_sdr_nrig_def).toInt()) {
                     centerFreq=f;
+                    iqRecorder.setCenterFreq(f);
                     int b=getBand(f);
                     setBandName(b);
 
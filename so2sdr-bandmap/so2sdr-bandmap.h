@@ -58,6 +58,7 @@
 #include "call.h"
 #include "utils.h"
 #include "helpdialog.h"
+#include "iqfile.h"
 
 class So2sdrBandmap : public QMainWindow, public Ui::Bandmap
 {
@@ -108,6 +109,8 @@ private slots:
     void mouseQSYDelta(int);
     void findQsy(double);
     void disconnectSignals();
+    bool setCenterFreq(double f);
+    void setRecordIQ(bool);
 
 private:
     QList<Call>          callList;
@@ -136,6 +139,7 @@ private:
     QAction              *showToolBar;
     QAction              *deleteAct;
     QAction              *iqShowData;
+    QAction              *recordIQ;
     QAction              *scaleX1;
     QAction              *scaleX2;
     QLabel               txLabel;
@@ -160,10 +164,12 @@ private:
     QUdpSocket           socketUdp,socketUdpN1MM;
     QXmlStreamReader     xmlReader;
     HelpDialog           *help;
+    IQFileWriter         iqRecorder;
     uiSize               uiSizes;
 
     void addCall(QByteArray);
     bool checkUserDirectory();
+    void connectSdrSource();
     void deleteCall(QByteArray);
     void makeCall();
     void makeFreqScaleAbsolute();
@@ -38,7 +38,9 @@ HEADERS += \
     bandmap-tcp.h \
     bandmapdisplay.h \
     helpdialog.h \
-    bandoffsetsetup.h
+    bandoffsetsetup.h \
+    iqfile.h \
+    iqfilesetup.h
 FORMS += \
     iqbalance.ui \
     bandmap.ui \
@@ -47,7 +49,8 @@ FORMS += \
     afedrisetup.ui \
     networksetup.ui \
     helpdialog.ui \
-    bandoffsetsetup.ui
+    bandoffsetsetup.ui \
+    iqfilesetup.ui
 SOURCES += \
     network.cpp \
     networksetup.cpp \
@@ -67,7 +70,9 @@ SOURCES += \
     call.cpp \
     bandmapdisplay.cpp \
     helpdialog.cpp \
-    bandoffsetsetup.cpp
+    bandoffsetsetup.cpp \
+    iqfile.cpp \
+    iqfilesetup.cpp
 
 
  RESOURCES +=  so2sdr-bandmap.qrc
@@ -0,0 +1,193 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include "adifbench.h"
+#include "adifparse.h"
+#include "qso.h"
+
+/*!
+   ADIF file with n records, similar to a contest log exported by logging programs
+ */
+static QByteArray makeAdif(int n)
+{
+    static const char * const bands[] = { "160m", "80m", "40m", "20m", "15m", "10m" };
+    static const char * const freqs[] = { "1.830", "3.530", "7.030", "14.030", "21.030", "28.030" };
+    static const char * const modes[] = { "CW", "SSB", "FT8", "RTTY" };
+    QByteArray adif;
+    adif.reserve(n * 160 + 100);
+    adif.append("so2sdr-bench generated log\n<ADIF_VER:5>3.1.0 <PROGRAMID:12>so2sdr-bench <EOH>\n");
+    for (int i = 0; i < n; i++) {
+        char       call[16];
+        const int  len = sprintf(call, "K%dA%c%c", i % 10, 'A' + (i / 10) % 26, 'A' + (i / 260) % 26);
+        const int  b   = i % 6;
+        char       rec[256];
+        sprintf(rec, "<CALL:%d>%s <QSO_DATE:8>2020%02d%02d <TIME_ON:6>%02d%02d%02d <BAND:%d>%s <FREQ:%d>%s "
+                     "<MODE:%d>%s <RST_SENT:3>599 <RST_RCVD:3>599 <GRIDSQUARE:4>FN%02d <EOR>\n",
+                len, call, 1 + i % 12, 1 + i % 28, (i / 3600) % 24, (i / 60) % 60, i % 60,
+                (int) strlen(bands[b]), bands[b], (int) strlen(freqs[b]), freqs[b],
+                (int) strlen(modes[i % 4]), modes[i % 4], i % 100);
+        adif.append(rec);
+    }
+    return adif;
+}
+
+/*!
+   time the tokenizer alone and full record parsing over an ADIF file, or over a
+   generated log of the given number of records if fileName is empty
+ */
+bool adifBench(const QString &fileName, int records, int iterations)
+{
+    QByteArray adif;
+    if (fileName.isEmpty()) {
+        adif = makeAdif(records);
+    } else {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            fprintf(stderr, "can't open %s\n", fileName.toLatin1().data());
+            return false;
+        }
+        adif = file.readAll();
+    }
+    const double mb = adif.size() / 1048576.0;
+
+    QElapsedTimer timer;
+    int           nFields = 0;
+    timer.start();
+    for (int n = 0; n < iterations; n++) {
+        AdifTokenizer tok(adif.constData(), adif.size());
+        AdifField     f;
+        nFields = 0;
+        while (tok.next(f)) nFields++;
+    }
+    const double tTok = timer.nsecsElapsed() / 1.0e9 / iterations;
+
+    ADIFParse parse;
+    Qso       qso;
+    int       nRecords = 0;
+    timer.restart();
+    for (int n = 0; n < iterations; n++) {
+        AdifTokenizer tok(adif.constData(), adif.size());
+        nRecords = 0;
+        while (parse.nextRecord(tok, &qso)) nRecords++;
+    }
+    const double tParse = timer.nsecsElapsed() / 1.0e9 / iterations;
+
+    printf("adif: %.1f MB, %d fields, %d records\n", mb, nFields, nRecords);
+    printf("adif: tokenize %.1f ms (%.0f MB/s), parse %.1f ms (%.0f records/s)\n", tTok * 1000.0,
+           tTok > 0.0 ? mb / tTok : 0.0, tParse * 1000.0, tParse > 0.0 ? nRecords / tParse : 0.0);
+    return (fileName.isEmpty() ? nRecords == records : nRecords > 0);
+}
+
+/*!
+   random change to an ADIF buffer: byte changes biased towards ADIF syntax, field
+   lengths that run past the end, and truncation
+ */
+static void mutate(QByteArray &data)
+{
+    static const char syntax[] = "<>:0123456789 \n";
+    const int nchange = 1 + rand() % 8;
+    for (int i = 0; i < nchange && !data.isEmpty(); i++) {
+        const int p = rand() % data.size();
+        switch (rand() % 6) {
+        case 0:
+            data[p] = (char) (rand() % 256);
+            break;
+        case 1:
+            data[p] = syntax[rand() % (sizeof(syntax) - 1)];
+            break;
+        case 2:
+            data.insert(p, syntax[rand() % (sizeof(syntax) - 1)]);
+            break;
+        case 3:
+            data.remove(p, 1 + rand() % 16);
+            break;
+        case 4:
+            data.insert(p, (rand() % 2) ? "<CALL:99999>" : "<EOR>");
+            break;
+        case 5:
+            data.truncate(p);
+            break;
+        }
+    }
+}
+
+/*!
+   check that every field lies inside the buffer and that the tokenizer always
+   moves forward. The buffer is copied to an allocation of exactly its size, so
+   a read past the end is caught when built with address sanitizer
+ */
+static bool checkBuffer(const QByteArray &data)
+{
+    const int size = data.size();
+    char     *buff = (char *) malloc(size ? size : 1);
+    memcpy(buff, data.constData(), size);
+    const char *end = buff + size;
+    bool        ok  = true;
+
+    AdifTokenizer tok(buff, size);
+    AdifField     f;
+    int           last = -1;
+    while (ok && tok.next(f)) {
+        if (f.nameLen < 0 || f.valueLen < 0 || f.name < buff || f.name + f.nameLen > end ||
+            f.value < buff || f.value + f.valueLen > end) {
+            ok = false;
+        }
+        if (tok.position() <= last) ok = false;
+        last = tok.position();
+    }
+
+    ADIFParse parse;
+    Qso       qso;
+    AdifTokenizer tok2(buff, size);
+    int           nrec = 0;
+    while (ok && parse.nextRecord(tok2, &qso)) {
+        if (++nrec > size) ok = false;
+    }
+    free(buff);
+    return ok;
+}
+
+/*!
+   tokenize and parse randomly damaged ADIF. Returns false on the first buffer that
+   breaks a check; it is written to adif-fuzz-fail.adi
+ */
+bool adifFuzz(int iterations, unsigned int seed)
+{
+    srand(seed);
+    const QByteArray seedData = makeAdif(20);
+    for (int n = 0; n < iterations; n++) {
+        QByteArray data = seedData;
+        mutate(data);
+        if (!checkBuffer(data)) {
+            printf("adif-fuzz: failed at iteration %d (seed %u)\n", n, seed);
+            QFile file("adif-fuzz-fail.adi");
+            if (file.open(QIODevice::WriteOnly)) {
+                file.write(data);
+            }
+            return false;
+        }
+    }
+    printf("adif-fuzz: %d buffers ok (seed %u)\n", iterations, seed);
+    return true;
+}
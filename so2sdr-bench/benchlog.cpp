@@ -0,0 +1,308 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTime>
+#include "benchlog.h"
+#include "utils.h"
+
+/*!
+   contests known to the benchmarks, with a template for the received exchange.
+   In the template # is a qso number, M1 and M2 a name from the first or second mult
+   list, NAME an operator name, GRID a grid square, CQZ and ITUZ a zone. Anything
+   else is copied as is
+ */
+typedef struct BenchContest {
+    const char *cfg;
+    const char *exch;
+} BenchContest;
+
+static const BenchContest benchContests[] = {
+    { "arrl-june-vhf.cfg", "GRID" },
+    { "arrl10.cfg",        "599 M1" },
+    { "arrl160.cfg",       "599 M1" },
+    { "arrl160dx.cfg",     "599 M1" },
+    { "arrldx.cfg",        "599 100" },
+    { "arrldx-dx.cfg",     "599 M1" },
+    { "cq160.cfg",         "599 M1" },
+    { "cqp.cfg",           "# M1" },
+    { "cqp_ca.cfg",        "# M1" },
+    { "cqww.cfg",          "599 CQZ" },
+    { "cwops.cfg",         "NAME #" },
+    { "dxped.cfg",         "599" },
+    { "fd.cfg",            "2A M1" },
+    { "iaru.cfg",          "599 ITUZ" },
+    { "kqp.cfg",           "599 M1" },
+    { "kqp_ks.cfg",        "599 M1" },
+    { "kqp_rules.cfg",     "599 M1" },
+    { "msqp.cfg",          "599 M1" },
+    { "msqp_ms.cfg",       "599 M1" },
+    { "naqp.cfg",          "NAME M1" },
+    { "nasprint.cfg",      "# NAME M1" },
+    { "ns.cfg",            "# NAME M1" },
+    { "paqp.cfg",          "# M1" },
+    { "paqp_pa.cfg",       "# M1" },
+    { "ss.cfg",            "# A 99 M1" },
+    { "stew.cfg",          "GRID" },
+    { "wpx.cfg",           "599 #" }
+};
+static const int nBenchContests = sizeof(benchContests) / sizeof(benchContests[0]);
+
+// number of different calls in generated logs
+static const int BENCH_CALLS = 5000;
+
+BenchLog::BenchLog()
+{
+    logp      = 0;
+    csettings = 0;
+    settings  = 0;
+}
+
+BenchLog::~BenchLog()
+{
+    delete logp;
+    delete csettings;
+    delete settings;
+
+    // the next BenchLog adds the default connection again
+    QSqlDatabase::removeDatabase(QSqlDatabase::defaultConnection);
+}
+
+/*!
+   cfg files of all contests known to the benchmarks
+ */
+QStringList BenchLog::contests()
+{
+    QStringList l;
+    for (int i = 0; i < nBenchContests; i++) {
+        l.append(benchContests[i].cfg);
+    }
+    return l;
+}
+
+Log *BenchLog::log() const
+{
+    return logp;
+}
+
+QString BenchLog::logFile() const
+{
+    return logName;
+}
+
+/*!
+   set up the contest in cfgFile (a file in the share directory). The log starts empty,
+   or as a copy of the log file oldLog
+ */
+bool BenchLog::open(const QString &cfgFile, const QString &oldLog)
+{
+    exchTemplate.clear();
+    for (int i = 0; i < nBenchContests; i++) {
+        if (cfgFile == benchContests[i].cfg) exchTemplate = benchContests[i].exch;
+    }
+    if (exchTemplate.isEmpty()) {
+        fprintf(stderr, "%s: no exchange template\n", cfgFile.toLatin1().data());
+        return false;
+    }
+    if (!dir.isValid()) {
+        fprintf(stderr, "could not create temporary directory\n");
+        return false;
+    }
+    const QString fileName = dir.path() + "/" + cfgFile;
+    if (!QFile::exists(fileName) && !QFile::copy(dataDirectory() + cfgFile, fileName)) {
+        fprintf(stderr, "can't read %s%s\n", dataDirectory().toLatin1().data(), cfgFile.toLatin1().data());
+        return false;
+    }
+    logName = fileName;
+    logName.remove(".cfg");
+    logName += ".log";
+    if (!oldLog.isEmpty() && !QFile::copy(oldLog, logName)) {
+        fprintf(stderr, "can't copy %s\n", oldLog.toLatin1().data());
+        return false;
+    }
+    QDir().mkpath(userDirectory());
+    if (!QFile::exists(userDirectory() + "/wl_cty.dat")) {
+        QFile::copy(dataDirectory() + "wl_cty.dat", userDirectory() + "/wl_cty.dat");
+    }
+
+    csettings = new QSettings(fileName, QSettings::IniFormat);
+    settings  = new QSettings(dir.path() + "/so2sdr-bench.ini", QSettings::IniFormat);
+    settings->setValue(s_call, "N4OGW");
+    settings->setValue(s_name, "TOR");
+    settings->setValue(s_state, "LA");
+    settings->setValue(s_section, "LA");
+    settings->setValue(s_grid, "EM40");
+    settings->setValue(s_cqzone, 4);
+    settings->setValue(s_ituzone, 7);
+
+    uiSize sizes = { 20.0, 10.0, 16.0, 8.0 };
+    logp = new Log(*csettings, *settings, sizes, 0);
+    logp->setLatLon(30.4, 91.1);
+    logp->selectContest();
+    logp->initializeContest();
+    if (!logp->openLogFile(fileName, false)) {
+        fprintf(stderr, "%s: can't open log file\n", cfgFile.toLatin1().data());
+        return false;
+    }
+
+    for (int ii = 0; ii < MMAX; ii++) {
+        multNames[ii].clear();
+        for (int i = 0; i < logp->nMults(ii); i++) {
+            bool       neededBand, needed;
+            QByteArray name = logp->neededMultName(ii, 0, i, neededBand, needed);
+            if (!name.isEmpty()) multNames[ii].append(name);
+        }
+    }
+
+    // US, VE and DX calls
+    static const char * const pfx[] = { "K", "W", "N", "AA", "KB", "WA", "VE", "VA", "DL", "G", "F", "I",
+                                         "EA", "JA", "UA", "PY", "LU", "VK", "OH", "SM", "OK", "SP" };
+    const int npfx = sizeof(pfx) / sizeof(pfx[0]);
+    calls.clear();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        char call[16];
+        sprintf(call, "%s%d%c%c%c", pfx[i % npfx], (i / npfx) % 10, 'A' + (i / 7) % 26, 'A' + (i / 3) % 26,
+                'A' + i % 26);
+        calls.append(call);
+    }
+    return true;
+}
+
+/*!
+   received exchange for a generated qso
+ */
+QByteArray BenchLog::exchange()
+{
+    static const char * const names[] = { "TOR", "BOB", "ANN", "DAVE", "SUE", "JIM", "KEN", "MARY" };
+    const QList<QByteArray> fields = exchTemplate.split(' ');
+    QByteArray exch;
+    for (int i = 0; i < fields.size(); i++) {
+        const QByteArray &f = fields.at(i);
+        if (i) exch.append(' ');
+        if (f == "#") {
+            exch.append(QByteArray::number(1 + rand() % 2000));
+        } else if (f == "M1" || f == "M2") {
+            const QList<QByteArray> &m = multNames[f.at(1) - '1'];
+            if (!m.isEmpty()) exch.append(m.at(rand() % m.size()));
+        } else if (f == "NAME") {
+            exch.append(names[rand() % 8]);
+        } else if (f == "GRID") {
+            exch.append((char) ('D' + rand() % 4));
+            exch.append((char) ('L' + rand() % 4));
+            exch.append((char) ('0' + rand() % 10));
+            exch.append((char) ('0' + rand() % 10));
+        } else if (f == "CQZ") {
+            exch.append(QByteArray::number(1 + rand() % 40));
+        } else if (f == "ITUZ") {
+            exch.append(QByteArray::number(1 + rand() % 90));
+        } else {
+            exch.append(f);
+        }
+    }
+    return exch;
+}
+
+/*!
+   fill in qso number i of a generated log, up to the exchange entered. The qso is
+   not validated
+ */
+void BenchLog::makeQso(Qso &qso, int i)
+{
+    static const double freqs[] = { 1830000.0, 3530000.0, 7030000.0, 14030000.0, 21030000.0, 28030000.0 };
+    qso.clear();
+    for (int j = 0; j < logp->nExch(); j++) {
+        qso.setExchangeType(j, logp->exchType(j));
+    }
+    qso.call = calls.at(rand() % calls.size());
+    bool qsy;
+    qso.country  = logp->idPfx(&qso, qsy);
+    qso.band     = rand() % 6;
+    qso.freq     = freqs[qso.band] + (rand() % 40) * 1000.0;
+    qso.mode     = (rand() % 4) ? RIG_MODE_CW : RIG_MODE_USB;
+    qso.modeType = getModeType(qso.mode);
+    qso.time     = QDateTime(QDate(2020, 10, 17), QTime(0, 0), Qt::UTC).addSecs(i * 20);
+    qso.nr       = i + 1;
+    qso.exch     = exchange();
+}
+
+/*!
+   add nqso generated and validated qsos to the log in one transaction. The log is
+   not rescored
+ */
+bool BenchLog::fill(int nqso)
+{
+    QSqlDatabase &db    = logp->dataBase();
+    const int    nExch  = logp->nExch();
+    const char   *snt[] = { "snt1", "snt2", "snt3", "snt4" };
+    const char   *rcv[] = { "rcv1", "rcv2", "rcv3", "rcv4" };
+    QByteArray   sent[MAX_EXCH_FIELDS];
+    sent[0] = csettings->value(c_sentexch1, c_sentexch1_def).toByteArray();
+    sent[1] = csettings->value(c_sentexch2, c_sentexch2_def).toByteArray();
+    sent[2] = csettings->value(c_sentexch3, c_sentexch3_def).toByteArray();
+    sent[3] = csettings->value(c_sentexch4, c_sentexch4_def).toByteArray();
+
+    Qso qso(nExch);
+    db.transaction();
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO log (nr,time,freq,call,band,date,mode,snt1,snt2,snt3,snt4,rcv1,rcv2,rcv3,rcv4,pts,valid)"
+                  "VALUES (:nr,:time,:freq,:call,:band,:date,:mode,:snt1,:snt2,:snt3,:snt4,:rcv1,:rcv2,:rcv3,:rcv4,:pts,:valid)");
+    for (int i = 0; i < nqso; i++) {
+        makeQso(qso, i);
+        qso.valid = logp->validateExchange(&qso);
+        query.bindValue(":nr", qso.nr);
+        query.bindValue(":time", qso.time.toString("hhmm"));
+        query.bindValue(":freq", qso.freq);
+        query.bindValue(":call", qso.call);
+        query.bindValue(":band", qso.band);
+        query.bindValue(":date", qso.time.toString("MMddyyyy"));
+        query.bindValue(":mode", (int) qso.mode);
+        for (int j = 0; j < MAX_EXCH_FIELDS; j++) {
+            if (j < nExch) {
+                query.bindValue(QString(":") + snt[j], sent[j] == "#" ? QByteArray::number(qso.nr) : sent[j]);
+                query.bindValue(QString(":") + rcv[j], qso.rcv_exch[j]);
+            } else {
+                query.bindValue(QString(":") + snt[j], QVariant(QVariant::String));
+                query.bindValue(QString(":") + rcv[j], QVariant(QVariant::String));
+            }
+        }
+        query.bindValue(":pts", qso.pts);
+        query.bindValue(":valid", qso.valid);
+        if (!query.exec()) {
+            fprintf(stderr, "log insert failed: %s\n", query.lastError().text().toLatin1().data());
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        fprintf(stderr, "log commit failed: %s\n", db.lastError().text().toLatin1().data());
+        return false;
+    }
+    logp->mod()->select();
+    while (logp->mod()->canFetchMore()) {
+        logp->mod()->fetchMore();
+    }
+    return true;
+}
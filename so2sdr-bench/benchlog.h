@@ -0,0 +1,67 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef BENCHLOG_H
+#define BENCHLOG_H
+
+#include <QByteArray>
+#include <QList>
+#include <QSettings>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include "log.h"
+#include "qso.h"
+
+/*!
+   contest log set up the way so2sdr sets it up, for benchmarks that need contest
+   scoring.
+
+   The contest cfg file is copied from the share directory into a temporary
+   directory, which also holds the station settings and the log file. The cty file
+   is read from the user directory, as in so2sdr. Generated qsos draw calls from a
+   pool, so the log has dupes, and build the exchange from a template for the
+   contest filled in with its own mult names.
+ */
+class BenchLog
+{
+public:
+    BenchLog();
+    ~BenchLog();
+    bool fill(int nqso);
+    Log *log() const;
+    QString logFile() const;
+    void makeQso(Qso &qso, int i);
+    bool open(const QString &cfgFile, const QString &oldLog = QString());
+
+    static QStringList contests();
+
+private:
+    QByteArray exchange();
+
+    QByteArray        exchTemplate;
+    QList<QByteArray> calls;
+    QList<QByteArray> multNames[MMAX];
+    Log               *logp;
+    QSettings         *csettings;
+    QSettings         *settings;
+    QString           logName;
+    QTemporaryDir     dir;
+};
+
+#endif // BENCHLOG_H
@@ -0,0 +1,137 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <stdio.h>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QList>
+#include <QSettings>
+#include <QTemporaryDir>
+#include "defines.h"
+#include "history.h"
+#include "historybench.h"
+#include "qso.h"
+#include "utils.h"
+
+static const char *const historyPfx[] = { "K", "W", "N", "AA", "KB", "KC", "KD", "KE", "KF", "KG", "KI",
+                                          "KJ", "KK", "KN", "KO", "N", "VE", "VA", "WA", "WB", "WD", "G" };
+static const int nHistoryPfx = sizeof(historyPfx) / sizeof(historyPfx[0]);
+
+/*!
+   n'th of a set of distinct calls
+ */
+static QByteArray historyCall(int n)
+{
+    QByteArray call(historyPfx[n % nHistoryPfx]);
+    n /= nHistoryPfx;
+    call.append('0' + n % 10);
+    n /= 10;
+    for (int i = 0; i < 3; i++) {
+        call.append('A' + n % 26);
+        n /= 26;
+    }
+    return call;
+}
+
+/*!
+   start history and wait until the writer thread has read the file. Returns false if
+   the file could not be opened
+ */
+static bool loadHistory(History &history)
+{
+    QEventLoop loop;
+    QObject::connect(&history, SIGNAL(message(const QString &, int)), &loop, SLOT(quit()));
+    history.startHistory();
+    loop.exec();
+    return history.isOpen();
+}
+
+/*!
+   time the exchange history with records calls, as when building history from a large
+   log: adding the qsos and writing them to a new history file, reading the file back
+   into memory, and prefill lookups of every call
+ */
+bool historyBench(int records, int iterations)
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        fprintf(stderr, "could not create temporary directory\n");
+        return false;
+    }
+    // History opens its file relative to the user directory
+    QDir().mkpath(userDirectory());
+    QSettings csettings(dir.path() + "/history.cfg", QSettings::IniFormat);
+    csettings.setValue(c_historyfile, QDir(userDirectory()).relativeFilePath(dir.path() + "/history.dat"));
+    History history(csettings);
+
+    QList<QByteArray> calls;
+    for (int i = 0; i < records; i++) {
+        calls.append(historyCall(i));
+    }
+    Qso qso(2);
+    qso.setExchangeType(0, Name);
+    qso.setExchangeType(1, State);
+    qso.rcv_exch[0] = "TOR";
+    qso.rcv_exch[1] = "LA";
+
+    if (!loadHistory(history)) {
+        fprintf(stderr, "could not create history file\n");
+        return false;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < records; i++) {
+        qso.call = calls.at(i);
+        history.addQso(&qso);
+    }
+    // writes the pending records and waits for the writer thread
+    history.stopHistory();
+    const qint64 insertNs = timer.nsecsElapsed();
+
+    timer.start();
+    if (!loadHistory(history)) {
+        fprintf(stderr, "could not read history file\n");
+        return false;
+    }
+    const qint64 loadNs = timer.nsecsElapsed();
+
+    int found = 0;
+    timer.start();
+    for (int n = 0; n < iterations; n++) {
+        found = 0;
+        for (int i = 0; i < records; i++) {
+            qso.prefill.clear();
+            history.fillExchange(&qso, calls.at(i));
+            if (qso.prefill == "TOR LA") found++;
+        }
+    }
+    const qint64 lookupNs = timer.nsecsElapsed();
+    history.stopHistory();
+
+    printf("history: %d calls\n", records);
+    printf("insert+write %8.1f ms %7.0f ns/call\n", insertNs / 1e6, (double) insertNs / records);
+    printf("load         %8.1f ms %7.0f ns/call\n", loadNs / 1e6, (double) loadNs / records);
+    printf("lookup                  %7.0f ns/call\n", (double) lookupNs / iterations / records);
+    // a failed write shows up as calls missing from the reloaded file
+    if (found != records) {
+        fprintf(stderr, "history: %d of %d calls found after reload\n", found, records);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,253 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QTemporaryDir>
+#include "benchlog.h"
+#include "logbench.h"
+
+/*!
+   time exchange validation for every contest, over records generated qsos. Each
+   exchange goes through the contest's validateExchange as when typed in so2sdr
+ */
+bool exchBench(int records, int iterations)
+{
+    const QStringList cfgs = BenchLog::contests();
+    bool              ok   = true;
+    for (int c = 0; c < cfgs.size(); c++) {
+        srand(1);
+        BenchLog bench;
+        if (!bench.open(cfgs.at(c))) {
+            ok = false;
+            continue;
+        }
+        Log *log = bench.log();
+        QList<Qso *> qsos;
+        for (int i = 0; i < records; i++) {
+            Qso *qso = new Qso(log->nExch());
+            bench.makeQso(*qso, i);
+            qsos.append(qso);
+        }
+        int           nValid = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (int n = 0; n < iterations; n++) {
+            nValid = 0;
+            for (int i = 0; i < records; i++) {
+                if (log->validateExchange(qsos.at(i))) nValid++;
+            }
+        }
+        const double ns = (double) timer.nsecsElapsed() / iterations / records;
+        printf("exch: %-18s %7.0f ns/exchange, %5.1f%% valid\n", cfgs.at(c).toLatin1().data(), ns,
+               100.0 * nValid / records);
+        qDeleteAll(qsos);
+    }
+    return ok;
+}
+
+/*!
+   time ADIF and Cabrillo export of a generated WPX log of records qsos, and check that
+   every valid qso was written
+ */
+bool exportBench(int records, int iterations)
+{
+    srand(1);
+    BenchLog bench;
+    if (!bench.open("wpx.cfg") || !bench.fill(records)) return false;
+    Log *log = bench.log();
+
+    int       nValid = 0;
+    QSqlQuery q(log->dataBase());
+    if (q.exec("SELECT count(*) FROM log where valid=1") && q.next()) {
+        nValid = q.value(0).toInt();
+    }
+    q.finish();
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        fprintf(stderr, "could not create temporary directory\n");
+        return false;
+    }
+    QFile         file(dir.path() + "/export");
+    QElapsedTimer timer;
+    qint64        tAdif = 0;
+    qint64        tCbr  = 0;
+    int           nAdif = 0;
+    int           nCbr  = 0;
+    bool          ok    = true;
+    for (int n = 0; n < iterations && ok; n++) {
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "can't write %s\n", file.fileName().toLatin1().data());
+            return false;
+        }
+        timer.start();
+        ok = log->exportADIF(&file);
+        file.close();
+        tAdif += timer.nsecsElapsed();
+        if (file.open(QIODevice::ReadOnly)) {
+            nAdif = file.readAll().count("<eor>");
+            file.close();
+        }
+
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "can't write %s\n", file.fileName().toLatin1().data());
+            return false;
+        }
+        timer.start();
+        ok = ok && log->exportCabrillo(&file, "N4OGW", "599", "#", "", "");
+        file.close();
+        tCbr += timer.nsecsElapsed();
+        if (file.open(QIODevice::ReadOnly)) {
+            nCbr = file.readAll().count("QSO: ");
+            file.close();
+        }
+    }
+    if (!ok) {
+        printf("export: export failed\n");
+        return false;
+    }
+    const double msAdif = tAdif / 1.0e6 / iterations;
+    const double msCbr  = tCbr / 1.0e6 / iterations;
+    printf("export: %d qsos, %d valid\n", records, nValid);
+    printf("export: ADIF %.1f ms (%.0f qsos/s), Cabrillo %.1f ms (%.0f qsos/s)\n", msAdif,
+           msAdif > 0.0 ? nValid / msAdif * 1000.0 : 0.0, msCbr, msCbr > 0.0 ? nValid / msCbr * 1000.0 : 0.0);
+    if (nAdif != nValid || nCbr != nValid) {
+        printf("export: wrote %d ADIF and %d Cabrillo records, expected %d\n", nAdif, nCbr, nValid);
+        return false;
+    }
+    return true;
+}
+
+/*!
+   time Log::rescore over a generated log of records qsos for the contest in cfgFile
+ */
+bool rescoreBench(const QString &cfgFile, int records, int iterations)
+{
+    srand(1);
+    BenchLog bench;
+    if (!bench.open(cfgFile) || !bench.fill(records)) return false;
+    Log *log = bench.log();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int n = 0; n < iterations; n++) {
+        log->rescore();
+    }
+    const double ms = timer.nsecsElapsed() / 1.0e6 / iterations;
+    const ScoreSummary s = log->scoreSummary();
+    printf("rescore: %s, %d qsos, %d dupes, %d invalid, score %d\n", cfgFile.toLatin1().data(), records,
+           s.nDupes, s.nInvalid, s.score);
+    printf("rescore: %.1f ms (%.0f qsos/s)\n", ms, ms > 0.0 ? records / ms * 1000.0 : 0.0);
+    return (s.nQso + s.nDupes + s.nInvalid == records);
+}
+
+/*!
+   score totals of a log, as shown in so2sdr
+ */
+typedef struct LogTotals {
+    ScoreSummary summary;
+    int          nQso[N_BANDS];
+    int          nMults[MMAX][N_BANDS + 1];
+} LogTotals;
+
+/*!
+   rescore the log and read back its totals
+ */
+static LogTotals rescoreTotals(Log *log)
+{
+    LogTotals t;
+    log->rescore();
+    t.summary = log->scoreSummary();
+    for (int b = 0; b < N_BANDS; b++) {
+        t.nQso[b] = log->nQso(b);
+    }
+    for (int ii = 0; ii < MMAX; ii++) {
+        for (int b = 0; b <= N_BANDS; b++) {
+            t.nMults[ii][b] = log->nMultsBWorked(ii, b);
+        }
+    }
+    return t;
+}
+
+static bool compareTotal(const char *name, int a, int b)
+{
+    if (a == b) return true;
+    printf("rules-check: %s differs: kqp %d, rules %d\n", name, a, b);
+    return false;
+}
+
+/*!
+   score one generated Kansas QSO Party log with the KQP class (kqp.cfg) and with the
+   cfg file rules (kqp_rules.cfg). Fails if points, mults or dupes differ
+ */
+bool rulesCheck(int records, unsigned int seed)
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        fprintf(stderr, "could not create temporary directory\n");
+        return false;
+    }
+    const QString logFile = dir.path() + "/kqp.log";
+    LogTotals     kqp;
+    LogTotals     rules;
+    {
+        srand(seed);
+        BenchLog bench;
+        if (!bench.open("kqp.cfg") || !bench.fill(records)) return false;
+        kqp = rescoreTotals(bench.log());
+        bench.log()->closeLogFile();
+        if (!QFile::copy(bench.logFile(), logFile)) {
+            fprintf(stderr, "can't copy %s\n", bench.logFile().toLatin1().data());
+            return false;
+        }
+    }
+    {
+        BenchLog bench;
+        if (!bench.open("kqp_rules.cfg", logFile)) return false;
+        rules = rescoreTotals(bench.log());
+    }
+
+    bool ok = true;
+    ok &= compareTotal("score", kqp.summary.score, rules.summary.score);
+    ok &= compareTotal("qso points", kqp.summary.qsoPts, rules.summary.qsoPts);
+    ok &= compareTotal("qsos", kqp.summary.nQso, rules.summary.nQso);
+    ok &= compareTotal("dupes", kqp.summary.nDupes, rules.summary.nDupes);
+    ok &= compareTotal("invalid qsos", kqp.summary.nInvalid, rules.summary.nInvalid);
+    ok &= compareTotal("mults", kqp.summary.nMults, rules.summary.nMults);
+    for (int b = 0; b < N_BANDS; b++) {
+        const QByteArray name = "qsos on " + bandName[b].toLatin1();
+        ok &= compareTotal(name.data(), kqp.nQso[b], rules.nQso[b]);
+    }
+    for (int ii = 0; ii < MMAX; ii++) {
+        for (int b = 0; b <= N_BANDS; b++) {
+            const QByteArray name = "mult" + QByteArray::number(ii + 1) + " on " +
+                                    (b < N_BANDS ? bandName[b].toLatin1() : QByteArray("all bands"));
+            ok &= compareTotal(name.data(), kqp.nMults[ii][b], rules.nMults[ii][b]);
+        }
+    }
+    printf("rules-check: %d qsos, %d dupes, %d invalid, %d qso points, %d mults, score %d: %s\n",
+           kqp.summary.nQso, kqp.summary.nDupes, kqp.summary.nInvalid, kqp.summary.qsoPts,
+           kqp.summary.nMults, kqp.summary.score, ok ? "same" : "DIFFERENT");
+    return ok;
+}
@@ -0,0 +1,29 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef LOGBENCH_H
+#define LOGBENCH_H
+
+#include <QString>
+
+bool exchBench(int records, int iterations);
+bool exportBench(int records, int iterations);
+bool rescoreBench(const QString &cfgFile, int records, int iterations);
+bool rulesCheck(int records, unsigned int seed);
+
+#endif // LOGBENCH_H
@@ -0,0 +1,121 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QApplication>
+#include <QCommandLineParser>
+#include "adifbench.h"
+#include "historybench.h"
+#include "logbench.h"
+#include "wpxbench.h"
+
+/*
+  so2sdr-bench: regression checks and timings for so2sdr parsing and scoring code.
+
+  wpx <corpus>   check WPX prefixes against a corpus of calls and time the
+                 old and new prefix code
+  adif [file]    time the ADIF tokenizer and record parser over an ADIF file, or
+                 over a generated log of --records records
+  adif-fuzz      tokenize and parse randomly damaged ADIF, checking that no field
+                 points outside the buffer. Build with
+                 CONFIG+=sanitizer CONFIG+=sanitize_address to catch any read past
+                 the end
+  exch           time exchange validation for each contest over --records
+                 generated qsos
+  export         time ADIF and Cabrillo export of a generated WPX log of --records
+                 qsos
+  rescore [cfg]  time rescoring a generated log of --records qsos for the contest
+                 in cfg (a file in the share directory, default wpx.cfg)
+  history        time adding --records calls to a new exchange history file,
+                 reading it back and prefill lookups of every call
+  rules-check    score a generated Kansas QSO Party log of --records qsos with
+                 the KQP class (kqp.cfg) and with contest=RULES (kqp_rules.cfg),
+                 failing if points, mults or dupes differ
+
+  The contest modes read the contest files from the installed share directory and
+  the cty file from ~/.so2sdr, as so2sdr does. They need a QApplication for the log
+  widgets; unless QT_QPA_PLATFORM is set the offscreen platform is used.
+*/
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("so2sdr-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Parser and scoring regression checks and benchmarks for so2sdr");
+    parser.addHelpOption();
+    QCommandLineOption iterOpt("iterations","passes over the input for timing, or fuzz buffers","n");
+    QCommandLineOption recordsOpt("records","records in generated ADIF log, or generated qsos","n");
+    QCommandLineOption seedOpt("seed","random seed for adif-fuzz and rules-check","n","1");
+    parser.addOption(iterOpt);
+    parser.addOption(recordsOpt);
+    parser.addOption(seedOpt);
+    parser.addPositionalArgument("test","wpx, adif, adif-fuzz, exch, export, rescore, history, or rules-check","test");
+    parser.addPositionalArgument("file","input file, or contest cfg file for rescore","[file]");
+    parser.process(app);
+
+    const QStringList args=parser.positionalArguments();
+    if (args.isEmpty()) {
+        parser.showHelp(-1);
+    }
+    const QString test=args.at(0);
+    int iterations=parser.value(iterOpt).toInt();
+    if (!parser.isSet(iterOpt)) {
+        if (test=="wpx") iterations=10000;
+        else if (test=="adif") iterations=5;
+        else if (test=="exch") iterations=20;
+        else if (test=="export") iterations=3;
+        else if (test=="rescore") iterations=5;
+        else if (test=="history") iterations=5;
+        else iterations=100000;
+    }
+    iterations=qMax(1,iterations);
+    int records=parser.value(recordsOpt).toInt();
+    if (!parser.isSet(recordsOpt)) {
+        if (test=="exch") records=1000;
+        else if (test=="export") records=50000;
+        else if (test=="rescore") records=10000;
+        else if (test=="rules-check") records=5000;
+        else if (test=="history") records=200000;
+        else records=100000;
+    }
+    records=qMax(1,records);
+    bool ok=false;
+    if (test=="wpx" && args.size()==2) {
+        ok=wpxBench(args.at(1),iterations);
+    } else if (test=="adif" && args.size()<=2) {
+        ok=adifBench(args.size()==2 ? args.at(1) : QString(),records,iterations);
+    } else if (test=="adif-fuzz" && args.size()==1) {
+        ok=adifFuzz(iterations,parser.value(seedOpt).toUInt());
+    } else if (test=="exch" && args.size()==1) {
+        ok=exchBench(records,iterations);
+    } else if (test=="export" && args.size()==1) {
+        ok=exportBench(records,iterations);
+    } else if (test=="rescore" && args.size()<=2) {
+        ok=rescoreBench(args.size()==2 ? args.at(1) : QString("wpx.cfg"),records,iterations);
+    } else if (test=="history" && args.size()==1) {
+        ok=historyBench(records,iterations);
+    } else if (test=="rules-check" && args.size()==1) {
+        ok=rulesCheck(records,parser.value(seedOpt).toUInt());
+    } else {
+        parser.showHelp(-1);
+    }
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,106 @@
+# This file is part of so2sdr.
+# so2sdr is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# any later version.
+# so2sdr is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# You should have received a copy of the GNU General Public License
+# along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+TEMPLATE = app
+TARGET = so2sdr-bench
+
+QT += sql widgets
+CONFIG += console
+
+INCLUDEPATH += ../so2sdr
+
+HEADERS += adifbench.h \
+    benchlog.h \
+    historybench.h \
+    logbench.h \
+    wpxbench.h \
+    ../so2sdr/adifparse.h \
+    ../so2sdr/contest.h \
+    ../so2sdr/contest_arrl10.h \
+    ../so2sdr/contest_arrl160.h \
+    ../so2sdr/contest_arrldx.h \
+    ../so2sdr/contest_cq160.h \
+    ../so2sdr/contest_cqp.h \
+    ../so2sdr/contest_cqww.h \
+    ../so2sdr/contest_cwops.h \
+    ../so2sdr/contest_dxped.h \
+    ../so2sdr/contest_fd.h \
+    ../so2sdr/contest_iaru.h \
+    ../so2sdr/contest_junevhf.h \
+    ../so2sdr/contest_kqp.h \
+    ../so2sdr/contest_msqp.h \
+    ../so2sdr/contest_naqp.h \
+    ../so2sdr/contest_paqp.h \
+    ../so2sdr/contest_rules.h \
+    ../so2sdr/contest_sprint.h \
+    ../so2sdr/contest_stew.h \
+    ../so2sdr/contest_sweepstakes.h \
+    ../so2sdr/contest_wpx.h \
+    ../so2sdr/cty.h \
+    ../so2sdr/detailededit.h \
+    ../so2sdr/exchtokenizer.h \
+    ../so2sdr/history.h \
+    ../so2sdr/log.h \
+    ../so2sdr/logdelegate.h \
+    ../so2sdr/logedit.h \
+    ../so2sdr/logimporter.h \
+    ../so2sdr/qso.h \
+    ../so2sdr/utils.h \
+    ../so2sdr/wpxprefix.h
+SOURCES += main.cpp \
+    adifbench.cpp \
+    benchlog.cpp \
+    historybench.cpp \
+    logbench.cpp \
+    wpxbench.cpp \
+    ../so2sdr/adifparse.cpp \
+    ../so2sdr/contest.cpp \
+    ../so2sdr/contest_arrl10.cpp \
+    ../so2sdr/contest_arrl160.cpp \
+    ../so2sdr/contest_arrldx.cpp \
+    ../so2sdr/contest_cq160.cpp \
+    ../so2sdr/contest_cqp.cpp \
+    ../so2sdr/contest_cqww.cpp \
+    ../so2sdr/contest_cwops.cpp \
+    ../so2sdr/contest_dxped.cpp \
+    ../so2sdr/contest_fd.cpp \
+    ../so2sdr/contest_iaru.cpp \
+    ../so2sdr/contest_junevhf.cpp \
+    ../so2sdr/contest_kqp.cpp \
+    ../so2sdr/contest_msqp.cpp \
+    ../so2sdr/contest_naqp.cpp \
+    ../so2sdr/contest_paqp.cpp \
+    ../so2sdr/contest_rules.cpp \
+    ../so2sdr/contest_sprint.cpp \
+    ../so2sdr/contest_stew.cpp \
+    ../so2sdr/contest_sweepstakes.cpp \
+    ../so2sdr/contest_wpx.cpp \
+    ../so2sdr/cty.cpp \
+    ../so2sdr/detailededit.cpp \
+    ../so2sdr/exchtokenizer.cpp \
+    ../so2sdr/history.cpp \
+    ../so2sdr/log.cpp \
+    ../so2sdr/logdelegate.cpp \
+    ../so2sdr/logedit.cpp \
+    ../so2sdr/logimporter.cpp \
+    ../so2sdr/qso.cpp \
+    ../so2sdr/utils.cpp \
+    ../so2sdr/wpxprefix.cpp
+FORMS += ../so2sdr/detailededit.ui
+
+unix {
+    include (../common.pri)
+    CONFIG += link_pkgconfig
+    PKGCONFIG += hamlib
+    QMAKE_CXXFLAGS += -O2 -Wall -DINSTALL_DIR=\\\"$$SO2SDR_INSTALL_DIR\\\"
+}
@@ -0,0 +1,186 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <stdio.h>
+#include "wpxbench.h"
+#include "wpxprefix.h"
+
+/*!
+   WPX prefix as computed before the char buffer version in wpxprefix.cpp. Kept
+   unchanged as the reference for the regression corpus
+ */
+void oldWpxPrefix(QByteArray call, QByteArray &pfx)
+{
+    const char digits[10] = { '1', '2', '3', '4', '5', '6', '7', '8', '9', '0' };
+    const int nIgnorePfx=8;
+    const QByteArray ignorePfx[nIgnorePfx]={"P","M","QRP","AE","AG","KT","MM","AM"};
+    bool changeDigit=false;
+    bool ignore=false;
+    QByteArray portPfx="";
+    pfx = "";
+
+    // is it a portable?
+    if (call.contains("/")) {
+        int        j    = call.indexOf("/");
+        QByteArray tmp1 = call.mid(0, j);
+        QByteArray tmp2 = call.mid(j + 1, call.length() - j - 1);
+
+        // the longer one is probably the call, the other the port pfx
+        // tmp1/tmp2
+        if (tmp2.length() > tmp1.length()) {
+            portPfx = tmp1;
+            call=call.right(call.length()-tmp1.length()-1);
+        } else {
+            portPfx = tmp2;
+            call.chop(tmp2.length()+1);
+        }
+
+        // certain portable prefixes do not count as new pfx
+        for (int i=0;i<nIgnorePfx;i++) {
+            if (portPfx==ignorePfx[i]) {
+                portPfx.clear();
+                ignore=true;
+                break;
+            }
+        }
+        if (!ignore) {
+            // is there a digit in the portable pfx?
+            bool isdigit = false;
+            for (int i = 0; i < 10; i++) {
+                if (portPfx.contains(digits[i])) {
+                    isdigit = true;
+                    break;
+                }
+            }
+            if (portPfx.length()==1) {
+
+                if (isdigit) {
+                    // if the port Pfx is 1 character and a digit, it will modify the main pfx
+                    changeDigit=true;
+                } else {
+                    // single character pfx: must add '0' to form pfx
+                    portPfx = portPfx + "0";
+                }
+            }
+        }
+    }
+
+    // is there a digit in the call? Find LAST digit
+    int j = -1;
+    for (int i = 0; i < 10; i++) {
+        for (int k = 0; k < call.length(); k++) {
+            if ((call.at(k) == digits[i]) && k > j) {
+                j = k;
+            }
+        }
+    }
+    if (j != -1) {
+        // take up to the last digit in the call
+        pfx = call.mid(0, j + 1);
+    } else {
+        // take first 2 letters and add zero
+        pfx = call.mid(0, 2) + "0";
+    }
+
+    // apply change from portable digit
+    if (changeDigit) {
+        pfx.chop(1);
+        pfx=pfx+portPfx;
+    } else if (portPfx.length()>1) {
+        pfx=portPfx;
+    }
+}
+
+/*! prefix from the current version, as WPX::wpxPrefix computes it on a cache miss
+ */
+static QByteArray newWpxPrefix(const QByteArray &call)
+{
+    char buff[64];
+    int  n = call.size();
+    if (n > (int) sizeof(buff) - 2) n = sizeof(buff) - 2;
+    int  len = wpxPrefix(call.constData(), n, buff);
+    return QByteArray(buff, len);
+}
+
+/*!
+   check both prefix versions against the corpus file (lines of "call prefix"), then
+   time each over the corpus. Returns false if any prefix differs
+ */
+bool wpxBench(const QString &corpus, int iterations)
+{
+    QFile file(corpus);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        fprintf(stderr,"can't open %s\n",corpus.toLatin1().data());
+        return false;
+    }
+    QList<QByteArray> calls;
+    QList<QByteArray> expected;
+    while (!file.atEnd()) {
+        QByteArray line=file.readLine().simplified();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+        QList<QByteArray> field=line.split(' ');
+        if (field.size()!=2) {
+            fprintf(stderr,"bad corpus line: %s\n",line.data());
+            return false;
+        }
+        calls.append(field.at(0));
+        expected.append(field.at(1));
+    }
+    file.close();
+    if (calls.isEmpty()) {
+        fprintf(stderr,"no calls in %s\n",corpus.toLatin1().data());
+        return false;
+    }
+
+    int nfail=0;
+    for (int i=0;i<calls.size();i++) {
+        QByteArray oldPfx;
+        oldWpxPrefix(calls.at(i),oldPfx);
+        const QByteArray newPfx=newWpxPrefix(calls.at(i));
+        if (oldPfx!=expected.at(i) || newPfx!=expected.at(i)) {
+            printf("FAIL %-14s expected %-6s old %-6s new %s\n",calls.at(i).data(),expected.at(i).data(),
+                   oldPfx.data(),newPfx.data());
+            nfail++;
+        }
+    }
+    printf("wpx: %d calls, %d failed\n",calls.size(),nfail);
+
+    // timing
+    QElapsedTimer timer;
+    QByteArray    pfx;
+    timer.start();
+    for (int n=0;n<iterations;n++) {
+        for (int i=0;i<calls.size();i++) {
+            oldWpxPrefix(calls.at(i),pfx);
+        }
+    }
+    const qint64 tOld=timer.nsecsElapsed();
+    timer.restart();
+    for (int n=0;n<iterations;n++) {
+        for (int i=0;i<calls.size();i++) {
+            pfx=newWpxPrefix(calls.at(i));
+        }
+    }
+    const qint64 tNew=timer.nsecsElapsed();
+    const double nCalls=(double)iterations*calls.size();
+    printf("wpx: old %.1f ns/call, new %.1f ns/call\n",tOld/nCalls,tNew/nCalls);
+    return nfail==0;
+}
@@ -0,0 +1,68 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <stdio.h>
+#include "historybuilder.h"
+
+/*
+  so2sdr-history: builds an so2sdr exchange history file from past logs.
+
+  Input files can be so2sdr .log files, Cabrillo, ADIF, or N1MM-style call
+  history files. Existing entries in the output file are kept unless a newer
+  value is found.
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("so2sdr-history");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Build an so2sdr history file from past logs");
+    parser.addHelpOption();
+    QCommandLineOption outOpt(QStringList() << "o" << "output","history file to create or update","file");
+    QCommandLineOption exchOpt("exchange","received fields of .log and Cabrillo files, eg NAME,STATE. "
+                               "Types are GENERAL, RST, MULT, ZONE, NR, NAME, STATE, SECTION, GRID, NUMBER","list");
+    QCommandLineOption minOpt("min-count","only add calls seen in at least n input records","n","1");
+    parser.addOption(outOpt);
+    parser.addOption(exchOpt);
+    parser.addOption(minOpt);
+    parser.addPositionalArgument("files","log and call history files to read","files...");
+    parser.process(app);
+
+    const QStringList files=parser.positionalArguments();
+    if (!parser.isSet(outOpt) || files.isEmpty()) {
+        parser.showHelp(-1);
+    }
+    QList<FieldTypes> types;
+    if (!HistoryBuilder::parseExchange(parser.value(exchOpt),types)) {
+        fprintf(stderr,"bad exchange list %s\n",parser.value(exchOpt).toLatin1().data());
+        return -1;
+    }
+    HistoryBuilder builder;
+    builder.setExchange(types);
+    builder.setMinCount(parser.value(minOpt).toInt());
+    for (int i=0;i<files.size();i++) {
+        builder.addFile(files.at(i));
+    }
+    bool ok=builder.build(parser.value(outOpt));
+    printf("%d records read from %d files, %d calls in %s\n",builder.nRecords(),files.size(),builder.nCalls(),
+           parser.value(outOpt).toLatin1().data());
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,43 @@
+# This file is part of so2sdr.
+# so2sdr is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# any later version.
+# so2sdr is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# You should have received a copy of the GNU General Public License
+# along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+TEMPLATE = app
+TARGET = so2sdr-history
+
+QT += sql widgets
+CONFIG += console
+
+INCLUDEPATH += ../so2sdr
+
+HEADERS += ../so2sdr/adifparse.h \
+    ../so2sdr/exchtokenizer.h \
+    ../so2sdr/history.h \
+    ../so2sdr/historybuilder.h \
+    ../so2sdr/logimporter.h \
+    ../so2sdr/qso.h \
+    ../so2sdr/utils.h
+SOURCES += main.cpp \
+    ../so2sdr/adifparse.cpp \
+    ../so2sdr/exchtokenizer.cpp \
+    ../so2sdr/history.cpp \
+    ../so2sdr/historybuilder.cpp \
+    ../so2sdr/logimporter.cpp \
+    ../so2sdr/qso.cpp \
+    ../so2sdr/utils.cpp
+
+unix {
+    include (../common.pri)
+    CONFIG += link_pkgconfig
+    PKGCONFIG += hamlib
+    QMAKE_CXXFLAGS += -O2 -Wall -DINSTALL_DIR=\\\"$$SO2SDR_INSTALL_DIR\\\"
+}
@@ -0,0 +1,268 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QMetaObject>
+#include <QSettings>
+#include <QtGlobal>
+#include <stdio.h>
+#include "harness.h"
+#include "rigsim.h"
+#include "serial.h"
+#include "utils.h"
+
+// time (ms) to wait for each step before counting it as lost
+const int HARNESS_STEP_TIMEOUT=3000;
+
+RigHarness::RigHarness(int lat, int jit, int n, QObject *parent) : QObject(parent)
+{
+    latency=lat;
+    jitter=jit;
+    iterations=n;
+    count=0;
+    stepRadio=0;
+    stepTime=0;
+    targetFreq=0;
+    targetMode=RIG_MODE_CW;
+    timeouts=0;
+    phase=Connect;
+    connectFailed=false;
+    settings=nullptr;
+    for (int i=0;i<NRIG;i++) {
+        cat[i]=nullptr;
+        sim[i]=nullptr;
+        radioReady[i]=false;
+    }
+    timeout.setSingleShot(true);
+    connect(&timeout,SIGNAL(timeout()),this,SLOT(stepTimeout()));
+}
+
+RigHarness::~RigHarness()
+{
+    for (int i=0;i<NRIG;i++) {
+        if (catThread[i].isRunning()) {
+            catThread[i].quit();
+            catThread[i].wait();
+        }
+        delete cat[i];
+    }
+    delete settings;
+}
+
+/*! start simulated radios and both radio threads
+ */
+bool RigHarness::start(quint16 port1, quint16 port2)
+{
+    if (!dir.isValid()) {
+        fprintf(stderr,"could not create temporary directory\n");
+        return false;
+    }
+    const quint16 port[NRIG]={port1,port2};
+    QString settingsFile=dir.path()+"/righarness.ini";
+    settings=new QSettings(settingsFile,QSettings::IniFormat);
+    for (int i=0;i<NRIG;i++) {
+        settings->setValue(s_radios_rig[i],RIG_MODEL_DUMMY);
+        settings->setValue(s_radios_rigctld_enable[i],true);
+        settings->setValue(s_radios_rigctld_ip[i],"localhost");
+        settings->setValue(s_radios_rigctld_port[i],port[i]);
+    }
+    settings->sync();
+
+    qRegisterMetaType<rmode_t>("rmode_t");
+    qRegisterMetaType<pbwidth_t>("pbwidth_t");
+    qRegisterMetaType<qint64>("qint64");
+    for (int i=0;i<NRIG;i++) {
+        sim[i]=new RigSim(i,this);
+        sim[i]->setLatency(latency,jitter);
+        if (!sim[i]->listen(port[i])) {
+            fprintf(stderr,"radio %d: could not listen on port %d\n",i+1,port[i]);
+            return false;
+        }
+        connect(sim[i],SIGNAL(freqChanged(int,double)),this,SLOT(simFreqChanged(int,double)));
+
+        cat[i]=new RigSerial(i,settingsFile);
+        cat[i]->moveToThread(&catThread[i]);
+        connect(&catThread[i],SIGNAL(started()),cat[i],SLOT(run()));
+        connect(cat[i],SIGNAL(rigChanged(int,double,quint64,qint64)),this,SLOT(rigChanged(int,double,quint64,qint64)));
+    }
+    connect(this,SIGNAL(qsy1(double)),cat[0],SLOT(qsyExact(double)));
+    connect(this,SIGNAL(qsy2(double)),cat[1],SLOT(qsyExact(double)));
+    for (int i=0;i<NRIG;i++) {
+        catThread[i].start();
+    }
+    printf("rigctld latency %d ms, jitter %d ms, %d iterations\n",latency,jitter,iterations);
+
+    // measurements start once both radio threads have read the initial state
+    timeout.start(HARNESS_STEP_TIMEOUT);
+    return true;
+}
+
+/*! start the next measurement
+ */
+void RigHarness::nextStep()
+{
+    if (phase==Connect || count==iterations) {
+        count=0;
+        switch (phase) {
+        case Connect:
+            phase=Qsy;
+            break;
+        case Qsy:
+            phase=Track;
+            break;
+        case Track:
+            phase=Mode;
+            break;
+        default:
+            phase=Done;
+            break;
+        }
+    }
+    stepRadio=count%NRIG;
+    double f=sim[stepRadio]->freq();
+    switch (phase) {
+    case Qsy:
+        // program qsy, as from the bandmap or a keyboard command
+        targetFreq=f+100+(count%10)*10;
+        stepTime=monotonicUsec();
+        timeout.start(HARNESS_STEP_TIMEOUT);
+        if (stepRadio==0) {
+            emit(qsy1(targetFreq));
+        } else {
+            emit(qsy2(targetFreq));
+        }
+        break;
+    case Track:
+        // operator tunes the VFO knob
+        targetFreq=f-50-(count%10)*10;
+        stepTime=monotonicUsec();
+        timeout.start(HARNESS_STEP_TIMEOUT);
+        sim[stepRadio]->setFreq(targetFreq);
+        break;
+    case Mode:
+        if (sim[stepRadio]->mode()=="CW") {
+            targetMode=RIG_MODE_USB;
+        } else {
+            targetMode=RIG_MODE_CW;
+        }
+        stepTime=monotonicUsec();
+        timeout.start(HARNESS_STEP_TIMEOUT);
+        sim[stepRadio]->setMode(rig_strrmode(targetMode));
+        break;
+    default:
+        report();
+        stop();
+        break;
+    }
+}
+
+/*! stop the radio threads and quit
+ */
+void RigHarness::stop()
+{
+    for (int i=0;i<NRIG;i++) {
+        QMetaObject::invokeMethod(cat[i],"stopSerial",Qt::BlockingQueuedConnection);
+    }
+    emit(finished());
+}
+
+/*! returns true if both radios connected
+ */
+bool RigHarness::connected() const
+{
+    return !connectFailed;
+}
+
+/*! record one result and schedule the next step. A random gap keeps the
+ * steps from locking to the radio poll interval
+ */
+void RigHarness::finishStep(LatencyStats &stats)
+{
+    timeout.stop();
+    stats.add(monotonicUsec()-stepTime);
+    stepTime=0;
+    count++;
+    QTimer::singleShot(50+qrand()%200,this,SLOT(nextStep()));
+}
+
+/*! qsy has reached the simulated radio
+ */
+void RigHarness::simFreqChanged(int nr, double f)
+{
+    if (phase==Qsy && stepTime && nr==stepRadio && f==targetFreq) {
+        finishStep(qsyLatency);
+    }
+}
+
+/*! change from the radio thread has reached the main thread
+ */
+void RigHarness::rigChanged(int nr, double f, quint64 mode, qint64 t)
+{
+    Q_UNUSED(t)
+    if (phase==Connect) {
+        // first rigChanged from each radio carries its initial state
+        radioReady[nr]=true;
+        for (int i=0;i<NRIG;i++) {
+            if (!radioReady[i]) return;
+        }
+        timeout.stop();
+        nextStep();
+        return;
+    }
+    if (!stepTime || nr!=stepRadio) return;
+    if (phase==Track && f==targetFreq) {
+        finishStep(trackLatency);
+    } else if (phase==Mode && (rmode_t)mode==targetMode) {
+        finishStep(modeLatency);
+    }
+}
+
+void RigHarness::stepTimeout()
+{
+    if (phase==Connect) {
+        fprintf(stderr,"radios did not report their initial state\n");
+        connectFailed=true;
+        stop();
+        return;
+    }
+    timeouts++;
+    stepTime=0;
+    count++;
+    nextStep();
+}
+
+void RigHarness::report()
+{
+    QString s;
+    s=qsyLatency.summary("qsy");
+    printf("%s\n",s.toLatin1().data());
+    s=qsyLatency.histogramSummary("qsy");
+    printf("%s\n",s.toLatin1().data());
+    s=trackLatency.summary("tracking");
+    printf("%s\n",s.toLatin1().data());
+    s=trackLatency.histogramSummary("tracking");
+    printf("%s\n",s.toLatin1().data());
+    s=modeLatency.summary("mode");
+    printf("%s\n",s.toLatin1().data());
+    s=modeLatency.histogramSummary("mode");
+    printf("%s\n",s.toLatin1().data());
+    for (int i=0;i<NRIG;i++) {
+        s=cat[i]->latencySummary();
+        printf("radio %d %s\n",i+1,s.toLatin1().data());
+    }
+    printf("timeouts: %d\n",timeouts);
+}
@@ -0,0 +1,99 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include "defines.h"
+#include "latency.h"
+#include <hamlib/rig.h>
+
+class QSettings;
+class RigSerial;
+class RigSim;
+
+/*!
+   Headless timing harness: runs both RigSerial radio threads against two
+   in-process simulated radios and measures
+
+   - qsy: qsyExact request until the simulated radio has changed frequency
+   - tracking: simulated radio tuned (as by the VFO knob) until rigChanged arrives
+   - mode: simulated radio mode change until rigChanged arrives
+ */
+class RigHarness : public QObject
+{
+    Q_OBJECT
+public:
+    RigHarness(int latency, int jitter, int iterations, QObject *parent = nullptr);
+    ~RigHarness();
+    bool connected() const;
+    bool start(quint16 port1, quint16 port2);
+
+signals:
+    void finished();
+    void qsy1(double);
+    void qsy2(double);
+
+private slots:
+    void nextStep();
+    void rigChanged(int nr, double f, quint64 mode, qint64 t);
+    void simFreqChanged(int nr, double f);
+    void stepTimeout();
+
+private:
+    typedef enum {
+        Connect,
+        Qsy,
+        Track,
+        Mode,
+        Done
+    } Phase;
+
+    bool                   connectFailed;
+    bool                   radioReady[NRIG];
+    double                 targetFreq;
+    int                    count;
+    int                    iterations;
+    int                    jitter;
+    int                    latency;
+    int                    stepRadio;
+    int                    timeouts;
+    qint64                 stepTime;
+    rmode_t                targetMode;
+    LatencyStats           qsyLatency;
+    LatencyStats           trackLatency;
+    LatencyStats           modeLatency;
+    Phase                  phase;
+    QSettings              *settings;
+    QTemporaryDir          dir;
+    QThread                catThread[NRIG];
+    QTimer                 timeout;
+    RigSerial              *cat[NRIG];
+    RigSim                 *sim[NRIG];
+
+    void finishStep(LatencyStats &stats);
+    void report();
+    void stop();
+};
+
+#endif // HARNESS_H
@@ -0,0 +1,57 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include "harness.h"
+
+/*
+  so2sdr-righarness: measures radio control latency without hardware or GUI.
+
+  Runs both radio threads against simulated rigctld radios and reports qsy,
+  frequency tracking, and mode change latency percentiles.
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("so2sdr-righarness");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Radio latency test harness for so2sdr");
+    parser.addHelpOption();
+    QCommandLineOption port1Opt("port1","TCP port for simulated radio 1","port","14532");
+    QCommandLineOption port2Opt("port2","TCP port for simulated radio 2","port","14534");
+    QCommandLineOption latencyOpt("latency","simulated rigctld reply latency","ms","5");
+    QCommandLineOption jitterOpt("jitter","random extra reply latency, 0 to this value","ms","5");
+    QCommandLineOption iterOpt("iterations","measurements per test","n","200");
+    parser.addOption(port1Opt);
+    parser.addOption(port2Opt);
+    parser.addOption(latencyOpt);
+    parser.addOption(jitterOpt);
+    parser.addOption(iterOpt);
+    parser.process(app);
+
+    RigHarness harness(parser.value(latencyOpt).toInt(),parser.value(jitterOpt).toInt(),
+                       qMax(1,parser.value(iterOpt).toInt()));
+    QObject::connect(&harness,SIGNAL(finished()),&app,SLOT(quit()),Qt::QueuedConnection);
+    if (!harness.start(parser.value(port1Opt).toInt(),parser.value(port2Opt).toInt())) {
+        return -1;
+    }
+    int status=app.exec();
+    return harness.connected() ? status : -1;
+}
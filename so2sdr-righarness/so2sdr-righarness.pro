@@ -0,0 +1,43 @@
+# This file is part of so2sdr.
+# so2sdr is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# any later version.
+# so2sdr is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# You should have received a copy of the GNU General Public License
+# along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+TEMPLATE = app
+TARGET = so2sdr-righarness
+
+QT += network widgets
+CONFIG += console
+
+INCLUDEPATH += ../so2sdr ../so2sdr-rigsim
+
+HEADERS += harness.h \
+    ../so2sdr/latency.h \
+    ../so2sdr/rigctld.h \
+    ../so2sdr/rigmailbox.h \
+    ../so2sdr/serial.h \
+    ../so2sdr/utils.h \
+    ../so2sdr-rigsim/rigsim.h
+SOURCES += main.cpp \
+    harness.cpp \
+    ../so2sdr/latency.cpp \
+    ../so2sdr/rigctld.cpp \
+    ../so2sdr/rigmailbox.cpp \
+    ../so2sdr/serial.cpp \
+    ../so2sdr/utils.cpp \
+    ../so2sdr-rigsim/rigsim.cpp
+
+unix {
+    include (../common.pri)
+    CONFIG += link_pkgconfig
+    PKGCONFIG += hamlib
+    QMAKE_CXXFLAGS += -O2 -Wall -DINSTALL_DIR=\\\"$$SO2SDR_INSTALL_DIR\\\"
+}
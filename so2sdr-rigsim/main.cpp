@@ -0,0 +1,75 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QStringList>
+#include <stdio.h>
+#include "rigsim.h"
+
+/*
+  so2sdr-rigsim: simulated radios for running so2sdr without hardware.
+
+  Starts two rigctld-compatible servers on the so2sdr default rigctld ports.
+  Enable rigctld for both radios in the so2sdr radio dialog to use them.
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("so2sdr-rigsim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulated rigctld radios for so2sdr");
+    parser.addHelpOption();
+    QCommandLineOption port1Opt("port1","TCP port for radio 1","port","4532");
+    QCommandLineOption port2Opt("port2","TCP port for radio 2","port","4534");
+    QCommandLineOption latencyOpt("latency","reply latency","ms","0");
+    QCommandLineOption jitterOpt("jitter","random extra reply latency, 0 to this value","ms","0");
+    QCommandLineOption script1Opt("script1","script file for radio 1","file");
+    QCommandLineOption script2Opt("script2","script file for radio 2","file");
+    parser.addOption(port1Opt);
+    parser.addOption(port2Opt);
+    parser.addOption(latencyOpt);
+    parser.addOption(jitterOpt);
+    parser.addOption(script1Opt);
+    parser.addOption(script2Opt);
+    parser.process(app);
+
+    const QCommandLineOption *portOpt[2]={&port1Opt,&port2Opt};
+    const QCommandLineOption *scriptOpt[2]={&script1Opt,&script2Opt};
+    RigSim *sim[2];
+    for (int i=0;i<2;i++) {
+        sim[i]=new RigSim(i,&app);
+        sim[i]->setLatency(parser.value(latencyOpt).toInt(),parser.value(jitterOpt).toInt());
+        int port=parser.value(*portOpt[i]).toInt();
+        if (!sim[i]->listen(port)) {
+            fprintf(stderr,"radio %d: could not listen on port %d\n",i+1,port);
+            return -1;
+        }
+        if (parser.isSet(*scriptOpt[i])) {
+            if (!sim[i]->loadScript(parser.value(*scriptOpt[i]))) {
+                fprintf(stderr,"radio %d: could not read script %s\n",i+1,
+                        parser.value(*scriptOpt[i]).toLatin1().data());
+                return -1;
+            }
+            sim[i]->startScript();
+        }
+        printf("radio %d: rigctld on port %d\n",i+1,port);
+    }
+    return app.exec();
+}
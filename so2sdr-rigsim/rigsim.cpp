@@ -0,0 +1,323 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QFile>
+#include <QHostAddress>
+#include <QtGlobal>
+#include "rigsim.h"
+
+RigSim::RigSim(int nr, QObject *parent) : QObject(parent)
+{
+    nrig=nr;
+    ptt=false;
+    rit=0;
+    passband=500;
+    jitter=0;
+    latency=0;
+    scriptPtr=0;
+    sweepFreq=0;
+    mode_="CW";
+    if (nr==0) {
+        freq_=14000000;
+    } else {
+        freq_=7000000;
+    }
+    clock.start();
+    replyTimer.setSingleShot(true);
+    scriptTimer.setSingleShot(true);
+    connect(&server,SIGNAL(newConnection()),this,SLOT(newConnection()));
+    connect(&replyTimer,SIGNAL(timeout()),this,SLOT(sendPending()));
+    connect(&scriptTimer,SIGNAL(timeout()),this,SLOT(scriptStep()));
+}
+
+double RigSim::freq() const
+{
+    return freq_;
+}
+
+QByteArray RigSim::mode() const
+{
+    return mode_;
+}
+
+/*! start listening for rigctld clients on localhost
+ */
+bool RigSim::listen(quint16 port)
+{
+    return server.listen(QHostAddress::LocalHost,port);
+}
+
+/*! every reply is delayed by ms plus a random 0..jitterMs
+ */
+void RigSim::setLatency(int ms, int jitterMs)
+{
+    latency=ms;
+    jitter=jitterMs;
+}
+
+void RigSim::setFreq(double f)
+{
+    if (f==freq_) return;
+    freq_=f;
+    emit(freqChanged(nrig,freq_));
+}
+
+void RigSim::setMode(const QByteArray &m)
+{
+    if (m==mode_) return;
+    mode_=m;
+    emit(modeChanged(nrig,mode_));
+}
+
+void RigSim::newConnection()
+{
+    while (server.hasPendingConnections()) {
+        QTcpSocket *socket=server.nextPendingConnection();
+        connect(socket,SIGNAL(readyRead()),this,SLOT(readClient()));
+        connect(socket,SIGNAL(disconnected()),socket,SLOT(deleteLater()));
+    }
+}
+
+void RigSim::readClient()
+{
+    QTcpSocket *socket=qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+    while (socket->canReadLine()) {
+        QByteArray reply=execute(socket->readLine());
+        if (!reply.isEmpty()) queueReply(socket,reply);
+    }
+}
+
+/*! replies are sent in order, each no earlier than its own due time
+ */
+void RigSim::queueReply(QTcpSocket *socket, const QByteArray &data)
+{
+    qint64 due=clock.elapsed()+latency;
+    if (jitter>0) due+=qrand()%(jitter+1);
+    if (!pendingDue.isEmpty() && pendingDue.last()>due) due=pendingDue.last();
+    pendingDue.append(due);
+    pendingData.append(data);
+    pendingSocket.append(QPointer<QTcpSocket>(socket));
+    if (!replyTimer.isActive()) sendPending();
+}
+
+void RigSim::sendPending()
+{
+    qint64 now=clock.elapsed();
+    while (!pendingDue.isEmpty() && pendingDue.first()<=now) {
+        pendingDue.removeFirst();
+        QByteArray data=pendingData.takeFirst();
+        QPointer<QTcpSocket> socket=pendingSocket.takeFirst();
+        if (socket) socket->write(data);
+    }
+    if (!pendingDue.isEmpty()) {
+        replyTimer.start(pendingDue.first()-now);
+    }
+}
+
+/*! execute one command line, returns the reply
+ */
+QByteArray RigSim::execute(const QByteArray &line)
+{
+    QByteArray l=line.trimmed();
+    if (l.isEmpty()) return QByteArray();
+
+    // ";\get_freq" or ";f" : extended response using ; as separator. "+" means newline
+    bool ext=false;
+    char sep='\n';
+    if (l.size()>1 && (l.at(0)==';' || l.at(0)=='|' || l.at(0)==',' || l.at(0)=='+')) {
+        ext=true;
+        if (l.at(0)!='+') sep=l.at(0);
+        l=l.mid(1);
+    }
+    if (l.startsWith('\\')) l=l.mid(1);
+
+    QList<QByteArray> tok=l.simplified().split(' ');
+    QByteArray c=tok.takeFirst();
+    if (c=="f") c="get_freq";
+    else if (c=="F") c="set_freq";
+    else if (c=="m") c="get_mode";
+    else if (c=="M") c="set_mode";
+    else if (c=="t") c="get_ptt";
+    else if (c=="T") c="set_ptt";
+    else if (c=="j") c="get_rit";
+    else if (c=="J") c="set_rit";
+    else if (c=="l") c="get_level";
+    QByteArray args=tok.join(' ');
+
+    int rprt=0;
+    bool get=c.startsWith("get_");
+    QList<QByteArray> values;
+    QList<QByteArray> keys;
+    bool ok;
+    if (c=="get_freq") {
+        keys << "Frequency";
+        values << QByteArray::number(freq_,'f',0);
+    } else if (c=="set_freq" && !tok.isEmpty()) {
+        double f=tok.at(0).toDouble(&ok);
+        if (ok) {
+            setFreq(f);
+        } else {
+            rprt=-1;
+        }
+    } else if (c=="get_mode") {
+        keys << "Mode" << "Passband";
+        values << mode_ << QByteArray::number(passband);
+    } else if (c=="set_mode" && !tok.isEmpty()) {
+        setMode(tok.at(0));
+        if (tok.size()>1) passband=tok.at(1).toInt();
+    } else if (c=="get_ptt") {
+        keys << "PTT";
+        values << QByteArray::number(ptt ? 1 : 0);
+    } else if (c=="set_ptt" && !tok.isEmpty()) {
+        ptt=(tok.at(0).toInt()!=0);
+    } else if (c=="get_rit") {
+        keys << "RIT";
+        values << QByteArray::number(rit);
+    } else if (c=="set_rit" && !tok.isEmpty()) {
+        rit=tok.at(0).toInt();
+    } else if (c=="get_level" && !tok.isEmpty() && tok.at(0).toLower()=="ifctr") {
+        // K3 IF center; plain value, no key
+        keys << "";
+        values << "8210000.000000";
+    } else {
+        // not implemented
+        rprt=-11;
+    }
+    emit(commandReceived(nrig,c));
+
+    QByteArray out;
+    if (ext) {
+        out=c+":";
+        if (!args.isEmpty()) out=out+" "+args;
+        out=out+sep;
+        for (int i=0;i<values.size();i++) {
+            if (keys.at(i).isEmpty()) {
+                out=out+values.at(i)+sep;
+            } else {
+                out=out+keys.at(i)+": "+values.at(i)+sep;
+            }
+        }
+        out=out+"RPRT "+QByteArray::number(rprt)+"\n";
+    } else if (get && rprt==0) {
+        for (int i=0;i<values.size();i++) {
+            out=out+values.at(i)+"\n";
+        }
+    } else {
+        out="RPRT "+QByteArray::number(rprt)+"\n";
+    }
+    return out;
+}
+
+/*! read a script file; see class description for format
+ */
+bool RigSim::loadScript(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+    QStringList lines;
+    while (!file.atEnd()) {
+        lines.append(QString::fromLatin1(file.readLine()));
+    }
+    file.close();
+    setScript(lines);
+    return true;
+}
+
+void RigSim::setScript(const QStringList &lines)
+{
+    script.clear();
+    for (int i=0;i<lines.size();i++) {
+        QList<QByteArray> tok=lines.at(i).toLatin1().simplified().split(' ');
+        if (tok.isEmpty() || tok.at(0).isEmpty() || tok.at(0).startsWith('#')) continue;
+        RigSimStep s;
+        s.cmd=tok.at(0).toLower();
+        s.start=0;
+        s.stop=0;
+        s.step=0;
+        s.interval=0;
+        if (s.cmd=="freq" && tok.size()>1) {
+            s.start=tok.at(1).toDouble();
+        } else if (s.cmd=="mode" && tok.size()>1) {
+            s.mode=tok.at(1).toUpper();
+        } else if (s.cmd=="wait" && tok.size()>1) {
+            s.interval=tok.at(1).toInt();
+        } else if (s.cmd=="sweep" && tok.size()>4) {
+            s.start=tok.at(1).toDouble();
+            s.stop=tok.at(2).toDouble();
+            s.step=qAbs(tok.at(3).toDouble());
+            s.interval=tok.at(4).toInt();
+            if (s.step==0) continue;
+        } else if (s.cmd!="repeat") {
+            continue;
+        }
+        script.append(s);
+    }
+}
+
+void RigSim::startScript()
+{
+    scriptPtr=0;
+    sweepFreq=0;
+    if (!script.isEmpty()) scriptTimer.start(0);
+}
+
+void RigSim::stopScript()
+{
+    scriptTimer.stop();
+}
+
+/*! run script until the next step that takes time
+ */
+void RigSim::scriptStep()
+{
+    int n=0;
+    while (scriptPtr<script.size()) {
+        // guard against a script of only "repeat"
+        if (++n>script.size()+1) return;
+        const RigSimStep &s=script.at(scriptPtr);
+        if (s.cmd=="freq") {
+            setFreq(s.start);
+            scriptPtr++;
+        } else if (s.cmd=="mode") {
+            setMode(s.mode);
+            scriptPtr++;
+        } else if (s.cmd=="wait") {
+            scriptPtr++;
+            scriptTimer.start(s.interval);
+            return;
+        } else if (s.cmd=="sweep") {
+            if (sweepFreq==0) {
+                sweepFreq=s.start;
+            } else if (s.stop>=s.start) {
+                sweepFreq=qMin(sweepFreq+s.step,s.stop);
+            } else {
+                sweepFreq=qMax(sweepFreq-s.step,s.stop);
+            }
+            setFreq(sweepFreq);
+            if (sweepFreq==s.stop) {
+                sweepFreq=0;
+                scriptPtr++;
+            }
+            scriptTimer.start(s.interval);
+            return;
+        } else if (s.cmd=="repeat") {
+            scriptPtr=0;
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef RIGSIM_H
+#define RIGSIM_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+/*!
+   one step of a radio script
+ */
+typedef struct RigSimStep {
+    QByteArray cmd;
+    double     start;
+    double     stop;
+    double     step;
+    int        interval;
+    QByteArray mode;
+} RigSimStep;
+
+/*!
+   Simulated radio speaking the rigctld TCP protocol.
+
+   Supports the commands so2sdr uses (get/set freq, mode, ptt, rit, K3 ifctr level)
+   in both plain and extended (";\cmd") form. Replies can be delayed by a fixed
+   latency plus random jitter; replies stay in order.
+
+   Radio activity can be scripted, one command per line:
+
+     freq 14025000              set frequency (Hz)
+     mode CW                    set mode
+     sweep 14000000 14050000 50 20   tune from start to stop in 50 Hz steps every 20 ms
+     wait 500                   pause (ms)
+     repeat                     start script over
+ */
+class RigSim : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RigSim(int nr, QObject *parent = nullptr);
+    double freq() const;
+    QByteArray mode() const;
+    bool listen(quint16 port);
+    bool loadScript(const QString &fileName);
+    void setLatency(int ms, int jitterMs);
+    void setScript(const QStringList &lines);
+
+signals:
+    void freqChanged(int nr, double f);
+    void modeChanged(int nr, const QByteArray &mode);
+    void commandReceived(int nr, const QByteArray &cmd);
+
+public slots:
+    void setFreq(double f);
+    void setMode(const QByteArray &m);
+    void startScript();
+    void stopScript();
+
+private slots:
+    void newConnection();
+    void readClient();
+    void scriptStep();
+    void sendPending();
+
+private:
+    bool             ptt;
+    double           freq_;
+    double           sweepFreq;
+    int              jitter;
+    int              latency;
+    int              nrig;
+    int              passband;
+    int              rit;
+    int              scriptPtr;
+    QByteArray       mode_;
+    QElapsedTimer    clock;
+    QList<qint64>    pendingDue;
+    QList<QByteArray> pendingData;
+    QList<QPointer<QTcpSocket> > pendingSocket;
+    QList<RigSimStep> script;
+    QTcpServer       server;
+    QTimer           replyTimer;
+    QTimer           scriptTimer;
+
+    QByteArray execute(const QByteArray &line);
+    void queueReply(QTcpSocket *socket, const QByteArray &data);
+};
+
+#endif // RIGSIM_H
@@ -0,0 +1,33 @@
+# This file is part of so2sdr.
+# so2sdr is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# any later version.
+# so2sdr is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# You should have received a copy of the GNU General Public License
+# along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+TEMPLATE = app
+TARGET = so2sdr-rigsim
+
+QT += network
+QT -= gui
+CONFIG += console
+
+HEADERS += rigsim.h
+SOURCES += main.cpp \
+    rigsim.cpp
+
+unix {
+    include (../common.pri)
+    QMAKE_CXXFLAGS += -O2 -Wall
+
+    install.target = install
+    install.commands = install -d $$SO2SDR_INSTALL_DIR/bin; \
+        install -o root -m 755 so2sdr-rigsim $$SO2SDR_INSTALL_DIR/bin
+    QMAKE_EXTRA_TARGETS += install
+}
@@ -1,2 +1,2 @@
 TEMPLATE = subdirs
-SUBDIRS = so2sdr so2sdr-bandmap
+SUBDIRS = so2sdr so2sdr-bandmap so2sdr-rigsim so2sdr-righarness so2sdr-history so2sdr-bench
@@ -16,186 +16,272 @@
     along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
 
  */
+#include <limits.h>
+#include <string.h>
 #include <QByteArray>
 #include <QDateTime>
-#include <QDebug>
 #include <QTime>
 #include "adifparse.h"
 #include "hamlib/rig.h"
 #include "utils.h"
 
+/*!
+   true if the n characters at p equal s, ignoring case
+ */
+static bool equalNoCase(const char *p, int n, const char *s)
+{
+    int i = 0;
+    for (; i < n; i++) {
+        char c = p[i];
+        if (c >= 'a' && c <= 'z') c = c - 'a' + 'A';
+        if (s[i] != c) return false;
+    }
+    return (s[i] == 0);
+}
+
+/*!
+   true if field name is s (upper case), ignoring case
+ */
+bool AdifField::is(const char *s) const
+{
+    return equalNoCase(name, nameLen, s);
+}
+
+/*!
+   true if field value is s (upper case), ignoring case
+ */
+bool AdifField::valueIs(const char *s) const
+{
+    return equalNoCase(value, valueLen, s);
+}
+
+/*!
+   value of the n digits starting at start in the field value. Missing or
+   non-digit characters count as 0
+ */
+int AdifField::toInt(int start, int n) const
+{
+    int v = 0;
+    for (int i = start; i < start + n; i++) {
+        v = v * 10;
+        if (i < valueLen && value[i] >= '0' && value[i] <= '9') v += value[i] - '0';
+    }
+    return v;
+}
+
+AdifTokenizer::AdifTokenizer(const char *data, int size)
+{
+    begin = data;
+    end   = data + size;
+    pos   = data;
+}
+
+bool AdifTokenizer::atEnd() const
+{
+    return (pos >= end);
+}
+
+/*!
+   offset of the next unread character
+ */
+int AdifTokenizer::position() const
+{
+    return pos - begin;
+}
+
+/*!
+   read the next field <name:length[:type]>value, or <name> for EOH/EOR.
+   Returns false at end of data
+ */
+bool AdifTokenizer::next(AdifField &f)
+{
+    while (pos < end) {
+        const char *lt = (const char *) memchr(pos, '<', end - pos);
+        if (!lt) break;
+        const char *p = lt + 1;
+        f.name = p;
+        while (p < end && *p != ':' && *p != '>' && *p != '<') p++;
+        if (p == end) break;
+        if (*p == '<') {
+            // stray '<' in text
+            pos = p;
+            continue;
+        }
+        f.nameLen = p - f.name;
+        if (*p == '>') {
+            f.value    = p + 1;
+            f.valueLen = 0;
+            pos        = p + 1;
+            return true;
+        }
+        // field length
+        p++;
+        int  len    = 0;
+        bool digits = false;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (len < (INT_MAX - 9) / 10) len = len * 10 + (*p - '0');
+            digits = true;
+            p++;
+        }
+        // optional data type
+        if (p < end && *p == ':') {
+            while (p < end && *p != '>' && *p != '<') p++;
+        }
+        if (p == end || *p != '>' || !digits) {
+            // malformed tag: skip it
+            pos = lt + 1;
+            continue;
+        }
+        p++;
+        if (len > end - p) len = end - p;
+        f.value    = p;
+        f.valueLen = len;
+        pos        = p + len;
+        return true;
+    }
+    pos = end;
+    return false;
+}
+
 ADIFParse::ADIFParse(QObject *parent) : QObject(parent)
 {
 
 }
 
+/*! parse the first ADIF record in data
+ */
+bool ADIFParse::parse(const QByteArray &data, Qso *qso)
+{
+    return parse(data.constData(), data.size(), qso);
+}
 
-/*! parse an ADIF record
- *
- * the first record found in data is returned as a SQL log record
- * Designed for WSJTX ADIF ouput, may not work well on more general
- *   ADIF sources.
- *  @todo validate each field and return a bool
+/*! parse the first ADIF record in a buffer
  */
-bool ADIFParse::parse(QByteArray data, Qso *qso)
+bool ADIFParse::parse(const char *data, int size, Qso *qso)
 {
-    const QByteArray token_names[] = { "CALL",
-                                       "GRIDSQUARE",
-                                       "MODE",
-                                       "QSO_DATE_OFF",
-                                       "TIME_OFF",
-                                       "BAND",
-                                       "FREQ"};
-    const int n_token_names = 7;
+    AdifTokenizer tok(data, size);
+    return nextRecord(tok, qso);
+}
 
+/*! parse the next ADIF record from tok into qso
+ *
+ * Anything before an <EOH> is header and is ignored, so this works on whole
+ * files as well as single WSJTX UDP records. Designed for WSJTX ADIF output;
+ * only the fields logged by so2sdr are read.
+ * Returns false when there are no more records
+ */
+bool ADIFParse::nextRecord(AdifTokenizer &tok, Qso *qso)
+{
     // only common and WSJTX modes will be matched
-    const QByteArray mode_name[] = { "AM",
-                                     "CW",
-                                     "FM",
-                                     "SSB",
-                                     "USB",
-                                     "LSB",
-                                     "FT8",
-                                     "ISCAT",
-                                     "JT4",
-                                     "JT9",
-                                     "JT65",
-                                     "MSK144",
-                                     "QRA64",
-                                     "RTTY"};
-    const rmode_t modes[] = { RIG_MODE_AM,
-                              RIG_MODE_CW,
-                              RIG_MODE_FM,
-                              RIG_MODE_USB,
-                              RIG_MODE_USB,
-                              RIG_MODE_LSB,
-                              RIG_MODE_RTTY,
-                              RIG_MODE_RTTY,
-                              RIG_MODE_RTTY,
-                              RIG_MODE_RTTY,
-                              RIG_MODE_RTTY,
-                              RIG_MODE_RTTY,
-                              RIG_MODE_RTTY,
-                              RIG_MODE_RTTY};
+    static const char * const mode_name[] = { "AM",
+                                              "CW",
+                                              "FM",
+                                              "SSB",
+                                              "USB",
+                                              "LSB",
+                                              "FT8",
+                                              "ISCAT",
+                                              "JT4",
+                                              "JT9",
+                                              "JT65",
+                                              "MSK144",
+                                              "QRA64",
+                                              "RTTY"};
+    static const rmode_t modes[] = { RIG_MODE_AM,
+                                     RIG_MODE_CW,
+                                     RIG_MODE_FM,
+                                     RIG_MODE_USB,
+                                     RIG_MODE_USB,
+                                     RIG_MODE_LSB,
+                                     RIG_MODE_RTTY,
+                                     RIG_MODE_RTTY,
+                                     RIG_MODE_RTTY,
+                                     RIG_MODE_RTTY,
+                                     RIG_MODE_RTTY,
+                                     RIG_MODE_RTTY,
+                                     RIG_MODE_RTTY,
+                                     RIG_MODE_RTTY};
     const int n_mode_names=14;
 
     // bands are in the same order as in defines.h
-    const QByteArray band_name[]= { "160M",
-                                    "80M",
-                                    "40M",
-                                    "20M",
-                                    "15M",
-                                    "10M",
-                                    "60M",
-                                    "30M",
-                                    "17M",
-                                    "12M",
-                                    "6M",
-                                    "2M",
-                                    "1.25M",
-                                    "70CM",
-                                    "33CM",
-                                    "23CM"};
+    static const char * const band_name[]= { "160M",
+                                             "80M",
+                                             "40M",
+                                             "20M",
+                                             "15M",
+                                             "10M",
+                                             "60M",
+                                             "30M",
+                                             "17M",
+                                             "12M",
+                                             "6M",
+                                             "2M",
+                                             "1.25M",
+                                             "70CM",
+                                             "33CM",
+                                             "23CM"};
+    const int n_band_names=16;
 
     qso->clear();
-    data=data.toUpper();
-    int end=data.indexOf("<EOR>");
-    int start=data.indexOf("<EOH>");
-    if (start==-1) {
-        start=0;
-    } else {
-        start+=5;
-    }
-    data=data.mid(start,end-start);
-    QList<QByteArray>elements=data.split('<');
-
-    QDateTime time;
-    time.setTimeSpec(Qt::UTC);
-    QByteArray key,val;
-    for (int i=0;i<elements.size();i++) {
-        parseBit(elements.at(i),key,val);
-        for (int j = 0; j < n_token_names; j++) {
-            if (key == token_names[j]) {
-                switch (j) {
-                case 0:  // CALL
-                    qso->call=val;
-                    break;
-                case 1: // GRID
-                    qso->exch=val;
-                    qso->rcv_exch[0]=val;
-                    break;
-                case 2: // MODE
-                {
-                    for (int k=0;k<n_mode_names;k++) {
-                        if (val==mode_name[k]) {
-                            qso->mode=modes[k];
-                            qso->modeType=getModeType(modes[k]);
-                            break;
-                        }
-                    }
-                    break;
-                }
-                case 3: // DATE
-                {
-                    int y=val.mid(0,4).toInt();
-                    int m=val.mid(4,2).toInt();
-                    int d=val.mid(6,2).toInt();
-                    time.setDate(QDate(y, m, d));
-                    break;
-                }
-                case 4: // TIME
-                {
-                    int h=val.mid(0,2).toInt();
-                    int m=val.mid(2,2).toInt();
-                    int s=0;
-                    if (val.size()==6) {
-                        s=val.mid(4,2).toInt();
-                    }
-                    time.setTime(QTime(h,m,s));
-                    break;
-                }
-                case 5: // BAND
-                {
-                    for (int k=0;k<N_BANDS;k++) {
-                        if (val==band_name[k]) {
-                            qso->band=k;
-                            break;
-                        }
-                    }
+    qso->freq = 0.0;
+    QDate dateOff, dateOn;
+    QTime timeOff, timeOn;
+    bool  hasFields = false;
+    AdifField f;
+    while (tok.next(f)) {
+        if (f.is("EOR")) {
+            if (hasFields) break;
+            continue;
+        }
+        if (f.is("EOH")) {
+            // everything so far was header
+            qso->clear();
+            qso->freq = 0.0;
+            dateOff = dateOn = QDate();
+            timeOff = timeOn = QTime();
+            hasFields = false;
+            continue;
+        }
+        hasFields = true;
+        if (f.is("CALL")) {
+            qso->call = QByteArray(f.value, f.valueLen).toUpper();
+        } else if (f.is("GRIDSQUARE")) {
+            qso->exch = QByteArray(f.value, f.valueLen).toUpper();
+            qso->rcv_exch[0] = qso->exch;
+        } else if (f.is("MODE")) {
+            for (int k=0;k<n_mode_names;k++) {
+                if (f.valueIs(mode_name[k])) {
+                    qso->mode=modes[k];
+                    qso->modeType=getModeType(modes[k]);
                     break;
                 }
-                case 6: // FREQ
-                    qso->freq=val.toDouble()*1000000;
+            }
+        } else if (f.is("QSO_DATE_OFF")) {
+            dateOff = QDate(f.toInt(0, 4), f.toInt(4, 2), f.toInt(6, 2));
+        } else if (f.is("QSO_DATE")) {
+            dateOn = QDate(f.toInt(0, 4), f.toInt(4, 2), f.toInt(6, 2));
+        } else if (f.is("TIME_OFF")) {
+            timeOff = QTime(f.toInt(0, 2), f.toInt(2, 2), (f.valueLen == 6) ? f.toInt(4, 2) : 0);
+        } else if (f.is("TIME_ON")) {
+            timeOn = QTime(f.toInt(0, 2), f.toInt(2, 2), (f.valueLen == 6) ? f.toInt(4, 2) : 0);
+        } else if (f.is("BAND")) {
+            for (int k=0;k<n_band_names;k++) {
+                if (f.valueIs(band_name[k])) {
+                    qso->band=k;
                     break;
                 }
             }
+        } else if (f.is("FREQ")) {
+            qso->freq=QByteArray::fromRawData(f.value, f.valueLen).toDouble()*1000000;
         }
     }
+    if (!hasFields) return false;
+
+    // use time the qso was logged if given, otherwise the start time
+    QDateTime time;
+    time.setTimeSpec(Qt::UTC);
+    time.setDate(dateOff.isValid() ? dateOff : dateOn);
+    time.setTime(timeOff.isValid() ? timeOff : timeOn);
     qso->time=time;
     return true;
 }
-
-/*!
- * \brief ADIFParse::parseBit
- * \param in
- * \param out
- */
-void ADIFParse::parseBit(QByteArray in,QByteArray &key,QByteArray &val)
-{
-    if (in.size()<5) {
-        key.clear();
-        val.clear();
-        return;
-    }
-    int i1=in.indexOf(":");
-    key=in.mid(0,i1);
-    int i2=in.indexOf(">");
-    bool ok=false;
-    int n=in.mid(i1+1,i2-i1-1).toInt(&ok);
-    if (!ok) {
-        key.clear();
-        val.clear();
-        return;
-    }
-    val=in.mid(i2+1,n);
-}
@@ -23,19 +23,51 @@
 #include <QObject>
 #include "qso.h"
 
+/*!
+   one ADIF field. name and value point into the buffer being tokenized;
+   nothing is copied. <EOH> and <EOR> are returned as fields with no value
+ */
+typedef struct AdifField {
+    const char *name;
+    int         nameLen;
+    const char *value;
+    int         valueLen;
+
+    bool is(const char *s) const;
+    int toInt(int start, int n) const;
+    bool valueIs(const char *s) const;
+} AdifField;
+
+/*!
+   Streaming ADIF tokenizer.
+
+   Works over any buffer (a mapped file, a UDP datagram) and returns the fields
+   in order. The buffer must remain valid while fields are used. Field lengths
+   are checked against the buffer end, so truncated or malformed input cannot
+   read past it; a malformed tag is skipped.
+ */
+class AdifTokenizer
+{
+public:
+    AdifTokenizer(const char *data, int size);
+    bool atEnd() const;
+    bool next(AdifField &f);
+    int position() const;
+
+private:
+    const char *begin;
+    const char *end;
+    const char *pos;
+};
+
 class ADIFParse : public QObject
 {
     Q_OBJECT
 public:
     explicit ADIFParse(QObject *parent = nullptr);
-    bool parse(QByteArray data,Qso *qso);
-
-signals:
-
-public slots:
-
-private:
-    void parseBit(QByteArray in, QByteArray &key, QByteArray &val);
+    bool nextRecord(AdifTokenizer &tok, Qso *qso);
+    bool parse(const char *data, int size, Qso *qso);
+    bool parse(const QByteArray &data, Qso *qso);
 };
 
 #endif // ADIFPARSE_H
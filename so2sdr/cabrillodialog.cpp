@@ -17,7 +17,7 @@
 
  */
 #include <QDialog>
-#include <QFile>
+#include <QIODevice>
 #include <QFormLayout>
 #include <QLabel>
 #include <QSettings>
@@ -142,7 +142,7 @@ void CabrilloDialog::updateExch()
 
   also update some settings
   */
-void CabrilloDialog::writeHeader(QFile *cbrFile,int score)
+void CabrilloDialog::writeHeader(QIODevice *cbrFile,int score)
 {
     QString tmpstr;
     cbrFile->write("START-OF-LOG: " + settings->value(c_cab_version,c_cab_version_def).toByteArray() + "\n");
@@ -23,7 +23,7 @@
 #include <QSettings>
 
 class QComboBox;
-class QFile;
+class QIODevice;
 class QLabel;
 class QLineEdit;
 class So2sdr;
@@ -39,7 +39,7 @@ public:
     explicit CabrilloDialog(QWidget *parent = 0);
     void initialize(QSettings *s1,QSettings *s2);
     void updateExch();
-    void writeHeader(QFile *cbrFile,int score);
+    void writeHeader(QIODevice *cbrFile,int score);
     friend class So2sdr;
 
 private:
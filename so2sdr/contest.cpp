@@ -19,18 +19,43 @@
 #include <QDebug>
 #include <QDir>
 #include <QSettings>
+#include <algorithm>
 #include "cty.h"
 #include "contest.h"
 #include "hamlib/rotator.h"
 #include "utils.h"
 
-Contest::Contest(QSettings &cs,QSettings &ss) : settings(cs),stnSettings(ss)
+ContestConfig::ContestConfig()
+{
+    multiMode = c_multimode_def;
+    multsBand = c_multsband_def;
+    multsMode = c_multsmode_def;
+    multDisplayOnly[0] = c_mult1_displayonly_def;
+    multDisplayOnly[1] = c_mult2_displayonly_def;
+    dupeMode = c_dupemode_def;
+    nMultTypes = c_nmulttypes_def;
+}
+
+ContestConfig::ContestConfig(const QSettings &s)
+{
+    multiMode = s.value(c_multimode,c_multimode_def).toBool();
+    multsBand = s.value(c_multsband,c_multsband_def).toBool();
+    multsMode = s.value(c_multsmode,c_multsmode_def).toBool();
+    multDisplayOnly[0] = s.value(c_mult1_displayonly,c_mult1_displayonly_def).toBool();
+    multDisplayOnly[1] = s.value(c_mult2_displayonly,c_mult2_displayonly_def).toBool();
+    dupeMode = s.value(c_dupemode,c_dupemode_def).toInt();
+    nMultTypes = qBound(0,s.value(c_nmulttypes,c_nmulttypes_def).toInt(),MMAX);
+}
+
+Contest::Contest(QSettings &cs,QSettings &ss) : cfg(cs),settings(cs),stnSettings(ss)
 {
     myGrid.clear();
     myLat = 0.0;
     myLon = 0.0;
     for (int ii = 0; ii < MMAX; ii++) {
         mults[ii].clear();
+        multIndex[ii].clear();
+        multOrderValid[ii] = false;
         _nMults[ii] = 0;
         qsoTypeCntry[ii].clear();
         qsoTypeStr[ii].clear();
@@ -48,6 +73,12 @@ Contest::Contest(QSettings &cs,QSettings &ss) : settings(cs),stnSettings(ss)
     _zoneMax  = 40;
     _vExch    = false;
     for (int i=0;i<6;i++) qsoCnt[i]=0;
+    qsoPts = 0;
+    nDupes = 0;
+    nInvalid = 0;
+    nQso = 0;
+    multsWorkedTotal = 0;
+    multsScoreTotal = 0;
 }
 
 /* default labels for bands in score summary */
@@ -217,38 +248,85 @@ Contest::~Contest()
   */
 void Contest::multIndx(Qso *qso) const
 {
-    for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) {
         // unique callsigns, special mults. Check to see if this is
-        // a completely new mult, and if so add it to the lists
-        if (qso->isamult[ii] && (multType[ii] == Uniques || multType[ii] == Special || multType[ii] == Prefix ||
-                                 multType[ii] == Grids)) {
-            QByteArray tmp;
+        // a completely new mult
+        if (qso->isamult[ii] && dynamicMults(ii)) {
+            QHash<QByteArray,int>::const_iterator it;
             if (multType[ii] == Uniques) {
-                tmp = qso->call;
+                it = multIndex[ii].constFind(qso->call);
             } else {
-                tmp = qso->mult_name;
+                it = multIndex[ii].constFind(qso->mult_name);
             }
-
-            // search for the mult
-            bool newmult = true;
-            int j;
-            for (j = 0; j < mults[ii].size(); j++) {
-                if (mults[ii][j]->name == tmp) {
-                    newmult = false;
-                    break;
-                }
-            }
-            if (newmult) {
+            if (it == multIndex[ii].constEnd()) {
                 qso->mult[ii]=-1;
                 qso->newmult[ii]=true;
             } else {
                 qso->newmult[ii]=false;
-                qso->mult[ii]=j;
+                qso->mult[ii]=it.value();
             }
         }
     }
 }
 
+/*!
+  true for mult types where the list of mults is built from the log
+  */
+bool Contest::dynamicMults(int ii) const
+{
+    return (multType[ii] == Uniques || multType[ii] == Special || multType[ii] == Prefix ||
+            multType[ii] == Grids);
+}
+
+/*!
+  returns index of mult name, adding it to the list if it is new. Indices are never
+  reused or renumbered, so the score records do not change when a mult is added;
+  the sorted display order is kept separately in multOrder
+  */
+int Contest::addMult(int ii, const QByteArray &name)
+{
+    QHash<QByteArray,int>::const_iterator it = multIndex[ii].constFind(name);
+    if (it != multIndex[ii].constEnd()) return it.value();
+
+    DomMult* mult = new DomMult;
+    mult->hasAltNames = false;
+    mult->name        = name;
+    mult->isamult     = true;
+    int indx = mults[ii].size();
+    mults[ii].append(mult);
+    multIndex[ii].insert(name, indx);
+
+    // new bits are cleared
+    for (int k = 0; k < NModeTypes; k++) {
+        for (int j = 0; j <= N_BANDS; j++) {
+            multWorked[ii][k][j].resize(indx + 1);
+        }
+    }
+    _nMults[ii] = mults[ii].size();
+    multOrderValid[ii] = false;
+    return indx;
+}
+
+/*!
+  index of the i'th mult in display order. Dynamic mult lists are shown sorted
+  */
+int Contest::multDisplayIndx(int ii, int i) const
+{
+    if (!dynamicMults(ii)) return i;
+
+    if (!multOrderValid[ii]) {
+        multOrder[ii].resize(mults[ii].size());
+        for (int j = 0; j < mults[ii].size(); j++) {
+            multOrder[ii][j] = j;
+        }
+        const QList<DomMult *> &m = mults[ii];
+        std::sort(multOrder[ii].begin(), multOrder[ii].end(),
+                  [&m](int a, int b) { return m.at(a)->name < m.at(b)->name; });
+        multOrderValid[ii] = true;
+    }
+    return multOrder[ii].at(i);
+}
+
 /*!
    Updates mult counters for added qso
     */
@@ -266,141 +344,91 @@ void Contest::addQsoMult(Qso *qso)
 
     // qsos marked invalid ignored
     if (!qso->valid) {
+        nInvalid++;
         score.append(newrec);
         return;
     }
     // if mults do not count per-mode, store them all in the CW slot
     mode_t mode=CWType;
-    if (settings.value(c_multsmode,c_multsmode_def).toBool()) mode=qso->modeType;
+    if (cfg.multsMode) mode=qso->modeType;
+
+    // per-hour totals
+    ScoreHour *hour = 0;
+    if (qso->time.isValid()) {
+        int h = (int) (qso->time.toMSecsSinceEpoch() / 3600000);
+        QMap<int,ScoreHour>::iterator it = scoreHours.find(h);
+        if (it == scoreHours.end()) {
+            ScoreHour empty = { 0, 0, 0 };
+            it = scoreHours.insert(h, empty);
+        }
+        hour = &it.value();
+    }
+    if (qso->dupe) {
+        nDupes++;
+    } else {
+        nQso++;
+        if (hour) {
+            hour->nQso++;
+            hour->qsoPts += qso->pts;
+        }
+    }
 
     // counter for screen display of qsos
     if (!qso->dupe && qso->bandColumn>=0 && qso->bandColumn<6) qsoCnt[qso->bandColumn]++;
 
-    // mults worked counted per-band
-    // last index N_BANDS is for total number of mults regardless of band
-    for (int j = 0; j < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); j++) {
-        for (int k = 0; k < NModeTypes; k++) {
-            for (int i = 0; i <= N_BANDS; i++) {
-                multsWorked[j][k][i] = 0;
-            }
-        }
-    }
     bool new_m[MMAX]  = { false, false };
     bool new_bm[MMAX] = { false, false };
-    for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
-        // unique callsigns, special mults. Check to see if this is
-        // a completely new mult, and if so add it to the lists
-        if (qso->isamult[ii] && (multType[ii] == Uniques || multType[ii] == Special || multType[ii] == Prefix ||
-                                 multType[ii] == Grids)) {
-            QByteArray tmp;
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) {
+        // unique callsigns, special mults. Add to the list if this is
+        // a completely new mult
+        if (qso->isamult[ii] && dynamicMults(ii)) {
             if (multType[ii] == Uniques) {
-                tmp = qso->call;
+                qso->mult[ii] = addMult(ii, qso->call);
             } else {
-                tmp = qso->mult_name;
-            }
-
-            // assume mult list is sorted in this case
-            bool newmult = true;
-            /*!
-               can make search more efficient here
-             */
-            for (int j = 0; j < mults[ii].size(); j++) {
-                if (mults[ii][j]->name == tmp) {
-                    newmult = false;
-                    break;
-                }
-            }
-            if (newmult) {
-                DomMult* mult = new DomMult;
-                mult->hasAltNames = false;
-                mult->name        = tmp;
-                mult->isamult     = true;
-                // insert so list is ordered
-                int indx = mults[ii].size();
-                for (int j = 0; j < mults[ii].size(); j++) {
-                    if (tmp < mults[ii][j]->name) {
-                        indx = j;
-                        break;
-                    }
-                }
-                qso->mult[ii]    = indx;
-                qso->isamult[ii] = true;
-                if (indx != mults[ii].size()) {
-                    for (int k = 0; k < score.size(); k++) {
-                        if (score.at(k)->mult[ii] >= indx) {
-                            score[k]->mult[ii]++;
-                        }
-                    }
-                }
-
-                mults[ii].insert(indx, mult);
-
-                // must insert extra element in other arrays
-                for (int j = 0; j <= N_BANDS; j++) {
-                    multWorked[ii][mode][j].insert(indx, false);
-                }
-                _nMults[ii] = mults[ii].size();
-            }
-        }
-        // count number of worked mults BEFORE this qso
-        int sz[NModeTypes][N_BANDS + 1];
-        for (int k=0;k<NModeTypes;k++) {
-            if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-            for (int i = 0; i <= N_BANDS; i++) {
-                sz[k][i] = multWorked[ii][k][i].size();
-            }
-        }
-        // for all-band mults: stored in (last+1) band array element
-        for (int k=0;k < NModeTypes; k++) {
-            if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-            for (int j = 0; j < sz[k][N_BANDS]; j++) {
-                if (!mults[ii].at(j)->isamult) continue;
-                if (multWorked[ii][k][N_BANDS].at(j)) {
-                    multsWorked[ii][k][N_BANDS]++;
-                }
-            }
-        }
-        // band-by-band mults
-        for (int k = 0; k < NModeTypes; k++) {
-            if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-            for (int b = 0; b < N_BANDS; b++) {
-                for (int j = 0; j < sz[k][b]; j++) {
-                    if (!mults[ii].at(j)->isamult) continue;
-                    if (multWorked[ii][k][b].at(j)) {
-                        multsWorked[ii][k][b]++;
-                    }
-                }
+                qso->mult[ii] = addMult(ii, qso->mult_name);
             }
         }
     }
-    // add new mult
-    for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+    // add new mult. multsWorked holds the number of bits set in multWorked
+    // last index N_BANDS is for total number of mults regardless of band
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) {
         if (_nMults[ii] == 0 || !qso->isamult[ii]) continue;
-        if (qso->mult[ii] != -1) {
-            if (!multWorked[ii][mode][qso->band][qso->mult[ii]] && mults[ii][qso->mult[ii]]->isamult) {
-                new_bm[ii] = true;
-                multsWorked[ii][mode][qso->band]++;
-                multWorked[ii][mode][qso->band][qso->mult[ii]] = true;
+        const int m = qso->mult[ii];
+        if (m < 0 || m >= mults[ii].size() || !mults[ii].at(m)->isamult) continue;
+
+        if (!multWorked[ii][mode][qso->band].testBit(m)) {
+            new_bm[ii] = true;
+            multsWorked[ii][mode][qso->band]++;
+            multWorked[ii][mode][qso->band].setBit(m);
+            if (cfg.multsBand) multsWorkedTotal++;
+            if (multCountsInScore(ii, qso->band)) {
+                multsScoreTotal++;
+                if (hour) hour->nMults++;
             }
-            // all-band mults
-            if (!multWorked[ii][mode][N_BANDS][qso->mult[ii]] && mults[ii][qso->mult[ii]]->isamult) {
-                new_m[ii] = true;
-                multsWorked[ii][mode][N_BANDS]++;
-                multWorked[ii][mode][N_BANDS][qso->mult[ii]] = true;
+        }
+        // all-band mults
+        if (!multWorked[ii][mode][N_BANDS].testBit(m)) {
+            new_m[ii] = true;
+            multsWorked[ii][mode][N_BANDS]++;
+            multWorked[ii][mode][N_BANDS].setBit(m);
+            if (!cfg.multsBand && ii < 2) multsWorkedTotal++;
+            if (multCountsInScore(ii, N_BANDS)) {
+                multsScoreTotal++;
+                if (hour) hour->nMults++;
             }
         }
     }
     qso->newmult[0] = -1;
     qso->newmult[1] = -1;
-    if (settings.value(c_multsband,c_multsband_def).toBool()) {
+    if (cfg.multsBand) {
         // mults count per-band
-        for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+        for (int ii = 0; ii < cfg.nMultTypes; ii++) {
             if (new_bm[ii]) {
                 qso->newmult[ii] = multFieldHighlight[ii];
             }
         }
     } else {
-        for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+        for (int ii = 0; ii < cfg.nMultTypes; ii++) {
             if (new_m[ii]) {
                 qso->newmult[ii] = multFieldHighlight[ii];
             }
@@ -487,6 +515,51 @@ void Contest::addQsoTypeCntry(int i, int ii)
     qsoTypeCntry[ii].append(i);
 }
 
+/*!
+   build per-country lookups from the country list of mult type ii:
+   - cntryExcluded: country is on the list with "!"
+   - cntryMultFile: mult file applies to this country (matches an included country,
+     or differs from an excluded one)
+ */
+void Contest::setCntryMaps(int ii, int nc)
+{
+    cntryExcluded[ii].fill(false, nc);
+    cntryMultFile[ii].fill(false, nc);
+    int n = qMin(qsoTypeCntry[ii].size(), isMultCntry[ii].size());
+    for (int i = 0; i < n; i++) {
+        int c = qsoTypeCntry[ii].at(i);
+        if (isMultCntry[ii].at(i)) {
+            if (c >= 0 && c < nc) cntryMultFile[ii].setBit(c);
+        } else {
+            if (c >= 0 && c < nc) cntryExcluded[ii].setBit(c);
+            for (int j = 0; j < nc; j++) {
+                if (j != c) cntryMultFile[ii].setBit(j);
+            }
+        }
+    }
+}
+
+bool Contest::cntryTest(const QBitArray &map, int c)
+{
+    return (c >= 0 && c < map.size() && map.testBit(c));
+}
+
+/*!
+   continent for the ContXX mult types
+ */
+Cont Contest::multContinent(MultTypeDef t)
+{
+    switch (t) {
+    case ContNA: return NA;
+    case ContSA: return SA;
+    case ContEU: return EU;
+    case ContAF: return AF;
+    case ContAS: return AS;
+    case ContOC: return OC;
+    default: return ALL;
+    }
+}
+
 
 /*!
    Add a new qso/mult type
@@ -505,28 +578,11 @@ QList<QByteArray> &Contest::qsoType(int ii)
   */
 void Contest::count_mults()
 {
-    for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) {
         for (int k=0;k<NModeTypes;k++) {
-            if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
+            if (k>0 && !cfg.multsMode) break;
             for (int i = 0; i <= N_BANDS; i++) {
-                multsWorked[ii][k][i] = 0;
-            }
-        }
-    }
-    for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
-        for (int k=0;k<NModeTypes;k++) {
-            if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-            for (int j = 0; j < N_BANDS; j++) {
-                for (int i = 0; i < _nMults[ii]; i++) {
-                    if (multWorked[ii][k][j].at(i)) multsWorked[ii][k][j]++;
-                }
-            }
-        }
-        // all-band mults
-        for (int k=0;k<NModeTypes;k++) {
-            if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-            for (int i = 0; i < _nMults[ii]; i++) {
-                if (multWorked[ii][k][N_BANDS].at(i)) multsWorked[ii][k][N_BANDS]++;
+                multsWorked[ii][k][i] = multWorked[ii][k][i].count(true);
             }
         }
     }
@@ -539,7 +595,7 @@ void Contest::count_mults()
  */
 void Contest::guessMult(Qso *qso) const
 {
-    for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) {
         // mult info already known
         if (qso->mult[ii] != -1) continue;
 
@@ -570,37 +626,37 @@ void Contest::guessMult(Qso *qso) const
  */
 void Contest::workedMults(Qso *qso, unsigned int worked[MMAX]) const
 {
-    for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) worked[ii] = 0;
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) worked[ii] = 0;
 
     // option 1: per-mode mults
     // this currently only applies to the ARRL 10M contest; the code below is only for this
     // special case. @todo fix for general case
-    if (settings.value(c_multsmode,c_multsmode_def).toBool()) {
-        for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+    if (cfg.multsMode) {
+        for (int ii = 0; ii < cfg.nMultTypes; ii++) {
             if (qso->mult[ii] != -1 && qso->mult[ii] < _nMults[ii]) {
-                worked[ii] += multWorked[ii][CWType][5][qso->mult[ii]] * bits[4];
-                worked[ii] += multWorked[ii][PhoneType][5][qso->mult[ii]] * bits[5];
+                worked[ii] += multWorked[ii][CWType][5].testBit(qso->mult[ii]) * bits[4];
+                worked[ii] += multWorked[ii][PhoneType][5].testBit(qso->mult[ii]) * bits[5];
             }
         }
         return;
     }
     // option 2: mults count per-band but not per-mode. Here the mult status is stored internally in the CW modetype slot
-    if (settings.value(c_multsband,c_multsband_def).toBool()) {
-        for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+    if (cfg.multsBand) {
+        for (int ii = 0; ii < cfg.nMultTypes; ii++) {
             for (int i = 0; i < N_BANDS; i++) {
                 if (qso->mult[ii] != -1 && qso->mult[ii] < _nMults[ii]) {
-                    worked[ii] += multWorked[ii][CWType][i][qso->mult[ii]] * bits[i];
+                    worked[ii] += multWorked[ii][CWType][i].testBit(qso->mult[ii]) * bits[i];
                 }
             }
         }
     } else {
         // option 3: mults count once on all bands (Sweepstakes, qso parties, etc) on any mode. Here
         // the mult status is stored in the N_BANDS slot. Note that this is only set up for HF contests.
-        for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+        for (int ii = 0; ii < cfg.nMultTypes; ii++) {
             if (qso->mult[ii] != -1 && qso->mult[ii] < _nMults[ii]) {
-                if (multWorked[ii][CWType][N_BANDS][qso->mult[ii]] ||
-                        multWorked[ii][PhoneType][N_BANDS][qso->mult[ii]] ||
-                        multWorked[ii][DigiType][N_BANDS][qso->mult[ii]]) worked[ii] = 1 + 2 + 4 + 8 + 16 + 32;
+                if (multWorked[ii][CWType][N_BANDS].testBit(qso->mult[ii]) ||
+                        multWorked[ii][PhoneType][N_BANDS].testBit(qso->mult[ii]) ||
+                        multWorked[ii][DigiType][N_BANDS].testBit(qso->mult[ii])) worked[ii] = 1 + 2 + 4 + 8 + 16 + 32;
             }
         }
     }
@@ -631,6 +687,7 @@ void Contest::readMultFile(QByteArray filename[MMAX], const Cty *cty)
             int  pfx = cty->idPfx(tmpqso, b);
             addQsoTypeCntry(pfx, ii);
         }
+        setCntryMaps(ii, cty->nCountries());
 
         if (multFile[ii].toLower() == "none" || multFile[ii].isEmpty()) {
             _nMults[ii]  = 0;
@@ -758,11 +815,24 @@ void Contest::readMultFile(QByteArray filename[MMAX], const Cty *cty)
         }
         for (int k=0;k<NModeTypes;k++) {
             for (int i = 0; i <= N_BANDS; i++) {
-                for (int j = 0; j < _nMults[ii]; j++) {
-                    multWorked[ii][k][i].append(false);
+                multWorked[ii][k][i].fill(false, _nMults[ii]);
+            }
+        }
+        multIndex[ii].clear();
+        multAltIndex[ii].clear();
+        for (int j = 0; j < mults[ii].size(); j++) {
+            if (!multIndex[ii].contains(mults[ii].at(j)->name)) {
+                multIndex[ii].insert(mults[ii].at(j)->name, j);
+            }
+            if (mults[ii].at(j)->hasAltNames) {
+                for (int k = 0; k < mults[ii].at(j)->alt_names.size(); k++) {
+                    if (!multAltIndex[ii].contains(mults[ii].at(j)->alt_names.at(k))) {
+                        multAltIndex[ii].insert(mults[ii].at(j)->alt_names.at(k), j);
+                    }
                 }
             }
         }
+        multOrderValid[ii] = false;
     }
     delete tmpqso;
 }
@@ -775,10 +845,10 @@ void Contest::readMultFile(QByteArray filename[MMAX], const Cty *cty)
  */
 void Contest::determineMultType(Qso *qso)
 {
-    for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) qso->isamult[ii] = false;
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) qso->isamult[ii] = false;
     int  i, sz;
     bool ok;
-    for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) {
         switch (multType[ii]) {
         case File:
             // if no country list given, apply list to all
@@ -790,19 +860,7 @@ void Contest::determineMultType(Qso *qso)
                 if (qso->country == -1) break;
 
                 // country should match one on list in order to use this mult file
-                for (i = 0; i < sz; i++) {
-                    if (isMultCntry[ii].at(i)) {
-                        if (qso->country == qsoTypeCntry[ii].at(i)) {
-                            qso->isamult[ii] = true;
-                            break;
-                        }
-                    } else {
-                        if (qso->country != qsoTypeCntry[ii].at(i)) {
-                            qso->isamult[ii] = true;
-                            break;
-                        }
-                    }
-                }
+                qso->isamult[ii] = cntryTest(cntryMultFile[ii], qso->country);
             }
             break;
         case Uniques: case Grids:
@@ -813,133 +871,23 @@ void Contest::determineMultType(Qso *qso)
             if (qso->country == -1) break;
 
             // check for excluded countries
-            qso->isamult[ii] = true;
-            qso->mult[ii]    = qso->country;
-            for (i = 0; i < qsoTypeCntry[ii].size(); i++) {
-                if (qso->country == qsoTypeCntry[ii][i] && !isMultCntry[ii][i]) {
-                    qso->isamult[ii] = false;
-                    qso->mult[ii]    = -1;
-                    break;
-                }
-            }
-            break;
-        case ContNA:
-            if (qso->country == -1) break;
-
-            // must match NA continent
-            if (qso->continent == NA) {
-                // must not be an excluded country
-                ok = true;
-                for (i = 0; i < qsoTypeCntry[ii].size(); i++) {
-                    if (!isMultCntry[ii][i] && qso->country == qsoTypeCntry[ii][i]) {
-                        ok = false;
-                    }
-                }
-                if (ok) {
-                    qso->isamult[ii] = true;
-                    qso->mult[ii]    = qso->country;
-                } else {
-                    qso->mult[ii] = -1;
-                }
-            }
-            break;
-        case ContSA:
-            if (qso->country == -1) break;
-
-            // must match SA continent
-            if (qso->continent == SA) {
-                // must not be an excluded country
-                ok = true;
-                for (i = 0; i < qsoTypeCntry[ii].size(); i++) {
-                    if (!isMultCntry[ii][i] && qso->country == qsoTypeCntry[ii][i]) {
-                        ok = false;
-                    }
-                }
-                if (ok) {
-                    qso->isamult[ii] = true;
-                    qso->mult[ii]    = qso->country;
-                } else {
-                    qso->mult[ii] = -1;
-                }
-            }
-            break;
-        case ContEU:
-            if (qso->country == -1) break;
-
-            // must match EU continent
-            if (qso->continent == EU) {
-                // must not be an excluded country
-                ok = true;
-                for (i = 0; i < qsoTypeCntry[ii].size(); i++) {
-                    if (!isMultCntry[ii][i] && qso->country == qsoTypeCntry[ii][i]) {
-                        ok = false;
-                    }
-                }
-                if (ok) {
-                    qso->isamult[ii] = true;
-                    qso->mult[ii]    = qso->country;
-                } else {
-                    qso->mult[ii] = -1;
-                }
+            if (cntryTest(cntryExcluded[ii], qso->country)) {
+                qso->mult[ii]    = -1;
+            } else {
+                qso->isamult[ii] = true;
+                qso->mult[ii]    = qso->country;
             }
             break;
-        case ContAF:
+        case ContNA: case ContSA: case ContEU: case ContAF: case ContAS: case ContOC:
             if (qso->country == -1) break;
 
-            // must match AF continent
-            if (qso->continent == AF) {
-                // must not be an excluded country
-                ok = true;
-                for (i = 0; i < qsoTypeCntry[ii].size(); i++) {
-                    if (!isMultCntry[ii][i] && qso->country == qsoTypeCntry[ii][i]) {
-                        ok = false;
-                    }
-                }
-                if (ok) {
-                    qso->isamult[ii] = true;
-                    qso->mult[ii]    = qso->country;
-                } else {
+            // must match continent and not be an excluded country
+            if (qso->continent == multContinent(multType[ii])) {
+                if (cntryTest(cntryExcluded[ii], qso->country)) {
                     qso->mult[ii] = -1;
-                }
-            }
-            break;
-        case ContAS:
-            if (qso->country == -1) break;
-
-            // must match AS continent
-            if (qso->continent == AS) {
-                // must not be an excluded country
-                ok = true;
-                for (i = 0; i < qsoTypeCntry[ii].size(); i++) {
-                    if (!isMultCntry[ii][i] && qso->country == qsoTypeCntry[ii][i]) {
-                        ok = false;
-                    }
-                }
-                if (ok) {
-                    qso->isamult[ii] = true;
-                    qso->mult[ii]    = qso->country;
                 } else {
-                    qso->mult[ii] = -1;
-                }
-            }
-            break;
-        case ContOC:
-            if (qso->country == -1) break;
-
-            // must match OC continent
-            if (qso->continent == OC) {
-                // must not be an excluded country
-                ok = true;
-                for (i = 0; i < qsoTypeCntry[ii].size(); i++) {
-                    if (!isMultCntry[ii][i] && qso->country == qsoTypeCntry[ii][i]) {
-                        ok = false;
-                    }
-                }
-                if (ok) {
                     qso->isamult[ii] = true;
                     qso->mult[ii]    = qso->country;
-                } else {
-                    qso->mult[ii] = -1;
                 }
             }
             break;
@@ -972,11 +920,11 @@ void Contest::determineMultType(Qso *qso)
         case Special:
 
             // is it already in the list of mults?
-            for (int j = 0; j < mults[ii].size(); j++) {
-                if (qso->mult_name == mults[ii][j]->name) {
+            {
+                QHash<QByteArray,int>::const_iterator it = multIndex[ii].constFind(qso->mult_name);
+                if (it != multIndex[ii].constEnd()) {
                     qso->isamult[ii] = true;
-                    qso->mult[ii]    = j;
-                    break;
+                    qso->mult[ii]    = it.value();
                 }
             }
 
@@ -1013,10 +961,8 @@ void Contest::selectCountries(int ii, const Cty *cty, Cont cont)
         } else {
             mult->isamult = false;
         }
-        for (int j = 0; j < qsoTypeCntry[ii].size(); j++) {
-            if (i == qsoTypeCntry[ii][j] && !isMultCntry[ii][j]) {
-                mult->isamult = false;
-            }
+        if (cntryTest(cntryExcluded[ii], i)) {
+            mult->isamult = false;
         }
         mults[ii].append(mult);
     }
@@ -1074,26 +1020,39 @@ bool Contest::dupeCheckingByBand() const
 */
 int Contest::nMultsWorked() const
 {
-    if (settings.value(c_multsband,c_multsband_def).toBool()) {
-        int n = 0;
-        for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
-            for (int k=0;k<NModeTypes;k++) {
-                if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-                for (int i = 0; i < N_BANDS; i++) {
-                    n += multsWorked[ii][k][i];
+    return(multsWorkedTotal);
+}
+
+/*!
+   true if a mult of type ii counted in multsWorked[ii][][band] adds to the score
+ */
+bool Contest::multCountsInScore(int ii, int band) const
+{
+    if (ii >= MMAX || cfg.multDisplayOnly[ii]) return false;
+    if (cfg.multsBand) return (band < N_BANDS);
+    else return (band == N_BANDS);
+}
+
+/*!
+   recount running mult totals from multsWorked. Only needed when the contest
+   options change without a rescore; addQsoMult keeps them up to date otherwise
+ */
+void Contest::countMultTotals()
+{
+    multsWorkedTotal = 0;
+    multsScoreTotal  = 0;
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) {
+        for (int k=0;k<NModeTypes;k++) {
+            if (k>0 && !cfg.multsMode) break;
+            for (int i = 0; i <= N_BANDS; i++) {
+                if ((cfg.multsBand && i < N_BANDS) || (!cfg.multsBand && i == N_BANDS && ii < 2)) {
+                    multsWorkedTotal += multsWorked[ii][k][i];
+                }
+                if (multCountsInScore(ii, i)) {
+                    multsScoreTotal += multsWorked[ii][k][i];
                 }
             }
         }
-        return(n);
-    } else {
-        // all-band mults
-        int tot=0;
-        for (int k=0;k<NModeTypes;k++) {
-            if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-            tot+=multsWorked[0][k][N_BANDS];
-            tot+=multsWorked[1][k][N_BANDS];
-        }
-        return(tot);
     }
 }
 
@@ -1104,7 +1063,7 @@ int Contest::nMultsBWorked(int ii, int band) const
 {
     int tot=0;
     for (int k=0;k<NModeTypes;k++) {
-        if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
+        if (k>0 && !cfg.multsMode) break;
         tot+=multsWorked[ii][k][band];
     }
     return tot;
@@ -1137,22 +1096,23 @@ QByteArray Contest::neededMultName(int ii, int band, int i, bool &needed_band, b
     needed_band = false;
 
     if (i < _nMults[ii]) {
-        if (!mults[ii][i]->isamult) {
+        int j = multDisplayIndx(ii, i);
+        if (!mults[ii][j]->isamult) {
             return("");
         }
         for (int k=0;k<NModeTypes;k++) {
-            if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-            if (multWorked[ii][k][band][i]) {
+            if (k>0 && !cfg.multsMode) break;
+            if (multWorked[ii][k][band].testBit(j)) {
                 needed_band = true;
             }
         }
         for (int k=0;k<NModeTypes;k++) {
-            if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-            if (multWorked[ii][k][N_BANDS][i]) {
+            if (k>0 && !cfg.multsMode) break;
+            if (multWorked[ii][k][N_BANDS].testBit(j)) {
                 needed = true;
             }
         }
-        return(mults[ii][i]->name);
+        return(mults[ii][j]->name);
     } else {
         return("");
     }
@@ -1167,16 +1127,17 @@ QByteArray Contest::neededMultNameMode(int ii, int band, ModeTypes mode,int i, b
     needed_band = false;
 
     if (i < _nMults[ii]) {
-        if (!mults[ii][i]->isamult) {
+        int j = multDisplayIndx(ii, i);
+        if (!mults[ii][j]->isamult) {
             return("");
         }
-        if (multWorked[ii][mode][band][i]) {
+        if (multWorked[ii][mode][band].testBit(j)) {
             needed_band = true;
         }
-        if (multWorked[ii][mode][N_BANDS][i]) {
+        if (multWorked[ii][mode][N_BANDS].testBit(j)) {
             needed = true;
         }
-        return(mults[ii][i]->name);
+        return(mults[ii][j]->name);
     } else {
         return("");
     }
@@ -1214,26 +1175,20 @@ int Contest::isAMult(QByteArray exch, int ii) const
 {
     if (multType[ii]==CQZone || multType[ii]==ITUZone) {
         /* match zones by number, not string */
-        for (int i = 0; i < _nMults[ii]; i++) {
-            bool ok=false;
-            int eZone=exch.toInt(&ok);
-            if (ok && eZone==(i+1)) return(i);
-        }
+        bool ok=false;
+        int eZone=exch.toInt(&ok);
+        if (ok && eZone>=1 && eZone<=_nMults[ii]) return(eZone-1);
     } else {
-        for (int i = 0; i < _nMults[ii]; i++) {
-            if (exch == mults[ii].at(i)->name) {
-                return(i);
-            }
-
-            // check alt names
-            if (mults[ii].at(i)->hasAltNames) {
-                for (int j = 0; j < mults[ii].at(i)->alt_names.size(); j++) {
-                    if (exch == mults[ii].at(i)->alt_names[j]) {
-                        return(i);
-                    }
-                }
-            }
+        // a name can be both a mult and an alt name of another mult: the one
+        // first in the mult file wins
+        int indx=-1;
+        QHash<QByteArray,int>::const_iterator it = multIndex[ii].constFind(exch);
+        if (it != multIndex[ii].constEnd() && it.value() < _nMults[ii]) indx=it.value();
+        it = multAltIndex[ii].constFind(exch);
+        if (it != multAltIndex[ii].constEnd() && it.value() < _nMults[ii]) {
+            if (indx==-1 || it.value()<indx) indx=it.value();
         }
+        return(indx);
     }
     return(-1);
 }
@@ -1252,49 +1207,99 @@ bool Contest::newCall(QByteArray &b) const
 }
 
 /*!
-   Total score
+   dupe check, validate, and score one qso. qso.valid is the valid flag set by the user.
+   Qsos must be given in log order; dupes holds the calls seen so far on each band and
+   cnt the number of valid, non-dupe qsos on each band
  */
-int Contest::Score() const
-{
-    if (settings.value(c_multsband,c_multsband_def).toBool()) {
-        // per-band mults
-        int n = 0;
-        for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
-            switch (ii) {
-            case 0:
-                if (settings.value(c_mult1_displayonly,c_mult1_displayonly_def).toBool())
-                    continue;
-                break;
-            case 1:
-                if (settings.value(c_mult2_displayonly,c_mult2_displayonly_def).toBool())
-                    continue;
-                break;
+void Contest::scoreQso(Qso &qso, QSet<QByteArray> dupes[N_BANDS], int cnt[N_BANDS])
+{
+    // valid can be changed to ways:
+    // 1) when user unchecks checkbox
+    // 2) if program can't parse the exchange
+    //
+    // first check for user changing check status
+    bool userValid=qso.valid;
+
+    // dupe check
+    // qsos marked invalid are excluded from log and dupe check
+    qso.dupe = false;
+    const bool knownBand = (qso.band >= 0 && qso.band < N_BANDS);
+    if (qso.valid) {
+        if (cfg.dupeMode!=NO_DUPE_CHECKING && knownBand) {
+            // can work station on other bands, just check this one
+            QByteArray check=qso.call;
+            // multi-mode contest: append a mode index to the call
+            if (cfg.multiMode) {
+                check=check+QByteArray::number((int)qso.modeType);
             }
-            for (int k=0;k<NModeTypes;k++) {
-                if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-                for (int i = 0; i < N_BANDS; i++) {
-                    n += multsWorked[ii][k][i];
+            if (dupeCheckingByBand()) {
+                if (dupes[qso.band].contains(check)) {
+                    qso.dupe = true;
+                }
+            } else {
+                // qsos count only once on any band
+                for (int j = 0; j < N_BANDS; j++) {
+                    if (dupes[j].contains(check)) {
+                        qso.dupe = true;
+                    }
                 }
             }
+            dupes[qso.band].insert(check);
         }
-        return(qsoPts * n);
     } else {
-        // all-band mults
-        int n=0;
-        if (!settings.value(c_mult1_displayonly,c_mult1_displayonly_def).toBool()) {
-            for (int k=0;k<NModeTypes;k++) {
-                if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-                n += multsWorked[0][k][N_BANDS];
-            }
-        }
-        if (!settings.value(c_mult2_displayonly,c_mult2_displayonly_def).toBool()) {
-            for (int k=0;k<NModeTypes;k++) {
-                if (k>0 && !settings.value(c_multsmode,c_multsmode_def).toBool()) break;
-                n += multsWorked[1][k][N_BANDS];
-            }
-        }
-        return(qsoPts * n);
+        qso.pts=0;
+        qso.mult[0]=-1;
+        qso.mult[1]=-1;
+        qso.newmult[0]=-1;
+        qso.newmult[1]=-1;
+    }
+    // next check exchange
+    // in the case of mobiles, this might change dupe status!
+    bool exchValid=validateExchange(&qso);
+    qso.valid=userValid & exchValid;
+
+    if (!qso.dupe && qso.valid && knownBand) cnt[qso.band]++;
+    if (!qso.valid || qso.dupe) {
+        qso.pts=0;
+        qso.mult[0]=-1;
+        qso.mult[1]=-1;
+        qso.newmult[0]=-1;
+        qso.newmult[1]=-1;
     }
+    addQso(&qso);
+}
+
+/*!
+   number of mults counted in the score
+ */
+int Contest::nMultsScore() const
+{
+    return(multsScoreTotal);
+}
+
+/*!
+   Total score
+ */
+int Contest::Score() const
+{
+    return(qsoPts * nMultsScore());
+}
+
+/*!
+   current score totals. All values are kept up to date as qsos are added, so this
+   is cheap enough to call on every display update
+ */
+ScoreSummary Contest::summary() const
+{
+    ScoreSummary s;
+    s.score    = Score();
+    s.qsoPts   = qsoPts;
+    s.nQso     = nQso;
+    s.nDupes   = nDupes;
+    s.nInvalid = nInvalid;
+    s.nMults   = nMultsScore();
+    s.hours    = scoreHours;
+    return s;
 }
 
 /*!
@@ -1302,48 +1307,42 @@ int Contest::Score() const
  */
 bool Contest::separateExchange(Qso *qso)
 {
-    // clean up
-    QByteArray exchange = qso->exch;
-    exchange = exchange.simplified();
-    exchange = exchange.toUpper();
-    if (exchange.size() == 0) {
+    // split exchange into upper-case elements separated by space
+    exchTok.tokenize(qso->exch);
+    if (exchTok.size() == 0) {
         exchElement.clear();
         return(false);  // nothing to do!
     }
-    // find exchange elements separated by space
-    int nel = 0;
-    int i1  = 0;
-    int i2  = exchange.indexOf(" ");
-    exchElement.clear();
-    while (i2 != -1) {
-        exchElement.append(exchange.mid(i1, i2 - i1));
-        nel++;
-        i1 = i2 + 1;
-        i2 = exchange.indexOf(" ", i1);
-    }
-
-    // last (or only) piece
-    exchElement.append(exchange.mid(i1, exchange.size() - i1));
-    nel++;
 
     // put first nExch or non-null pieces into qso received info. This will be used
     // in the case the exchange can't be validated, but the qso
     // is forcibly logged (ctrl+enter)
     int n = nExch;
-    if (exchElement.size() < n) n = exchElement.size();
+    if (exchTok.size() < n) n = exchTok.size();
     for (int i = 0; i < n; i++) {
-        qso->rcv_exch[i] = exchElement[i];
+        exchTok.copyTo(i, qso->rcv_exch[i]);
     }
 
     // check for next callsign (begins with "/")
     nextCall.clear();
-    for (int i = 0; i < exchElement.size(); i++) {
-        if (exchElement.at(i).left(1) == "/") {
-            nextCall = exchElement.at(i);
-            nextCall = nextCall.right(nextCall.size() - 1);
-            exchElement.removeAt(i);
+    for (int i = 0; i < exchTok.size(); i++) {
+        if (exchTok.data(i)[0] == '/') {
+            nextCall = QByteArray(exchTok.data(i) + 1, exchTok.length(i) - 1);
+            exchTok.removeAt(i);
+            break;
         }
     }
+
+    // refill exchElement in place so its elements keep their buffers between calls
+    while (exchElement.size() > exchTok.size()) {
+        exchElement.removeLast();
+    }
+    while (exchElement.size() < exchTok.size()) {
+        exchElement.append(QByteArray());
+    }
+    for (int i = 0; i < exchTok.size(); i++) {
+        exchTok.copyTo(i, exchElement[i]);
+    }
     return(true);
 }
 
@@ -1842,33 +1841,50 @@ bool Contest::valid(int row) const
     }
 }
 
+const ContestConfig &Contest::config() const
+{
+    return cfg;
+}
+
+/*!
+   re-read contest settings used in scoring. Must be called after the contest options
+   are changed and before the log is rescored
+ */
+void Contest::updateConfig()
+{
+    cfg = ContestConfig(settings);
+    countMultTotals();
+}
+
 /*!
    zeros out score and mult count
  */
 void Contest::zeroScore()
 {
     qsoPts = 0;
-    for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+    nDupes = 0;
+    nInvalid = 0;
+    nQso = 0;
+    multsWorkedTotal = 0;
+    multsScoreTotal = 0;
+    scoreHours.clear();
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) {
+        // in these cases, the number of mults depends on the contents of the log
+        if (dynamicMults(ii)) {
+            for (int i = 0; i < mults[ii].size(); i++) {
+                delete mults[ii][i];
+            }
+            mults[ii].clear();
+            multIndex[ii].clear();
+            multOrderValid[ii] = false;
+            _nMults[ii] = 0;
+        }
         for (int kk=0;kk<NModeTypes;kk++) {
             for (int j = 0; j <= N_BANDS; j++) {
-                for (int k = 0; k < multWorked[ii][kk][j].size(); k++) {
-                    multWorked[ii][kk][j][k] = false;
-                }
+                multWorked[ii][kk][j].fill(false, mults[ii].size());
                 multsWorked[ii][kk][j] = 0;
             }
         }
-
-        // in these cases, the number of mults depends on the contents of the log
-        if (multType[ii] == Uniques || multType[ii] == Special || multType[ii] == Prefix) {
-            mults[ii].clear();
-            for (int ii = 0; ii < settings.value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
-                for (int k=0;k<NModeTypes;k++) {
-                    for (int j = 0; j <= N_BANDS; j++) {
-                        multWorked[ii][k][j].clear();
-                    }
-                }
-            }
-        }
     }
     for (int i = 0; i < score.size(); i++) {
         delete (score[i]);
@@ -1883,7 +1899,7 @@ void Contest::zeroScore()
  */
 ModeTypes Contest::nextModeType(ModeTypes m) const
 {
-    if (settings.value(c_multimode,c_multimode_def).toBool()) {
+    if (cfg.multiMode) {
         int i=(int)m;
         i=(i+1) % NModeTypes;
         while (i!=m) {
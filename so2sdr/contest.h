@@ -19,14 +19,20 @@
 #ifndef CONTEST_H
 #define CONTEST_H
 #include <QObject>
+#include <QBitArray>
 #include <QByteArray>
 #include <QSettings>
 #include <QString>
 #include <QFile>
+#include <QHash>
 #include <QList>
+#include <QMap>
+#include <QSet>
 #include <QVariant>
+#include <QVector>
 #include "cty.h"
 #include "defines.h"
+#include "exchtokenizer.h"
 #include "qso.h"
 
 /*! structure recording point and multiplier information for
@@ -42,6 +48,50 @@ typedef struct scoreRecord
 } scoreRecord;
 Q_DECLARE_TYPEINFO(scoreRecord, Q_PRIMITIVE_TYPE);
 
+/*! qsos, points and new mults made in one clock hour (UTC) */
+typedef struct ScoreHour
+{
+    int nQso;
+    int nMults;
+    int qsoPts;
+} ScoreHour;
+Q_DECLARE_TYPEINFO(ScoreHour, Q_PRIMITIVE_TYPE);
+
+/*! snapshot of the running score totals
+
+   hours is keyed by hours since 1970-01-01 UTC. Qsos without a time
+   are not included in hours.
+ */
+typedef struct ScoreSummary
+{
+    int score;
+    int qsoPts;
+    int nQso;
+    int nDupes;
+    int nInvalid;
+    int nMults;
+    QMap<int,ScoreHour> hours;
+} ScoreSummary;
+
+/*!
+   ContestConfig: copy of the contest settings used while scoring and dupe checking.
+
+   Read once from the contest ini and replaced as a whole with Contest::updateConfig
+   when the contest options change, so the scoring loops do not go through QSettings.
+ */
+class ContestConfig
+{
+public:
+    ContestConfig();
+    explicit ContestConfig(const QSettings &s);
+
+    bool multiMode;
+    bool multsBand;
+    bool multsMode;
+    bool multDisplayOnly[MMAX];
+    int  dupeMode;
+    int  nMultTypes;
+};
 
 /*!
    Contest: defines rules, scoring, exchange for generic contests
@@ -57,6 +107,7 @@ public:
     void addQsoMult(Qso *qso);
     void addQsoType(QByteArray str, int ii);
     virtual void addQso(Qso *qso) = 0;
+    const ContestConfig &config() const;
     virtual QString bandLabel(int i) const;
     virtual bool bandLabelEnable(int i) const;
     QByteArray contestName() const;
@@ -89,6 +140,7 @@ public:
     int nMults(int ii) const;
     virtual int nMultsColumn(int col,int ii) const;
     int nMultsWorked() const;
+    virtual int nMultsScore() const;
     int nMultsBWorked(int ii, int band) const;
     int nMultsBMWorked(int ii, int band, int mode) const;
     virtual int numberField() const = 0;
@@ -99,6 +151,8 @@ public:
     void readMultFile(QByteArray filename[MMAX], const Cty * cty);
     virtual int rstField() const { return -1;}
     virtual int Score() const;
+    void scoreQso(Qso &qso, QSet<QByteArray> dupes[N_BANDS], int cnt[N_BANDS]);
+    ScoreSummary summary() const;
     void setContestName(QByteArray s);
     void setContinent(Cont);
     void setCountry(int);
@@ -107,6 +161,7 @@ public:
     void setVExch(bool);
     void setZoneMax(int);
     void setZoneType(int);
+    void updateConfig();
     virtual bool showQsoPtsField() const = 0;
     virtual unsigned int sntFieldShown() const = 0;
     bool valid(int row) const;
@@ -127,17 +182,24 @@ protected:
     bool                 prefill;
     bool                 _vExch;
     Cont                 myContinent;
+    ContestConfig        cfg;
+    ExchTokenizer        exchTok;
     double               myLat;
     double               myLon;
     FieldTypes           *exchange_type;
     int                  multFieldHighlight[MAX_EXCH_FIELDS];
     int                  multsWorked[MMAX][NModeTypes][N_BANDS + 1];
+    int                  multsWorkedTotal;
+    int                  multsScoreTotal;
     int                  myCountry;
     int                  _myZone;
     int                  nExch;
     int                  _nMults[MMAX];
     int                  qsoCnt[6];
     int                  qsoPts;
+    int                  nDupes;
+    int                  nInvalid;
+    int                  nQso;
     int                  _zoneMax;
     int                  _zoneType;
     MultTypeDef          multType[MMAX];
@@ -146,20 +208,35 @@ protected:
     QByteArray           multFile[MMAX];
     QByteArray           myGrid;
     QByteArray           nextCall;
+    QBitArray            cntryExcluded[MMAX];
+    QBitArray            cntryMultFile[MMAX];
     QList<bool>          isMultCntry[MMAX];
-    QList<bool>          multWorked[MMAX][NModeTypes][N_BANDS + 1];
+    QBitArray            multWorked[MMAX][NModeTypes][N_BANDS + 1];
+    QHash<QByteArray,int> multAltIndex[MMAX];
+    QHash<QByteArray,int> multIndex[MMAX];
     QList<DomMult *>     mults[MMAX];
+    mutable bool         multOrderValid[MMAX];
+    mutable QVector<int> multOrder[MMAX];
     QList<int>           qsoTypeCntry[MMAX];
     QList<QByteArray>    exchElement;
     QList<QByteArray>    qsoTypeStr[MMAX];
     QList<scoreRecord *> score;
+    QMap<int,ScoreHour>  scoreHours;
     QSettings            &settings;
     QSettings            &stnSettings;
     QString              exchName[MAX_EXCH_FIELDS];
 
+    int addMult(int ii, const QByteArray &name);
     void addQsoTypeCntry(int i, int ii);
+    static bool cntryTest(const QBitArray &map, int c);
     void count_mults();
+    void countMultTotals();
+    bool multCountsInScore(int ii, int band) const;
+    bool dynamicMults(int ii) const;
+    static Cont multContinent(MultTypeDef t);
+    int multDisplayIndx(int ii, int i) const;
     void fillDefaultRST(Qso *qso) const;
+    void setCntryMaps(int ii, int nc);
     void setGrid();
     void selectCountries(int ii, const Cty *cty, Cont cont);
     bool separateExchange(Qso *qso);
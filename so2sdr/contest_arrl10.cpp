@@ -176,10 +176,10 @@ unsigned int ARRL10::rcvFieldShown() const
     return(2);  // show second exchange field (ST or #)
 }
 
-int ARRL10::Score() const
+int ARRL10::nMultsScore() const
 {
-    return(qsoPts * (multsWorked[0][CWType][BAND10] + multsWorked[1][CWType][BAND10] +
-            multsWorked[0][PhoneType][BAND10] + multsWorked[1][PhoneType][BAND10]));
+    return(multsWorked[0][CWType][BAND10] + multsWorked[1][CWType][BAND10] +
+           multsWorked[0][PhoneType][BAND10] + multsWorked[1][PhoneType][BAND10]);
 }
 
 unsigned int ARRL10::sntFieldShown() const
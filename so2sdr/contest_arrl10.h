@@ -40,7 +40,7 @@ public:
     int numberField() const;
     unsigned int rcvFieldShown() const;
     unsigned int sntFieldShown() const;
-    int Score() const;
+    int nMultsScore() const;
     bool showQsoPtsField() const { return true;}
     int rstField() const { return 0;}
 };
@@ -129,9 +129,9 @@ unsigned int ARRL160::rcvFieldShown() const
     return(1+2);  // show first and second fields
 }
 
-int ARRL160::Score() const
+int ARRL160::nMultsScore() const
 {
-    return(qsoPts * (multsWorked[0][CWType][BAND160] + multsWorked[1][CWType][BAND160]));
+    return(multsWorked[0][CWType][BAND160] + multsWorked[1][CWType][BAND160]);
 }
 
 void ARRL160::setupContest(QByteArray MultFile[MMAX], const Cty *cty)
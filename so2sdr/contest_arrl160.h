@@ -37,7 +37,7 @@ public:
     QByteArray prefillExchange(Qso *qso);
     unsigned int rcvFieldShown() const;
     unsigned int sntFieldShown() const;
-    int Score() const;
+    int nMultsScore() const;
     bool showQsoPtsField() const { return true;}
     int rstField() const { return 0;}
 private:
@@ -137,9 +137,9 @@ unsigned int CQ160::rcvFieldShown() const
 /*!
    only count qso's on 160m in score
  */
-int CQ160::Score() const
+int CQ160::nMultsScore() const
 {
-    return(qsoPts * (multsWorked[0][CWType][BAND160] + multsWorked[1][CWType][BAND160]));
+    return(multsWorked[0][CWType][BAND160] + multsWorked[1][CWType][BAND160]);
 }
 
 void CQ160::setupContest(QByteArray MultFile[MMAX], const Cty *cty)
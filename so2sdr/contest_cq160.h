@@ -34,7 +34,7 @@ public:
     bool validateExchange(Qso *qso);
     int fieldWidth(int col) const;
     unsigned int rcvFieldShown() const;
-    int Score() const;
+    int nMultsScore() const;
     unsigned int sntFieldShown() const;
     int numberField() const;
     bool showQsoPtsField() const { return true;}
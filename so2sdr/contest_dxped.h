@@ -34,6 +34,7 @@ public:
     int numberField() const;
     unsigned int rcvFieldShown() const;
     unsigned int sntFieldShown() const;
+    int nMultsScore() const { return 0;}
     int Score() const;
     QByteArray prefillExchange(Qso *qso);
     bool showQsoPtsField() const { return false;}
@@ -35,6 +35,7 @@ public:
     int numberField() const;
     unsigned int rcvFieldShown() const;
     unsigned int sntFieldShown() const;
+    int nMultsScore() const { return 0;}
     int Score() const;
     bool showQsoPtsField() const { return true;}
 };
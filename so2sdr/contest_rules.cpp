@@ -0,0 +1,351 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QStringList>
+#include "contest_rules.h"
+#include "log.h"
+
+/*!
+   comma-separated list from the cfg file. Unquoted lists are read by QSettings as
+   a QStringList, quoted ones as a single string
+ */
+static QStringList cfgList(const QVariant &v)
+{
+    QStringList l;
+    if (v.type() == QVariant::StringList) {
+        l = v.toStringList();
+    } else {
+        l = v.toString().split(",", QString::SkipEmptyParts);
+    }
+    for (int i = 0; i < l.size(); i++) {
+        l[i] = l.at(i).trimmed().toUpper();
+    }
+    return l;
+}
+
+/*! Contest with rules read from the cfg file */
+ContestRules::ContestRules(QSettings &cs, QSettings &ss) : Contest(cs,ss)
+{
+    setVExch(true);
+    dupeCheckingEveryBand = true;
+    prefill               = false;
+    readExchange();
+    readPoints();
+}
+
+ContestRules::~ContestRules()
+{
+    delete[] logFieldPrefill;
+    delete[] finalExch;
+    delete[] exchange_type;
+}
+
+/*!
+   read exchange fields: c_rules_exchange is a comma-separated list of
+   RST, NR, NUMBER, ZONE, MULT1, MULT2, NAME, STATE, SECTION, GRID, GENERAL
+
+   c_rules_fieldwidth optionally gives the width shown for each field
+ */
+void ContestRules::readExchange()
+{
+    QStringList fields=cfgList(settings.value(c_rules_exchange,c_rules_exchange_def));
+    QStringList widths=cfgList(settings.value(c_rules_fieldwidth,c_rules_fieldwidth_def));
+    nExch=qMin(fields.size(),MAX_EXCH_FIELDS);
+    logFieldPrefill = new bool[nExch];
+    finalExch       = new QByteArray[nExch];
+    exchange_type   = new FieldTypes[nExch];
+    multFieldHighlight[0] = -1;
+    multFieldHighlight[1] = -1;
+    nrField   = -1;
+    _rstField = -1;
+    for (int i = 0; i < nExch; i++) {
+        const QString &f=fields.at(i);
+        logFieldPrefill[i] = true;
+        fieldMult[i]       = -1;
+        fieldWidths[i]     = 4;
+        if (f == "RST") {
+            exchange_type[i] = RST;
+            _rstField        = i;
+        } else if (f == "NR" || f == "#") {
+            exchange_type[i] = QsoNumber;
+            logFieldPrefill[i] = false;
+            nrField          = i;
+        } else if (f == "NUMBER") {
+            exchange_type[i] = Number;
+        } else if (f == "ZONE") {
+            exchange_type[i] = Zone;
+        } else if (f == "MULT1" || f == "MULT2") {
+            exchange_type[i] = DMult;
+            fieldMult[i]     = (f == "MULT1") ? 0 : 1;
+            fieldWidths[i]   = 5;
+            multFieldHighlight[fieldMult[i]] = SQL_COL_RCV1 + i;
+        } else if (f == "NAME") {
+            exchange_type[i] = Name;
+            fieldWidths[i]   = 9;
+        } else if (f == "STATE") {
+            exchange_type[i] = State;
+        } else if (f == "SECTION") {
+            exchange_type[i] = ARRLSection;
+        } else if (f == "GRID") {
+            exchange_type[i] = Grid;
+            fieldWidths[i]   = 6;
+        } else {
+            exchange_type[i] = General;
+        }
+        if (i < widths.size()) {
+            bool ok=false;
+            int w=widths.at(i).toInt(&ok);
+            if (ok && w > 0) fieldWidths[i] = w;
+        }
+    }
+}
+
+/*!
+   compile the points table. Each c_rules_points entry gives
+
+   - mode: CW, PHONE, DIGI (empty: all)
+   - band: comma-separated band names as shown on the band labels (empty: all)
+   - match: COUNTRY (same country), CONTINENT (same continent, other country),
+     DX (other continent) (empty: all)
+   - pts: qso points
+
+   The first entry matching a qso sets its points. Qsos matching no entry get 0 points.
+ */
+void ContestRules::readPoints()
+{
+    for (int k = 0; k < NModeTypes; k++) {
+        for (int b = 0; b < N_BANDS; b++) {
+            for (int m = 0; m < NRulesMatch; m++) {
+                pts[k][b][m] = -1;
+            }
+        }
+    }
+    int sz=settings.beginReadArray(c_rules_points);
+    for (int i = 0; i < sz; i++) {
+        settings.setArrayIndex(i);
+        QString mode=settings.value(c_rules_points_mode,c_rules_points_mode_def).toString().trimmed().toUpper();
+        QStringList bands=cfgList(settings.value(c_rules_points_band,c_rules_points_band_def));
+        QString match=settings.value(c_rules_points_match,c_rules_points_match_def).toString().trimmed().toUpper();
+        int p=settings.value(c_rules_points_pts,c_rules_points_pts_def).toInt();
+
+        bool modeOk[NModeTypes];
+        for (int k = 0; k < NModeTypes; k++) {
+            modeOk[k] = mode.isEmpty() || (mode == "CW" && k == CWType) || (mode == "PHONE" && k == PhoneType) ||
+                        (mode.startsWith("DIGI") && k == DigiType);
+        }
+        bool bandOk[N_BANDS];
+        for (int b = 0; b < N_BANDS; b++) {
+            bandOk[b] = bands.isEmpty();
+        }
+        for (int j = 0; j < bands.size(); j++) {
+            for (int b = 0; b < N_BANDS; b++) {
+                if (bands.at(j) == bandName[b].toUpper()) bandOk[b] = true;
+            }
+        }
+        bool matchOk[NRulesMatch];
+        matchOk[RulesSameCountry]   = match.isEmpty() || match == "COUNTRY";
+        matchOk[RulesSameContinent] = match.isEmpty() || match == "CONTINENT";
+        matchOk[RulesDx]            = match.isEmpty() || match == "DX";
+
+        for (int k = 0; k < NModeTypes; k++) {
+            if (!modeOk[k]) continue;
+            for (int b = 0; b < N_BANDS; b++) {
+                if (!bandOk[b]) continue;
+                for (int m = 0; m < NRulesMatch; m++) {
+                    if (matchOk[m] && pts[k][b][m] == -1) pts[k][b][m] = p;
+                }
+            }
+        }
+    }
+    settings.endArray();
+    for (int k = 0; k < NModeTypes; k++) {
+        for (int b = 0; b < N_BANDS; b++) {
+            for (int m = 0; m < NRulesMatch; m++) {
+                if (pts[k][b][m] == -1) pts[k][b][m] = 0;
+            }
+        }
+    }
+}
+
+void ContestRules::addQso(Qso *qso)
+{
+    qso->pts = 0;
+    if (!qso->dupe && qso->valid && qso->band >= 0 && qso->band < N_BANDS) {
+        RulesMatch m;
+        if (qso->country == myCountry) {
+            m = RulesSameCountry;
+        } else if (qso->continent == myContinent) {
+            m = RulesSameContinent;
+        } else {
+            m = RulesDx;
+        }
+        qso->pts = pts[qso->modeType][qso->band][m];
+    }
+    qsoPts += qso->pts;
+    addQsoMult(qso);
+}
+
+int ContestRules::fieldWidth(int col) const
+{
+    if (col >= 0 && col < nExch) return fieldWidths[col];
+    return 4;
+}
+
+int ContestRules::numberField() const
+{
+    return nrField;
+}
+
+int ContestRules::rstField() const
+{
+    return _rstField;
+}
+
+/*!
+   show all received fields except RST
+ */
+unsigned int ContestRules::rcvFieldShown() const
+{
+    unsigned int f = 0;
+    for (int i = 0; i < nExch; i++) {
+        if (exchange_type[i] != RST) f += (1 << i);
+    }
+    return f;
+}
+
+/*!
+   show sent fields other than RST and qso number
+ */
+unsigned int ContestRules::sntFieldShown() const
+{
+    unsigned int f = 0;
+    for (int i = 0; i < nExch; i++) {
+        if (exchange_type[i] != RST && exchange_type[i] != QsoNumber) f += (1 << i);
+    }
+    return f;
+}
+
+void ContestRules::setupContest(QByteArray MultFile[MMAX], const Cty *cty)
+{
+    readMultFile(MultFile, cty);
+    zeroScore();
+}
+
+bool ContestRules::isNumericField(FieldTypes t)
+{
+    return (t == RST || t == QsoNumber || t == Number || t == Zone);
+}
+
+/*!
+   generic exchange validator
+
+   - mult fields take the last entered element found in their mult list
+   - number fields take the last unused numbers, in field order. RST may be left off
+   - other fields take the last unused non-numeric elements, in field order
+ */
+bool ContestRules::validateExchange(Qso *qso)
+{
+    if (!separateExchange(qso)) return(false);
+
+    qso->bandColumn=qso->band;
+    for (int ii = 0; ii < MMAX; ii++) qso->mult[ii] = -1;
+
+    determineMultType(qso);
+
+    const int n = exchTok.size();
+    QVarLengthArray<bool, 16> used(n);
+    for (int i = 0; i < n; i++) used[i] = false;
+    bool ok = true;
+
+    // mult fields
+    for (int f = 0; f < nExch; f++) {
+        if (exchange_type[f] != DMult) continue;
+        const int ii = fieldMult[f];
+        bool found = false;
+        for (int i = n - 1; i >= 0; i--) {
+            if (used[i]) continue;
+            int m = isAMult(exchElement.at(i), ii);
+            if (m != -1) {
+                if (qso->isamult[ii]) qso->mult[ii] = m;
+                qso->mult_name = exchElement.at(i);
+                finalExch[f]   = exchElement.at(i);
+                used[i]        = true;
+                found          = true;
+                break;
+            }
+        }
+        if (!found) ok = false;
+    }
+
+    // number and text fields
+    QVarLengthArray<int, 16> nums;
+    QVarLengthArray<int, 16> words;
+    for (int i = 0; i < n; i++) {
+        if (used[i]) continue;
+        if (exchTok.isNumber(i)) nums.append(i);
+        else words.append(i);
+    }
+    int nNum  = 0;
+    int nWord = 0;
+    for (int f = 0; f < nExch; f++) {
+        if (exchange_type[f] == DMult) continue;
+        if (isNumericField(exchange_type[f])) nNum++;
+        else nWord++;
+    }
+    const bool defaultRst = (_rstField != -1 && nums.size() < nNum);
+    int kn = nums.size() - (defaultRst ? nNum - 1 : nNum);
+    int kw = words.size() - nWord;
+    if (kn < 0 || kw < 0) ok = false;
+    for (int f = 0; f < nExch; f++) {
+        if (exchange_type[f] == DMult) continue;
+        if (isNumericField(exchange_type[f])) {
+            if (exchange_type[f] == RST && defaultRst) {
+                if (qso->modeType == CWType || qso->modeType == DigiType) {
+                    finalExch[f] = "599";
+                } else {
+                    finalExch[f] = "59";
+                }
+            } else if (kn >= 0 && kn < nums.size()) {
+                finalExch[f] = exchElement.at(nums[kn++]);
+            } else {
+                kn++;
+            }
+        } else {
+            if (kw >= 0 && kw < words.size()) {
+                finalExch[f] = exchElement.at(words[kw++]);
+            } else {
+                kw++;
+            }
+        }
+    }
+
+    // only copy into log if exchange is validated
+    if (ok) {
+        for (int i = 0; i < nExch; i++) {
+            qso->rcv_exch[i] = finalExch[i];
+        }
+    }
+    // if exchange is ok and a mobile, we need a mobile dupe check
+    if (qso->isMobile && ok) {
+        emit(mobileDupeCheck(qso));
+        if (!qso->dupe) {
+            emit(clearDupe());
+        }
+    }
+    return(ok);
+}
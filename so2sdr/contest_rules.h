@@ -0,0 +1,68 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef CONTEST_RULES_H
+#define CONTEST_RULES_H
+
+#include "contest.h"
+
+/*!
+   where the station worked is relative to us, used to look up qso points
+ */
+typedef enum RulesMatch {
+    RulesSameCountry   = 0,
+    RulesSameContinent = 1,
+    RulesDx            = 2,
+    NRulesMatch        = 3
+} RulesMatch;
+
+/*!
+   Contest defined entirely by the contest .cfg file (contest=RULES).
+
+   The exchange fields and the points table are read once from the cfg
+   file when the contest is loaded. Qso points are then a single table
+   lookup by mode, band and country/continent.
+ */
+class ContestRules : public Contest {
+public:
+    ContestRules(QSettings &cs,QSettings &ss);
+    ~ContestRules();
+    void addQso(Qso *qso);
+    ContestType contestType() const { return Rules_t;}
+    int fieldWidth(int col) const;
+    int numberField() const;
+    unsigned int rcvFieldShown() const;
+    int rstField() const;
+    void setupContest(QByteArray MultFile[MMAX], const Cty * cty);
+    bool showQsoPtsField() const { return true;}
+    unsigned int sntFieldShown() const;
+    bool validateExchange(Qso *qso);
+
+private:
+    int  fieldMult[MAX_EXCH_FIELDS];
+    int  fieldWidths[MAX_EXCH_FIELDS];
+    int  nrField;
+    int  pts[NModeTypes][N_BANDS][NRulesMatch];
+    int  _rstField;
+
+    static bool isNumericField(FieldTypes t);
+    void readExchange();
+    void readPoints();
+};
+
+#endif
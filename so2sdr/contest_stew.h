@@ -32,6 +32,7 @@ public:
     bool validateExchange(Qso *qso);
     int fieldWidth(int col) const;
     unsigned int rcvFieldShown() const;
+    int nMultsScore() const { return 0;}
     int Score() const;
     bool showQsoPtsField() const { return true;}
     unsigned int sntFieldShown() const;
@@ -154,11 +154,14 @@ bool Sweepstakes::validateExchange(Qso *qso)
         // could have #PREC  together; 3 elements minimum
         if (exchElement.size() < 3) return(false);
 
-        bool *used = new bool[exchElement.size()];
-        for (int i = 0; i < exchElement.size(); i++) used[i] = false;
+        // elements are read from exchTok, which has the same elements as exchElement
+        // with numbers already parsed
+        const int n = exchTok.size();
+        QVarLengthArray<bool, 16> used(n);
+        for (int i = 0; i < n; i++) used[i] = false;
 
         // take last entered section name
-        for (int i = exchElement.size() - 1; i >= 0; i--) {
+        for (int i = n - 1; i >= 0; i--) {
             int m;
             if ((m = isAMult(exchElement.at(i), 0)) != -1) {
                 if (!ok_part[3]) {
@@ -176,52 +179,38 @@ bool Sweepstakes::validateExchange(Qso *qso)
         // move precedence to a separate array element in exchElement
 
         // start search from end of entered data
-        for (int i = exchElement.size() - 1; i >= 0; i--) {
-            QByteArray last = exchElement.at(i);
-            last = last.right(1);
-            if (last == "Q" || last == "A" || last == "B" ||
-                last == "U" || last == "M" || last == "S") {
-                QByteArray tmp = exchElement.at(i);
-                tmp.chop(1);
-                if (!tmp.isEmpty()) {
-                    bool ok = false;
-                    int nr=tmp.toInt(&ok, 10);
-                    Q_UNUSED(nr);
-                    if (ok) {
-                        used[i]=true;
-                        if (!ok_part[0]) {
-                            finalExch[0]=tmp;
-                            ok_part[0]=true;
-                        }
-                        if (!ok_part[1]) {
-                            ok_part[1]=true;
-                            finalExch[1]=last;
-                        }
+        for (int i = n - 1; i >= 0; i--) {
+            const char last = exchTok.data(i)[exchTok.length(i) - 1];
+            if (last == 'Q' || last == 'A' || last == 'B' ||
+                last == 'U' || last == 'M' || last == 'S') {
+                int nr;
+                if (exchTok.prefixNumber(i, nr)) {
+                    used[i]=true;
+                    if (!ok_part[0]) {
+                        finalExch[0]=QByteArray(exchTok.data(i), exchTok.length(i) - 1);
+                        ok_part[0]=true;
+                    }
+                    if (!ok_part[1]) {
+                        ok_part[1]=true;
+                        finalExch[1]=QByteArray(1, last);
                     }
-                } else if (exchElement.at(i).size()==1) {
+                } else if (exchTok.length(i)==1) {
                     // matched just prec
                     used[i]=true;
                     if (!ok_part[1]) {
                         ok_part[1]=true;
-                        finalExch[1]=last;
+                        finalExch[1]=QByteArray(1, last);
                     }
                 }
             }
         }
 
         // qso number: take last number which is not 2 digits or is a single digit
-        for (int i = exchElement.size() - 1; i >= 0; i--) {
-            if (used[i]) continue;
-            bool nrok = false;
-            int  nr   = exchElement.at(i).toInt(&nrok, 10);
-            if (nrok && nr > 99) {
-                // >99: QSO number
-                finalExch[0] = exchElement.at(i);
-                used[i]      = true;
-                ok_part[0]   = true;
-                break;
-            } else if (nrok && nr<10 && (exchElement.at(i).size()==1)) {
-                // single digit: must also be qso number
+        for (int i = n - 1; i >= 0; i--) {
+            if (used[i] || !exchTok.isNumber(i)) continue;
+            int nr = exchTok.number(i);
+            if (nr > 99 || (nr < 10 && exchTok.length(i) == 1)) {
+                // >99 or single digit: QSO number
                 finalExch[0] = exchElement.at(i);
                 used[i]      = true;
                 ok_part[0]   = true;
@@ -229,12 +218,9 @@ bool Sweepstakes::validateExchange(Qso *qso)
             }
         }
         // check: take last two-digit number
-        for (int i = exchElement.size() - 1; i >= 0; i--) {
+        for (int i = n - 1; i >= 0; i--) {
             if (used[i]) continue;
-            bool nrok = false;
-            int  nr   = exchElement.at(i).toInt(&nrok, 10);
-            Q_UNUSED(nr);
-            if (nrok && (exchElement.at(i).size()==2)) {
+            if (exchTok.isNumber(i) && exchTok.length(i) == 2) {
                 ok_part[2]   = true;
                 used[i]      = true;
                 finalExch[2] = exchElement.at(i);
@@ -244,36 +230,27 @@ bool Sweepstakes::validateExchange(Qso *qso)
 
         // if still don't have a qso number, take the first number on the line
         if (!ok_part[0]) {
-            for (int i = 0; i < exchElement.size(); i++) {
-                if (used[i]) continue;
+            for (int i = 0; i < n; i++) {
+                if (used[i] || !exchTok.isNumber(i)) continue;
 
-                bool ok;
-                int nr = exchElement.at(i).toInt(&ok, 10);
-                Q_UNUSED(nr);
-                if (ok && !ok_part[0]) {
+                if (!ok_part[0]) {
                     finalExch[0] = exchElement.at(i);
                     ok_part[0]=true;
-                    used[i]=true;
-                } else if (ok) {
-                    used[i]      = true;
                 }
+                used[i] = true;
             }
         }
         // try to update callsign if there is a non-identified string
         if (ok_part[0] & ok_part[1] & ok_part[2] & ok_part[3]) {
-            for (int i = exchElement.size() - 1; i >= 0; i--) {
+            for (int i = n - 1; i >= 0; i--) {
                 if (!used[i]) {
-                    bool ok;
-                    int nr = exchElement.at(i).toInt(&ok, 10);
-                    Q_UNUSED(nr);
-                    if (!ok) {
+                    if (!exchTok.isNumber(i)) {
                         qso->call = exchElement.at(i);
                     }
                     break;
                 }
             }
         }
-        delete[] used;
     } else {
         // not US/VE call, can't be logged
         return(false);
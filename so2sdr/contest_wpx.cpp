@@ -18,9 +18,10 @@
  */
 #include "contest_wpx.h"
 #include "log.h"
+#include "wpxprefix.h"
 
 /*! CQ WPX contest */
-WPX::WPX(QSettings &cs, QSettings &ss) : Contest(cs,ss)
+WPX::WPX(QSettings &cs, QSettings &ss) : Contest(cs,ss), pfxCache(WPX_PFX_CACHE_SIZE)
 {
     setVExch(true);
     setZoneMax(40);
@@ -172,92 +173,24 @@ bool WPX::validateExchange(Qso *qso)
 }
 
 
-void WPX::wpxPrefix(QByteArray call, QByteArray &pfx)
-
-// determines prefix from call
-// rewritten 05/30/2019
-//  -may not correctly handle callsigns with two /'s: will assume pfx before FIRST / is correct
+/*!
+   determines WPX prefix from call. Results are kept in a LRU cache since the same
+   calls are looked up repeatedly while typing, logging, and rescoring
+ */
+void WPX::wpxPrefix(const QByteArray &call, QByteArray &pfx)
 {
-    const char digits[10] = { '1', '2', '3', '4', '5', '6', '7', '8', '9', '0' };
-    const int nIgnorePfx=8;
-    const QByteArray ignorePfx[nIgnorePfx]={"P","M","QRP","AE","AG","KT","MM","AM"};
-    bool changeDigit=false;
-    bool ignore=false;
-    QByteArray portPfx="";
-    pfx = "";
-
-    // is it a portable?
-    if (call.contains("/")) {
-        int        j    = call.indexOf("/");
-        QByteArray tmp1 = call.mid(0, j);
-        QByteArray tmp2 = call.mid(j + 1, call.length() - j - 1);
-
-        // the longer one is probably the call, the other the port pfx
-        // tmp1/tmp2
-        if (tmp2.length() > tmp1.length()) {
-            portPfx = tmp1;
-            call=call.right(call.length()-tmp1.length()-1);
-        } else {
-            portPfx = tmp2;
-            call.chop(tmp2.length()+1);
-        }
-
-        // certain portable prefixes do not count as new pfx
-        for (int i=0;i<nIgnorePfx;i++) {
-            if (portPfx==ignorePfx[i]) {
-                portPfx.clear();
-                ignore=true;
-                break;
-            }
-        }
-        if (!ignore) {
-            // is there a digit in the portable pfx?
-            bool isdigit = false;
-            for (int i = 0; i < 10; i++) {
-                if (portPfx.contains(digits[i])) {
-                    isdigit = true;
-                    break;
-                }
-            }
-            if (portPfx.length()==1) {
-
-                if (isdigit) {
-                    // if the port Pfx is 1 character and a digit, it will modify the main pfx
-                    changeDigit=true;
-                } else {
-                    // single character pfx: must add '0' to form pfx
-                    portPfx = portPfx + "0";
-                }
-            }
-        }
-    }
-
-    // is there a digit in the call? Find LAST digit
-    int j = -1;
-    for (int i = 0; i < 10; i++) {
-        for (int k = 0; k < call.length(); k++) {
-            if ((call.at(k) == digits[i]) && k > j) {
-                j = k;
-            }
-        }
-    }
-    if (j != -1) {
-        // take up to the last digit in the call
-        pfx = call.mid(0, j + 1);
-    } else {
-        // take first 2 letters and add zero
-        pfx = call.mid(0, 2) + "0";
-    }
-
-    // apply change from portable digit
-    if (changeDigit) {
-        pfx.chop(1);
-        pfx=pfx+portPfx;
-    } else if (portPfx.length()>1) {
-        pfx=portPfx;
+    QByteArray *cached = pfxCache.object(call);
+    if (cached) {
+        pfx = *cached;
+        return;
     }
+    char buff[64];
+    int  n = call.size();
+    if (n > (int) sizeof(buff) - 2) n = sizeof(buff) - 2;
+    int  len = ::wpxPrefix(call.constData(), n, buff);
+    pfx = QByteArray(buff, len);
+    pfxCache.insert(call, new QByteArray(pfx));
 }
 
 
 
-
@@ -19,8 +19,12 @@
 #ifndef CONTEST_WPX_H
 #define CONTEST_WPX_H
 
+#include <QCache>
 #include "contest.h"
 
+// number of calls with prefixes kept by WPX::wpxPrefix
+const int WPX_PFX_CACHE_SIZE=8192;
+
 class WPX : public Contest {
 public:
     WPX(QSettings &cs,QSettings &ss);
@@ -37,7 +41,10 @@ public:
     bool showQsoPtsField() const { return true;}
     int rstField() const { return 0;}
     void workedMults(QByteArray Call, int mult, unsigned int &worked);
-    void wpxPrefix(QByteArray call, QByteArray &pfx);
+    void wpxPrefix(const QByteArray &call, QByteArray &pfx);
+
+private:
+    QCache<QByteArray,QByteArray> pfxCache;
 };
 
 #endif // CONTEST_WPX
@@ -16,11 +16,18 @@
     along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
 
  */
+#include <algorithm>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QFileInfo>
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include <QDate>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QSaveFile>
 #include "hamlib/rotator.h"
 #include "cty.h"
 #include "utils.h"
@@ -30,6 +37,9 @@
  */
 Cty::Cty(QSettings& s) : settings(s)
 {
+    myLat    = 0.0;
+    myLon    = 0.0;
+    zoneType = 0;
     // portable identifiers not giving a new country
     portId.clear();
     portId << "1" << "2" << "3" << "4" << "5" << "6" << "7" << "8" << "9" << "0";
@@ -49,6 +59,13 @@ Cty::Cty(QSettings& s) : settings(s)
 }
 
 Cty::~Cty()
+{
+    clear();
+}
+
+/*! delete all country, prefix, and exception data
+ */
+void Cty::clear()
 {
     for (int i = 0; i < countryList.size(); i++)
         delete (countryList[i]);
@@ -58,6 +75,138 @@ Cty::~Cty()
 
     for (int i = 0; i < pfxList.size(); i++)
         delete (pfxList[i]);
+
+    countryList.clear();
+    CallE.clear();
+    pfxList.clear();
+    zoneBearing.clear();
+    zoneLat.clear();
+    zoneLon.clear();
+    zoneSun.clear();
+}
+
+/*! hash identifying the parsed tables: name, size, and modification time of the CTY
+ *  and zone files, station location, and zone type. The files themselves are not read
+ */
+QByteArray Cty::cacheKey(const QString &ctyFile, const QString &zoneFile, double lat, double lon, int ZoneType) const
+{
+    const QFileInfo info(ctyFile);
+    if (!info.exists()) return QByteArray();
+    const QFileInfo info2(zoneFile);
+    QByteArray params;
+    QDataStream ds(&params, QIODevice::WriteOnly);
+    ds << CTY_CACHE_VERSION << ctyFile << (qint64) info.size() << (qint64) info.lastModified().toMSecsSinceEpoch();
+    ds << zoneFile << info2.exists() << (qint64) info2.size() << (qint64) info2.lastModified().toMSecsSinceEpoch();
+    ds << lat << lon << (qint32) ZoneType;
+    return QCryptographicHash::hash(params, QCryptographicHash::Sha1);
+}
+
+/*! load tables from binary cache. The file is memory-mapped and deserialized in one pass;
+ *  sunrise/sunset times are then computed for today's date.
+ *  Returns false if the cache is missing, out of date, or corrupt
+ */
+bool Cty::readCache(const QString &fileName, const QByteArray &key)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const qint64 size = file.size();
+    if (size < (qint64) sizeof(CTY_CACHE_MAGIC)) return false;
+    uchar *map = file.map(0, size);
+    if (!map) return false;
+
+    const QByteArray data = QByteArray::fromRawData((const char *) map, size);
+    QDataStream      ds(data);
+    ds.setVersion(QDataStream::Qt_5_0);
+    char       magic[8];
+    quint32    version = 0;
+    QByteArray k;
+    ds.readRawData(magic, 8);
+    ds >> version >> k;
+    if (qstrncmp(magic, CTY_CACHE_MAGIC, 8) != 0 || version != CTY_CACHE_VERSION || k != key) {
+        file.unmap(map);
+        return false;
+    }
+    qint32 n1, n2, n3;
+    ds >> n1 >> n2 >> n3;
+    nARRLCty = n1;
+    nCQCty   = n2;
+    usaIndx  = n3;
+    ds >> zoneBearing >> zoneLat >> zoneLon;
+
+    qint32 n;
+    ds >> n;
+    for (int i = 0; i < n && ds.status() == QDataStream::Ok; i++) {
+        Country *c = new Country;
+        qint32   indx, zone, cont, bearing;
+        ds >> indx >> c->name >> zone >> cont >> c->delta_t >> bearing >> c->lat >> c->lon >> c->MainPfx
+           >> c->multipleZones >> c->zonePfx >> c->zones;
+        c->indx      = indx;
+        c->Zone      = zone;
+        c->Continent = (Cont) cont;
+        c->bearing   = bearing;
+        countryList.append(c);
+    }
+    ds >> n;
+    for (int i = 0; i < n && ds.status() == QDataStream::Ok; i++) {
+        Pfx   *p = new Pfx;
+        qint32 indx, zone;
+        ds >> p->prefix >> indx >> zone >> p->zoneOverride;
+        p->CtyIndx = indx;
+        p->Zone    = zone;
+        pfxList.append(p);
+    }
+    ds >> n;
+    for (int i = 0; i < n && ds.status() == QDataStream::Ok; i++) {
+        CtyCall *c = new CtyCall;
+        qint32   indx, zone;
+        ds >> c->call >> indx >> zone >> c->zoneSun;
+        c->CtyIndx = indx;
+        c->Zone    = zone;
+        CallE.append(c);
+    }
+    file.unmap(map);
+    if (ds.status() != QDataStream::Ok || countryList.isEmpty() || pfxList.isEmpty()) {
+        clear();
+        return false;
+    }
+    updateSunTimes();
+    return true;
+}
+
+/*! save parsed tables to binary cache
+ */
+void Cty::writeCache(const QString &fileName, const QByteArray &key) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "cty: can't write cache" << fileName;
+        return;
+    }
+    QDataStream ds(&file);
+    ds.setVersion(QDataStream::Qt_5_0);
+    ds.writeRawData(CTY_CACHE_MAGIC, 8);
+    ds << CTY_CACHE_VERSION << key;
+    ds << (qint32) nARRLCty << (qint32) nCQCty << (qint32) usaIndx;
+    ds << zoneBearing << zoneLat << zoneLon;
+    ds << (qint32) countryList.size();
+    for (int i = 0; i < countryList.size(); i++) {
+        const Country *c = countryList.at(i);
+        ds << (qint32) c->indx << c->name << (qint32) c->Zone << (qint32) c->Continent << c->delta_t
+           << (qint32) c->bearing << c->lat << c->lon << c->MainPfx << c->multipleZones << c->zonePfx << c->zones;
+    }
+    ds << (qint32) pfxList.size();
+    for (int i = 0; i < pfxList.size(); i++) {
+        const Pfx *p = pfxList.at(i);
+        ds << p->prefix << (qint32) p->CtyIndx << (qint32) p->Zone << p->zoneOverride;
+    }
+    ds << (qint32) CallE.size();
+    for (int i = 0; i < CallE.size(); i++) {
+        const CtyCall *c = CallE.at(i);
+        ds << c->call << (qint32) c->CtyIndx << (qint32) c->Zone << c->zoneSun;
+    }
+    if (ds.status() != QDataStream::Ok || !file.commit()) {
+        qDebug() << "cty: can't write cache" << fileName;
+    }
 }
 
 
@@ -385,6 +534,28 @@ int Cty::idPfx2(Qso *qso, int sz) const
 
  */
 void Cty::initialize(double la, double lo, int ZoneType)
+{
+    prepare(la, lo, ZoneType);
+    build();
+}
+
+/*! set the cty file and station parameters used by build(). This reads the contest
+    settings, so must be called in the thread that owns them
+ */
+void Cty::prepare(double la, double lo, int ZoneType)
+{
+    ctyFile  = userDirectory()+"/"+settings.value(c_cty,c_cty_def).toString();
+    myLat    = la;
+    myLon    = lo;
+    zoneType = ZoneType;
+}
+
+/*! build the country tables from the file given to prepare(). Does not use the contest
+    settings, so may be run in a worker thread while this object is not yet in use.
+
+    Returns false if the cty file could not be read
+ */
+bool Cty::build()
 {
 /*! CTY file format
 
@@ -401,10 +572,14 @@ void Cty::initialize(double la, double lo, int ZoneType)
                         that the country is on the DARC WAEDC list, and counts in
                         CQ-sponsored contests, but not ARRL-sponsored contests).
  */
-    double mylat=la;
-    double mylon=lo;
-
-    QFile file(userDirectory()+"/"+settings.value(c_cty,c_cty_def).toString());
+    const double mylat=myLat;
+    const double mylon=myLon;
+    const int ZoneType=zoneType;
+    QElapsedTimer timer;
+    timer.start();
+
+    const QString &ctyFileName=ctyFile;
+    QFile file(ctyFileName);
     int   indx;
 
     // sunrise/sunset times for station
@@ -417,6 +592,17 @@ void Cty::initialize(double la, double lo, int ZoneType)
     case 0:zoneFileName=dataDirectory()+"/cq_zone_latlong.dat";break;
     case 1:zoneFileName=dataDirectory()+"/itu_zone_latlong.dat";break;
     }
+
+    // use tables from binary cache if nothing has changed since it was written
+    clear();
+    const QString cacheFileName=ctyFileName+(ZoneType ? ".itu.cache" : ".cq.cache");
+    const QByteArray key=cacheKey(ctyFileName,zoneFileName,mylat,mylon,ZoneType);
+    if (!key.isEmpty() && readCache(cacheFileName,key)) {
+        qDebug("cty: %d countries, %d prefixes, %d calls read from cache in %lld ms",countryList.size(),
+               pfxList.size(),CallE.size(),timer.elapsed());
+        return true;
+    }
+
     QFile file2(zoneFileName);
     if (file2.open(QIODevice::ReadOnly | QIODevice::Text)) {
         // add blank for 0, zones start with 1
@@ -431,6 +617,8 @@ void Cty::initialize(double la, double lo, int ZoneType)
             QStringList field = buffer.split(" ", QString::SkipEmptyParts);
             double lat=field.at(1).toDouble();
             double lon=field.at(2).toDouble();
+            zoneLat.append(lat);
+            zoneLon.append(lon);
             QString sunTime;
             QString set;
             sunTimes(lat, -lon, sunTime);
@@ -452,9 +640,9 @@ void Cty::initialize(double la, double lo, int ZoneType)
         }
     }
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QString tmp = "ERROR: can't open file " + userDirectory() + "/"+settings.value(c_cty,c_cty_def).toString();
+        QString tmp = "ERROR: can't open file " + ctyFileName;
         emit(ctyError(tmp));
-        return;
+        return false;
     }
     nARRLCty = 0;
     nCQCty   = 0;
@@ -541,6 +729,8 @@ void Cty::initialize(double la, double lo, int ZoneType)
         double head;
         qrb(mylon * -1.0, mylat, lon * -1.0, lat, &dist, &head);
         new_country->bearing = qRound(head); // round azimuth to nearest degree
+        new_country->lat     = lat;
+        new_country->lon     = lon;
         sunTimes(lat, lon, new_country->sun);
 
         i1                   = buffer.indexOf(":", i2 + 1);
@@ -709,6 +899,7 @@ void Cty::initialize(double la, double lo, int ZoneType)
                     // it NEITHER zone was defined, add call to exception list
                     // (with default zones set above). This is mostly for weird/unexpected calls
                     new_call->CtyIndx = indx;
+                    new_call->zoneSun = false;
                     new_call->sun=new_country->sun;
                     CallE.append(new_call);
                 } else if ((!ZoneType && cqz == -1) || (ZoneType && ituz == -1)) {
@@ -719,6 +910,7 @@ void Cty::initialize(double la, double lo, int ZoneType)
                     delete new_call;
                 } else {
                     new_call->CtyIndx = indx;
+                    new_call->zoneSun = true;
                     new_call->sun=zoneSun.at(new_call->Zone);
                     CallE.append(new_call);
                 }
@@ -753,55 +945,23 @@ void Cty::initialize(double la, double lo, int ZoneType)
         indx++;
     }
 
-    /*!
-       @todo define < operator so qsort can be used sort prefix and call exception lists
-     */
-
-    // prefix
-    for (int i = 1; i < pfxList.size(); i++) {
-        QByteArray tmp = pfxList[i]->prefix;
-        int        i0  = pfxList[i]->Zone;
-        int        i1  = pfxList[i]->CtyIndx;
-        bool       i2  = pfxList[i]->zoneOverride;
-        int        j   = i - 1;
-        while (j >= 0 && pfxList[j]->prefix > tmp) {
-            pfxList[j + 1]->prefix       = pfxList[j]->prefix;
-            pfxList[j + 1]->Zone         = pfxList[j]->Zone;
-            pfxList[j + 1]->CtyIndx      = pfxList[j]->CtyIndx;
-            pfxList[j + 1]->zoneOverride = pfxList[j]->zoneOverride;
-            j--;
-        }
-        pfxList[j + 1]->prefix       = tmp;
-        pfxList[j + 1]->Zone         = i0;
-        pfxList[j + 1]->CtyIndx      = i1;
-        pfxList[j + 1]->zoneOverride = i2;
-    }
-
-    // exception
-    for (int i = 1; i < CallE.size(); i++) {
-        QByteArray tmp = CallE[i]->call;
-        QString suntmp= CallE[i]->sun;
-        int        i0  = CallE[i]->Zone;
-        int        i1  = CallE[i]->CtyIndx;
-        int        j   = i - 1;
-        while (j >= 0 && CallE[j]->call > tmp) {
-            CallE[j + 1]->call    = CallE[j]->call;
-            CallE[j + 1]->sun    = CallE[j]->sun;
-            CallE[j + 1]->Zone    = CallE[j]->Zone;
-            CallE[j + 1]->CtyIndx = CallE[j]->CtyIndx;
-            j--;
-        }
-        CallE[j + 1]->call    = tmp;
-        CallE[j + 1]->sun    = suntmp;
-        CallE[j + 1]->Zone    = i0;
-        CallE[j + 1]->CtyIndx = i1;
-    }
+    // sort prefix and call exception lists. Stable sort keeps the file order of
+    // duplicate entries
+    std::stable_sort(pfxList.begin(), pfxList.end(),
+                     [](const Pfx *a, const Pfx *b) { return a->prefix < b->prefix; });
+    std::stable_sort(CallE.begin(), CallE.end(),
+                     [](const CtyCall *a, const CtyCall *b) { return a->call < b->call; });
 
     // save index for US
     Qso  tmpqso;
     tmpqso.call = "W1AW";
     bool b;
     usaIndx = idPfx(&tmpqso, b);
+
+    if (!key.isEmpty()) writeCache(cacheFileName,key);
+    qDebug("cty: %d countries, %d prefixes, %d calls parsed in %lld ms",countryList.size(),
+           pfxList.size(),CallE.size(),timer.elapsed());
+    return true;
 }
 
 /*!
@@ -822,6 +982,20 @@ QString Cty::mySunTimes() const
     return mySun;
 }
 
+/*!
+   true if c has the same countries in the same order, so country indices
+   from one can be used with the other
+ */
+bool Cty::sameCountries(const Cty *c) const
+{
+    if (c->countryList.size() != countryList.size()) return false;
+    for (int i = 0; i < countryList.size(); i++) {
+        if (c->countryList.at(i)->MainPfx != countryList.at(i)->MainPfx ||
+            c->countryList.at(i)->name != countryList.at(i)->name) return false;
+    }
+    return true;
+}
+
 /*!
    number of countries in database
  */
@@ -843,6 +1017,39 @@ QByteArray Cty::pfxName(int indx) const
     }
 }
 
+/*! sunrise/sunset times for zones, countries, and exception calls after the
+   tables were read from the cache
+ */
+void Cty::updateSunTimes()
+{
+    zoneSun.clear();
+    if (zoneLat.isEmpty()) {
+        // zone file was missing
+        for (int i = 0; i < zoneBearing.size(); i++) {
+            zoneSun.append("ERR");
+        }
+    } else {
+        // add blank for 0, zones start with 1
+        zoneSun.append("");
+        for (int i = 0; i < zoneLat.size(); i++) {
+            QString sunTime;
+            sunTimes(zoneLat.at(i), -zoneLon.at(i), sunTime);
+            zoneSun.append(sunTime);
+        }
+    }
+    for (int i = 0; i < countryList.size(); i++) {
+        sunTimes(countryList.at(i)->lat, countryList.at(i)->lon, countryList[i]->sun);
+    }
+    for (int i = 0; i < CallE.size(); i++) {
+        CtyCall *c = CallE[i];
+        if (c->zoneSun) {
+            c->sun = zoneSun.value(c->Zone);
+        } else if (c->CtyIndx >= 0 && c->CtyIndx < countryList.size()) {
+            c->sun = countryList.at(c->CtyIndx)->sun;
+        }
+    }
+}
+
 /*!
    Calculate sunrise/set times
 
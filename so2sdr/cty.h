@@ -29,6 +29,12 @@
 #include "defines.h"
 #include "qso.h"
 
+/*! binary cache of the parsed CTY file. The cache is rebuilt when the CTY or zone file,
+ *  station location, or zone type change. Sunrise/sunset times are not cached
+ */
+const char CTY_CACHE_MAGIC[]="SO2SDRCC";
+const quint32 CTY_CACHE_VERSION=2;
+
 class Cty : public QObject
 {
 Q_OBJECT
@@ -37,21 +43,27 @@ public:
     explicit Cty(QSettings& s);
     ~Cty();
 
+    bool build();
     int findPfx(QByteArray prefix, int& zone, Cont &continent, bool &o) const;
     int idPfx(Qso *qso, bool &qsy) const;
     void initialize(double la, double lo, int ZoneType);
     QString mySunTimes() const;
     int nCountries() const;
     QByteArray pfxName(int indx) const;
+    void prepare(double la, double lo, int ZoneType);
     void readCtyFile(QByteArray cty_file);
+    bool sameCountries(const Cty *c) const;
 
 signals:
     void ctyError(const QString &);
 
 private:
+    double            myLat;
+    double            myLon;
     int               nARRLCty;
     int               nCQCty;
     int               usaIndx;
+    int               zoneType;
     QList<Country *>  countryList;
     QList<CtyCall *>  CallE;
     QList<Pfx *>      pfxList;
@@ -60,13 +72,21 @@ private:
     QList<QByteArray> portIdMobile;
     QList<QByteArray> portIdRover;
     QSettings&        settings;
+    QString           ctyFile;
     QString           mySun;
     QList<int>        zoneBearing;
+    QList<double>     zoneLat;
+    QList<double>     zoneLon;
     QList<QString>    zoneSun;
 
+    QByteArray cacheKey(const QString &ctyFile, const QString &zoneFile, double lat, double lon, int ZoneType) const;
     int checkException(QByteArray call, int& zone, QString &sun) const;
+    void clear();
     int idPfx2(Qso *qso, int sz) const;
     bool isDigit(char c) const;
+    bool readCache(const QString &fileName, const QByteArray &key);
     void sunTimes(double lat, double lon, QString &suntime);
+    void updateSunTimes();
+    void writeCache(const QString &fileName, const QByteArray &key) const;
 };
 #endif // CTY_H
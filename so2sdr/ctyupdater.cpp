@@ -0,0 +1,114 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QFile>
+#include <QMetaType>
+#include <QSaveFile>
+#include "ctyupdater.h"
+
+CtyUpdater::CtyUpdater(QObject *parent) : QObject(parent)
+{
+    qRegisterMetaType<Cty*>("Cty*");
+}
+
+/*!
+ * \brief CtyUpdater::version version date of a CTY file, from its =VERyyyymmdd entry
+ * \param data contents of CTY file
+ * \param ver returns version string
+ * \return invalid date if no version entry was found
+ */
+QDate CtyUpdater::version(const QByteArray &data, QString &ver)
+{
+    int indx=data.indexOf("=VER");
+    while (indx!=-1 && data.mid(indx+1,7)=="VERSION") {
+        indx=data.indexOf("=VER",indx+1);
+    }
+    if (indx==-1) return QDate();
+    ver=data.mid(indx+4,8);
+    return QDate(ver.left(4).toInt(),ver.mid(4,2).toInt(),ver.right(2).toInt());
+}
+
+/*!
+ * \brief CtyUpdater::check compare downloaded CTY file with the one in directory.
+ * Emits newVersion if the download is newer or there is no installed file
+ */
+void CtyUpdater::check(const QByteArray &newCty, const QString &directory)
+{
+    QString newVer;
+    QDate newDate=version(newCty,newVer);
+    if (!newDate.isValid()) {
+        // CTY download failed (incomplete), missing version string
+        return;
+    }
+    QString oldVer;
+    QDate oldDate;
+    QFile oldCty(directory+"/wl_cty.dat");
+    if (oldCty.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        oldDate=version(oldCty.readAll(),oldVer);
+        oldCty.close();
+    }
+    if (!oldDate.isValid() || newDate>oldDate) {
+        data=newCty;
+        dir=directory;
+        emit(newVersion(newVer));
+    }
+}
+
+/*!
+ * \brief CtyUpdater::save write file atomically; an existing file is only replaced if
+ * the whole file was written
+ */
+bool CtyUpdater::save(const QString &fileName, const QByteArray &d)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    file.write(d);
+    return file.commit();
+}
+
+/*!
+ * \brief CtyUpdater::install save the CTY file found by check(), then build cty from it.
+ * cty may be null if no contest is open
+ */
+void CtyUpdater::install(Cty *cty)
+{
+    if (data.isEmpty()) {
+        emit(installed(cty,false,"ERROR: no CTY file to install"));
+        return;
+    }
+    if (!save(dir+"/wl_cty.dat",data)) {
+        emit(installed(cty,false,"ERROR: can't write "+dir+"/wl_cty.dat"));
+        return;
+    }
+    // save new NCCC Sprint CTY file with some countries changed from SA to NA
+    data.replace("Trinidad & Tobago:        09:  11:  SA","Trinidad & Tobago:        09:  11:  NA");
+    data.replace("Aruba:                    09:  11:  SA","Aruba:                    09:  11:  NA");
+    data.replace("Curacao:                  09:  11:  SA","Curacao:                  09:  11:  NA");
+    data.replace("Bonaire:                  09:  11:  SA","Bonaire:                  09:  11:  NA");
+    bool ok=save(dir+"/wl_cty-ns.dat",data);
+    data.clear();
+    if (!ok) {
+        emit(installed(cty,false,"ERROR: can't write "+dir+"/wl_cty-ns.dat"));
+        return;
+    }
+    if (cty && !cty->build()) {
+        emit(installed(cty,false,"ERROR: can't read new CTY file"));
+        return;
+    }
+    emit(installed(cty,true,"CTY file updated"));
+}
@@ -0,0 +1,59 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef CTYUPDATER_H
+#define CTYUPDATER_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QObject>
+#include <QString>
+#include "cty.h"
+
+/*!
+ checks and installs a downloaded CTY file. Runs in its own thread so the version
+ check, file writes, and rebuild of the country tables never block the UI.
+
+ check() compares the downloaded file with the installed one and emits newVersion()
+ if it is newer. install() then saves it and builds the country tables given to it,
+ which are handed back with installed() to be swapped in by the GUI thread
+ */
+class CtyUpdater : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CtyUpdater(QObject *parent = 0);
+    static QDate version(const QByteArray &data, QString &ver);
+
+signals:
+    void installed(Cty *cty, bool ok, const QString &msg);
+    void newVersion(const QString &ver);
+
+public slots:
+    void check(const QByteArray &newCty, const QString &directory);
+    void install(Cty *cty);
+
+private:
+    QByteArray data;
+    QString    dir;
+
+    static bool save(const QString &fileName, const QByteArray &d);
+};
+
+#endif // CTYUPDATER_H
@@ -0,0 +1,94 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include "cwtrace.h"
+#include "utils.h"
+
+CwTrace::CwTrace()
+{
+    active = false;
+    t0     = 0;
+    for (int i = 0; i < NCwTraceStages; i++) {
+        marked[i] = false;
+    }
+}
+
+/*!
+   clear all statistics
+ */
+void CwTrace::clear()
+{
+    active = false;
+    for (int i = 0; i < NCwTraceStages; i++) {
+        marked[i] = false;
+        stats[i].clear();
+    }
+}
+
+/*!
+   record time to stage s. key is the time of the key event being handled
+   (monotonicUsec() time base), or 0 for stages after the key press
+ */
+void CwTrace::mark(CwTraceStage s, qint64 key)
+{
+    if (key && (key != t0 || !active)) {
+        // first stage reached for a new key press
+        active = true;
+        t0     = key;
+        for (int i = 0; i < NCwTraceStages; i++) {
+            marked[i] = false;
+        }
+    }
+    if (!active || marked[s]) return;
+    if ((s == CwTraceWritten || s == CwTraceEcho) && !marked[CwTraceLoaded]) return;
+    marked[s] = true;
+    stats[s].add(monotonicUsec() - t0);
+    if (s == CwTraceEcho) active = false;
+}
+
+/*!
+   percentile latencies of each stage as an html table
+ */
+QString CwTrace::report() const
+{
+    QString s = "<table><tr><th align=left>Stage</th><th align=right>n</th><th align=right>p50</th>"
+                "<th align=right>p90</th><th align=right>p99</th><th align=right>max (ms)</th></tr>";
+    for (int i = 0; i < NCwTraceStages; i++) {
+        s += "<tr><td>" + CwTraceStageName[i] + "</td><td align=right>" + QString::number(stats[i].count()) + "</td>";
+        s += "<td align=right>" + QString::number(stats[i].percentile(50) / 1000.0, 'f', 2) + "</td>";
+        s += "<td align=right>" + QString::number(stats[i].percentile(90) / 1000.0, 'f', 2) + "</td>";
+        s += "<td align=right>" + QString::number(stats[i].percentile(99) / 1000.0, 'f', 2) + "</td>";
+        s += "<td align=right>" + QString::number(stats[i].max() / 1000.0, 'f', 2) + "</td></tr>";
+    }
+    s += "</table>";
+    return s;
+}
+
+/*!
+   one line per stage for debug output. Empty if nothing was traced
+ */
+QString CwTrace::summary() const
+{
+    QString s;
+    if (!stats[CwTraceLoaded].count()) return s;
+    for (int i = 0; i < NCwTraceStages; i++) {
+        if (i) s += "\n";
+        s += stats[i].summary("CW trace " + CwTraceStageName[i]);
+    }
+    return s;
+}
@@ -0,0 +1,67 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef CWTRACE_H
+#define CWTRACE_H
+
+#include <QString>
+#include "latency.h"
+
+/*!
+   stages of the CW path from a key press to Winkey. Times are measured
+   from the key event
+ */
+typedef enum CwTraceStage {
+    CwTraceRadio   = 0, // transmit radio switched
+    CwTraceMacro   = 1, // message expanded
+    CwTraceLoaded  = 2, // message given to Winkey::loadbuff
+    CwTraceWritten = 3, // bytes written to Winkey serial port
+    CwTraceEcho    = 4, // first echo byte received from Winkey
+    NCwTraceStages = 5
+} CwTraceStage;
+
+const QString CwTraceStageName[NCwTraceStages]={"radio switched","macro expanded","loaded in Winkey buffer",
+                                                "bytes written","Winkey echo"};
+
+/*!
+   latency tracing of CW messages sent by a key press.
+
+   Stages reached while a key press is handled are marked with the time of
+   the key event, which starts a new trace if it differs from the current one.
+   The serial port stages come later and are marked without a key time; they
+   are only recorded after the message has been loaded, so writes made before
+   it (speed, radio switching) are not counted. Each stage is recorded once
+   per trace; a trace ends at the Winkey echo or when the next one starts
+ */
+class CwTrace
+{
+public:
+    CwTrace();
+    void clear();
+    void mark(CwTraceStage s, qint64 key = 0);
+    QString report() const;
+    QString summary() const;
+
+private:
+    bool         active;
+    bool         marked[NCwTraceStages];
+    qint64       t0;
+    LatencyStats stats[NCwTraceStages];
+};
+
+#endif // CWTRACE_H
@@ -102,7 +102,8 @@ typedef enum ContestType {
     Arrldx_t  = 16,
     Paqp_t    = 17,
     Msqp_t    = 18,
-    JuneVHF_t = 19
+    JuneVHF_t = 19,
+    Rules_t   = 20
 } ContestType;
 
 // ////////////// Contest/Log/country database
@@ -153,6 +154,8 @@ typedef struct Country {
     Cont              Continent;
     float             delta_t;
     int               bearing;
+    double            lat;
+    double            lon;
     QByteArray        MainPfx;
     bool              multipleZones;
     QList<QByteArray> zonePfx;
@@ -179,6 +182,7 @@ typedef struct CtyCall {
     QByteArray call;
     int        CtyIndx;
     int        Zone;
+    bool       zoneSun;
     QString    sun;
 } CtyCall;
 Q_DECLARE_TYPEINFO(CtyCall, Q_PRIMITIVE_TYPE);
@@ -223,6 +227,18 @@ const int SQL_COL_PTS   =  15;   // qso points (int)
 const int SQL_COL_VALID =  16;   // valid flag (int) if 0, qso not exported to cabrillo
 const int SQL_N_COL     =  17;   // total number of columns
 
+/*! size of blocks written during log export (bytes)
+ */
+const int LOG_EXPORT_BUFFER_SIZE=65536;
+
+/*! number of qsos in each batch insert during log import
+ */
+const int LOG_IMPORT_BATCH_SIZE=1000;
+
+/*! number of qsos between progress updates during log import
+ */
+const int LOG_IMPORT_PROGRESS_STEP=500;
+
 /*!
    Exchange field types
 
@@ -308,7 +324,7 @@ const int N_TIMERS=3;
 // default frequency for various things (all in milliseconds)
 const int timerSettings[]={
     1000,  // clock update
-    300, // radio/serial update
+    1000, // radio status (freq/mode changes are signaled by RigSerial)
     100 // auto-CQ, dueling CQ resolution
 };
 
@@ -733,6 +749,27 @@ const QString c_qso_type1_def="";
 const QString c_qso_type2="contest/qsotype2";
 const QString c_qso_type2_def="";
 
+// rules for contests without a built-in C++ class (contest=RULES)
+const QString c_rules_exchange="contest/rules_exchange";
+const QString c_rules_exchange_def="RST,MULT1";
+
+const QString c_rules_fieldwidth="contest/rules_fieldwidth";
+const QString c_rules_fieldwidth_def="";
+
+const QString c_rules_points="contest/rules_points";
+
+const QString c_rules_points_mode="mode";
+const QString c_rules_points_mode_def="";
+
+const QString c_rules_points_band="band";
+const QString c_rules_points_band_def="";
+
+const QString c_rules_points_match="match";
+const QString c_rules_points_match_def="";
+
+const QString c_rules_points_pts="pts";
+const int c_rules_points_pts_def=1;
+
 const QString c_cq_func[2]={"keys/cq","keys_phone/cq"};
 const QString c_cq_func_def[2]={"",""};
 
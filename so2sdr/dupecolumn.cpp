@@ -0,0 +1,141 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <algorithm>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QRect>
+#include <QResizeEvent>
+#include <QScrollBar>
+#include <QString>
+#include "dupecolumn.h"
+
+DupeColumn::DupeColumn(QWidget *parent) : QAbstractScrollArea(parent)
+{
+    setFocusPolicy(Qt::NoFocus);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    viewport()->setCursor(Qt::ArrowCursor);
+}
+
+/*!
+   index of the character following the first digit in call. Calls with no
+   digit are sorted from their second character
+ */
+int DupeColumn::suffixStart(const QByteArray &call)
+{
+    for (int i = 0; i < call.size(); i++) {
+        if (call.at(i) >= '0' && call.at(i) <= '9') return i + 1;
+    }
+    return 1;
+}
+
+/*!
+   sort order: part of call after the first digit, then the whole call
+ */
+bool DupeColumn::lessThan(const QByteArray &a, const QByteArray &b)
+{
+    const int ia = qMin(suffixStart(a), a.size());
+    const int ib = qMin(suffixStart(b), b.size());
+    int c = qstrncmp(a.constData() + ia, b.constData() + ib, qMax(a.size() - ia, b.size() - ib) + 1);
+    if (c == 0) c = qstrcmp(a, b);
+    return (c < 0);
+}
+
+/*!
+   add call to the column. Returns false if the call is already there
+ */
+bool DupeColumn::addCall(const QByteArray &call)
+{
+    QVector<QByteArray>::iterator it = std::lower_bound(calls.begin(), calls.end(), call, lessThan);
+    if (it != calls.end() && *it == call) return false;
+
+    const int row = it - calls.begin();
+    calls.insert(it, call);
+    updateScrollRange();
+
+    // rows from the new call down move by one line
+    const int lineHeight = fontMetrics().height();
+    const int y = DUPE_COLUMN_MARGIN + row * lineHeight - verticalScrollBar()->value();
+    if (y < viewport()->height()) {
+        viewport()->update(QRect(0, qMax(0, y), viewport()->width(), viewport()->height()));
+    }
+    return true;
+}
+
+void DupeColumn::clear()
+{
+    calls.clear();
+    updateScrollRange();
+    viewport()->update();
+}
+
+/*!
+   replace all calls in the column. list does not need to be sorted
+ */
+void DupeColumn::setCalls(QVector<QByteArray> list)
+{
+    std::sort(list.begin(), list.end(), lessThan);
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+    calls.swap(list);
+    updateScrollRange();
+    viewport()->update();
+}
+
+void DupeColumn::updateScrollRange()
+{
+    const int lineHeight = fontMetrics().height();
+    const int contentHeight = calls.size() * lineHeight + 2 * DUPE_COLUMN_MARGIN;
+    verticalScrollBar()->setRange(0, qMax(0, contentHeight - viewport()->height()));
+    verticalScrollBar()->setPageStep(viewport()->height());
+    verticalScrollBar()->setSingleStep(lineHeight);
+}
+
+/*!
+   paint only the rows intersecting the update region
+ */
+void DupeColumn::paintEvent(QPaintEvent *e)
+{
+    if (calls.isEmpty()) return;
+
+    QPainter   p(viewport());
+    const QRect update = e->rect();
+    const int  scroll = verticalScrollBar()->value();
+    const int  lineHeight = fontMetrics().height();
+    int        r0 = (update.top() + scroll - DUPE_COLUMN_MARGIN) / lineHeight;
+    int        r1 = (update.bottom() + scroll - DUPE_COLUMN_MARGIN) / lineHeight;
+    if (r0 < 0) r0 = 0;
+    if (r1 >= calls.size()) r1 = calls.size() - 1;
+    p.setPen(palette().color(QPalette::Text));
+    for (int i = r0; i <= r1; i++) {
+        QRect r(DUPE_COLUMN_MARGIN, DUPE_COLUMN_MARGIN + i * lineHeight - scroll,
+                viewport()->width() - DUPE_COLUMN_MARGIN, lineHeight);
+        p.drawText(r, Qt::AlignLeft | Qt::AlignVCenter, QString::fromLatin1(calls.at(i)));
+    }
+}
+
+void DupeColumn::resizeEvent(QResizeEvent *e)
+{
+    QAbstractScrollArea::resizeEvent(e);
+    updateScrollRange();
+}
+
+void DupeColumn::scrollContentsBy(int dx, int dy)
+{
+    viewport()->scroll(dx, dy);
+}
@@ -0,0 +1,63 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef DUPECOLUMN_H
+#define DUPECOLUMN_H
+
+#include <QAbstractScrollArea>
+#include <QByteArray>
+#include <QVector>
+#include <QWidget>
+
+class QPaintEvent;
+class QResizeEvent;
+
+/*! margin around dupesheet column contents in pixels */
+const int DUPE_COLUMN_MARGIN=4;
+
+/*!
+   One column of the visible dupesheet.
+
+   Calls are kept sorted by the part of the call after the first digit, so
+   that a call can be found by binary search. Only visible rows are painted,
+   and adding a call only repaints the rows from the new call down.
+ */
+class DupeColumn : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit DupeColumn(QWidget *parent = Q_NULLPTR);
+    bool addCall(const QByteArray &call);
+    void clear();
+    void setCalls(QVector<QByteArray> list);
+    static int suffixStart(const QByteArray &call);
+
+protected:
+    void paintEvent(QPaintEvent *e);
+    void resizeEvent(QResizeEvent *e);
+    void scrollContentsBy(int dx, int dy);
+
+private:
+    QVector<QByteArray> calls;
+
+    static bool lessThan(const QByteArray &a, const QByteArray &b);
+    void updateScrollRange();
+};
+
+#endif // DUPECOLUMN_H
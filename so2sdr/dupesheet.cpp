@@ -18,43 +18,25 @@
  */
 #include <QDialog>
 #include <QKeyEvent>
+#include <QVector>
+#include "dupecolumn.h"
 #include "dupesheet.h"
 
 DupeSheet::DupeSheet(QWidget *parent) : QDialog(parent)
 {
     setupUi(this);
+    column[0]=Dupes0;
+    column[1]=Dupes1;
+    column[2]=Dupes2;
+    column[3]=Dupes3;
+    column[4]=Dupes4;
+    column[5]=Dupes5;
+    column[6]=Dupes6;
+    column[7]=Dupes7;
+    column[8]=Dupes8;
+    column[9]=Dupes9;
     clear();
     setFocusPolicy(Qt::NoFocus);
-    Dupes0->setFocusPolicy(Qt::NoFocus);
-    Dupes0->setLineWrapMode(QTextEdit::NoWrap);
-    Dupes0->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    Dupes1->setFocusPolicy(Qt::NoFocus);
-    Dupes1->setLineWrapMode(QTextEdit::NoWrap);
-    Dupes1->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    Dupes2->setFocusPolicy(Qt::NoFocus);
-    Dupes2->setLineWrapMode(QTextEdit::NoWrap);
-    Dupes2->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    Dupes3->setFocusPolicy(Qt::NoFocus);
-    Dupes3->setLineWrapMode(QTextEdit::NoWrap);
-    Dupes3->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    Dupes4->setFocusPolicy(Qt::NoFocus);
-    Dupes4->setLineWrapMode(QTextEdit::NoWrap);
-    Dupes4->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    Dupes5->setFocusPolicy(Qt::NoFocus);
-    Dupes5->setLineWrapMode(QTextEdit::NoWrap);
-    Dupes5->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    Dupes6->setFocusPolicy(Qt::NoFocus);
-    Dupes6->setLineWrapMode(QTextEdit::NoWrap);
-    Dupes6->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    Dupes7->setFocusPolicy(Qt::NoFocus);
-    Dupes7->setLineWrapMode(QTextEdit::NoWrap);
-    Dupes7->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    Dupes8->setFocusPolicy(Qt::NoFocus);
-    Dupes8->setLineWrapMode(QTextEdit::NoWrap);
-    Dupes8->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    Dupes9->setFocusPolicy(Qt::NoFocus);
-    Dupes9->setLineWrapMode(QTextEdit::NoWrap);
-    Dupes9->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     band_=BAND_NONE;
 }
 
@@ -97,79 +79,40 @@ void DupeSheet::closeEvent(QCloseEvent *event)
 void DupeSheet::clear()
 {
     for (int i = 0; i < dsColumns; i++) {
-        dupeCalls[i].clear();
-        dupeCallsKey[i].clear();
+        column[i]->clear();
     }
-    Dupes0->clear();
-    Dupes1->clear();
-    Dupes2->clear();
-    Dupes3->clear();
-    Dupes4->clear();
-    Dupes5->clear();
-    Dupes6->clear();
-    Dupes7->clear();
-    Dupes8->clear();
-    Dupes9->clear();
 }
 
-void DupeSheet::updateDupesheet(QByteArray call)
+/*!
+   column for call: first digit in the call, 0 if there is none
+ */
+int DupeSheet::columnIndex(const QByteArray &call)
 {
-    // find first digit in callsign
-    int idigit = 0;
     for (int i = 0; i < call.size(); i++) {
-        if (call.at(i) > 47 && call.at(i) < 58) {
-            idigit = i;
-            break;
-        }
-    }
-    int  digit = call.mid(idigit, 1).toInt();
-    char next;
-    if ((idigit + 1) < call.size()) {
-        next = call.mid(idigit + 1, 1).at(0);
-    } else {
-        next = 'A';
+        if (call.at(i) >= '0' && call.at(i) <= '9') return call.at(i) - '0';
     }
+    return 0;
+}
 
-    // is call already in list?
-    bool found = false;
-    for (int i = 0; i < dupeCalls[digit].size(); i++) {
-        if (call == dupeCalls[digit].at(i)) {
-            found = true;
-            break;
-        }
+/*!
+   replace contents of dupesheet with list of calls
+ */
+void DupeSheet::setCalls(const QList<QByteArray> &list)
+{
+    QVector<QByteArray> calls[dsColumns];
+    for (int i = 0; i < list.size(); i++) {
+        calls[columnIndex(list.at(i))].append(list.at(i));
     }
-    if (!found) {
-        int j = dupeCallsKey[digit].size();
-
-        // find place to insert call based on letter after the number
-        for (int i = 0; i < dupeCallsKey[digit].size(); i++) {
-            if (next < dupeCallsKey[digit].at(i)) {
-                j = i;
-                break;
-            }
-        }
-        dupeCalls[digit].insert(j, call);
-        dupeCallsKey[digit].insert(j, next);
-
-        QByteArray tmp = "";
-        for (int i = 0; i < dupeCalls[digit].size(); i++) {
-            tmp = tmp + dupeCalls[digit][i];
-            if (i != (dupeCalls[digit].size() - 1)) {
-                tmp = tmp + "\n";
-            }
-        }
-        switch (digit) {
-        case 0: Dupes0->setText(tmp); break;
-        case 1: Dupes1->setText(tmp); break;
-        case 2: Dupes2->setText(tmp); break;
-        case 3: Dupes3->setText(tmp); break;
-        case 4: Dupes4->setText(tmp); break;
-        case 5: Dupes5->setText(tmp); break;
-        case 6: Dupes6->setText(tmp); break;
-        case 7: Dupes7->setText(tmp); break;
-        case 8: Dupes8->setText(tmp); break;
-        case 9: Dupes9->setText(tmp); break;
-        }
+    for (int i = 0; i < dsColumns; i++) {
+        column[i]->setCalls(calls[i]);
     }
 }
 
+/*!
+   add one call to dupesheet. Only the column of the call is redrawn
+ */
+void DupeSheet::updateDupesheet(const QByteArray &call)
+{
+    if (call.isEmpty()) return;
+    column[columnIndex(call)]->addCall(call);
+}
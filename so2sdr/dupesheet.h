@@ -18,9 +18,13 @@
  */
 #ifndef DUPESHEET_H
 #define DUPESHEET_H
+#include <QByteArray>
+#include <QList>
 #include "defines.h"
 #include "ui_dupesheet.h"
 
+class DupeColumn;
+
 /*!
    Class for visible dupesheet
  */
@@ -34,7 +38,8 @@ public:
     int band() const;
     void setBand(int);
     void clear();
-    void updateDupesheet(QByteArray call);
+    void setCalls(const QList<QByteArray> &list);
+    void updateDupesheet(const QByteArray &call);
 
 signals:
     void closed(bool);
@@ -44,8 +49,9 @@ protected:
     void keyPressEvent(QKeyEvent *event);
 
 private:
-    QList<char>          dupeCallsKey[dsColumns];
-    QList<QByteArray>    dupeCalls[dsColumns];
+    DupeColumn           *column[dsColumns];
     int                  band_;
+
+    static int columnIndex(const QByteArray &call);
 };
 #endif
@@ -0,0 +1,152 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <limits.h>
+#include <string.h>
+#include "exchtokenizer.h"
+
+ExchTokenizer::ExchTokenizer()
+{
+}
+
+/*!
+   split exch at white space, converting to upper case. Gives the same
+   elements as exch.simplified().toUpper() split at spaces
+ */
+void ExchTokenizer::tokenize(const QByteArray &exch)
+{
+    buff.resize(exch.size());
+    tokens.clear();
+    const char *p = exch.constData();
+    const int   n = exch.size();
+    int         j = 0;
+    int         i = 0;
+    while (i < n) {
+        // skip white space
+        while (i < n && (p[i] == ' ' || (p[i] >= '\t' && p[i] <= '\r'))) i++;
+        if (i == n) break;
+
+        ExchToken t;
+        t.start    = j;
+        t.value    = 0;
+        t.isNumber = true;
+        while (i < n && !(p[i] == ' ' || (p[i] >= '\t' && p[i] <= '\r'))) {
+            char c = p[i];
+            if (c >= 'a' && c <= 'z') c = c - 'a' + 'A';
+            buff[j++] = c;
+            if (t.isNumber) {
+                if (c >= '0' && c <= '9' && t.value <= (INT_MAX - 9) / 10) {
+                    t.value = t.value * 10 + (c - '0');
+                } else {
+                    t.isNumber = false;
+                }
+            }
+            i++;
+        }
+        t.length = j - t.start;
+        if (!t.isNumber) t.value = 0;
+        tokens.append(t);
+    }
+}
+
+int ExchTokenizer::size() const
+{
+    return tokens.size();
+}
+
+const char *ExchTokenizer::data(int i) const
+{
+    return buff.constData() + tokens.at(i).start;
+}
+
+int ExchTokenizer::length(int i) const
+{
+    return tokens.at(i).length;
+}
+
+/*!
+   true if element i is all digits
+ */
+bool ExchTokenizer::isNumber(int i) const
+{
+    return tokens.at(i).isNumber;
+}
+
+/*!
+   value of element i if it is a number, otherwise 0
+ */
+int ExchTokenizer::number(int i) const
+{
+    return tokens.at(i).value;
+}
+
+/*!
+   true if element i is a number followed by a single character (eg "213A").
+   value returns the number
+ */
+bool ExchTokenizer::prefixNumber(int i, int &value) const
+{
+    const ExchToken &t = tokens.at(i);
+    if (t.length < 2) return false;
+    const char *p = buff.constData() + t.start;
+    int v = 0;
+    for (int k = 0; k < t.length - 1; k++) {
+        if (p[k] < '0' || p[k] > '9' || v > (INT_MAX - 9) / 10) return false;
+        v = v * 10 + (p[k] - '0');
+    }
+    value = v;
+    return true;
+}
+
+/*!
+   true if element i is the string s
+ */
+bool ExchTokenizer::equals(int i, const char *s) const
+{
+    const ExchToken &t = tokens.at(i);
+    const char *p = buff.constData() + t.start;
+    int k = 0;
+    for (; k < t.length; k++) {
+        if (s[k] != p[k]) return false;
+    }
+    return (s[k] == 0);
+}
+
+/*!
+   copy element i into dst. If dst is not shared its buffer is reused, so
+   refilling the same QByteArray does not allocate
+ */
+void ExchTokenizer::copyTo(int i, QByteArray &dst) const
+{
+    const ExchToken &t = tokens.at(i);
+    dst.resize(t.length);
+    memcpy(dst.data(), buff.constData() + t.start, t.length);
+}
+
+/*!
+   copy of element i
+ */
+QByteArray ExchTokenizer::token(int i) const
+{
+    return QByteArray(data(i), tokens.at(i).length);
+}
+
+void ExchTokenizer::removeAt(int i)
+{
+    tokens.remove(i);
+}
@@ -0,0 +1,66 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef EXCHTOKENIZER_H
+#define EXCHTOKENIZER_H
+
+#include <QByteArray>
+#include <QVarLengthArray>
+
+/*!
+   one exchange element: position in the tokenizer buffer and, if the
+   element is all digits, its value
+ */
+typedef struct ExchToken {
+    int  start;
+    int  length;
+    int  value;
+    bool isNumber;
+} ExchToken;
+Q_DECLARE_TYPEINFO(ExchToken, Q_PRIMITIVE_TYPE);
+
+/*!
+   Splits an entered exchange into space-separated upper-case elements.
+
+   The exchange is copied once into an internal buffer; elements are kept as
+   offsets into it, and numbers are parsed while splitting. For normal
+   exchange lengths nothing is allocated on the heap, so this can run on
+   every keystroke.
+ */
+class ExchTokenizer
+{
+public:
+    ExchTokenizer();
+    void copyTo(int i, QByteArray &dst) const;
+    bool equals(int i, const char *s) const;
+    bool isNumber(int i) const;
+    int number(int i) const;
+    int length(int i) const;
+    const char *data(int i) const;
+    bool prefixNumber(int i, int &value) const;
+    void removeAt(int i);
+    int size() const;
+    QByteArray token(int i) const;
+    void tokenize(const QByteArray &exch);
+
+private:
+    QVarLengthArray<char, 128>     buff;
+    QVarLengthArray<ExchToken, 16> tokens;
+};
+
+#endif // EXCHTOKENIZER_H
@@ -16,191 +16,315 @@
     along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
 
  */
-
 #include "defines.h"
-#include "log.h"
 #include "utils.h"
 #include "history.h"
 #include <QFileInfo>
 #include <QString>
 #include <QVariant>
 #include <QSqlDatabase>
+#include <QSqlError>
 #include <QSqlQuery>
-#include <QSqlRecord>
-#include <QSqlQueryModel>
 #include <QSettings>
 
+HistoryWriter::HistoryWriter(QObject *parent) : QObject(parent)
+{
+}
+
+/*!
+ * \brief HistoryWriter::open open the history file and read it into memory. Called in the writer
+ * thread. If the file does not exist it is created
+ */
+void HistoryWriter::open(const QString &fileName, int id)
+{
+    QFileInfo info(fileName);
+    bool exists=info.exists();
+    history = QSqlDatabase::addDatabase("QSQLITE", "HISTORY_WRITER");
+    history.setDatabaseName(fileName);
+    if (!history.open()) {
+        emit(opened(id, false, HistoryCache(), "ERROR: can't open history file " + fileName));
+        return;
+    }
+    HistoryCache cache;
+    if (!exists) { // create new history file
+        History::createTable(history);
+        emit(opened(id, true, cache, "INFO: History file " + fileName + " created"));
+        return;
+    }
+    QSqlQuery h(history);
+    h.setForwardOnly(true);
+    h.exec("SELECT Call,General,DMult,Name,State,ARRLSection,Grid,Number,Zone FROM history");
+    while (h.next()) {
+        HistoryFields &f = cache[h.value(0).toString().toLatin1()];
+        for (int j = 0; j < N_HISTORY_FIELDS; j++) {
+            f.field[j] = h.value(j + 1).toString().toLatin1();
+        }
+    }
+    h.finish();
+    emit(opened(id, true, cache, "History file " + fileName + " loaded"));
+}
+
+void HistoryWriter::close()
+{
+    if (history.isOpen()) {
+        history.close();
+    }
+    history = QSqlDatabase();
+    QSqlDatabase::removeDatabase("HISTORY_WRITER");
+}
+
+/*!
+ * \brief HistoryWriter::write write records in one transaction with a batched prepared statement.
+ * Failures are reported with error()
+ */
+void HistoryWriter::write(const QList<HistoryRecord> &records)
+{
+    if (!history.isOpen() || records.isEmpty()) return;
+
+    QVariantList col[N_HISTORY_FIELDS + 1];
+    for (int i = 0; i < records.size(); i++) {
+        col[0].append(QString::fromLatin1(records.at(i).call));
+        for (int j = 0; j < N_HISTORY_FIELDS; j++) {
+            col[j + 1].append(QString::fromLatin1(records.at(i).fields.field[j]));
+        }
+    }
+    history.transaction();
+    QSqlQuery h(history);
+    h.prepare("INSERT OR REPLACE INTO history (Call,General,DMult,Name,State,ARRLSection,Grid,Number,Zone) "
+              "VALUES (?,?,?,?,?,?,?,?,?)");
+    for (int i = 0; i < N_HISTORY_FIELDS + 1; i++) {
+        h.addBindValue(col[i]);
+    }
+    if (!h.execBatch()) {
+        emit(error("ERROR: can't write history file: " + h.lastError().text()));
+        h.finish();
+        history.rollback();
+        return;
+    }
+    if (!history.commit()) {
+        emit(error("ERROR: can't write history file: " + history.lastError().text()));
+    }
+}
+
 History::History(QSettings& s,QObject *parent) :
     QObject(parent),csettings(s)
 {
+    open = false;
+    loaded = false;
+    paused = false;
+    openId = 0;
+    qRegisterMetaType<HistoryRecord>("HistoryRecord");
+    qRegisterMetaType<QList<HistoryRecord> >("QList<HistoryRecord>");
+    qRegisterMetaType<HistoryCache>("HistoryCache");
+    writer = new HistoryWriter();
+    writer->moveToThread(&historyThread);
+    connect(this, SIGNAL(openWriter(const QString &, int)), writer, SLOT(open(const QString &, int)));
+    connect(writer, SIGNAL(opened(int, bool, const HistoryCache &, const QString &)),
+            this, SLOT(writerOpened(int, bool, const HistoryCache &, const QString &)));
+    connect(this, SIGNAL(writeRecords(const QList<HistoryRecord> &)), writer, SLOT(write(const QList<HistoryRecord> &)));
+    connect(writer, SIGNAL(error(const QString &)), this, SIGNAL(errorMessage(const QString &)));
+    connect(this, SIGNAL(closeWriter()), writer, SLOT(close()), Qt::BlockingQueuedConnection);
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(HISTORY_FLUSH_TIME);
+    connect(&flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
 }
 
 History::~History()
 {
     stopHistory();
+    delete writer;
 }
 
 /*!
- * \brief History::addQso update history database from qso
+ * \brief History::historyColumn history field used for an exchange field type
+ * \return index in HistoryFields, or -1 if this type is not kept
+ */
+int History::historyColumn(FieldTypes t)
+{
+    switch (t) {
+    case General: return 0;
+    case DMult: return 1;
+    case Name: return 2;
+    case State: return 3;
+    case ARRLSection: return 4;
+    case Grid: return 5;
+    case Number: return 6;
+    case Zone: return 7;
+    default: return -1;
+    }
+}
+
+/*!
+ * \brief History::createTable create the history table and index if they don't exist
+ */
+void History::createTable(QSqlDatabase &db)
+{
+    QSqlQuery h(db);
+    h.exec("CREATE TABLE IF NOT EXISTS history (`Call` TEXT PRIMARY KEY, `General` TEXT, `DMult` TEXT, `Name` TEXT, `State` TEXT, `ARRLSection` TEXT, `Grid` TEXT, `Number` TEXT, `Zone` TEXT)");
+    createIndex(db);
+}
+
+void History::createIndex(QSqlDatabase &db)
+{
+    QSqlQuery h(db);
+    h.exec("CREATE UNIQUE INDEX IF NOT EXISTS `call_idx` ON history (`Call`)");
+}
+
+/*!
+ * \brief History::addQso update history from qso. Fields not in this contest's
+ * exchange keep their previous values
  * \param qso
- * \param newqso
  */
 void History::addQso(const Qso *qso)
 {
-    if (!history.isOpen()) return;
+    if (!open || qso->call.isEmpty()) return;
 
-    QString query;
-    query.append("INSERT OR REPLACE INTO history (Call,General,DMult,Name,State,ARRLSection,Grid,Number,Zone) ");
-    query.append("SELECT new.Call, old.General, old.DMult, old.Name, old.State, old.ARRLSection, old.Grid, old.Number, old.Zone ");
-    query.append("FROM ( SELECT '" + QVariant(qso->call).toString() + "' AS Call");
+    HistoryRecord r;
+    r.call = qso->call;
+    quint8 mask = 0;
     for (int i = 0; i < qso->n_exchange; i++) {
-        switch (qso->exchange_type[i]) {
-        case General:
-            query.replace(QString("old.General"), QString("new.General"));
-            query.append(", '" + QVariant(qso->rcv_exch[i]).toString() + "' AS General");
-            break;
-        case DMult:
-            query.replace(QString("old.DMult"), QString("new.DMult"));
-            query.append(", '" + QVariant(qso->rcv_exch[i]).toString() + "' AS DMult");
-            break;
-        case Name:
-            query.replace(QString("old.Name"), QString("new.Name"));
-            query.append(", '" + QVariant(qso->rcv_exch[i]).toString() + "' AS Name");
-            break;
-        case State:
-            query.replace(QString("old.State"), QString("new.State"));
-            query.append(", '" + QVariant(qso->rcv_exch[i]).toString() + "' AS State");
-            break;
-        case ARRLSection:
-            query.replace(QString("old.ARRLSection"), QString("new.ARRLSection"));
-            query.append(", '" + QVariant(qso->rcv_exch[i]).toString() + "' AS ARRLSection");
-            break;
-        case Grid:
-            query.replace(QString("old.Grid"), QString("new.Grid"));
-            query.append(", '" + QVariant(qso->rcv_exch[i]).toString() + "' AS Grid");
-            break;
-        case Number:
-            query.replace(QString("old.Number"), QString("new.Number"));
-            query.append(", '" + QVariant(qso->rcv_exch[i]).toString() + "' AS Number");
-            break;
-        case Zone:
-            query.replace(QString("old.Zone"), QString("new.Zone"));
-            query.append(", '" + QVariant(qso->rcv_exch[i]).toString() + "' AS Zone");
-            break;
-        default:
-            break;
+        int j = historyColumn(qso->exchange_type[i]);
+        if (j != -1) {
+            r.fields.field[j] = qso->rcv_exch[i];
+            mask |= (1 << j);
         }
     }
-    query.append(") AS new LEFT JOIN ( SELECT Call,General,DMult,Name,State,ARRLSection,Grid,Number,Zone FROM history ) AS old ON new.Call = old.Call");
-    QSqlQuery h(history);
-    h.exec(query);
-    query.clear();
+    if (!loaded) {
+        // file is still being read; other fields of this call are not known yet
+        deferred.append(r);
+        deferredMask.append(mask);
+        return;
+    }
+    update(r, mask);
+}
+
+/*!
+ * \brief History::update set the fields of r given by mask in memory and queue the
+ * complete record for writing
+ */
+void History::update(const HistoryRecord &r, quint8 mask)
+{
+    HistoryFields &h = cache[r.call];
+    for (int j = 0; j < N_HISTORY_FIELDS; j++) {
+        if (mask & (1 << j)) h.field[j] = r.fields.field[j];
+    }
+    HistoryRecord w;
+    w.call   = r.call;
+    w.fields = h;
+    pending.append(w);
+    if (!flushTimer.isActive()) flushTimer.start();
+}
+
+/*!
+ * \brief History::writerOpened history file has been read by the writer thread
+ */
+void History::writerOpened(int id, bool ok, const HistoryCache &c, const QString &msg)
+{
+    if (id != openId || !open) return; // history was restarted or stopped since
+    emit(message(msg, 3000));
+    if (!ok) {
+        stopHistory();
+        return;
+    }
+    cache  = c;
+    loaded = true;
+    for (int i = 0; i < deferred.size(); i++) {
+        update(deferred.at(i), deferredMask.at(i));
+    }
+    deferred.clear();
+    deferredMask.clear();
+    emit(ready());
+}
+
+/*!
+ * \brief History::flush send pending records to the writer thread
+ */
+void History::flush()
+{
+    flushTimer.stop();
+    if (pending.isEmpty()) return;
+    emit(writeRecords(pending));
+    pending.clear();
 }
 
 /*!
- * \brief History::fillExchange copy exchange from history database to Qso prefill field
+ * \brief History::fillExchange copy exchange from history to Qso prefill field
  * \param qso current qso
  * \param part partial callsign
  */
 void History::fillExchange(Qso *qso,QByteArray part)
 {
-    if (!history.isOpen()) return;
-    QSqlQueryModel h;
-    QString query;
-    query.append("SELECT Call");
-    for (int i = 0; i < qso->n_exchange; i++) {
+    if (!loaded) return;
+    QHash<QByteArray, HistoryFields>::const_iterator it = cache.constFind(part);
+    if (it == cache.constEnd()) return;
 
-        switch (qso->exchange_type[i]) {
-        case General:
-            query.append(",General");
-            break;
-        case DMult:
-            query.append(",DMult");
-            break;
-        case Name:
-            query.append(",Name");
-            break;
-        case State:
-            query.append(",State");
-            break;
-        case ARRLSection:
-            query.append(",ARRLSection");
-            break;
-        case Grid:
-            query.append(",Grid");
-            break;
-        case Number:
-            query.append(",Number");
-            break;
-        case Zone:
-            query.append(",Zone");
-            break;
-        default:
-            break;
-        }
-    }
-    query.append(" FROM history where Call = '" + part + "'");
-    h.setQuery(query, history);
-    if (h.rowCount()) {
-        for (int i = 1; i < h.columnCount(); i++) { // skip call field
-            qso->prefill.append(h.record(0).value(i).toString().toLatin1());
-            if (i < (h.columnCount() - 1)) {
-                qso->prefill.append(" ");
-            }
-        }
+    bool first = true;
+    for (int i = 0; i < qso->n_exchange; i++) {
+        int j = historyColumn(qso->exchange_type[i]);
+        if (j == -1) continue;
+        if (!first) qso->prefill.append(" ");
+        qso->prefill.append(it.value().field[j]);
+        first = false;
     }
-    h.clear();
 }
 
 bool History::isOpen()
 {
-    return history.open();
+    return open;
 }
 
 /*! initialize the history database. If historyfile is not found, it will be created.
  *
+ * The history file is opened and read into memory by the writer thread; ready() is
+ * emitted when it has been loaded
  */
 void History::startHistory()
 {
-    if (history.isOpen()) {
-        history.close();
-        history = QSqlDatabase();
-        QSqlDatabase::removeDatabase("HISTORY");
+    // qsos logged while paused are applied once the file is read
+    QList<HistoryRecord> d;
+    QList<quint8>        m;
+    if (paused) {
+        d = deferred;
+        m = deferredMask;
     }
+    stopHistory();
+    deferred     = d;
+    deferredMask = m;
     QString filename=csettings.value(c_historyfile,c_historyfile_def).toString();
-    QFileInfo info(userDirectory() + "/" + filename);
-    if (info.exists()) {
-        history = QSqlDatabase::addDatabase("QSQLITE", "HISTORY");
-        history.setDatabaseName(userDirectory() + "/" + filename);
-        if (!history.open()) {
-            history = QSqlDatabase();
-            QSqlDatabase::removeDatabase("HISTORY");
-            emit(message("ERROR: can't open history file " + userDirectory() + "/" + filename,3000));
-        } else {
-            emit(message("History file " + userDirectory() + "/" + filename + " loaded",3000));
-        }
-    } else { // create new history file
-        history = QSqlDatabase::addDatabase("QSQLITE", "HISTORY");
-        history.setDatabaseName(userDirectory() + "/" + filename);
-        history.open();
+    QString path=userDirectory() + "/" + filename;
+    open = true;
+    openId++;
+    historyThread.start();
+    emit(openWriter(path, openId));
+}
 
-        QSqlQuery h(history);
-        QString query;
-        query.append("CREATE TABLE IF NOT EXISTS history (`Call` TEXT PRIMARY KEY, `General` TEXT, `DMult` TEXT, `Name` TEXT, `State` TEXT, `ARRLSection` TEXT, `Grid` TEXT, `Number` TEXT, `Zone` TEXT)");
-        h.exec(query);
-        query.clear();
-        query.append("CREATE UNIQUE INDEX `call_idx` ON history (`Call`)");
-        h.exec(query);
-        query.clear();
-        emit(message("INFO: History file " + userDirectory() + "/" + filename + " created",3000));
-    }
+/*!
+ * \brief History::pauseHistory close the history file so it can be rewritten. New qsos
+ * are kept and applied when the file is opened again with startHistory
+ */
+void History::pauseHistory()
+{
+    stopHistory();
+    open   = true;
+    paused = true;
 }
 
+/*!
+ * \brief History::stopHistory write any pending records and close the history file
+ */
 void History::stopHistory()
 {
-    if (history.isOpen()) {
-        history.close();
-        history = QSqlDatabase();
-        QSqlDatabase::removeDatabase("HISTORY");
+    if (historyThread.isRunning()) {
+        flush();
+        emit(closeWriter());
+        historyThread.quit();
+        historyThread.wait();
     }
+    open = false;
+    loaded = false;
+    paused = false;
+    cache.clear();
+    deferred.clear();
+    deferredMask.clear();
+    pending.clear();
 }
@@ -16,19 +16,77 @@
     along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
 
  */
-
 #ifndef HISTORY_H
 #define HISTORY_H
 
 #include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMetaType>
 #include <QObject>
 #include <QSqlDatabase>
 #include <QSettings>
-#include <QSqlRecord>
+#include <QThread>
+#include <QTimer>
 #include "qso.h"
 
+/*! number of exchange fields kept in the history file
+ */
+const int N_HISTORY_FIELDS=8;
+
+/*! time (ms) new history records are kept before they are written to the file
+ */
+const int HISTORY_FLUSH_TIME=2000;
+
+/*!
+   exchange fields for one call, in history file column order
+   General, DMult, Name, State, ARRLSection, Grid, Number, Zone
+ */
+typedef struct HistoryFields {
+    QByteArray field[N_HISTORY_FIELDS];
+} HistoryFields;
+
+typedef struct HistoryRecord {
+    QByteArray    call;
+    HistoryFields fields;
+} HistoryRecord;
+Q_DECLARE_METATYPE(HistoryRecord)
+
+typedef QHash<QByteArray, HistoryFields> HistoryCache;
+Q_DECLARE_METATYPE(HistoryCache)
+
+/*!
+ writes history records to the history file. Runs in its own thread with
+ its own database connection
+ */
+class HistoryWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HistoryWriter(QObject *parent = 0);
+
+signals:
+    void error(const QString &msg);
+    void opened(int id, bool ok, const HistoryCache &cache, const QString &msg);
+
+public slots:
+    void close();
+    void open(const QString &fileName, int id);
+    void write(const QList<HistoryRecord> &records);
+
+private:
+    QSqlDatabase history;
+};
+
 /*!
  exchange history database
+
+ The whole history file is read into memory when started, so prefill lookups
+ do not touch the database. New qsos update the memory copy at once and are
+ written to the file in batches by a HistoryWriter in historyThread.
+
+ The file is read by the writer thread; ready() is emitted when it is in memory.
+ Qsos added before then are applied once the file is loaded.
  */
 class History : public QObject
 {
@@ -37,20 +95,45 @@ public:
     explicit History(QSettings& csettings,QObject *parent = 0);
     ~History();
     void fillExchange(Qso *qso,QByteArray part);
+    void pauseHistory();
     void startHistory();
     void stopHistory();
     bool isOpen();
 
+    static void createIndex(QSqlDatabase &db);
+    static void createTable(QSqlDatabase &db);
+    static int historyColumn(FieldTypes t);
+
 signals:
+    void closeWriter();
+    void errorMessage(const QString &);
     void message(const QString &,int);
+    void openWriter(const QString &, int);
+    void ready();
+    void writeRecords(const QList<HistoryRecord> &);
 
 public slots:
     void addQso(const Qso *qso);
+    void flush();
+
+private slots:
+    void writerOpened(int id, bool ok, const HistoryCache &c, const QString &msg);
 
 private:
-    QSqlDatabase         history;
-    QSettings&            csettings;
+    bool                 open;
+    bool                 loaded;
+    bool                 paused;
+    int                  openId;
+    HistoryCache         cache;
+    QList<HistoryRecord> deferred;
+    QList<quint8>        deferredMask;
+    QList<HistoryRecord> pending;
+    QSettings&           csettings;
+    QThread              historyThread;
+    QTimer               flushTimer;
+    HistoryWriter        *writer;
 
+    void update(const HistoryRecord &r, quint8 mask);
 };
 
 #endif // HISTORY_H
@@ -0,0 +1,513 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThreadPool>
+#include <QVariant>
+#include <QVector>
+#include "adifparse.h"
+#include "historybuilder.h"
+#include "logimporter.h"
+
+/*!
+   reads one input file in a QThreadPool thread
+ */
+class HistoryBuildTask : public QRunnable
+{
+public:
+    HistoryBuildTask(const QString &f, const QList<FieldTypes> &e, HistoryBuildMap *m, int *n, QAtomicInt *d)
+        : fileName(f), exchange(e), map(m), nrec(n), done(d) {}
+    void run()
+    {
+        *nrec = HistoryBuilder::readFile(fileName, exchange, *map);
+        done->ref();
+    }
+
+private:
+    QString           fileName;
+    QList<FieldTypes> exchange;
+    HistoryBuildMap   *map;
+    int               *nrec;
+    QAtomicInt        *done;
+};
+
+/*!
+   seconds since epoch for a date (MMddyyyy) and time (hhmm) as stored in
+   the SQL log, or def if they are not valid
+ */
+static qint64 seenTime(const QString &date, const QString &time, qint64 def)
+{
+    QDateTime t(QDate::fromString(date, "MMddyyyy"), QTime::fromString(time, "hhmm"), Qt::UTC);
+    if (!t.isValid()) return def;
+    return t.toMSecsSinceEpoch() / 1000;
+}
+
+HistoryBuilder::HistoryBuilder(QObject *parent) : QObject(parent)
+{
+    minCount = 1;
+    calls    = 0;
+    records  = 0;
+}
+
+void HistoryBuilder::addFile(const QString &fileName)
+{
+    files.append(fileName);
+}
+
+/*!
+   number of calls written to the history file by the last build
+ */
+int HistoryBuilder::nCalls() const
+{
+    return calls;
+}
+
+/*!
+   number of records (qsos or call history lines) read by the last build
+ */
+int HistoryBuilder::nRecords() const
+{
+    return records;
+}
+
+/*!
+   exchange field types of received fields in so2sdr .log and Cabrillo files
+ */
+void HistoryBuilder::setExchange(const QList<FieldTypes> &types)
+{
+    exchange = types;
+}
+
+/*!
+   calls seen fewer than n times in the input files are not added to the history
+ */
+void HistoryBuilder::setMinCount(int n)
+{
+    minCount = qMax(1, n);
+}
+
+/*!
+   parse a comma-separated list of exchange field types, eg "NAME,STATE".
+   Types are GENERAL, RST, MULT, ZONE, NR, NAME, STATE, SECTION, GRID, NUMBER
+ */
+bool HistoryBuilder::parseExchange(const QString &s, QList<FieldTypes> &types)
+{
+    types.clear();
+    const QStringList l = s.split(",", QString::SkipEmptyParts);
+    for (int i = 0; i < l.size(); i++) {
+        const QString f = l.at(i).trimmed().toUpper();
+        if (f == "GENERAL") types.append(General);
+        else if (f == "RST") types.append(RST);
+        else if (f == "MULT" || f == "DMULT") types.append(DMult);
+        else if (f == "ZONE") types.append(Zone);
+        else if (f == "NR" || f == "#") types.append(QsoNumber);
+        else if (f == "NAME") types.append(Name);
+        else if (f == "STATE") types.append(State);
+        else if (f == "SECTION") types.append(ARRLSection);
+        else if (f == "GRID") types.append(Grid);
+        else if (f == "NUMBER") types.append(Number);
+        else return false;
+    }
+    return (types.size() <= MAX_EXCH_FIELDS);
+}
+
+/*!
+   add one record for call to map. Non-empty fields replace older values
+ */
+void HistoryBuilder::addRecord(HistoryBuildMap &map, const QByteArray &call, qint64 seen, const HistoryFields &f)
+{
+    if (call.isEmpty()) return;
+    HistoryBuildMap::iterator it = map.find(call);
+    if (it == map.end()) {
+        HistoryBuildEntry e;
+        e.inFile = false;
+        e.count  = 0;
+        for (int j = 0; j < N_HISTORY_FIELDS; j++) e.seen[j] = -1;
+        it = map.insert(call, e);
+    }
+    HistoryBuildEntry &e = it.value();
+    e.count++;
+    for (int j = 0; j < N_HISTORY_FIELDS; j++) {
+        if (!f.field[j].isEmpty() && seen >= e.seen[j]) {
+            e.field[j] = f.field[j];
+            e.seen[j]  = seen;
+        }
+    }
+}
+
+/*!
+   merge from into to. For equal times, values in from win
+ */
+void HistoryBuilder::merge(HistoryBuildMap &to, const HistoryBuildMap &from)
+{
+    for (HistoryBuildMap::const_iterator it = from.constBegin(); it != from.constEnd(); ++it) {
+        HistoryBuildMap::iterator t = to.find(it.key());
+        if (t == to.end()) {
+            to.insert(it.key(), it.value());
+            continue;
+        }
+        HistoryBuildEntry &e = t.value();
+        e.count  += it.value().count;
+        e.inFile |= it.value().inFile;
+        for (int j = 0; j < N_HISTORY_FIELDS; j++) {
+            if (!it.value().field[j].isEmpty() && it.value().seen[j] >= e.seen[j]) {
+                e.field[j] = it.value().field[j];
+                e.seen[j]  = it.value().seen[j];
+            }
+        }
+    }
+}
+
+/*!
+   read one input file into map, returns number of records read.
+
+   The type is found from the contents: SQLite (so2sdr log), Cabrillo
+   (START-OF-LOG or QSO: lines), ADIF (<EOH> or <CALL:), otherwise call
+   history text
+ */
+int HistoryBuilder::readFile(const QString &fileName, const QList<FieldTypes> &exchange, HistoryBuildMap &map)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return 0;
+    const QByteArray head = file.read(4096);
+    file.close();
+    if (head.startsWith("SQLite format 3")) {
+        return readLog(fileName, exchange, map);
+    }
+    const QByteArray up = head.toUpper();
+    if (up.contains("START-OF-LOG:") || up.contains("QSO:")) {
+        return readCabrillo(fileName, exchange, map);
+    }
+    if (up.contains("<EOH>") || up.contains("<CALL:")) {
+        return readAdif(fileName, map);
+    }
+    return readCsv(fileName, map);
+}
+
+/*!
+   so2sdr log: valid qsos, with received fields given by exchange
+ */
+int HistoryBuilder::readLog(const QString &fileName, const QList<FieldTypes> &exchange, HistoryBuildMap &map)
+{
+    // each thread needs its own connection
+    static QAtomicInt connections;
+    const QString name = "HISTORY_BUILD_" + QString::number(connections.fetchAndAddOrdered(1));
+    const qint64  def  = QFileInfo(fileName).lastModified().toMSecsSinceEpoch() / 1000;
+    int n = 0;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+        db.setDatabaseName(fileName);
+        if (db.open()) {
+            QSqlQuery q(db);
+            q.setForwardOnly(true);
+            q.exec("SELECT call,date,time,rcv1,rcv2,rcv3,rcv4 FROM log WHERE valid=1");
+            while (q.next()) {
+                HistoryFields f;
+                for (int i = 0; i < exchange.size() && i < MAX_EXCH_FIELDS; i++) {
+                    int j = History::historyColumn(exchange.at(i));
+                    if (j != -1) f.field[j] = q.value(3 + i).toString().toLatin1().toUpper();
+                }
+                addRecord(map, q.value(0).toString().toLatin1().toUpper(),
+                          seenTime(q.value(1).toString(), q.value(2).toString(), def), f);
+                n++;
+            }
+            q.finish();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+    return n;
+}
+
+/*!
+   Cabrillo log, with received fields given by exchange
+ */
+int HistoryBuilder::readCabrillo(const QString &fileName, const QList<FieldTypes> &exchange, HistoryBuildMap &map)
+{
+    LogImporter importer(fileName, exchange.size());
+    importer.run();
+    const qint64 def = QFileInfo(fileName).lastModified().toMSecsSinceEpoch() / 1000;
+    const QList<ImportQso> &qsos = importer.qsos();
+    for (int i = 0; i < qsos.size(); i++) {
+        HistoryFields f;
+        for (int k = 0; k < exchange.size() && k < MAX_EXCH_FIELDS; k++) {
+            int j = History::historyColumn(exchange.at(k));
+            if (j != -1) f.field[j] = qsos.at(i).rcv[k];
+        }
+        addRecord(map, qsos.at(i).call, seenTime(qsos.at(i).date, qsos.at(i).time, def), f);
+    }
+    return qsos.size();
+}
+
+/*!
+   ADIF log. Standard ADIF fields are used: NAME, STATE, ARRL_SECT, GRIDSQUARE,
+   CQZ, and SRX_STRING for General
+ */
+int HistoryBuilder::readAdif(const QString &fileName, HistoryBuildMap &map)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return 0;
+    QByteArray  data;
+    const char *p    = 0;
+    int         size = (int) file.size();
+    uchar      *m    = file.map(0, size);
+    if (m) {
+        p = (const char *) m;
+    } else {
+        data = file.readAll();
+        p    = data.constData();
+        size = data.size();
+    }
+    const qint64  def = QFileInfo(fileName).lastModified().toMSecsSinceEpoch() / 1000;
+    AdifTokenizer tok(p, size);
+    AdifField     fld;
+    HistoryFields f;
+    QByteArray    call;
+    QDate         date;
+    QTime         time;
+    int           n = 0;
+    while (tok.next(fld)) {
+        if (fld.is("EOR") || fld.is("EOH")) {
+            if (fld.is("EOR") && !call.isEmpty()) {
+                QDateTime t(date, time, Qt::UTC);
+                addRecord(map, call, t.isValid() ? t.toMSecsSinceEpoch() / 1000 : def, f);
+                n++;
+            }
+            f    = HistoryFields();
+            call.clear();
+            date = QDate();
+            time = QTime();
+            continue;
+        }
+        int j = -1;
+        if (fld.is("CALL")) {
+            call = QByteArray(fld.value, fld.valueLen).toUpper();
+        } else if (fld.is("QSO_DATE")) {
+            date = QDate(fld.toInt(0, 4), fld.toInt(4, 2), fld.toInt(6, 2));
+        } else if (fld.is("TIME_ON")) {
+            time = QTime(fld.toInt(0, 2), fld.toInt(2, 2));
+        } else if (fld.is("NAME")) {
+            j = History::historyColumn(Name);
+        } else if (fld.is("STATE")) {
+            j = History::historyColumn(State);
+        } else if (fld.is("ARRL_SECT")) {
+            j = History::historyColumn(ARRLSection);
+        } else if (fld.is("GRIDSQUARE")) {
+            j = History::historyColumn(Grid);
+        } else if (fld.is("CQZ")) {
+            j = History::historyColumn(Zone);
+        } else if (fld.is("SRX_STRING")) {
+            j = History::historyColumn(General);
+        }
+        if (j != -1) f.field[j] = QByteArray(fld.value, fld.valueLen).toUpper();
+    }
+    if (m) file.unmap(m);
+    return n;
+}
+
+/*!
+   N1MM-style call history text file. Lines starting with # are comments; a line
+   !!Order!!,Call,Name,... gives the columns. Without it, columns are Call,Name.
+   Used columns are Call, Name, State, Sect, Grid, CQZone and Exch1 (General)
+ */
+int HistoryBuilder::readCsv(const QString &fileName, HistoryBuildMap &map)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return 0;
+    const qint64 seen = QFileInfo(fileName).lastModified().toMSecsSinceEpoch() / 1000;
+
+    int callCol = 0;
+    QVector<int> col;
+    col << -1 << History::historyColumn(Name);
+    int n = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+        const QList<QByteArray> l = line.split(',');
+        if (line.startsWith("!!Order!!")) {
+            callCol = -1;
+            col.fill(-1, l.size());
+            for (int i = 1; i < l.size(); i++) {
+                const QByteArray c = l.at(i).trimmed().toUpper();
+                if (c == "CALL") callCol = i;
+                else if (c == "NAME") col[i] = History::historyColumn(Name);
+                else if (c == "STATE") col[i] = History::historyColumn(State);
+                else if (c == "SECT") col[i] = History::historyColumn(ARRLSection);
+                else if (c == "GRID" || c == "GRIDSQUARE") col[i] = History::historyColumn(Grid);
+                else if (c == "CQZONE") col[i] = History::historyColumn(Zone);
+                else if (c == "EXCH1") col[i] = History::historyColumn(General);
+            }
+            continue;
+        }
+        if (callCol < 0 || callCol >= l.size()) continue;
+        HistoryFields f;
+        for (int i = 0; i < l.size() && i < col.size(); i++) {
+            if (col.at(i) != -1) f.field[col.at(i)] = l.at(i).trimmed().toUpper();
+        }
+        addRecord(map, l.at(callCol).trimmed().toUpper(), seen, f);
+        n++;
+    }
+    return n;
+}
+
+/*!
+   read an existing history file. Its entries count as older than anything in the input files
+ */
+bool HistoryBuilder::readHistory(const QString &historyFile, HistoryBuildMap &map)
+{
+    if (!QFileInfo(historyFile).exists()) return true;
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "HISTORY_BUILD");
+        db.setDatabaseName(historyFile);
+        if (db.open()) {
+            // a file without a history table is treated as empty
+            ok = true;
+            QSqlQuery q(db);
+            q.setForwardOnly(true);
+            q.exec("SELECT Call,General,DMult,Name,State,ARRLSection,Grid,Number,Zone FROM history");
+            while (q.next()) {
+                HistoryBuildEntry e;
+                e.inFile = true;
+                e.count  = 0;
+                for (int j = 0; j < N_HISTORY_FIELDS; j++) {
+                    e.field[j] = q.value(j + 1).toString().toLatin1();
+                    e.seen[j]  = -1;
+                }
+                map.insert(q.value(0).toString().toLatin1(), e);
+            }
+            q.finish();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("HISTORY_BUILD");
+    return ok;
+}
+
+/*!
+   rewrite the history file in one transaction. The index is dropped while
+   inserting and created again afterwards
+ */
+bool HistoryBuilder::writeHistory(const QString &historyFile, const HistoryBuildMap &map)
+{
+    bool ok = false;
+    calls = 0;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "HISTORY_BUILD");
+        db.setDatabaseName(historyFile);
+        if (db.open()) {
+            QSqlQuery q(db);
+            q.exec("PRAGMA synchronous=OFF");
+            History::createTable(db);
+            db.transaction();
+            q.exec("DROP INDEX IF EXISTS `call_idx`");
+            q.exec("DELETE FROM history");
+            q.prepare("INSERT INTO history (Call,General,DMult,Name,State,ARRLSection,Grid,Number,Zone) "
+                      "VALUES (?,?,?,?,?,?,?,?,?)");
+            QVariantList col[N_HISTORY_FIELDS + 1];
+            ok = true;
+            HistoryBuildMap::const_iterator it = map.constBegin();
+            while (ok && it != map.constEnd()) {
+                const HistoryBuildEntry &e = it.value();
+                if (e.inFile || e.count >= minCount) {
+                    col[0].append(QString::fromLatin1(it.key()));
+                    for (int j = 0; j < N_HISTORY_FIELDS; j++) {
+                        col[j + 1].append(QString::fromLatin1(e.field[j]));
+                    }
+                    calls++;
+                }
+                ++it;
+                if (col[0].size() == LOG_IMPORT_BATCH_SIZE || (it == map.constEnd() && !col[0].isEmpty())) {
+                    for (int j = 0; j < N_HISTORY_FIELDS + 1; j++) {
+                        q.addBindValue(col[j]);
+                        col[j].clear();
+                    }
+                    if (!q.execBatch()) {
+                        emit(message("history write failed: " + q.lastError().text()));
+                        ok = false;
+                    }
+                }
+            }
+            History::createIndex(db);
+            if (ok) {
+                db.commit();
+            } else {
+                db.rollback();
+            }
+            q.finish();
+            db.close();
+        } else {
+            emit(message("can't open history file " + historyFile));
+        }
+    }
+    QSqlDatabase::removeDatabase("HISTORY_BUILD");
+    return ok;
+}
+
+/*!
+   read all input files and merge them into historyFile. Entries already
+   in historyFile are kept unless a newer value is found. finished() is
+   emitted when done, so this can be run in a worker thread
+ */
+bool HistoryBuilder::build(const QString &historyFile)
+{
+    QElapsedTimer timer;
+    timer.start();
+    records = 0;
+    calls   = 0;
+
+    // read the input files in parallel, each into its own map
+    QVector<HistoryBuildMap> maps(files.size());
+    QVector<int>             nrec(files.size());
+    QAtomicInt               done;
+    emit(progressMax(files.size()));
+    QThreadPool pool;
+    for (int i = 0; i < files.size(); i++) {
+        pool.start(new HistoryBuildTask(files.at(i), exchange, &maps[i], &nrec[i], &done));
+    }
+    while (!pool.waitForDone(100)) {
+        emit(progressCnt(done.load()));
+    }
+    emit(progressCnt(files.size()));
+
+    // merge in file order so later files win for qsos with equal times
+    HistoryBuildMap total;
+    if (!readHistory(historyFile, total)) {
+        emit(message("can't read history file " + historyFile));
+        emit(finished(false));
+        return false;
+    }
+    for (int i = 0; i < maps.size(); i++) {
+        records += nrec.at(i);
+        merge(total, maps.at(i));
+        maps[i].clear();
+    }
+    bool ok = writeHistory(historyFile, total);
+    emit(message(QString("history: %1 records from %2 files, %3 calls written in %4 ms").arg(records).arg(files.size())
+                 .arg(calls).arg(timer.elapsed())));
+    emit(finished(ok));
+    return ok;
+}
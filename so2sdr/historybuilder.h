@@ -0,0 +1,94 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef HISTORYBUILDER_H
+#define HISTORYBUILDER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include "defines.h"
+#include "history.h"
+
+/*!
+   history of one call while building: each field keeps the value seen last,
+   and count is the number of times the call was seen
+ */
+typedef struct HistoryBuildEntry {
+    bool       inFile;
+    int        count;
+    qint64     seen[N_HISTORY_FIELDS];
+    QByteArray field[N_HISTORY_FIELDS];
+} HistoryBuildEntry;
+
+typedef QHash<QByteArray, HistoryBuildEntry> HistoryBuildMap;
+
+/*!
+   Builds a history file from past logs.
+
+   Input files can be so2sdr .log files, Cabrillo, ADIF, or N1MM-style call
+   history text files; the type is found from the file contents. Each file
+   is read by its own task in a QThreadPool. The results are merged by call
+   with the most recently seen value of each field kept, and the history file
+   is rewritten in one transaction.
+ */
+class HistoryBuilder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HistoryBuilder(QObject *parent = 0);
+    void addFile(const QString &fileName);
+    int nCalls() const;
+    int nRecords() const;
+    void setExchange(const QList<FieldTypes> &types);
+    void setMinCount(int n);
+
+    static void addRecord(HistoryBuildMap &map, const QByteArray &call, qint64 seen, const HistoryFields &f);
+    static bool parseExchange(const QString &s, QList<FieldTypes> &types);
+    static int readFile(const QString &fileName, const QList<FieldTypes> &exchange, HistoryBuildMap &map);
+
+public slots:
+    bool build(const QString &historyFile);
+
+signals:
+    void finished(bool);
+    void message(const QString &);
+    void progressCnt(int);
+    void progressMax(int);
+
+private:
+    int               minCount;
+    int               calls;
+    int               records;
+    QList<FieldTypes> exchange;
+    QStringList       files;
+
+    static void merge(HistoryBuildMap &to, const HistoryBuildMap &from);
+    static int readAdif(const QString &fileName, HistoryBuildMap &map);
+    static int readCabrillo(const QString &fileName, const QList<FieldTypes> &exchange, HistoryBuildMap &map);
+    static int readCsv(const QString &fileName, HistoryBuildMap &map);
+    static int readLog(const QString &fileName, const QList<FieldTypes> &exchange, HistoryBuildMap &map);
+    bool readHistory(const QString &historyFile, HistoryBuildMap &map);
+    bool writeHistory(const QString &historyFile, const HistoryBuildMap &map);
+};
+
+#endif // HISTORYBUILDER_H
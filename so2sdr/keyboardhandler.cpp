@@ -17,104 +17,193 @@
 
  */
 #include "keyboardhandler.h"
+#include "utils.h"
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
-#include <dirent.h>
 #include <linux/input.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <sys/select.h>
-#include <sys/time.h>
-#include <termios.h>
-#include <signal.h>
-#include <poll.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <QVector>
 
 #include <QDebug>
-#
-KeyboardHandler::KeyboardHandler(QString deviceName,QObject *parent) : QObject(parent)
+
+// epoll data value for the wakeup eventfd; keyboards use their index
+const uint32_t KBD_WAKE=0xffffffff;
+
+// number of input events read at once
+const int KBD_READ_EVENTS=64;
+
+KeyboardHandler::KeyboardHandler(QObject *parent) : QObject(parent)
 {
-    device=deviceName;
-    quitFlag=false;
-    fd=0;
+    quitFlag=0;
+    wakeFd=eventfd(0,EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd==-1) {
+        qDebug("KeyboardHandler: can't create eventfd");
+    }
 }
 
-void KeyboardHandler::setDevice(QString d)
+KeyboardHandler::~KeyboardHandler()
 {
-    device=d;
+    if (wakeFd!=-1) close(wakeFd);
 }
 
-void KeyboardHandler::run()
+/*!
+   set the keyboard devices, one per radio. An empty name means no keyboard for that
+   radio. Must be called before the thread running run() is started
+ */
+void KeyboardHandler::setDevices(const QStringList &d)
 {
-    struct input_event ev;
-    int size = sizeof(struct input_event);
-    int rd,ret;
-    bool shift = false;
-    bool alt = false;
-    bool ctrl = false;
-    struct pollfd pfd[1];
-
-    quitFlag=false;
-    fd = open(device.toStdString().c_str(), O_RDONLY);
-    pfd[0].fd=fd;
-    pfd[0].events=POLLIN;
-
-    if (fd == -1) {
-        qDebug("KeyboardHandler: error opening %s",device.toStdString().data());
-        return;
-    } else {
-        //qDebug("KeyboardHandler: opening %s",device.toStdString().data());
+    devices=d;
+    quitFlag=0;
+    // clear any wakeup left from the last quitHandler()
+    uint64_t v;
+    if (wakeFd!=-1 && read(wakeFd,&v,sizeof(v))<0 && errno!=EAGAIN) {
+        qDebug("KeyboardHandler: error clearing eventfd");
     }
+}
 
-    if (fd >= 0) {
-        ioctl(fd, EVIOCGRAB, 1);
-        while (!quitFlag) {
-            // timeout is set to 5 ms. Does this need adjusting?
-            ret = poll(pfd, 1, 5);
-            if (ret>0) {
-                if (pfd[0].revents == POLLIN) {
-                    rd = read(fd, &ev, size);
-                    if (rd!=size) break;
-                    // value 1 catches single keypresses; value 2 catches autorepeat
-                    if (ev.type == EV_KEY && ((ev.value == 1) || ev.value==2)) {
-                        switch (ev.code) {
-                        case KEY_LEFTSHIFT:case KEY_RIGHTSHIFT:
-                            shift = true;
-                            break;
-                        case KEY_LEFTALT:case KEY_RIGHTALT:
-                            alt=true;
-                            break;
-                        case KEY_LEFTCTRL:case KEY_RIGHTCTRL:
-                            ctrl = true;
-                            break;
-                        default:
-                            emit readKey(ev.code,shift,ctrl,alt);
-                            break;
-                        }
-                    } else if (ev.type == EV_KEY && ev.value == 0) {
-                        switch (ev.code) {
-                        case KEY_LEFTSHIFT:case KEY_RIGHTSHIFT:
-                            shift = false;
-                            break;
-                        case KEY_LEFTALT:case KEY_RIGHTALT:
-                            alt=false;
-                            break;
-                        case KEY_LEFTCTRL:case KEY_RIGHTCTRL:
-                            ctrl = false;
-                            break;
-                        default:
-                            break;
-                        }
+/*!
+   read all pending events from keyboard nr. Returns false if the device has gone away
+ */
+bool KeyboardHandler::readDevice(int nr, KeyboardDevice &kbd)
+{
+    struct input_event ev[KBD_READ_EVENTS];
+    while (true) {
+        ssize_t rd=read(kbd.fd,ev,sizeof(ev));
+        if (rd<0) {
+            if (errno==EINTR) continue;
+            return (errno==EAGAIN);
+        }
+        if (rd==0) return false;
+        const int n=rd/sizeof(struct input_event);
+        for (int i=0;i<n;i++) {
+            if (ev[i].type!=EV_KEY) continue;
+            // value 1 catches single keypresses; value 2 catches autorepeat
+            if (ev[i].value==1 || ev[i].value==2) {
+                switch (ev[i].code) {
+                case KEY_LEFTSHIFT:case KEY_RIGHTSHIFT:
+                    kbd.shift = true;
+                    break;
+                case KEY_LEFTALT:case KEY_RIGHTALT:
+                    kbd.alt=true;
+                    break;
+                case KEY_LEFTCTRL:case KEY_RIGHTCTRL:
+                    kbd.ctrl = true;
+                    break;
+                default:
+                {
+                    qint64 t;
+                    if (kbd.monotonic) {
+                        // move the kernel time stamp to the monotonicUsec() time base
+                        struct timespec ts;
+                        clock_gettime(CLOCK_MONOTONIC,&ts);
+                        qint64 age=((qint64)ts.tv_sec-ev[i].time.tv_sec)*1000000LL+ts.tv_nsec/1000-ev[i].time.tv_usec;
+                        t=monotonicUsec()-age;
+                    } else {
+                        t=monotonicUsec();
                     }
+                    emit readKey(nr,ev[i].code,kbd.shift,kbd.ctrl,kbd.alt,t);
+                    break;
+                }
+                }
+            } else if (ev[i].value == 0) {
+                switch (ev[i].code) {
+                case KEY_LEFTSHIFT:case KEY_RIGHTSHIFT:
+                    kbd.shift = false;
+                    break;
+                case KEY_LEFTALT:case KEY_RIGHTALT:
+                    kbd.alt=false;
+                    break;
+                case KEY_LEFTCTRL:case KEY_RIGHTCTRL:
+                    kbd.ctrl = false;
+                    break;
+                default:
+                    break;
                 }
             }
         }
+        if (rd<(ssize_t)sizeof(ev)) return true;
+    }
+}
 
+/*!
+   open and grab the keyboards, then wait for key presses until quitHandler() is called
+ */
+void KeyboardHandler::run()
+{
+    if (quitFlag || wakeFd==-1) return;
+    int epfd=epoll_create1(EPOLL_CLOEXEC);
+    if (epfd==-1) {
+        qDebug("KeyboardHandler: can't create epoll instance");
+        return;
+    }
+    struct epoll_event e;
+    e.events=EPOLLIN;
+    e.data.u32=KBD_WAKE;
+    epoll_ctl(epfd,EPOLL_CTL_ADD,wakeFd,&e);
+
+    QVector<KeyboardDevice> kbd(devices.size());
+    for (int i=0;i<devices.size();i++) {
+        kbd[i].fd=-1;
+        kbd[i].monotonic=false;
+        kbd[i].shift=false;
+        kbd[i].ctrl=false;
+        kbd[i].alt=false;
+        if (devices.at(i).isEmpty()) continue;
+        kbd[i].fd=open(devices.at(i).toStdString().c_str(),O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (kbd[i].fd==-1) {
+            qDebug("KeyboardHandler: error opening %s",devices.at(i).toStdString().data());
+            continue;
+        }
+        // have the kernel time stamp events with CLOCK_MONOTONIC so the age of each event is known
+        int clk=CLOCK_MONOTONIC;
+        kbd[i].monotonic=(ioctl(kbd[i].fd,EVIOCSCLOCKID,&clk)==0);
+        ioctl(kbd[i].fd,EVIOCGRAB,1);
+        e.events=EPOLLIN;
+        e.data.u32=i;
+        epoll_ctl(epfd,EPOLL_CTL_ADD,kbd[i].fd,&e);
     }
+
+    QVector<struct epoll_event> events(kbd.size()+1);
+    while (!quitFlag) {
+        int n=epoll_wait(epfd,events.data(),events.size(),-1);
+        if (n<0) {
+            if (errno==EINTR) continue;
+            qDebug("KeyboardHandler: epoll_wait error %d",errno);
+            break;
+        }
+        for (int j=0;j<n;j++) {
+            const uint32_t i=events[j].data.u32;
+            if (i==KBD_WAKE) continue;
+            if (!readDevice(i,kbd[i]) || (events[j].events & (EPOLLERR | EPOLLHUP))) {
+                qDebug("KeyboardHandler: lost %s",devices.at(i).toStdString().data());
+                epoll_ctl(epfd,EPOLL_CTL_DEL,kbd[i].fd,nullptr);
+                close(kbd[i].fd);
+                kbd[i].fd=-1;
+            }
+        }
+    }
+
+    for (int i=0;i<kbd.size();i++) {
+        if (kbd[i].fd==-1) continue;
+        ioctl(kbd[i].fd,EVIOCGRAB,0);
+        close(kbd[i].fd);
+    }
+    close(epfd);
 }
 
+/*!
+   stop run(). May be called from any thread
+ */
 void KeyboardHandler::quitHandler()
 {
-    ioctl(fd, EVIOCGRAB, 0);
-    quitFlag=true;
+    quitFlag=1;
+    uint64_t one=1;
+    if (wakeFd!=-1 && write(wakeFd,&one,sizeof(one))!=sizeof(one)) {
+        qDebug("KeyboardHandler: error writing eventfd");
+    }
 }
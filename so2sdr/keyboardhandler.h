@@ -19,27 +19,52 @@
 #ifndef KEYBOARDHANDLER_H
 #define KEYBOARDHANDLER_H
 
+#include <QAtomicInt>
 #include <QObject>
 #include <QString>
+#include <QStringList>
 
+/*!
+   state of one keyboard read by KeyboardHandler
+ */
+typedef struct KeyboardDevice {
+    int  fd;
+    bool monotonic;
+    bool shift;
+    bool ctrl;
+    bool alt;
+} KeyboardDevice;
+
+/*!
+   reads one or more keyboards (one per radio in two keyboard mode) directly
+   from their evdev devices.
+
+   run() sleeps in epoll_wait until a keyboard has input or quitHandler()
+   signals the eventfd, so the thread does not wake while idle. Key presses are
+   emitted with the number of the keyboard and the time of the key press
+   (monotonicUsec() time base) for latency measurements
+ */
 class KeyboardHandler : public QObject
 {
     Q_OBJECT
 public:
-    explicit KeyboardHandler(QString deviceName, QObject *parent = nullptr);
+    explicit KeyboardHandler(QObject *parent = nullptr);
+    ~KeyboardHandler();
     void quitHandler();
-    void setDevice(QString);
+    void setDevices(const QStringList &d);
 
 signals:
-    void readKey(int code,bool shift,bool ctrl,bool alt);
+    void readKey(int nr, int code, bool shift, bool ctrl, bool alt, qint64 t);
 
 public slots:
     void run();
 
 private:
-    QString device;
-    bool quitFlag;
-    int fd;
+    QStringList devices;
+    QAtomicInt  quitFlag;
+    int         wakeFd;
+
+    bool readDevice(int nr, KeyboardDevice &kbd);
 };
 
 #endif // KEYBOARDHANDLER_H
@@ -0,0 +1,146 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QMutexLocker>
+#include <algorithm>
+#include "latency.h"
+
+LatencyStats::LatencyStats(int n)
+{
+    if (n<1) n=1;
+    nSamples=n;
+    samples.reserve(nSamples);
+    ptr=0;
+    total=0;
+    maxUsec=0;
+    sumUsec=0.0;
+}
+
+/*! add one sample, in microseconds
+ */
+void LatencyStats::add(qint64 usec)
+{
+    QMutexLocker locker(&mutex);
+    if (samples.size()<nSamples) {
+        samples.append(usec);
+    } else {
+        samples[ptr]=usec;
+    }
+    ptr=(ptr+1)%nSamples;
+    total++;
+    sumUsec+=usec;
+    if (usec>maxUsec) maxUsec=usec;
+}
+
+void LatencyStats::clear()
+{
+    QMutexLocker locker(&mutex);
+    samples.clear();
+    ptr=0;
+    total=0;
+    maxUsec=0;
+    sumUsec=0.0;
+}
+
+/*! total number of samples added since last clear
+ */
+int LatencyStats::count() const
+{
+    QMutexLocker locker(&mutex);
+    return total;
+}
+
+qint64 LatencyStats::max() const
+{
+    QMutexLocker locker(&mutex);
+    return maxUsec;
+}
+
+double LatencyStats::mean() const
+{
+    QMutexLocker locker(&mutex);
+    if (total==0) return 0.0;
+    return sumUsec/total;
+}
+
+/*! returns a sorted copy of the samples currently in the ring buffer
+ */
+QVector<qint64> LatencyStats::sorted() const
+{
+    QMutexLocker locker(&mutex);
+    QVector<qint64> s=samples;
+    locker.unlock();
+    std::sort(s.begin(),s.end());
+    return s;
+}
+
+/*! p-th percentile (0-100) of the most recent samples
+ */
+qint64 LatencyStats::percentile(double p) const
+{
+    QVector<qint64> s=sorted();
+    if (s.isEmpty()) return 0;
+    int i=qRound(p/100.0*(s.size()-1));
+    if (i<0) i=0;
+    if (i>=s.size()) i=s.size()-1;
+    return s.at(i);
+}
+
+/*! one-line summary in ms, suitable for debug output
+ */
+QString LatencyStats::summary(const QString &label) const
+{
+    QVector<qint64> s=sorted();
+    if (s.isEmpty()) return label+": no samples";
+    const int n=s.size()-1;
+    return label+QString(": n=%1 mean=%2 p50=%3 p90=%4 p99=%5 max=%6 ms").arg(count()).
+            arg(mean()/1000.0,0,'f',2).
+            arg(s.at(qRound(0.50*n))/1000.0,0,'f',2).
+            arg(s.at(qRound(0.90*n))/1000.0,0,'f',2).
+            arg(s.at(qRound(0.99*n))/1000.0,0,'f',2).
+            arg(max()/1000.0,0,'f',2);
+}
+
+/*! counts of the most recent samples in bins. Bin i holds samples below edges[i]
+ * (and at or above edges[i-1]); the last bin holds samples at or above the last edge
+ */
+QVector<int> LatencyStats::histogram(const QVector<qint64> &edges) const
+{
+    QVector<int> h(edges.size()+1,0);
+    QVector<qint64> s=sorted();
+    int j=0;
+    for (int i=0;i<s.size();i++) {
+        while (j<edges.size() && s.at(i)>=edges.at(j)) j++;
+        h[j]++;
+    }
+    return h;
+}
+
+/*! histogram in ms bins, suitable for debug output
+ */
+QString LatencyStats::histogramSummary(const QString &label) const
+{
+    const QVector<qint64> edges={1000,2000,5000,10000,20000,50000,100000,200000,500000};
+    QVector<int> h=histogram(edges);
+    QString s=label+":";
+    for (int i=0;i<edges.size();i++) {
+        s=s+" <"+QString::number(edges.at(i)/1000)+"ms:"+QString::number(h.at(i));
+    }
+    s=s+" >="+QString::number(edges.last()/1000)+"ms:"+QString::number(h.last());
+    return s;
+}
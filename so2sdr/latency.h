@@ -0,0 +1,62 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+// default number of samples kept for latency statistics
+const int LATENCY_SAMPLES_DEF=1024;
+
+/*!
+   Running latency statistics (times in microseconds)
+
+   Keeps the most recent samples in a ring buffer for percentiles; count, mean and
+   max cover all samples added since the last clear(). Thread-safe: samples are
+   usually added from a worker thread and read from the GUI thread.
+ */
+class LatencyStats
+{
+public:
+    explicit LatencyStats(int n=LATENCY_SAMPLES_DEF);
+    void add(qint64 usec);
+    void clear();
+    int count() const;
+    qint64 max() const;
+    double mean() const;
+    QVector<int> histogram(const QVector<qint64> &edges) const;
+    QString histogramSummary(const QString &label) const;
+    qint64 percentile(double p) const;
+    QString summary(const QString &label) const;
+
+private:
+    mutable QMutex  mutex;
+    int             nSamples;
+    int             ptr;
+    int             total;
+    qint64          maxUsec;
+    double          sumUsec;
+    QVector<qint64> samples;
+
+    QVector<qint64> sorted() const;
+};
+
+#endif // LATENCY_H
@@ -47,6 +47,8 @@ Log::Log(QSettings &cs,QSettings &s, uiSize sizes,QObject *parent = 0) : QObject
     lat=0.0;
     lon=0.0;
     logdel=0;
+    importer=0;
+    importWriter=0;
     origEditRecord.clear();
     db=QSqlDatabase::addDatabase("QSQLITE");
     for (int i=0;i<N_BANDS;i++) qsoCnt[i]=0;
@@ -56,10 +58,17 @@ Log::Log(QSettings &cs,QSettings &s, uiSize sizes,QObject *parent = 0) : QObject
     connect(detail,SIGNAL(editedRecord(QSqlRecord)),this,SLOT(updateRecord(QSqlRecord)));
     detail->hide();
     cty = new Cty(csettings);
+    connect(cty,SIGNAL(ctyError(const QString &)),this,SIGNAL(errorMessage(QString)));
 }
 
 Log :: ~Log()
 {
+    if (importThread.isRunning()) {
+        importThread.quit();
+        importThread.wait();
+    }
+    if (importWriter) delete importWriter;
+    if (importer) delete importer;
     closeLogFile();
     if (model) {
         QSqlDatabase::removeDatabase("QSQLITE");
@@ -93,6 +102,8 @@ FieldTypes Log::exchType(int i) const { return contest->exchType(i);}
 int Log::nMultsBWorked(int ii, int band) const { return contest->nMultsBWorked(ii,band);}
 int Log::nMultsColumn(int col,int ii) const { return contest->nMultsColumn(col,ii);}
 int Log::score() const { return contest->Score();}
+ScoreSummary Log::scoreSummary() const { return contest->summary();}
+const ContestConfig &Log::contestConfig() const { return contest->config();}
 int Log::nMults(int ii) const { return contest->nMults(ii);}
 ContestType Log::contestType() const { return contest->contestType();}
 QByteArray Log::neededMultName(int ii, int band, int i, bool &needed_band, bool &needed) const
@@ -106,6 +117,7 @@ QByteArray Log::neededMultNameMode(int ii, int band, ModeTypes mode,int i, bool
 void Log::workedMults(Qso * qso, unsigned int worked[MMAX]) const { contest->workedMults(qso,worked);}
 void Log::guessMult(Qso *qso) const {  contest->guessMult(qso);}
 bool Log::dupeCheckingByBand() const { return contest->dupeCheckingByBand();}
+void Log::updateConfig() { contest->updateConfig();}
 bool Log::validateExchange(Qso *qso) { return contest->validateExchange(qso);}
 unsigned int Log::sntFieldShown() const { return contest->sntFieldShown();}
 unsigned int Log::rcvFieldShown() const { return contest->rcvFieldShown();}
@@ -122,304 +134,311 @@ void Log::closeLogFile()
 }
 
 /*!
-   ADIF file export
+   append buffered export data to file once it reaches LOG_EXPORT_BUFFER_SIZE, or always
+   if force is true. The buffer keeps its capacity and is reused for the next records
+ */
+static bool flushExport(QIODevice *f, QByteArray &buff, bool force)
+{
+    if (!force && buff.size() < LOG_EXPORT_BUFFER_SIZE) return true;
+    bool ok = (f->write(buff) == buff.size());
+    buff.resize(0);
+    return ok;
+}
 
+/*!
+   append one ADIF field <name:size>val
  */
-bool Log::exportADIF(QFile *adifFile) const
+static void adifField(QByteArray &buff, const char *name, const char *val, int n)
 {
-    QSqlQueryModel m;
+    buff.append('<');
+    buff.append(name);
+    buff.append(':');
+    buff.append(QByteArray::number(n));
+    buff.append('>');
+    buff.append(val, n);
+}
 
-    m.setQuery("SELECT * FROM log where valid=1", db);
-    while (m.canFetchMore()) {
-        m.fetchMore();
+// name of the read-only connection used by exportADIF and exportCabrillo
+static const QString LOG_EXPORT_CONNECTION = "LOG_EXPORT";
+
+/*!
+   open a second, read-only connection to the log file fileName as LOG_EXPORT_CONNECTION
+   and start a transaction on it, so everything read through it comes from one snapshot
+   of the file. Changes committed through other connections while it is open are not
+   seen. Close it and remove the connection once its queries are gone
+ */
+static bool openExportDb(const QString &fileName, QSqlDatabase &edb)
+{
+    edb = QSqlDatabase::addDatabase("QSQLITE", LOG_EXPORT_CONNECTION);
+    edb.setDatabaseName(fileName);
+    edb.setConnectOptions("QSQLITE_OPEN_READONLY");
+    if (!edb.open()) return false;
+    return edb.transaction();
+}
+
+/*!
+   ADIF file export
+
+   Qsos are read through a separate read-only connection, see openExportDb. The
+   file is not closed; caller commits it.
+ */
+bool Log::exportADIF(QIODevice *adifFile)
+{
+    bool ok = false;
+    {
+        QSqlDatabase edb;
+        if (openExportDb(db.databaseName(), edb)) {
+            ok = writeADIF(edb, adifFile);
+            edb.commit();
+        }
+        edb.close();
     }
-    if (m.rowCount() == 0) {
-        adifFile->close();
-        return(false);  // nothing to do
+    QSqlDatabase::removeDatabase(LOG_EXPORT_CONNECTION);
+    return ok;
+}
+
+/*!
+   stream qsos from edb as ADIF with a forward-only query. Records are built in one
+   reusable buffer which is written out in LOG_EXPORT_BUFFER_SIZE blocks
+ */
+bool Log::writeADIF(QSqlDatabase &edb, QIODevice *adifFile) const
+{
+    QSqlQuery q(edb);
+    q.setForwardOnly(true);
+    if (!q.exec("SELECT * FROM log where valid=1")) {
+        return(false);
     }
+    const int rst = contest->rstField();
+    const int rstSnt = SQL_COL_SNT1 + rst;
+    const int rstRcv = SQL_COL_RCV1 + rst;
 
+    QByteArray buff;
+    buff.reserve(LOG_EXPORT_BUFFER_SIZE + 1024);
     bool ok = true;
-    for (int i = 0; i < m.rowCount(); i++) {
-        // do not include invalid qsos
-        if (!m.record(i).value(SQL_COL_VALID).toBool()) continue;
-
-        QByteArray tmp;
-        QByteArray tmp2 = m.record(i).value(SQL_COL_CALL).toByteArray();
-
+    int  n  = 0;
+    while (q.next()) {
         // call
-        tmp = "<CALL:" + QByteArray::number(tmp2.size()) + ">" + tmp2;
+        QByteArray tmp = q.value(SQL_COL_CALL).toByteArray();
+        adifField(buff, "CALL", tmp.constData(), tmp.size());
 
         // band
-        switch (m.record(i).value(SQL_COL_BAND).toInt()) {
-        case BAND160: tmp = tmp + "<BAND:4>160M"; break;
-        case BAND80: tmp = tmp + "<BAND:3>80M"; break;
-        case BAND60: tmp = tmp + "<BAND:3>60M"; break;
-        case BAND40: tmp = tmp + "<BAND:3>40M"; break;
-        case BAND30: tmp = tmp + "<BAND:3>30M"; break;
-        case BAND20: tmp = tmp + "<BAND:3>20M"; break;
-        case BAND17: tmp = tmp + "<BAND:3>17M"; break;
-        case BAND15: tmp = tmp + "<BAND:3>15M"; break;
-        case BAND12: tmp = tmp + "<BAND:3>12M"; break;
-        case BAND10: tmp = tmp + "<BAND:3>10M"; break;
-        case BAND6: tmp = tmp + "<BAND:2>6M"; break;
-        case BAND2: tmp = tmp + "<BAND:3>2M"; break;
-        case BAND222: tmp = tmp + "<BAND:5>1.25M"; break;
-        case BAND420: tmp = tmp + "<BAND:4>70CM"; break;
-        case BAND902: tmp = tmp + "<BAND:4>33CM"; break;
-        case BAND1240: tmp = tmp + "<BAND:4>23CM"; break;
-        case BAND630: tmp = tmp + "<BAND:3>630M"; break;
-        case BAND2200: tmp = tmp + "<BAND:5>2200M"; break;
+        switch (q.value(SQL_COL_BAND).toInt()) {
+        case BAND160: buff.append("<BAND:4>160M"); break;
+        case BAND80: buff.append("<BAND:3>80M"); break;
+        case BAND60: buff.append("<BAND:3>60M"); break;
+        case BAND40: buff.append("<BAND:3>40M"); break;
+        case BAND30: buff.append("<BAND:3>30M"); break;
+        case BAND20: buff.append("<BAND:3>20M"); break;
+        case BAND17: buff.append("<BAND:3>17M"); break;
+        case BAND15: buff.append("<BAND:3>15M"); break;
+        case BAND12: buff.append("<BAND:3>12M"); break;
+        case BAND10: buff.append("<BAND:3>10M"); break;
+        case BAND6: buff.append("<BAND:2>6M"); break;
+        case BAND2: buff.append("<BAND:3>2M"); break;
+        case BAND222: buff.append("<BAND:5>1.25M"); break;
+        case BAND420: buff.append("<BAND:4>70CM"); break;
+        case BAND902: buff.append("<BAND:4>33CM"); break;
+        case BAND1240: buff.append("<BAND:4>23CM"); break;
+        case BAND630: buff.append("<BAND:3>630M"); break;
+        case BAND2200: buff.append("<BAND:5>2200M"); break;
         }
 
         // frequency
-        double f = m.record(i).value(SQL_COL_FREQ).toDouble() / 1000000.0;
-        tmp2 = QString::number(f, 'f', 4).toLatin1();
-        tmp  = tmp + "<FREQ:" + QString::number(tmp2.size()).toLatin1() + ">" + tmp2;
+        tmp = QByteArray::number(q.value(SQL_COL_FREQ).toDouble() / 1000000.0, 'f', 4);
+        adifField(buff, "FREQ", tmp.constData(), tmp.size());
 
         // date
         // in SQL log, date is of format MMddyyyy; need yyyyMMdd for adif
-        tmp2 = m.record(i).value(SQL_COL_DATE).toByteArray().right(4) +
-               m.record(i).value(SQL_COL_DATE).toByteArray().left(2)
-               + m.record(i).value(SQL_COL_DATE).toByteArray().mid(2, 2);
-        tmp = tmp + "<QSO_DATE:8>" + tmp2;
+        tmp = q.value(SQL_COL_DATE).toByteArray();
+        buff.append("<QSO_DATE:8>");
+        buff.append(tmp.right(4));
+        buff.append(tmp.left(4));
 
         // time
-        tmp = tmp + "<TIME_ON:4>" + m.record(i).value(SQL_COL_TIME).toByteArray();
+        buff.append("<TIME_ON:4>");
+        buff.append(q.value(SQL_COL_TIME).toByteArray());
 
         int rsti = 0;
-        switch (m.record(i).value(SQL_COL_MODE).toInt()) {
+        switch (q.value(SQL_COL_MODE).toInt()) {
         case RIG_MODE_LSB: case RIG_MODE_USB:
-            tmp  = tmp + "<MODE:3>SSB";
+            buff.append("<MODE:3>SSB");
             rsti = 1;
             break;
         case RIG_MODE_CW: case RIG_MODE_CWR:
-            tmp = tmp + "<MODE:2>CW";
+            buff.append("<MODE:2>CW");
             break;
         case RIG_MODE_FM:
-            tmp  = tmp + "<MODE:2>FM";
+            buff.append("<MODE:2>FM");
             rsti = 1;
             break;
         case RIG_MODE_AM:
-            tmp  = tmp + "<MODE:2>AM";
+            buff.append("<MODE:2>AM");
             rsti = 1;
             break;
         case RIG_MODE_RTTY: case RIG_MODE_RTTYR:
-            tmp = tmp + "<MODE:4>RTTY";
+            buff.append("<MODE:4>RTTY");
             break;
         default:
-            tmp = tmp + "<MODE:2>CW";
+            buff.append("<MODE:2>CW");
             break;
         }
         // RS(T). If not in log, use 59/599
         if (rsti == 0) {
             // RST for CW, RTTY
-            if (contest->rstField() == -1) {
-                tmp = tmp + "<RST_SENT:3>599<RST_RCVD:3>599";
+            if (rst == -1) {
+                buff.append("<RST_SENT:3>599<RST_RCVD:3>599");
             } else {
-                QByteArray tmp3;
-                switch (contest->rstField()) {
-                case 0:
-                    tmp2 = m.record(i).value(SQL_COL_SNT1).toByteArray();
-                    tmp3 = m.record(i).value(SQL_COL_RCV1).toByteArray(); break;
-                case 1:
-                    tmp2 = m.record(i).value(SQL_COL_SNT2).toByteArray();
-                    tmp3 = m.record(i).value(SQL_COL_RCV2).toByteArray(); break;
-                case 2:
-                    tmp2 = m.record(i).value(SQL_COL_SNT3).toByteArray();
-                    tmp3 = m.record(i).value(SQL_COL_RCV3).toByteArray(); break;
-                case 3:
-                    tmp2 = m.record(i).value(SQL_COL_SNT4).toByteArray();
-                    tmp3 = m.record(i).value(SQL_COL_RCV4).toByteArray(); break;
-                }
-                tmp = tmp + "<RST_SENT:3>" + tmp2.left(3) + "<RST_RCVD:3>" + tmp3.left(3);
+                buff.append("<RST_SENT:3>");
+                buff.append(q.value(rstSnt).toByteArray().left(3));
+                buff.append("<RST_RCVD:3>");
+                buff.append(q.value(rstRcv).toByteArray().left(3));
             }
         } else {
             // RS for voice modes
-            if (contest->rstField() == -1) {
-                tmp = tmp + "<RST_SENT:2>59<RST_RCVD:2>59";
+            if (rst == -1) {
+                buff.append("<RST_SENT:2>59<RST_RCVD:2>59");
             } else {
-                QByteArray tmp3;
-                switch (contest->rstField()) {
-                case 0:
-                    tmp2 = m.record(i).value(SQL_COL_SNT1).toByteArray();
-                    tmp3 = m.record(i).value(SQL_COL_RCV1).toByteArray(); break;
-                case 1:
-                    tmp2 = m.record(i).value(SQL_COL_SNT2).toByteArray();
-                    tmp3 = m.record(i).value(SQL_COL_RCV2).toByteArray(); break;
-                case 2:
-                    tmp2 = m.record(i).value(SQL_COL_SNT3).toByteArray();
-                    tmp3 = m.record(i).value(SQL_COL_RCV3).toByteArray(); break;
-                case 3:
-                    tmp2 = m.record(i).value(SQL_COL_SNT4).toByteArray();
-                    tmp3 = m.record(i).value(SQL_COL_RCV4).toByteArray(); break;
-                }
-                tmp = tmp + "<RST_SENT:2>" + tmp2.left(2) + "<RST_RCVD:2>" + tmp3.left(2);
+                buff.append("<RST_SENT:2>");
+                buff.append(q.value(rstSnt).toByteArray().left(2));
+                buff.append("<RST_RCVD:2>");
+                buff.append(q.value(rstRcv).toByteArray().left(2));
             }
         }
-
-        tmp = tmp + "<eor>\n";
-        if (adifFile->write(tmp) == -1) {
-            ok = false;
-        }
+        buff.append("<eor>\n");
+        n++;
+        if (!flushExport(adifFile, buff, false)) ok = false;
     }
-    adifFile->close();
+    if (!flushExport(adifFile, buff, true)) ok = false;
+    if (n == 0) return(false);  // nothing to do
     return(ok);
 }
 
 /*!
    Cabrillo export
 
+   Qsos are read through a separate read-only connection, see openExportDb.
+   An empty log writes nothing. For sent exchange, empty log fields are replaced
+   with the config file values snt_exch. The file is not closed; caller commits it.
  */
-void Log::exportCabrillo(QFile *cbrFile,QString call,QString snt_exch1,QString snt_exch2,QString snt_exch3,QString snt_exch4) const
+bool Log::exportCabrillo(QIODevice *cbrFile,QString call,QString snt_exch1,QString snt_exch2,QString snt_exch3,QString snt_exch4)
 {
-    QSqlQueryModel m;
-    m.setQuery("SELECT * FROM log  where valid=1", db);
-
-    while (m.canFetchMore()) {
-        m.fetchMore();
+    QByteArray snt_exch[MAX_EXCH_FIELDS];
+    snt_exch[0] = snt_exch1.toLatin1();
+    snt_exch[1] = snt_exch2.toLatin1();
+    snt_exch[2] = snt_exch3.toLatin1();
+    snt_exch[3] = snt_exch4.toLatin1();
+
+    bool ok = false;
+    {
+        QSqlDatabase edb;
+        if (openExportDb(db.databaseName(), edb)) {
+            ok = writeCabrillo(edb, cbrFile, call.toLatin1(), snt_exch);
+            edb.commit();
+        }
+        edb.close();
     }
-    if (m.rowCount() == 0) return;  // nothing to do
+    QSqlDatabase::removeDatabase(LOG_EXPORT_CONNECTION);
+    return ok;
+}
 
+/*!
+   stream qsos from edb as Cabrillo QSO: lines. Field widths are found with a single
+   aggregate query, then qsos are streamed with a forward-only query into a reusable
+   buffer
+ */
+bool Log::writeCabrillo(QSqlDatabase &edb, QIODevice *cbrFile, const QByteArray &call,
+                        const QByteArray snt_exch[MAX_EXCH_FIELDS]) const
+{
     // determine max field widths for sent/received data
     int sfw[MAX_EXCH_FIELDS], rfw[MAX_EXCH_FIELDS];
     for (int i = 0; i < MAX_EXCH_FIELDS; i++) {
-        sfw[i] = 0.;
+        sfw[i] = 0;
         rfw[i] = 0;
     }
-    QByteArray snt[MAX_EXCH_FIELDS];
-    for (int i = 0; i < m.rowCount(); i++) {
-        // for sent exchange, if log field is empty use config file value
-        snt[0]=m.record(i).value(SQL_COL_SNT1).toByteArray();
-        if (snt[0].isEmpty()) snt[0]=snt_exch1.toLatin1();
-        int j = snt[0].size();
-        if (j > sfw[0]) sfw[0] = j;
-
-        snt[1]=m.record(i).value(SQL_COL_SNT2).toByteArray();
-        if (snt[1].isEmpty()) snt[1]=snt_exch2.toLatin1();
-        j = snt[1].size();
-        if (j > sfw[1]) sfw[1] = j;
-
-        snt[2]=m.record(i).value(SQL_COL_SNT3).toByteArray();
-        if (snt[2].isEmpty()) snt[2]=snt_exch3.toLatin1();
-        j = snt[2].size();
-        if (j > sfw[2]) sfw[2] = j;
-
-        snt[3]=m.record(i).value(SQL_COL_SNT4).toByteArray();
-        if (snt[3].isEmpty()) snt[3]=snt_exch4.toLatin1();
-        j = snt[3].size();
-        if (j > sfw[3]) sfw[3] = j;
-
-        j = m.record(i).value(SQL_COL_RCV1).toByteArray().size();
-        if (j > rfw[0]) rfw[0] = j;
-        j = m.record(i).value(SQL_COL_RCV2).toByteArray().size();
-        if (j > rfw[1]) rfw[1] = j;
-        j = m.record(i).value(SQL_COL_RCV3).toByteArray().size();
-        if (j > rfw[2]) rfw[2] = j;
-        j = m.record(i).value(SQL_COL_RCV4).toByteArray().size();
+    int nrows = -1;
+    QSqlQuery w(edb);
+    w.prepare("SELECT max(length(ifnull(nullif(snt1,''),?))),max(length(ifnull(nullif(snt2,''),?))),"
+              "max(length(ifnull(nullif(snt3,''),?))),max(length(ifnull(nullif(snt4,''),?))),"
+              "max(length(rcv1)),max(length(rcv2)),max(length(rcv3)),max(length(rcv4)),count(*) FROM log where valid=1");
+    for (int i = 0; i < MAX_EXCH_FIELDS; i++) {
+        w.addBindValue(QString::fromLatin1(snt_exch[i]));
+    }
+    if (w.exec() && w.next()) {
+        for (int i = 0; i < MAX_EXCH_FIELDS; i++) {
+            sfw[i] = w.value(i).toInt();
+            rfw[i] = w.value(MAX_EXCH_FIELDS + i).toInt();
+        }
+        nrows = w.value(2 * MAX_EXCH_FIELDS).toInt();
+    }
+    w.finish();
+    if (nrows == 0) {
+        return(true);  // nothing to do
     }
 
-    for (int i = 0; i < m.rowCount(); i++) {
-        // skip qsos marked as invalid
-        if (!m.record(i).value(SQL_COL_VALID).toBool()) continue;
-
-        // for sent exchange, if log field is empty use config file value
-        snt[0]=m.record(i).value(SQL_COL_SNT1).toByteArray();
-        if (snt[0].isEmpty()) snt[0]=snt_exch1.toLatin1();
-
-        snt[1]=m.record(i).value(SQL_COL_SNT2).toByteArray();
-        if (snt[1].isEmpty()) snt[1]=snt_exch2.toLatin1();
-
-        snt[2]=m.record(i).value(SQL_COL_SNT3).toByteArray();
-        if (snt[2].isEmpty()) snt[2]=snt_exch3.toLatin1();
-
-        snt[3]=m.record(i).value(SQL_COL_SNT4).toByteArray();
-        if (snt[3].isEmpty()) snt[3]=snt_exch4.toLatin1();
-
-        QString tmp;
-        tmp = "QSO: ";
+    QSqlQuery q(edb);
+    q.setForwardOnly(true);
+    if (!q.exec("SELECT * FROM log where valid=1")) {
+        return(false);
+    }
+    const QByteArray mycall = call.leftJustified(11, ' ');
+    const int nexch = qMin(contest->nExchange(), MAX_EXCH_FIELDS);
+    QByteArray buff;
+    buff.reserve(LOG_EXPORT_BUFFER_SIZE + 1024);
+    bool ok = true;
+    while (q.next()) {
+        buff.append("QSO: ");
         // for VHF+ only band is given in freq column
-        int khz = qRound(m.record(i).value(SQL_COL_FREQ).toDouble() / 1000.0);
-        QString tmp2;
-        if (khz>30000) {
-            tmp2 = QString::number(khz/1000);
-        } else {
-            tmp2 = QString::number(khz);
-        }
-        for (int j = 0; j < (5 - tmp2.size()); j++) {
-            tmp = tmp + " ";
-        }
-        tmp = tmp + tmp2;
-        switch (m.record(i).value(SQL_COL_MODE).toInt()) {
+        int khz = qRound(q.value(SQL_COL_FREQ).toDouble() / 1000.0);
+        if (khz>30000) khz = khz/1000;
+        buff.append(QByteArray::number(khz).rightJustified(5, ' '));
+        switch (q.value(SQL_COL_MODE).toInt()) {
         case RIG_MODE_CW:
         case RIG_MODE_CWR:
-            tmp = tmp + " CW ";
+            buff.append(" CW ");
             break;
         case RIG_MODE_USB:
         case RIG_MODE_LSB:
         case RIG_MODE_AM:
         case RIG_MODE_FM:
-            tmp = tmp + " PH ";
+            buff.append(" PH ");
             break;
         case RIG_MODE_RTTY:
         case RIG_MODE_RTTYR:
-            tmp = tmp + " RY ";
+            buff.append(" RY ");
             break;
         default:
-            tmp = tmp + " CW ";
+            buff.append(" CW ");
             break;
         }
 
         // in SQL log, date is of format MMddyyyy
-        tmp2 = m.record(i).value(SQL_COL_DATE).toByteArray();
-        tmp  = tmp + tmp2.right(4) + "-" + tmp2.left(2) + "-" + tmp2.mid(2, 2);
-        tmp  = tmp + " " + m.record(i).value(SQL_COL_TIME).toByteArray();
-        tmp  = tmp + " " + call;
-        int n = 11 - call.size();
-        for (int j = 0; j < n; j++) tmp.append(" ");
-        for (int j = 0; j < contest->nExchange(); j++) {
-            QByteArray s;
-            s.clear();
-            switch (j) {
-            case 0:
-                s=snt[0];
-                s = s.leftJustified(sfw[0], ' ');
-                break;
-            case 1:
-                s=snt[1];
-                s = s.leftJustified(sfw[1], ' ');
-                break;
-            case 2:
-                s=snt[2];
-                s = s.leftJustified(sfw[2], ' ');
-                break;
-            case 3:
-                s=snt[3];
-                s = s.leftJustified(sfw[3], ' ');
-                break;
-            }
-            tmp = tmp + s + " ";
+        QByteArray tmp = q.value(SQL_COL_DATE).toByteArray();
+        buff.append(tmp.right(4));
+        buff.append('-');
+        buff.append(tmp.left(2));
+        buff.append('-');
+        buff.append(tmp.mid(2, 2));
+        buff.append(' ');
+        buff.append(q.value(SQL_COL_TIME).toByteArray());
+        buff.append(' ');
+        buff.append(mycall);
+        for (int j = 0; j < nexch; j++) {
+            tmp = q.value(SQL_COL_SNT1 + j).toByteArray();
+            if (tmp.isEmpty()) tmp = snt_exch[j];
+            buff.append(tmp.leftJustified(sfw[j], ' '));
+            buff.append(' ');
         }
-        tmp = tmp + m.record(i).value(SQL_COL_CALL).toByteArray();
-        n   = 11 - m.record(i).value(SQL_COL_CALL).toByteArray().size();
-        for (int j = 0; j < n; j++) tmp.append(" ");
-        for (int j = 0; j < contest->nExchange(); j++) {
-            switch (j) {
-            case 0:
-                tmp = tmp + m.record(i).value(SQL_COL_RCV1).toByteArray().leftJustified(rfw[0], ' '); break;
-            case 1:
-                tmp = tmp + m.record(i).value(SQL_COL_RCV2).toByteArray().leftJustified(rfw[1], ' '); break;
-            case 2:
-                tmp = tmp + m.record(i).value(SQL_COL_RCV3).toByteArray().leftJustified(rfw[2], ' '); break;
-            case 3:
-                tmp = tmp + m.record(i).value(SQL_COL_RCV4).toByteArray().leftJustified(rfw[3], ' '); break;
-            }
-            tmp = tmp + " ";
+        buff.append(q.value(SQL_COL_CALL).toByteArray().leftJustified(11, ' '));
+        for (int j = 0; j < nexch; j++) {
+            buff.append(q.value(SQL_COL_RCV1 + j).toByteArray().leftJustified(rfw[j], ' '));
+            buff.append(' ');
         }
-        tmp = tmp + "\n";
-        cbrFile->write(tmp.toLatin1());
+        buff.append('\n');
+        if (!flushExport(cbrFile, buff, false)) ok = false;
     }
-    cbrFile->write("END-OF-LOG:\n");
-    cbrFile->close();
+    buff.append("END-OF-LOG:\n");
+    if (!flushExport(cbrFile, buff, true)) ok = false;
+    return(ok);
 }
 
 /*!
@@ -443,7 +462,7 @@ bool Log::isDupe(Qso *qso, bool DupeCheckingEveryBand, bool FillWorked) const
 
     // call can only be worked once on any band
     if (!DupeCheckingEveryBand) {
-        if (!settings.value(c_multimode,c_multimode_def).toBool()) {
+        if (!contest->config().multiMode) {
             m.setQuery("SELECT * FROM log WHERE valid=1 and CALL LIKE '" + qso->call + "'", db);
         } else {
             // multimode: if voice mode, check for dupe with LSB, USB, or FM
@@ -759,193 +778,260 @@ void Log::addQso(Qso *qso)
     if (!qso->dupe && qso->valid) qsoCnt[qso->band]++;
 }
 
-/*! import a Cabrillo log
-   note: the number of exchange fields must be correct for this contest, otherwise
-    bad things happen.
-*/
-void Log::importCabrillo(QString cabFile)
+/*!
+   import a Cabrillo or ADIF (.adi, .adif) log
+   note: the number of exchange fields must be correct for this contest
+
+   The file is parsed by a LogImporter, then scored and written to the log by a
+   LogImportWriter, both in importThread. importStored is called when done.
+ */
+void Log::importLog(QString fileName)
 {
     int n=0;
     for (int i=0;i<N_BANDS;i++) n+=qsoCnt[i];
     if (n) {
         emit(errorMessage("ERROR: log must be empty to import cabrillo"));
+        emit(importFinished(0, 0));
         return;
     }
+    if (importer) return; // import already running
 
-    // open the file
-    QFile file(cabFile);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+    importTimer.start();
 
-    // count number of lines in file to get estimate of time needed to read
-    int maxLines = 0;
-    while (!file.atEnd()) {
-        QString buffer;
-        buffer = file.readLine();
-        maxLines++;
+    // contest set up like the current one, to be scored in the import thread
+    Contest *c = newContest(contest->contestName());
+    setupContest(c);
+    c->setMyZone(contest->myZone());
+    int mobileCol = 0;
+    if (csettings.value(c_mobile_dupes,c_mobile_dupes_def).toBool()) {
+        mobileCol = csettings.value(c_mobile_dupes_col,c_mobile_dupes_col_def).toInt();
     }
-    emit(progressMax(maxLines));
-    file.close();
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
 
-    QDataStream s(&file);
-    int         cnt = 0;
+    importer = new LogImporter(fileName, contest->nExchange());
+    importWriter = new LogImportWriter(importer, c, cty, db.databaseName(), mobileCol);
+    importer->moveToThread(&importThread);
+    importWriter->moveToThread(&importThread);
+    connect(&importThread, SIGNAL(started()), importer, SLOT(run()));
+    connect(importer, SIGNAL(progressMax(int)), this, SIGNAL(progressMax(int)));
+    connect(importer, SIGNAL(progressCnt(int)), this, SIGNAL(progressCnt(int)));
+    connect(importer, SIGNAL(finished(bool)), importWriter, SLOT(store(bool)));
+    connect(importWriter, SIGNAL(progressMax(int)), this, SIGNAL(progressMax(int)));
+    connect(importWriter, SIGNAL(progressCnt(int)), this, SIGNAL(progressCnt(int)));
+    connect(importWriter, SIGNAL(finished(bool)), this, SLOT(importStored(bool)));
+    importThread.start();
+}
+
+/*!
+   called when the import thread has scored and stored the imported qsos. On success the
+   contest scored in the import thread replaces the current one, so no rescore is needed.
+   On failure nothing was changed.
+ */
+void Log::importStored(bool ok)
+{
+    importThread.quit();
+    importThread.wait();
+    int nqso = 0;
+    if (ok) {
+        Contest *old = contest;
+        contest = importWriter->takeContest();
+        logdel->setContest(contest);
+        connect(contest,SIGNAL(mobileDupeCheck(Qso*)),this,SLOT(mobileDupeCheck(Qso*)));
+        connect(contest,SIGNAL(clearDupe()),this,SIGNAL(clearDupe()));
+        delete old;
+        for (int i = 0; i < N_BANDS; i++) qsoCnt[i] = importWriter->nQso(i);
+        nqso = importWriter->nImported();
+    } else {
+        emit(errorMessage("ERROR: log import failed: " + importWriter->error()));
+    }
+    delete importWriter;
+    importWriter = 0;
+    delete importer;
+    importer = 0;
+
+    model->select();
+    while (model->canFetchMore()) {
+        model->fetchMore();
+    }
+    logdel->invalidateCache();
+    emit(progressCnt(nqso));
+    emit(importFinished(nqso, importTimer.elapsed()));
+}
+
+LogImportWriter::LogImportWriter(LogImporter *imp, Contest *c, const Cty *ct, const QString &fileName,
+                                 int mobileCol, QObject *parent) : QObject(parent)
+{
+    importer = imp;
+    contest = c;
+    cty = ct;
+    logFile = fileName;
+    mobileDupeCol = mobileCol;
+    nqso = 0;
     for (int i = 0; i < N_BANDS; i++) qsoCnt[i] = 0;
-    Qso qso (contest->nExchange());
-    contest->zeroScore();
-    model->database().transaction();
-
-    QString buffer;
-    QStringList field;
-    QSqlRecord  newqso;
-    newqso.append(QSqlField("nr", QVariant::Int));
-    newqso.append(QSqlField("time", QVariant::String));
-    newqso.append(QSqlField("freq", QVariant::Double));
-    newqso.append(QSqlField("call", QVariant::String));
-    newqso.append(QSqlField("band", QVariant::Int));
-    newqso.append(QSqlField("date", QVariant::String));
-    newqso.append(QSqlField("mode", QVariant::Int));
-    newqso.append(QSqlField("snt1", QVariant::String));
-    newqso.append(QSqlField("snt2", QVariant::String));
-    newqso.append(QSqlField("snt3", QVariant::String));
-    newqso.append(QSqlField("snt4", QVariant::String));
-    newqso.append(QSqlField("rcv1", QVariant::String));
-    newqso.append(QSqlField("rcv2", QVariant::String));
-    newqso.append(QSqlField("rcv3", QVariant::String));
-    newqso.append(QSqlField("rcv4", QVariant::String));
-    newqso.append(QSqlField("pts", QVariant::Int));
-    newqso.append(QSqlField("valid", QVariant::Int));
-    for (int i = 0; i < SQL_N_COL; i++) newqso.setGenerated(i, true);
-
-    while (!file.atEnd()) {
-        buffer = file.readLine();
-        buffer = buffer.trimmed();
-        if (!buffer.contains("QSO:") && !buffer.contains("qso:")) {
-            continue;  // ignore header data
-        }
-        field = buffer.split(" ", QString::SkipEmptyParts);
-        int         nf    = field.size();
-
-        // Field1 = frequency in KHz
-        double f = field.at(1).toDouble() * 1000;
-        newqso.setValue(SQL_COL_FREQ, QVariant(f));
-
-        int b = getBand(f);
-        newqso.setValue(SQL_COL_BAND, QVariant(b));
-        qso.band = b;
-
-        // Field2 = mode
-        int m;
-        if (field.at(2).toUpper() == "CW") {
-            m = RIG_MODE_CW;
-        } else if (field.at(2).toUpper() == "RY") {
-            m = RIG_MODE_RTTY;
-        } else if (field.at(2).toUpper() == "PH") {
-            // Cabrillo doesn't store LSB/USB?
-            if (f < 14000000) {
-                m = RIG_MODE_LSB;
-            } else {
-                m = RIG_MODE_USB;
-            }
-        } else if (field.at(2).toUpper() == "FM") {
-            m = RIG_MODE_FM;
+
+    // mobile dupes are checked against the qsos scored so far rather than the log file
+    connect(contest, SIGNAL(mobileDupeCheck(Qso*)), this, SLOT(mobileDupeCheck(Qso*)), Qt::DirectConnection);
+}
+
+LogImportWriter::~LogImportWriter()
+{
+    delete contest;
+}
+
+QString LogImportWriter::error() const
+{
+    return errorText;
+}
+
+int LogImportWriter::nImported() const
+{
+    return nqso;
+}
+
+int LogImportWriter::nQso(int band) const
+{
+    return qsoCnt[band];
+}
+
+/*!
+   returns the scored contest; the caller now owns it
+ */
+Contest *LogImportWriter::takeContest()
+{
+    disconnect(contest, SIGNAL(mobileDupeCheck(Qso*)), this, SLOT(mobileDupeCheck(Qso*)));
+    Contest *c = contest;
+    contest = 0;
+    return c;
+}
+
+/*!
+   qsos with the same key count as dupes for mobiles; as in Log::isDupe this is the
+   call and band, and the exchange field chosen for mobile dupes if that option is on.
+   Returns an empty key if that field is not filled in yet
+ */
+QByteArray LogImportWriter::mobileKey(const Qso *qso) const
+{
+    QByteArray key = qso->call + ' ' + QByteArray::number(qso->band);
+    if (mobileDupeCol) {
+        if (mobileDupeCol < 1 || mobileDupeCol > qso->n_exchange) return QByteArray();
+        const QByteArray &exch = qso->rcv_exch[mobileDupeCol - 1];
+        if (exch.isEmpty()) return QByteArray();
+        key = key + ' ' + exch;
+    }
+    return key;
+}
+
+/*!
+   mobile dupe check for the import contest, called directly from its validator
+ */
+void LogImportWriter::mobileDupeCheck(Qso *qso)
+{
+    QByteArray key = mobileKey(qso);
+    qso->dupe = !key.isEmpty() && mobileCalls.contains(key);
+}
+
+/*!
+   score and store the qsos read by the importer. ok is false if the file could not be read
+ */
+void LogImportWriter::store(bool ok)
+{
+    if (!ok) {
+        errorText = "can't read import file";
+        emit(finished(false));
+        return;
+    }
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "LOG_IMPORT");
+        db.setDatabaseName(logFile);
+        if (db.open()) {
+            ok = write(db);
+            db.close();
         } else {
-            m = RIG_MODE_CW;
-        }
-        qso.mode = (rmode_t) m;
-        qso.modeType=getModeType(qso.mode);
-        newqso.setValue(SQL_COL_MODE, QVariant(m));
-        cnt++;
-        newqso.setValue(SQL_COL_NR, QVariant(cnt));
-
-        // Field3 = date
-        QDateTime time;
-        time.setTimeSpec(Qt::UTC);
-        int       y = field.at(3).mid(0, 4).toInt();
-        m = field[3].mid(5, 2).toInt();
-        int       d = field.at(3).mid(8, 2).toInt();
-        time.setDate(QDate(y, m, d));
-        newqso.setValue(SQL_COL_DATE, QVariant(time.toString("MMddyyyy").toLatin1()));
-
-        // Field4=time
-        newqso.setValue(SQL_COL_TIME, QVariant(field.at(4)));
-
-        // Field5=station call. ignore this
-
-        // Field6+
-        // next fields are sent exchange
-        int i, j;
-        for (i = 6, j = 0; i < (6 + contest->nExchange()); i++, j++) {
-            switch (j) {
-            case 0:
-                newqso.setValue(SQL_COL_SNT1, QVariant(field.at(i).toUpper()));
-                qso.snt_exch[0]=field.at(i).toLatin1().toUpper();
-                break;
-            case 1:
-                newqso.setValue(SQL_COL_SNT2, QVariant(field.at(i).toUpper()));
-                qso.snt_exch[1]=field.at(i).toLatin1().toUpper();
-                break;
-            case 2:
-                newqso.setValue(SQL_COL_SNT3, QVariant(field.at(i).toUpper()));
-                qso.snt_exch[2]=field.at(i).toLatin1().toUpper();
-                break;
-            case 3:
-                newqso.setValue(SQL_COL_SNT4, QVariant(field.at(i).toUpper()));
-                qso.snt_exch[3]=field.at(i).toLatin1().toUpper();
-                break;
-            }
+            errorText = db.lastError().text();
+            ok = false;
         }
+    }
+    QSqlDatabase::removeDatabase("LOG_IMPORT");
+    emit(finished(ok));
+}
 
-        // next field=call worked
-        newqso.setValue(SQL_COL_CALL, QVariant(field.at(6 + contest->nExchange()).toUpper()));
-        qso.call = field.at(6 + contest->nExchange()).toLatin1().toUpper();
-        bool bb;
-        qso.country = idPfx(&qso, bb);
+/*!
+   dupe check and score the imported qsos in log order, writing them to db with batched
+   prepared inserts in one transaction. Nothing is written if any insert fails
+ */
+bool LogImportWriter::write(QSqlDatabase &db)
+{
+    const QList<ImportQso> &qsos = importer->qsos();
+    const int nexch = qMin(contest->nExchange(), MAX_EXCH_FIELDS);
+    emit(progressMax(qsos.size()));
+
+    Qso qso(contest->nExchange());
+    QSet<QByteArray> dupes[N_BANDS];
+    contest->zeroScore();
+    for (int i = 0; i < N_BANDS; i++) qsoCnt[i] = 0;
 
-        // next received report
+    QVariantList col[SQL_N_COL];
+    QSqlQuery    q(db);
+    db.transaction();
+    bool ok = q.prepare("INSERT INTO log (nr,time,freq,call,band,date,mode,snt1,snt2,snt3,snt4,rcv1,rcv2,rcv3,rcv4,pts,valid) "
+                        "VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)");
+    if (!ok) errorText = q.lastError().text();
+    for (int i = 0; i < qsos.size() && ok; i++) {
+        const ImportQso &iq = qsos.at(i);
+        bool b;
+        qso.call    = iq.call;
+        qso.country = cty->idPfx(&qso, b);
+        qso.nr      = i + 1;
+        qso.mode    = (rmode_t) iq.mode;
+        qso.modeType = getModeType(qso.mode);
+        qso.band    = iq.band;
+        qso.freq    = iq.freq;
+        qso.pts     = 0;
+        qso.time    = QDateTime(QDate::fromString(iq.date, "MMddyyyy"), QTime::fromString(iq.time, "hhmm"), Qt::UTC);
         qso.exch.clear();
-        for (i = 7 + contest->nExchange(), j = 0; i < (7 + 2 * contest->nExchange()); i++, j++) {
-            // some fields may be empty (flaw in Cabrillo spec?)
-            if (i >= nf) {
-                continue;
+        for (int j = 0; j < nexch; j++) {
+            qso.exch = qso.exch + iq.rcv[j] + " ";
+            qso.snt_exch[j] = iq.snt[j];
+        }
+        qso.valid = true;
+        contest->scoreQso(qso, dupes, qsoCnt);
+        QByteArray key = mobileKey(&qso);
+        if (!key.isEmpty()) mobileCalls.insert(key);
+
+        col[SQL_COL_NR].append(qso.nr);
+        col[SQL_COL_TIME].append(QString::fromLatin1(iq.time));
+        col[SQL_COL_FREQ].append(iq.freq);
+        col[SQL_COL_CALL].append(QString::fromLatin1(iq.call));
+        col[SQL_COL_BAND].append(iq.band);
+        col[SQL_COL_DATE].append(QString::fromLatin1(iq.date));
+        col[SQL_COL_MODE].append(iq.mode);
+        for (int j = 0; j < MAX_EXCH_FIELDS; j++) {
+            col[SQL_COL_SNT1 + j].append(QString::fromLatin1(iq.snt[j]));
+            col[SQL_COL_RCV1 + j].append(QString::fromLatin1(iq.rcv[j]));
+        }
+        col[SQL_COL_PTS].append(qso.pts);
+        col[SQL_COL_VALID].append(true);
+
+        if (col[0].size() == LOG_IMPORT_BATCH_SIZE || i == qsos.size() - 1) {
+            for (int j = 0; j < SQL_N_COL; j++) {
+                q.addBindValue(col[j]);
+                col[j].clear();
             }
-            switch (j) {
-                case 0:
-                newqso.setValue(SQL_COL_RCV1, QVariant(field.at(i).toUpper()));
-                qso.exch = qso.exch + field.at(i).toLatin1().toUpper();
-                qso.rcv_exch[0]=field.at(i).toLatin1().toUpper();
-                break;
-            case 1:
-                newqso.setValue(SQL_COL_RCV2, QVariant(field.at(i).toUpper()));
-                qso.exch = qso.exch + " " + field.at(i).toLatin1().toUpper();
-                qso.rcv_exch[1]=field.at(i).toLatin1().toUpper();
-                break;
-            case 2:
-                newqso.setValue(SQL_COL_RCV3, QVariant(field.at(i).toUpper()));
-                qso.exch = qso.exch + " " + field.at(i).toLatin1().toUpper();
-                qso.rcv_exch[2]=field.at(i).toLatin1().toUpper();
-                break;
-            case 3:
-                newqso.setValue(SQL_COL_RCV4, QVariant(field.at(i).toUpper()));
-                qso.exch = qso.exch + " " + field.at(i).toLatin1().toUpper();
-                qso.rcv_exch[3]=field.at(i).toLatin1().toUpper();
-                break;
+            if (!q.execBatch()) {
+                ok = false;
+                errorText = q.lastError().text();
             }
         }
-        newqso.setValue(SQL_COL_PTS, QVariant(qso.pts));
-        newqso.setValue(SQL_COL_VALID, QVariant(true)); // set to valid
-        contest->addQso(&qso);
-        model->insertRecord(-1, newqso);
-        emit(progressCnt(cnt));
-        qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
+        if ((i % LOG_IMPORT_PROGRESS_STEP) == 0) emit(progressCnt(i));
     }
-    model->submitAll();
-    model->database().commit();
-    rescore();
-
-    while (model->canFetchMore()) {
-        model->fetchMore();
+    q.finish();
+    if (ok) {
+        ok = db.commit();
+        if (!ok) errorText = db.lastError().text();
+    } else {
+        db.rollback();
     }
-    emit(progressCnt(maxLines));
+    if (ok) nqso = qsos.size();
+    return ok;
 }
 
 int Log::rowCount() const
@@ -1003,7 +1089,7 @@ void Log::rescore()
         m.fetchMore();
     }
     bool b;
-    QList<QByteArray> dupes[N_BANDS];
+    QSet<QByteArray> dupes[N_BANDS];
     contest->zeroScore();
     for (int i = 0; i < N_BANDS; i++) {
         qsoCnt[i] = 0;
@@ -1028,62 +1114,13 @@ void Log::rescore()
         tmpqso.modeType = getModeType(tmpqso.mode);
         tmpqso.band = m.record(i).value("band").toInt();
         tmpqso.pts  = m.record(i).value("pts").toInt();
+        tmpqso.time = QDateTime(QDate::fromString(m.record(i).value("date").toString(),"MMddyyyy"),
+                                QTime::fromString(m.record(i).value("time").toString(),"hhmm"),Qt::UTC);
 
-        // valid can be changed to ways:
-        // 1) when user unchecks checkbox
-        // 2) if program can't parse the exchange
-        //
-        // first check for user changing check status
-        bool userValid=m.record(i).value("valid").toBool();
-        tmpqso.valid=userValid;
-
-        // dupe check
-        // qsos marked invalid are excluded from log and dupe check
-        tmpqso.dupe = false;
-        if (tmpqso.valid) {
-            if (csettings.value(c_dupemode,c_dupemode_def).toInt()!=NO_DUPE_CHECKING) {
-                // can work station on other bands, just check this one
-                QByteArray check=tmpqso.call;
-                // multi-mode contest: append a mode index to the call
-                if (csettings.value(c_multimode,c_multimode_def).toBool()) {
-                    check=check+QByteArray::number((int)tmpqso.modeType);
-                }
-                if (contest->dupeCheckingByBand()) {
-                    if (dupes[tmpqso.band].contains(check)) {
-                        tmpqso.dupe = true;
-                    }
-                } else {
-                    // qsos count only once on any band
-                    for (int j = 0; j < N_BANDS; j++) {
-                        if (dupes[j].contains(check)) {
-                            tmpqso.dupe = true;
-                        }
-                    }
-                }
-                dupes[tmpqso.band].append(check);
-            }
-        } else {
-            tmpqso.pts=0;
-            tmpqso.mult[0]=-1;
-            tmpqso.mult[1]=-1;
-            tmpqso.newmult[0]=-1;
-            tmpqso.newmult[1]=-1;
-        }
-        // next check exchange
-        // in the case of mobiles, this might change dupe status!
-        bool exchValid=contest->validateExchange(&tmpqso);
-        tmpqso.valid=userValid & exchValid;
-
-        if (!tmpqso.dupe && tmpqso.valid) qsoCnt[tmpqso.band]++;
-        if (!tmpqso.valid || tmpqso.dupe) {
-            tmpqso.pts=0;
-            tmpqso.mult[0]=-1;
-            tmpqso.mult[1]=-1;
-            tmpqso.newmult[0]=-1;
-            tmpqso.newmult[1]=-1;
-        }
-        contest->addQso(&tmpqso);
+        tmpqso.valid = m.record(i).value("valid").toBool();
+        contest->scoreQso(tmpqso, dupes, qsoCnt);
     }
+    if (logdel) logdel->invalidateCache();
     while (model->canFetchMore()) {
         model->fetchMore();
     }
@@ -1103,26 +1140,27 @@ void Log::updateRecord(QSqlRecord r)
 
 void Log::updateHistory()
 {
-    QSqlQueryModel log;
-    QString query_log = "SELECT call,rcv1,rcv2,rcv3,rcv4 from log where valid=1";
+    QSqlQuery log(db);
+    log.exec("SELECT count(*) from log where valid=1");
+    const int n = log.next() ? log.value(0).toInt() : 0;
+    emit(progressMax(n));
 
-    log.setQuery(query_log, db);
-    while (log.canFetchMore()) log.fetchMore();
-    emit(progressMax(log.rowCount()));
+    log.setForwardOnly(true);
+    log.exec("SELECT call,rcv1,rcv2,rcv3,rcv4 from log where valid=1");
     Qso tmpqso(contest->nExchange());
     for (int i = 0; i < contest->nExchange(); i++) {
         tmpqso.setExchangeType(i, contest->exchType(i));
     }
-    for (int row = 0; row < log.rowCount(); row++) {
-        tmpqso.call=log.record(row).value("Call").toString().toLatin1();
+    int row = 0;
+    while (log.next()) {
+        tmpqso.call=log.value(0).toString().toLatin1();
         for (int i = 0; i < contest->nExchange(); i++) {
-            tmpqso.rcv_exch[i]=log.record(row).value(i+1).toString().toLatin1();
+            tmpqso.rcv_exch[i]=log.value(i+1).toString().toLatin1();
         }
         emit(addQsoHistory(&tmpqso));
-        emit(progressCnt(row));
-        qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
+        if ((++row % LOG_IMPORT_PROGRESS_STEP) == 0) emit(progressCnt(row));
     }
-    emit(progressCnt(log.rowCount()));
+    emit(progressCnt(n));
 }
 
 void Log::searchPartial(Qso *qso, QByteArray part, QList<QByteArray>& calls, QList<unsigned int>& worked,
@@ -1250,12 +1288,12 @@ void Log::startDetailedEdit()
 int Log::idPfx(Qso *qso, bool &qsy) const
  {
      int pp=cty->idPfx(qso,qsy);
-     if (csettings.value(c_contestname,c_contestname_def).toString().toUpper()=="WPX") {
-         ((WPX*) contest)->wpxPrefix(qso->call, qso->mult_name);
+     if (contest->contestType()==Wpx_t) {
+         static_cast<WPX*>(contest)->wpxPrefix(qso->call, qso->mult_name);
          qso->isamult[0]=true;
          contest->multIndx(qso);
      }
-      if (csettings.value(c_contestname,c_contestname_def).toString().toUpper()=="ARRLJUNE") {
+      if (contest->contestType()==JuneVHF_t) {
           qso->isamult[0]=true;
           contest->multIndx(qso);
       }
@@ -1279,167 +1317,205 @@ int Log::idPfx(Qso *qso, bool &qsy) const
  void Log::selectContest()
  {
      QByteArray name=csettings.value(c_contestname,c_contestname_def).toString().toUpper().toLatin1();
+     contest=newContest(name);
+     if (contest) {
+         logdel=new logDelegate(this,contest,&logSearchFlag,&searchList);
+         connect(logdel,SIGNAL(setOrigRecord(QModelIndex)),this,SLOT(setOrigRecord(QModelIndex)));
+         connect(logdel,SIGNAL(startLogEdit()),this,SIGNAL(startLogEdit()));
+         connect(logdel,SIGNAL(editLogRow(QModelIndex)),this,SLOT(startQsoEditRow(QModelIndex)));
+         connect(logdel,SIGNAL(editLogRowDetail(QModelIndex)),this,SLOT(startDetailedQsoEditRow(QModelIndex)));
+         connect(logdel,SIGNAL(closeEditor(QWidget*,QAbstractItemDelegate::EndEditHint)),this,SIGNAL(update()));
+         connect(this,SIGNAL(dataChanged(QModelIndex,QModelIndex)),logdel,SLOT(invalidateRows(QModelIndex,QModelIndex)));
+         connect(contest,SIGNAL(mobileDupeCheck(Qso*)),this,SLOT(mobileDupeCheck(Qso*)));
+         connect(contest,SIGNAL(clearDupe()),this,SIGNAL(clearDupe()));
+         cty->initialize(lat,lon,contest->zoneType());
+         setupContest(contest);
+     }
+ }
+
+ /*!
+    create the contest object for contest name, with its qso types. Returns 0 if the
+    name is not known. The contest still has to be set up with setupContest
+  */
+ Contest* Log::newContest(const QByteArray &name) const
+ {
+     Contest *c=0;
      QString snt_exch[MAX_EXCH_FIELDS];
      for (int i=0;i<MAX_EXCH_FIELDS;i++) {
          snt_exch[i].clear();
      }
      if (name == "ARRLDX") {
          // from US/VE
-         contest = new ARRLDX(true,csettings,settings);
+         c = new ARRLDX(true,csettings,settings);
          snt_exch[0] = "RST";
          snt_exch[1]=settings.value(s_state,s_state_def).toString();
      }
      if (name == "ARRLDX-DX") {
          // from DX
-         contest = new ARRLDX(false,csettings,settings);
+         c = new ARRLDX(false,csettings,settings);
          snt_exch[0] = "RST";
      }
      if (name == "ARRL10") {
-         contest = new ARRL10(csettings,settings);
+         c = new ARRL10(csettings,settings);
          snt_exch[0] = "RST";
          snt_exch[1]=settings.value(s_state,s_state_def).toString();
      }
      if (name == "ARRL160") {
-         contest = new ARRL160(true,csettings,settings);
+         c = new ARRL160(true,csettings,settings);
          snt_exch[0] = "RST";
          snt_exch[1]=settings.value(s_section,s_section_def).toString();
      }
      if (name == "ARRL160-DX") {
-         contest = new ARRL160(false,csettings,settings);
+         c = new ARRL160(false,csettings,settings);
          snt_exch[0] = "RST";
      }
      if (name == "ARRLJUNE") {
-         contest = new JuneVHF(csettings,settings);
+         c = new JuneVHF(csettings,settings);
          snt_exch[0] = settings.value(s_grid,s_grid_def).toString();
      }
      if (name == "CQP-CA") {
-         contest = new CQP(csettings,settings);
-         static_cast<CQP*>(contest)->setWithinState(true);
+         c = new CQP(csettings,settings);
+         static_cast<CQP*>(c)->setWithinState(true);
          snt_exch[0]="#";
      }
      if (name == "CQP") {
-         contest = new CQP(csettings,settings);
-         static_cast<CQP*>(contest)->setWithinState(false);
+         c = new CQP(csettings,settings);
+         static_cast<CQP*>(c)->setWithinState(false);
          snt_exch[0]="#";
          snt_exch[1]=settings.value(s_state,s_state_def).toString();
      }
      if (name == "CQ160") {
-         contest = new CQ160(csettings,settings);
+         c = new CQ160(csettings,settings);
          snt_exch[0] = "RST";
          snt_exch[1]=settings.value(s_state,s_state_def).toString();
      }
      if (name == "CQWW") {
-         contest = new CQWW(csettings,settings);
+         c = new CQWW(csettings,settings);
          snt_exch[0] = "RST";
          snt_exch[1]=settings.value(s_cqzone,s_cqzone_def).toString();
      }
      if (name == "CWOPS") {
-         contest = new Cwops(csettings,settings);
+         c = new Cwops(csettings,settings);
          snt_exch[0]=settings.value(s_name,s_name_def).toString();
      }
      if (name == "DXPED") {
-         contest = new Dxped(csettings,settings);
+         c = new Dxped(csettings,settings);
          snt_exch[0] = "RST";
      }
      if (name == "FD") {
-         contest = new FD(csettings,settings);
+         c = new FD(csettings,settings);
          snt_exch[1]=settings.value(s_section,s_section_def).toString();
      }
      if (name == "IARU") {
-         contest = new IARU(csettings,settings);
+         c = new IARU(csettings,settings);
          snt_exch[0] = "RST";
          snt_exch[1]=settings.value(s_ituzone,s_ituzone_def).toString();
      }
      if (name == "KQP-KS") {
-         contest = new KQP(csettings,settings);
-         static_cast<KQP*>(contest)->setWithinState(true);
+         c = new KQP(csettings,settings);
+         static_cast<KQP*>(c)->setWithinState(true);
          snt_exch[0]="RST";
      }
      if (name == "KQP") {
-         contest = new KQP(csettings,settings);
-         static_cast<KQP*>(contest)->setWithinState(false);
+         c = new KQP(csettings,settings);
+         static_cast<KQP*>(c)->setWithinState(false);
          snt_exch[0]="RST";
          snt_exch[1]=settings.value(s_state,s_state_def).toString();
      }
      if (name == "MSQP-MS") {
-         contest = new MSQP(csettings,settings);
-         static_cast<MSQP*>(contest)->setWithinState(true);
+         c = new MSQP(csettings,settings);
+         static_cast<MSQP*>(c)->setWithinState(true);
          snt_exch[0]="RST";
      }
      if (name == "MSQP") {
-         contest = new MSQP(csettings,settings);
-         static_cast<MSQP*>(contest)->setWithinState(false);
+         c = new MSQP(csettings,settings);
+         static_cast<MSQP*>(c)->setWithinState(false);
          snt_exch[0]="RST";
          snt_exch[1]=settings.value(s_state,s_state_def).toString();
      }
      if (name == "NAQP") {
-         contest = new Naqp(csettings,settings);
+         c = new Naqp(csettings,settings);
          snt_exch[0]=settings.value(s_name,s_name_def).toString();
          snt_exch[1]=settings.value(s_state,s_state_def).toString();
      }
      if (name == "SPRINT") {
-         contest = new Sprint(csettings,settings);
+         c = new Sprint(csettings,settings);
          snt_exch[0]="#";
          snt_exch[1]=settings.value(s_name,s_name_def).toString();
          snt_exch[2]=settings.value(s_state,s_state_def).toString();
      }
      if (name == "STEW") {
-         contest = new Stew(csettings,settings);
+         c = new Stew(csettings,settings);
          snt_exch[0]=settings.value(s_grid,s_grid_def).toString();
      }
      if (name == "SWEEPSTAKES") {
-         contest = new Sweepstakes(csettings,settings);
+         c = new Sweepstakes(csettings,settings);
          snt_exch[0]="#";
          snt_exch[3]=settings.value(s_section,s_section_def).toString();
      }
      if (name == "WPX") {
-         contest = new WPX(csettings,settings);
+         c = new WPX(csettings,settings);
          snt_exch[0] = "RST";
          snt_exch[1] = "#";
      }
      if (name == "PAQP-PA") {
-         contest = new PAQP(csettings,settings);
-         static_cast<PAQP*>(contest)->setWithinState(true);
+         c = new PAQP(csettings,settings);
+         static_cast<PAQP*>(c)->setWithinState(true);
          snt_exch[0]="#";
      }
      if (name == "PAQP") {
-         contest = new PAQP(csettings,settings);
-         static_cast<PAQP*>(contest)->setWithinState(false);
+         c = new PAQP(csettings,settings);
+         static_cast<PAQP*>(c)->setWithinState(false);
          snt_exch[0]="#";
          snt_exch[1]=settings.value(s_state,s_state_def).toString();
      }
-     if (contest) {
+     if (name == "RULES") {
+         c = new ContestRules(csettings,settings);
+         for (int i=0;i<c->nExchange();i++) {
+             switch (c->exchType(i)) {
+             case RST: snt_exch[i]="RST"; break;
+             case QsoNumber: snt_exch[i]="#"; break;
+             case Name: snt_exch[i]=settings.value(s_name,s_name_def).toString(); break;
+             case State: snt_exch[i]=settings.value(s_state,s_state_def).toString(); break;
+             case ARRLSection: snt_exch[i]=settings.value(s_section,s_section_def).toString(); break;
+             case Grid: snt_exch[i]=settings.value(s_grid,s_grid_def).toString(); break;
+             case Zone: snt_exch[i]=settings.value(s_cqzone,s_cqzone_def).toString(); break;
+             default: break;
+             }
+         }
+     }
+     if (c) {
          int sz=csettings.beginReadArray(c_qso_type1);
          for (int i=0;i<sz;i++) {
              csettings.setArrayIndex(i);
              QByteArray tmp=csettings.value("pfx","").toByteArray();
-             contest->addQsoType(tmp,0);
+             c->addQsoType(tmp,0);
          }
          csettings.endArray();
          sz=csettings.beginReadArray(c_qso_type2);
          for (int i=0;i<sz;i++) {
              csettings.setArrayIndex(i);
              QByteArray tmp=csettings.value("pfx","").toByteArray();
-             contest->addQsoType(tmp,1);
+             c->addQsoType(tmp,1);
          }
          csettings.endArray();
-         contest->setContestName(name);
-         logdel=new logDelegate(this,*contest,&logSearchFlag,&searchList);
-         connect(logdel,SIGNAL(setOrigRecord(QModelIndex)),this,SLOT(setOrigRecord(QModelIndex)));
-         connect(logdel,SIGNAL(startLogEdit()),this,SIGNAL(startLogEdit()));
-         connect(logdel,SIGNAL(editLogRow(QModelIndex)),this,SLOT(startQsoEditRow(QModelIndex)));
-         connect(logdel,SIGNAL(editLogRowDetail(QModelIndex)),this,SLOT(startDetailedQsoEditRow(QModelIndex)));
-         connect(logdel,SIGNAL(closeEditor(QWidget*,QAbstractItemDelegate::EndEditHint)),this,SIGNAL(update()));
-         connect(contest,SIGNAL(mobileDupeCheck(Qso*)),this,SLOT(mobileDupeCheck(Qso*)));
-         connect(contest,SIGNAL(clearDupe()),this,SIGNAL(clearDupe()));
-         cty->initialize(lat,lon,contest->zoneType());
-         contest->initialize(cty);
-         Qso  tmp(2);
-         tmp.call = settings.value(s_call,s_call_def).toString().toLatin1();
-         bool b;
-         contest->setCountry(idPfx(&tmp, b));
-         contest->setContinent(tmp.continent);
+         c->setContestName(name);
      }
+     return c;
+ }
+
+ /*!
+    set up mults of contest c from the country tables, and its country and continent
+    from the station call
+  */
+ void Log::setupContest(Contest *c) const
+ {
+     c->initialize(cty);
+     Qso  tmp(2);
+     tmp.call = settings.value(s_call,s_call_def).toString().toLatin1();
+     bool b;
+     c->setCountry(idPfx(&tmp, b));
+     c->setContinent(tmp.continent);
  }
 
  /*!
@@ -1464,6 +1540,39 @@ int Log::idPfx(Qso *qso, bool &qsy) const
  {
      contest->setMyZone(zone);
  }
+/*!
+ * \brief Log::newCty a Cty set up like the current one but not yet built. It can be built
+ * in another thread with Cty::build, then installed with setCty
+ */
+Cty* Log::newCty() const
+{
+    Cty *c = new Cty(csettings);
+    c->prepare(lat, lon, contest->zoneType());
+    return c;
+}
+
+/*!
+ * \brief Log::setCty replace the country tables with c, which must have been built.
+ *
+ * All prefix lookups are done in the GUI thread, so swapping the pointer here can never
+ * be seen by a lookup in progress. The contest mult tables hold country indices, so the
+ * swap is only done if c has the same country list and no log import is running; otherwise
+ * c is deleted and false is returned, and the new tables are used the next time the contest
+ * is opened.
+ */
+bool Log::setCty(Cty *c)
+{
+    // the import thread is using the current tables
+    if (importWriter || !cty->sameCountries(c)) {
+        delete c;
+        return false;
+    }
+    Cty *old = cty;
+    cty = c;
+    connect(cty,SIGNAL(ctyError(const QString &)),this,SIGNAL(errorMessage(QString)));
+    delete old;
+    return true;
+}
 
  void Log::setCountry(int c)
  {
@@ -19,12 +19,16 @@
 #ifndef LOG_H
 #define LOG_H
 #include <QFile>
+#include <QIODevice>
 #include <QList>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QEvent>
 #include <QObject>
+#include <QSet>
 #include <QSettings>
 #include <QSqlDatabase>
+#include <QThread>
 #include "contest.h"
 #include "contest_arrldx.h"
 #include "contest_arrl10.h"
@@ -45,14 +49,62 @@
 #include "contest_sweepstakes.h"
 #include "contest_wpx.h"
 #include "contest_paqp.h"
+#include "contest_rules.h"
 #include "cty.h"
 #include "defines.h"
 #include "logedit.h"
+#include "logimporter.h"
 #include "qso.h"
 #include "serial.h"
 #include "detailededit.h"
 #include "logdelegate.h"
 
+/*!
+   Second phase of log import, run in the import thread once LogImporter has read the file.
+
+   The qsos are dupe checked and scored in log order with a contest object of their own,
+   so the contest used by the GUI is not touched, and written to the log file through a
+   separate connection with batched prepared inserts inside one transaction. If this
+   succeeds Log takes over the scored contest; otherwise it is deleted with the writer
+   and the log is left as it was.
+ */
+class LogImportWriter : public QObject
+{
+Q_OBJECT
+
+public:
+    LogImportWriter(LogImporter *imp, Contest *c, const Cty *ct, const QString &fileName,
+                    int mobileCol, QObject *parent = nullptr);
+    ~LogImportWriter();
+    QString error() const;
+    int nImported() const;
+    int nQso(int band) const;
+    Contest *takeContest();
+
+signals:
+    void finished(bool);
+    void progressCnt(int);
+    void progressMax(int);
+
+public slots:
+    void mobileDupeCheck(Qso *qso);
+    void store(bool ok);
+
+private:
+    Contest          *contest;
+    const Cty        *cty;
+    int              mobileDupeCol;
+    int              nqso;
+    int              qsoCnt[N_BANDS];
+    LogImporter      *importer;
+    QSet<QByteArray> mobileCalls;
+    QString          errorText;
+    QString          logFile;
+
+    QByteArray mobileKey(const Qso *qso) const;
+    bool write(QSqlDatabase &db);
+};
+
 /*!
    class defining log database structure and related functions
  */
@@ -70,6 +122,7 @@ public:
     void closeLogFile();
     int columnCount(int col) const;
     QVariant columnName(int c) const;
+    const ContestConfig &contestConfig() const;
     ContestType contestType() const;
     Cty* ctyPtr() const;
     QWidget* currentEditor() const;
@@ -80,15 +133,15 @@ public:
     void editLogDetail(QModelIndex index);
     QString exchangeName(int) const;
     FieldTypes exchType(int i) const;
-    bool exportADIF(QFile *) const;
-    void exportCabrillo(QFile *,QString call,QString,QString,QString,QString) const;
+    bool exportADIF(QIODevice *);
+    bool exportCabrillo(QIODevice *,QString call,QString,QString,QString,QString);
     int fieldWidth(int col) const;
     bool gridMults() const;
     void guessMult(Qso *qso) const;
     bool hasPrefill() const;
     int highlightBand(int b,ModeTypes modeType=CWType) const;
     int idPfx(Qso *qso, bool &qsy) const;
-    void importCabrillo(QString cabFile);
+    void importLog(QString fileName);
     void initializeContest();
     bool isDupe(Qso *qso, bool DupeCheckingEveryBand, bool FillWorked) const;
     bool isEditing() const;
@@ -102,6 +155,7 @@ public:
     int nExch() const;
     ModeTypes nextModeType(ModeTypes m) const;
     bool newCall(QByteArray &s) const;
+    Cty* newCty() const;
     int nMults(int ii) const;
     int nMultsBWorked(int ii, int band) const;
     int nMultsColumn(int col,int ii) const;
@@ -115,17 +169,20 @@ public:
     void rescore();
     int rowCount() const;
     int score() const;
+    ScoreSummary scoreSummary() const;
     void searchPartial(Qso *qso, QByteArray part, QList<QByteArray>& calls, QList<unsigned int>& worked,
                        QList<int>& mult1, QList<int>& mult2);
     void selectContest();
     void setContinent(Cont);
     void setCountry(int);
+    bool setCty(Cty *c);
     void setLatLon(double la, double lo);
     void setMyZone(int zone);
     void setZoneType(int);
     bool showQsoPtsField() const;
     unsigned int sntFieldShown() const;
     void startDetailedEdit();
+    void updateConfig();
     void updateHistory();
     bool validateExchange(Qso *qso);
     void workedMults(Qso * qso, unsigned int worked[MMAX]) const;
@@ -138,6 +195,7 @@ signals:
     void dataChanged(QModelIndex, QModelIndex);
     void errorMessage(QString);
     void grab();
+    void importFinished(int nqso, qint64 ms);
     void logEditDone(QSqlRecord,QSqlRecord);
     void multByBandEnabled(bool);
     void progressCnt(int);
@@ -159,6 +217,7 @@ private slots:
     void startQsoEditRow(QModelIndex index);
     void startDetailedQsoEditRow(QModelIndex index);
     void finishEdit(int row,QSqlRecord &r);
+    void importStored(bool ok);
 
 private:
     logDelegate  *logdel;
@@ -166,6 +225,10 @@ private:
     Contest      *contest;
     Cty          *cty;
     DetailedEdit *detail;
+    LogImporter   *importer;
+    LogImportWriter *importWriter;
+    QThread       importThread;
+    QElapsedTimer importTimer;
     double       lat;
     double       lon;
     int          qsoCnt[N_BANDS];
@@ -175,6 +238,12 @@ private:
     QSqlDatabase db;
     QSqlRecord   origEditRecord;
     tableModel   *model;
+
+    Contest* newContest(const QByteArray &name) const;
+    void setupContest(Contest *c) const;
+    bool writeADIF(QSqlDatabase &edb, QIODevice *adifFile) const;
+    bool writeCabrillo(QSqlDatabase &edb, QIODevice *cbrFile, const QByteArray &call,
+                       const QByteArray snt_exch[MAX_EXCH_FIELDS]) const;
 };
 
 #endif
@@ -32,7 +32,7 @@
 
    needs pointer to contest object to get score/multiplier information
  */
-logDelegate::logDelegate(QObject *parent, Contest& c, bool *e, QList<int> *l) : QStyledItemDelegate(parent),
+logDelegate::logDelegate(QObject *parent, Contest *c, bool *e, QList<int> *l) : QStyledItemDelegate(parent),
     contest(c)
 {
     logSearchFlag = e;
@@ -126,109 +126,167 @@ void logDelegate::startDetailedEdit()
 
 }
 
-/*! paints data from log into exchange columns on screen.
-
-   Columns that are a new multiplier are highlighted in red.
-   Use the points from contest.score rather than in the SQL log
+/*! true log row for a row of the view. When a log search is performed, row is the
+   row within the restricted filter, and not the true row. The true row is needed to
+   display newmult and valid status
  */
-void logDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+int logDelegate::realRow(int row) const
 {
-    // for qso valid column draw a checkbox
-    if (index.column()==SQL_COL_VALID) {
-        bool data=index.data(Qt::CheckStateRole).toBool();
-        QStyleOptionButton checkboxstyle;
-        QRect checkbox_rect = QApplication::style()->subElementRect(QStyle::SE_CheckBoxIndicator, &checkboxstyle);
-        checkboxstyle.rect = option.rect;
-        checkboxstyle.rect.setLeft(option.rect.x() + option.rect.width()/2 - checkbox_rect.width()/2);
-        if (data) {
-            checkboxstyle.state = QStyle::State_On|QStyle::State_Enabled;
-        } else {
-            checkboxstyle.state = QStyle::State_Off|QStyle::State_Enabled;
-        }
-        QApplication::style()->drawControl(QStyle::CE_CheckBox, &checkboxstyle, painter);
-        return;
-    }
-    // get the real row for this qso. When a log search is performed, index.row() gives the
-    // row within the restricted filter, and not the true row. The true row is needed to
-    // display newmult and valid status
-    int realRow;
     if (*logSearchFlag) {
-        realRow=(*searchList).at(index.row());
+        return (*searchList).at(row);
     } else {
-        realRow=index.row();
+        return row;
     }
+}
 
-    QStyleOptionViewItem opt = option;
-    initStyleOption(&opt, index);
-    QString s         = index.model()->data(index).toString();
-
-    // display frequency in KHz
-    // (this is the reason editing the frequency column is a problem)
-    if (index.column()==SQL_COL_FREQ) {
-        double f_khz=index.model()->data(index).toDouble();
-        f_khz = qRound(f_khz / 1000.0);
-        s = QString::number(f_khz);
+/*! use contest c for scores, for example after a log import. Clears the row cache
+ */
+void logDelegate::setContest(Contest *c)
+{
+    contest = c;
+    invalidateCache();
+}
+
+/*! forget all cached rows. Needs to be called after a rescore
+ */
+void logDelegate::invalidateCache()
+{
+    rowCache.clear();
+}
+
+/*! forget cached rows after an edit
+ */
+void logDelegate::invalidateRows(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid()) {
+        invalidateCache();
+        return;
+    }
+    for (int i = topLeft.row(); i <= bottomRight.row(); i++) {
+        if (*logSearchFlag && i >= searchList->size()) break;
+        int r = realRow(i);
+        if (r >= 0 && r < rowCache.size()) rowCache[r].filled = false;
     }
+}
 
-    if (index.column() == SQL_COL_MODE) {
-        rmode_t m = (rmode_t)index.model()->data(index).toInt();
+/*! compute display text and highlighting of every column of a row
 
-        switch(m) {
-        case RIG_MODE_CW:
-            s = "CW";
-            break;
-        case RIG_MODE_CWR:
-            s = "CWR";
-            break;
-        case RIG_MODE_LSB:
-            s = "LSB";
-            break;
-        case RIG_MODE_USB:
-            s = "USB";
-            break;
-        case RIG_MODE_FM:
-            s = "FM";
+   Use the points from contest.score rather than in the SQL log
+ */
+void logDelegate::fillRow(LogRowCache &c, const QModelIndex &index, int realRow) const
+{
+    const QAbstractItemModel *m = index.model();
+    const int row = index.row();
+
+    // 0 = regular text
+    // 1 = red (new multiplier)
+    // 2 = grey (dupe)
+    int mult0 = contest->newMult(realRow, 0);
+    int mult1 = contest->newMult(realRow, 1);
+    bool grey = (contest->dupe(realRow) || !contest->valid(realRow));
+    for (int col = 0; col < SQL_N_COL; col++) {
+        if (grey) {
+            c.highlight[col] = LogTextDupe;
+        } else if (col == mult0 || col == mult1) {
+            c.highlight[col] = LogTextNewMult;
+        } else {
+            c.highlight[col] = LogTextNormal;
+        }
+        if (col == SQL_COL_VALID) {
+            c.text[col].clear();
+            c.checked = m->data(m->index(row, col), Qt::CheckStateRole).toBool();
+            continue;
+        }
+        const QVariant v = m->data(m->index(row, col));
+        switch (col) {
+        case SQL_COL_FREQ:
+            // display frequency in KHz
+            // (this is the reason editing the frequency column is a problem)
+            c.text[col] = QString::number(qRound(v.toDouble() / 1000.0));
             break;
-        case RIG_MODE_AM:
-            s = "AM";
+        case SQL_COL_MODE:
+            switch ((rmode_t)v.toInt()) {
+            case RIG_MODE_CW:
+                c.text[col] = "CW";
+                break;
+            case RIG_MODE_CWR:
+                c.text[col] = "CWR";
+                break;
+            case RIG_MODE_LSB:
+                c.text[col] = "LSB";
+                break;
+            case RIG_MODE_USB:
+                c.text[col] = "USB";
+                break;
+            case RIG_MODE_FM:
+                c.text[col] = "FM";
+                break;
+            case RIG_MODE_AM:
+                c.text[col] = "AM";
+                break;
+            case RIG_MODE_RTTY:
+            case RIG_MODE_RTTYR:
+                c.text[col] = "RY";
+                break;
+            default:
+                c.text[col] = v.toString();
+                break;
+            }
             break;
-        case RIG_MODE_RTTY:
-        case RIG_MODE_RTTYR:
-            s = "RY";
+        case SQL_COL_PTS:
+            // get qso points from contest object instead of sql database
+            c.text[col] = QString::number(contest->points(realRow));
             break;
         default:
+            c.text[col] = v.toString();
             break;
         }
     }
+    c.filled = true;
+}
 
-    // 0 = regular text
-    // 1 = red (new multiplier)
-    // 2 = grey (dupe)
-    int    highlight = 0;
+/*! paints data from log into exchange columns on screen.
 
-    // get qso points from contest object instead of sql database
-    if (index.column() == SQL_COL_PTS) {
-        s = QString::number(contest.points(realRow));
+   Columns that are a new multiplier are highlighted in red. Text and colors of each
+   row are computed once and cached until the row is edited or the log is rescored
+ */
+void logDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const int r = realRow(index.row());
+    if (r < 0) return;
+    if (r >= rowCache.size()) {
+        const int n = rowCache.size();
+        rowCache.resize(r + 1);
+        for (int i = n; i <= r; i++) rowCache[i].filled = false;
     }
+    LogRowCache &c = rowCache[r];
+    if (!c.filled) fillRow(c, index, r);
+    const int col = index.column();
 
-    // check to see if a column is a new multiplier and needs highlighting
-    if ((contest.newMult(realRow, 0)) == index.column()) {
-        highlight = 1;
-    }
-    if ((contest.newMult(realRow, 1)) == index.column()) {
-        highlight = 1;
+    // for qso valid column draw a checkbox
+    if (col == SQL_COL_VALID) {
+        QStyleOptionButton checkboxstyle;
+        QRect checkbox_rect = QApplication::style()->subElementRect(QStyle::SE_CheckBoxIndicator, &checkboxstyle);
+        checkboxstyle.rect = option.rect;
+        checkboxstyle.rect.setLeft(option.rect.x() + option.rect.width()/2 - checkbox_rect.width()/2);
+        if (c.checked) {
+            checkboxstyle.state = QStyle::State_On|QStyle::State_Enabled;
+        } else {
+            checkboxstyle.state = QStyle::State_Off|QStyle::State_Enabled;
+        }
+        QApplication::style()->drawControl(QStyle::CE_CheckBox, &checkboxstyle, painter);
+        return;
     }
 
-    // dupes are grayed out
-    if (contest.dupe(realRow) || !contest.valid(realRow)) highlight = 2;
-
-    // draw correct background
-    opt.text = "";
+    // draw correct background. The log model supplies no font, color, or alignment
+    // roles, so the view's option can be used directly
+    QStyleOptionViewItem opt = option;
+    opt.index = index;
+    opt.text  = "";
     QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
     style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
 
-    QRect                rect = opt.rect;
-    QPalette::ColorGroup cg   = opt.state & QStyle::State_Enabled ? QPalette::Normal : QPalette::Disabled;
+    QPalette::ColorGroup cg = opt.state & QStyle::State_Enabled ? QPalette::Normal : QPalette::Disabled;
     if (cg == QPalette::Normal && !(opt.state & QStyle::State_Active)) {
         cg = QPalette::Inactive;
     }
@@ -237,11 +295,11 @@ void logDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, c
     if (opt.state & QStyle::State_Selected) {
         painter->setPen(opt.palette.color(cg, QPalette::HighlightedText));
     } else {
-        switch (highlight) {
-        case 1:
+        switch (c.highlight[col]) {
+        case LogTextNewMult:
             painter->setPen(Qt::red); // new multiplier: red
             break;
-        case 2:
+        case LogTextDupe:
             painter->setPen(Qt::lightGray); // dupes and invalids: light grey
             break;
         default:
@@ -251,7 +309,7 @@ void logDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, c
     }
 
     // draw text
-    painter->drawText(QRect(rect.left(), rect.top(), rect.width(), rect.height()), opt.displayAlignment, s);
+    painter->drawText(opt.rect, opt.displayAlignment, c.text[col]);
 }
 
 
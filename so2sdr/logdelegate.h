@@ -27,11 +27,32 @@
 #include <QObject>
 #include <QList>
 #include <QSqlRecord>
+#include <QString>
+#include <QVector>
 #include <QWidget>
 #include "defines.h"
 #include "contest.h"
 #include "utils.h"
 
+/*!
+  how a log cell is drawn
+  */
+typedef enum LogHighlight {
+    LogTextNormal = 0,
+    LogTextNewMult = 1,
+    LogTextDupe = 2
+} LogHighlight;
+
+/*!
+  text and colors of one log row, computed the first time the row is painted
+  */
+typedef struct LogRowCache {
+    bool filled;
+    bool checked;
+    unsigned char highlight[SQL_N_COL];
+    QString text[SQL_N_COL];
+} LogRowCache;
+
 /*!
   subclass of delegate for displaying log in main window
   */
@@ -40,7 +61,8 @@ class logDelegate : public QStyledItemDelegate
 Q_OBJECT
 
 public:
-    logDelegate(QObject *parent, Contest& c, bool *e, QList<int> *l);
+    logDelegate(QObject *parent, Contest *c, bool *e, QList<int> *l);
+    void setContest(Contest *c);
     bool currentlyEditing;
     mutable QWidget* currentEditor;
 
@@ -59,16 +81,22 @@ protected:
     bool eventFilter(QObject *obj, QEvent *event);
 
 public slots:
+    void invalidateCache();
+    void invalidateRows(const QModelIndex &topLeft, const QModelIndex &bottomRight);
     void startDetailedEdit();
 
 private slots:
     void closeEditor(QWidget *editor, QAbstractItemDelegate::EndEditHint hint = QAbstractItemDelegate::NoHint);
 
 private:
-    Contest& contest;
+    Contest *contest;
     bool *logSearchFlag;
     QList<int> *searchList;
     QModelIndex currentlyEditingIndex;
+    mutable QVector<LogRowCache> rowCache;
+
+    void fillRow(LogRowCache &c, const QModelIndex &index, int realRow) const;
+    int realRow(int row) const;
 };
 
 
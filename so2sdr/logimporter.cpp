@@ -0,0 +1,186 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QDateTime>
+#include "adifparse.h"
+#include "exchtokenizer.h"
+#include "hamlib/rig.h"
+#include "logimporter.h"
+#include "qso.h"
+#include "utils.h"
+
+LogImporter::LogImporter(const QString &fileName, int nExch, QObject *parent) : QObject(parent)
+{
+    this->fileName = fileName;
+    nExchange      = qBound(0, nExch, MAX_EXCH_FIELDS);
+    adif           = fileName.endsWith(".adi", Qt::CaseInsensitive) || fileName.endsWith(".adif", Qt::CaseInsensitive);
+}
+
+bool LogImporter::isAdif() const
+{
+    return adif;
+}
+
+/*!
+   qsos read from the file. Only valid after finished() is emitted
+ */
+QList<ImportQso> &LogImporter::qsos()
+{
+    return importQsos;
+}
+
+/*!
+   read the file. Progress is reported in kB read
+ */
+void LogImporter::run()
+{
+    importQsos.clear();
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        emit(finished(false));
+        return;
+    }
+    emit(progressMax((int) (file.size() / 1024) + 1));
+    if (adif) {
+        readAdif(file);
+    } else {
+        readCabrillo(file);
+    }
+    file.close();
+    emit(finished(true));
+}
+
+/*!
+   read Cabrillo QSO: lines
+ */
+void LogImporter::readCabrillo(QFile &file)
+{
+    ExchTokenizer field;
+    char          buff[1024];
+    qint64        n;
+    while ((n = file.readLine(buff, sizeof(buff))) > 0) {
+        // tokenizer copies and upper-cases the line, so no copy needed here
+        field.tokenize(QByteArray::fromRawData(buff, (int) n));
+        if (field.size() == 0 || !field.equals(0, "QSO:")) {
+            continue;  // ignore header data
+        }
+        // need at least freq, mode, date, time, station call, sent exchange, call worked
+        if (field.size() < 7 + nExchange) continue;
+
+        ImportQso qso;
+
+        // Field1 = frequency in KHz
+        qso.freq = field.token(1).toDouble() * 1000;
+        qso.band = getBand(qso.freq);
+
+        // Field2 = mode
+        if (field.equals(2, "CW")) {
+            qso.mode = RIG_MODE_CW;
+        } else if (field.equals(2, "RY")) {
+            qso.mode = RIG_MODE_RTTY;
+        } else if (field.equals(2, "PH")) {
+            // Cabrillo doesn't store LSB/USB?
+            if (qso.freq < 14000000) {
+                qso.mode = RIG_MODE_LSB;
+            } else {
+                qso.mode = RIG_MODE_USB;
+            }
+        } else if (field.equals(2, "FM")) {
+            qso.mode = RIG_MODE_FM;
+        } else {
+            qso.mode = RIG_MODE_CW;
+        }
+
+        // Field3 = date yyyy-mm-dd; SQL log uses MMddyyyy
+        if (field.length(3) == 10) {
+            const char *d = field.data(3);
+            qso.date.reserve(8);
+            qso.date.append(d + 5, 2);
+            qso.date.append(d + 8, 2);
+            qso.date.append(d, 4);
+        }
+
+        // Field4=time
+        qso.time = field.token(4);
+
+        // Field5=station call. ignore this
+
+        // Field6+
+        // next fields are sent exchange
+        for (int j = 0; j < nExchange; j++) {
+            qso.snt[j] = field.token(6 + j);
+        }
+
+        // next field=call worked
+        qso.call = field.token(6 + nExchange);
+
+        // next received report
+        // some fields may be empty (flaw in Cabrillo spec?)
+        for (int j = 0; j < nExchange && (7 + nExchange + j) < field.size(); j++) {
+            qso.rcv[j] = field.token(7 + nExchange + j);
+        }
+        importQsos.append(qso);
+        if ((importQsos.size() % LOG_IMPORT_PROGRESS_STEP) == 0) {
+            emit(progressCnt((int) (file.pos() / 1024)));
+        }
+    }
+}
+
+/*!
+   read ADIF records. The file is memory-mapped if possible and tokenized in place
+ */
+void LogImporter::readAdif(QFile &file)
+{
+    QByteArray  data;
+    const char *p    = 0;
+    int         size = (int) file.size();
+    uchar      *map  = file.map(0, size);
+    if (map) {
+        p = (const char *) map;
+    } else {
+        data = file.readAll();
+        p    = data.constData();
+        size = data.size();
+    }
+    AdifTokenizer tok(p, size);
+    ADIFParse     parser;
+    Qso           tmp(qMax(nExchange, 1));
+    while (parser.nextRecord(tok, &tmp)) {
+        if (tmp.call.isEmpty()) continue;
+
+        ImportQso qso;
+        qso.freq = tmp.freq;
+        if (qso.freq > 0.0) {
+            qso.band = getBand(qso.freq);
+        } else {
+            qso.band = tmp.band;
+        }
+        qso.mode = tmp.mode;
+        qso.date = tmp.time.toString("MMddyyyy").toLatin1();
+        qso.time = tmp.time.toString("hhmm").toLatin1();
+        qso.call = tmp.call;
+        for (int j = 0; j < nExchange; j++) {
+            qso.rcv[j] = tmp.rcv_exch[j];
+        }
+        importQsos.append(qso);
+        if ((importQsos.size() % LOG_IMPORT_PROGRESS_STEP) == 0) {
+            emit(progressCnt(tok.position() / 1024));
+        }
+    }
+    if (map) file.unmap(map);
+}
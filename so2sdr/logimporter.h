@@ -0,0 +1,78 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef LOGIMPORTER_H
+#define LOGIMPORTER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include "defines.h"
+
+/*!
+   one imported qso, with fields in the format stored in the SQL log
+ */
+typedef struct ImportQso {
+    double     freq;
+    int        band;
+    int        mode;
+    QByteArray date;
+    QByteArray time;
+    QByteArray call;
+    QByteArray snt[MAX_EXCH_FIELDS];
+    QByteArray rcv[MAX_EXCH_FIELDS];
+} ImportQso;
+
+/*!
+   Reads a Cabrillo or ADIF log file.
+
+   This is the first phase of log import and runs in its own QThread: the
+   file is read once and parsed into a list of qsos. It does not touch the
+   log database or contest; in so2sdr a LogImportWriter in the same thread
+   scores and inserts the qsos when finished() is emitted.
+ */
+class LogImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    LogImporter(const QString &fileName, int nExch, QObject *parent = nullptr);
+    bool isAdif() const;
+    QList<ImportQso> &qsos();
+
+signals:
+    void finished(bool);
+    void progressCnt(int);
+    void progressMax(int);
+
+public slots:
+    void run();
+
+private:
+    bool             adif;
+    int              nExchange;
+    QList<ImportQso> importQsos;
+    QString          fileName;
+
+    void readAdif(QFile &file);
+    void readCabrillo(QFile &file);
+};
+
+#endif // LOGIMPORTER_H
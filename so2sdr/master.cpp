@@ -19,15 +19,33 @@
 #include "master.h"
 #include <QString>
 #include <QIODevice>
+#include <QThreadPool>
+
+MasterLoader::MasterLoader(const QString &f, int i) : fileName(f), id(i)
+{
+    setAutoDelete(true);
+}
+
+void MasterLoader::run()
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit(loaded(id, QByteArray(), "ERROR: can't open file " + fileName));
+        return;
+    }
+    emit(loaded(id, file.readAll(), QString()));
+}
 
 /*!
-   Must call initialize after constructor before using class
+   Must call initialize or load after constructor before using class
  */
 Master::Master()
 {
     initialized = false;
     index       = 0;
     CallData    = 0;
+    loadId      = 0;
+    fileSize    = 0;
     chars       = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789/";
     nchars      = chars.size();
     indexSize   = nchars * nchars + 1;
@@ -37,8 +55,6 @@ Master::Master()
 
 Master::~Master()
 {
-    delete[] index;
-    delete[] CallData;
 }
 
 /*!
@@ -48,29 +64,64 @@ Master::~Master()
  */
 void Master::initialize(QFile &file)
 {
-    delete[] index;     // in case re-initialized
-    delete[] CallData;
-    index    = new int[indexSize];
-    fileSize = file.size();
-    if (file.read((char *) (&index[0]), indexBytes) != indexBytes) {
-        emit(masterError("ERROR: master file has incorrect size"));
+    loadId++; // any load in progress is now out of date
+    setData(file.readAll());
+    file.close();
+}
+
+/*!
+   Start reading master.dta file in a background thread. ready() is emitted
+   when lookups are available; searches before then return no calls
+ */
+void Master::load(const QString &fileName)
+{
+    loadId++;
+    MasterLoader *loader = new MasterLoader(fileName, loadId);
+    connect(loader, SIGNAL(loaded(int,QByteArray,QString)), this, SLOT(loaded(int,QByteArray,QString)));
+    QThreadPool::globalInstance()->start(loader);
+}
+
+void Master::loaded(int id, QByteArray d, QString error)
+{
+    if (id != loadId) return; // a newer file was requested
+    if (!error.isEmpty()) {
+        emit(masterError(error));
         return;
     }
+    if (setData(d)) emit(ready());
+}
+
+bool Master::isReady() const
+{
+    return initialized;
+}
+
+/*!
+   check file contents and set up lookup tables. The file starts with an index giving
+   the offset of the calls for each pair of characters
+ */
+bool Master::setData(const QByteArray &d)
+{
+    initialized = false;
+    index       = 0;
+    CallData    = 0;
+    data        = d;
+    fileSize    = data.size();
+    if (fileSize < indexBytes) {
+        emit(masterError("ERROR: master file has incorrect size"));
+        return false;
+    }
+    index = reinterpret_cast<const int *>(data.constData());
 
     // some basic checks on the master.dta file index
     if (index[0] != indexBytes || index[indexSize - 1] != fileSize) {
         emit(masterError("ERROR: Invalid master data file: index"));
-        return;
+        index = 0;
+        return false;
     }
-
-    // read callsign data
-    CallData = new char[fileSize - indexBytes];
-    if (file.read(CallData, fileSize - indexBytes) != (fileSize - indexBytes)) {
-        emit(masterError("ERROR: Invalid master data file: calls"));
-        return;
-    }
-    file.close();
+    CallData    = data.constData() + indexBytes;
     initialized = true;
+    return true;
 }
 
 /*!
@@ -83,6 +134,7 @@ void Master::search(QByteArray partial, QByteArray &CallList)
 {
     QByteArray mask = partial;
     CallList = "";
+    if (!initialized) return;
     for (int i = 0; i < partial.size(); i++) {
         if (chars.contains(partial.at(i))) {
             mask[i] = 'A';
@@ -21,8 +21,29 @@
 
 #include <QByteArray>
 #include <QFile>
+#include <QObject>
+#include <QRunnable>
 #include <QString>
 
+/*!
+   reads a MASTER.DTA file in a QThreadPool thread
+ */
+class MasterLoader : public QObject, public QRunnable
+{
+Q_OBJECT
+
+public:
+    MasterLoader(const QString &fileName, int id);
+    void run();
+
+signals:
+    void loaded(int id, QByteArray data, QString error);
+
+private:
+    QString fileName;
+    int     id;
+};
+
 /*!
    Class for supercheck partial lookups (MASTER.DTA)
 
@@ -36,20 +57,30 @@ public:
     Master();
     ~Master();
     void initialize(QFile &file);
+    bool isReady() const;
+    void load(const QString &fileName);
     void search(QByteArray partial, QByteArray &CallList);
 
 signals:
     void masterError(const QString &);
+    void ready();
+
+private slots:
+    void loaded(int id, QByteArray d, QString error);
 
 private:
     bool       initialized;
-    char       *CallData;
-    int        *index;
+    const char *CallData;
+    const int  *index;
     int        indexBytes;
     int        indexSize;
+    int        loadId;
     int        nchars;
     QByteArray chars;
+    QByteArray data;
     qint64     fileSize;
+
+    bool setData(const QByteArray &d);
 };
 
 #endif // MASTER_H
@@ -19,14 +19,16 @@
 #include "centergriddialog.h"
 #include "multdisplay.h"
 #include <QByteArray>
-#include <QDebug>
-#include <QEvent>
+#include <QColor>
+#include <QFontMetrics>
 #include <QMouseEvent>
-#include <QPoint>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QScrollBar>
 #include <QtMath>
-#include <QTextCursor>
 
-MultDisplay::MultDisplay(QWidget *parent) : QTextEdit(parent)
+MultDisplay::MultDisplay(QWidget *parent) : QAbstractScrollArea(parent)
 {
     gridMode=false;
     centerGrid="EM53";
@@ -34,81 +36,95 @@ MultDisplay::MultDisplay(QWidget *parent) : QTextEdit(parent)
     centerField2='M';
     centerNr1='5';
     centerNr2='3';
+    for (int i=0;i<4;i++) upperLeft[i]=0;
     mults.clear();
-    neededMults.clear();
+    needed.clear();
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     viewport()->setCursor(Qt::ArrowCursor);
-    installEventFilter(this);
 }
 
+/*! remove all mults from the display
+ */
+void MultDisplay::clear()
+{
+    mults.clear();
+    needed.clear();
+    multIndex.clear();
+    multRects.clear();
+    rowStart.clear();
+    gridCells.clear();
+    verticalScrollBar()->setRange(0,0);
+    viewport()->update();
+}
 
 void MultDisplay::setGridMode(bool b)
 {
     gridMode=b;
     if (b) {
-        setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
         setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+        drawGrids();
     } else {
-        setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
         setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+        gridCells.clear();
+        layoutMults();
     }
+    viewport()->update();
 }
 
-bool MultDisplay::eventFilter(QObject* o, QEvent* e)
+void MultDisplay::mousePressEvent(QMouseEvent *e)
 {
-    Q_UNUSED(o)
-
+    if (!gridMode) {
+        QAbstractScrollArea::mousePressEvent(e);
+        return;
+    }
     // if in grid mode, right mouse brings up center grid dialog
-    if (gridMode && e->type()==QEvent::MouseButtonPress) {
-        QMouseEvent* ev = static_cast<QMouseEvent*>(e);
-        if (ev->button()==Qt::RightButton) {
-            CenterGridDialog *dialog = new CenterGridDialog(this);
-            connect(dialog,SIGNAL(grid(QByteArray)),this,SLOT(setCenterGrid(QByteArray)));
-            dialog->show();
-            return true;
-        } else if (ev->button()==Qt::LeftButton) {
-            // compute new center grid from mouse position
-            int x=ev->pos().x();
-            int y=ev->pos().y();
-            int width=viewport()->width();
-            int gridWidth=QWidget::fontMetrics().averageCharWidth()*5;
-            int nw=width/gridWidth;
-            int woffset=qCeil((width-nw*gridWidth)/(QWidget::fontMetrics().averageCharWidth()*2.0));
-            x=x-woffset*QWidget::fontMetrics().averageCharWidth();
-            x=x/gridWidth;
-            y=(y-document()->documentMargin())/QWidget::fontMetrics().height();
-            for (int i=0;i<x;i++) {
-                upperLeft[2]++;
-                if (upperLeft[2]==10) {
-                    upperLeft[2]=0;
-                    upperLeft[0]++;
-                    if (upperLeft[0]=='R') upperLeft[0]='A';
-                }
+    if (e->button()==Qt::RightButton) {
+        CenterGridDialog *dialog = new CenterGridDialog(this);
+        connect(dialog,SIGNAL(grid(QByteArray)),this,SLOT(setCenterGrid(QByteArray)));
+        dialog->show();
+    } else if (e->button()==Qt::LeftButton) {
+        // compute new center grid from mouse position
+        int x=e->pos().x();
+        int y=e->pos().y();
+        int width=viewport()->width()-2*MULT_DISPLAY_MARGIN;
+        int charWidth=fontMetrics().averageCharWidth();
+        int gridWidth=charWidth*5;
+        int nw=width/gridWidth;
+        int woffset=qCeil((width-nw*gridWidth)/(charWidth*2.0));
+        x=(x-MULT_DISPLAY_MARGIN-woffset*charWidth)/gridWidth;
+        y=(y-MULT_DISPLAY_MARGIN)/fontMetrics().height();
+        for (int i=0;i<x;i++) {
+            upperLeft[2]++;
+            if (upperLeft[2]==10) {
+                upperLeft[2]=0;
+                upperLeft[0]++;
+                if (upperLeft[0]=='R') upperLeft[0]='A';
             }
-            for (int i=0;i<y;i++) {
-                upperLeft[3]--;
-                if (upperLeft[3]<0) {
-                    upperLeft[3]=9;
-                    upperLeft[1]--;
-                    if (upperLeft[1]<'A') upperLeft[1]='R';
-                }
+        }
+        for (int i=0;i<y;i++) {
+            upperLeft[3]--;
+            if (upperLeft[3]<0) {
+                upperLeft[3]=9;
+                upperLeft[1]--;
+                if (upperLeft[1]<'A') upperLeft[1]='R';
             }
-            centerField1=upperLeft[0];
-            centerField2=upperLeft[1];
-            centerNr1=upperLeft[2]+48;
-            centerNr2=upperLeft[3]+48;
-            centerGrid.clear();
-            centerGrid=centerGrid+centerField1+centerField2+char(centerNr1)+char(centerNr2);
-            drawGrids();
-            return true;
         }
+        centerField1=upperLeft[0];
+        centerField2=upperLeft[1];
+        centerNr1=upperLeft[2]+48;
+        centerNr2=upperLeft[3]+48;
+        centerGrid.clear();
+        centerGrid=centerGrid+centerField1+centerField2+char(centerNr1)+char(centerNr2);
+        drawGrids();
     }
-    return false;
+    e->accept();
 }
 
 void MultDisplay::setCenterGrid(QByteArray b)
 {
     char tmp[4];
     b=b.toUpper();
+    if (b.size()<4) return;
     if (b.at(0)>='A' && b.at(0)<='R') {
         tmp[0]=b.at(0);
     } else {
@@ -134,38 +150,165 @@ void MultDisplay::setCenterGrid(QByteArray b)
     centerNr1=tmp[2];
     centerNr2=tmp[3];
     centerGrid=b;
-    drawGrids();
+    if (gridMode) drawGrids();
 }
 
-void MultDisplay::updateMults()
+/*! set the mults shown and which of them are in the needed list (bit i set
+ *  for mult i).
+ *
+ * If the list of mults is unchanged, only cells whose needed state changed are
+ * repainted. Otherwise the display is laid out again.
+ */
+void MultDisplay::setMults(const QList<QByteArray> &list, const QBitArray &neededList)
 {
+    if (list.size()==mults.size() && neededList.size()==needed.size() && list==mults) {
+        const QBitArray changed=neededList ^ needed;
+        needed=neededList;
+        if (gridMode) {
+            for (int i=0;i<gridCells.size();i++) {
+                const MultGridCell &c=gridCells.at(i);
+                if (c.mult!=-1 && changed.testBit(c.mult)) viewport()->update(c.rect);
+            }
+        } else {
+            for (int i=0;i<changed.size();i++) {
+                if (changed.testBit(i)) updateCell(i);
+            }
+        }
+        return;
+    }
+    mults=list;
+    needed=neededList;
+    needed.resize(mults.size());
+    multIndex.clear();
+    multIndex.reserve(mults.size());
+    for (int i=0;i<mults.size();i++) {
+        multIndex.insert(mults.at(i),i);
+    }
     if (gridMode) {
         drawGrids();
     } else {
-        QString text;
-        text.clear();
-        for (int i=0;i<mults.size();i++) {
-            if (neededMults.contains(mults.at(i))) {
-                text=text+"<font color=#AAAAAA>"+mults.at(i)+"&nbsp;";
-            } else {
-                text=text+"<font color=#FF0000>"+mults.at(i)+"&nbsp;";
+        layoutMults();
+        viewport()->update();
+    }
+}
+
+/*! compute position of each mult, wrapping at the viewport width. Positions are
+ *  in contents coordinates (not shifted by the scrollbar)
+ */
+void MultDisplay::layoutMults()
+{
+    const QFontMetrics fm=fontMetrics();
+    const int lineHeight=fm.height();
+    const int space=fm.width(QLatin1Char(' '));
+    const int width=viewport()->width()-2*MULT_DISPLAY_MARGIN;
+    multRects.resize(mults.size());
+    rowStart.clear();
+    if (!mults.isEmpty()) rowStart.append(0);
+    int x=0;
+    int row=0;
+    for (int i=0;i<mults.size();i++) {
+        int w=fm.width(QString::fromLatin1(mults.at(i)));
+        if (x>0 && (x+w)>width) {
+            x=0;
+            row++;
+            rowStart.append(i);
+        }
+        multRects[i]=QRect(MULT_DISPLAY_MARGIN+x,MULT_DISPLAY_MARGIN+row*lineHeight,w,lineHeight);
+        x+=w+space;
+    }
+    const int contentHeight=rowStart.size()*lineHeight+2*MULT_DISPLAY_MARGIN;
+    verticalScrollBar()->setRange(0,qMax(0,contentHeight-viewport()->height()));
+    verticalScrollBar()->setPageStep(viewport()->height());
+    verticalScrollBar()->setSingleStep(lineHeight);
+}
+
+/*! repaint mult i
+ */
+void MultDisplay::updateCell(int i)
+{
+    if (i<0 || i>=multRects.size()) return;
+    viewport()->update(multRects.at(i).translated(0,-verticalScrollBar()->value()));
+}
+
+/*! mults in the needed list are drawn grey, all others red
+ */
+void MultDisplay::paintCell(QPainter &p, const QByteArray &name, const QRect &r, bool need)
+{
+    if (need) {
+        p.setPen(QColor(0xAA,0xAA,0xAA));
+    } else {
+        p.setPen(QColor(0xFF,0x00,0x00));
+    }
+    p.drawText(r,Qt::AlignLeft | Qt::AlignVCenter,QString::fromLatin1(name));
+}
+
+/*! paint only the cells intersecting the update region
+ */
+void MultDisplay::paintEvent(QPaintEvent *e)
+{
+    QPainter p(viewport());
+    const QRect update=e->rect();
+    if (gridMode) {
+        for (int i=0;i<gridCells.size();i++) {
+            const MultGridCell &c=gridCells.at(i);
+            if (c.rect.intersects(update)) {
+                paintCell(p,c.grid,c.rect,c.mult!=-1 && needed.testBit(c.mult));
             }
         }
-        setHtml(text);
+        return;
+    }
+    if (rowStart.isEmpty()) return;
+
+    // rows are of equal height, so the visible mults can be found directly
+    const int scroll=verticalScrollBar()->value();
+    const int lineHeight=fontMetrics().height();
+    const int nrow=rowStart.size();
+    int r0=(update.top()+scroll-MULT_DISPLAY_MARGIN)/lineHeight;
+    int r1=(update.bottom()+scroll-MULT_DISPLAY_MARGIN)/lineHeight;
+    if (r0<0) r0=0;
+    if (r1>=nrow) r1=nrow-1;
+    if (r0>r1) return;
+    const int end=(r1+1<nrow) ? rowStart.at(r1+1) : mults.size();
+    for (int i=rowStart.at(r0);i<end;i++) {
+        const QRect r=multRects.at(i).translated(0,-scroll);
+        if (r.intersects(update)) {
+            paintCell(p,mults.at(i),r,needed.testBit(i));
+        }
+    }
+}
+
+void MultDisplay::resizeEvent(QResizeEvent *e)
+{
+    QAbstractScrollArea::resizeEvent(e);
+    if (gridMode) {
+        drawGrids();
+    } else {
+        layoutMults();
     }
 }
 
-/*! draws grid squares in mult window, centered at centerGrid
- *  worked grids are
+void MultDisplay::scrollContentsBy(int dx, int dy)
+{
+    viewport()->scroll(dx,dy);
+}
+
+/*! lays out grid squares in mult window, centered at centerGrid
  */
 void MultDisplay::drawGrids()
 {
-    int height=viewport()->height();
-    int width=viewport()->width();
-    int gridWidth=QWidget::fontMetrics().averageCharWidth()*5;
-    char nw=width/gridWidth;
-    int woffset=qCeil((width-nw*gridWidth)/(QWidget::fontMetrics().averageCharWidth()*2.0));
-    char nh=height/QWidget::fontMetrics().height();
+    gridCells.clear();
+    if (mults.isEmpty()) {
+        viewport()->update();
+        return;
+    }
+    const int charWidth=fontMetrics().averageCharWidth();
+    const int lineHeight=fontMetrics().height();
+    int height=viewport()->height()-2*MULT_DISPLAY_MARGIN;
+    int width=viewport()->width()-2*MULT_DISPLAY_MARGIN;
+    int gridWidth=charWidth*5;
+    int nw=width/gridWidth;
+    int woffset=qCeil((width-nw*gridWidth)/(charWidth*2.0));
+    int nh=height/lineHeight;
 
     upperLeft[0]=centerField1;
     upperLeft[1]=centerField2;
@@ -181,25 +324,20 @@ void MultDisplay::drawGrids()
         upperLeft[1]++;
         if (upperLeft[1]>'R') upperLeft[1]='A';
     }
-    QByteArray text;
-    text.clear();
+    gridCells.reserve(nw*nh);
     char tmpf2=upperLeft[1];
     char tmpr2=upperLeft[3];
     for (int i=0;i<nh;i++) {
         char tmpr1=upperLeft[2];
         char tmpf1=upperLeft[0];
-        for (int k=0;k<woffset;k++) text=text+"&nbsp;";
         for (int j=0;j<nw;j++) {
-            QByteArray grid;
-            grid.clear();
-            grid=grid+tmpf1+tmpf2+char(tmpr1+48)+char(tmpr2+48);
-            QByteArray displayGrid;
-            if (neededMults.contains(grid)) {
-                displayGrid="<font color=#AAAAAA>"+grid;
-            } else {
-                displayGrid="<font color=#FF0000>"+grid;
-            }
-            text=text+displayGrid+' ';
+            MultGridCell c;
+            c.grid.reserve(4);
+            c.grid=c.grid+tmpf1+tmpf2+char(tmpr1+48)+char(tmpr2+48);
+            c.rect=QRect(MULT_DISPLAY_MARGIN+(woffset+j*5)*charWidth,MULT_DISPLAY_MARGIN+i*lineHeight,
+                         charWidth*4,lineHeight);
+            c.mult=multIndex.value(c.grid,-1);
+            gridCells.append(c);
             tmpr1++;
             if (tmpr1==10) {
                 tmpr1=0;
@@ -207,7 +345,6 @@ void MultDisplay::drawGrids()
                 if (tmpf1>'R') tmpf1='A';
             }
         }
-        text=text+'\n';
         tmpr2--;
         if (tmpr2<0) {
             tmpr2=9;
@@ -215,5 +352,5 @@ void MultDisplay::drawGrids()
             if (tmpf2<'A') tmpf2='R';
         }
     }
-    setText(text);
+    viewport()->update();
 }
@@ -19,39 +19,73 @@
 #ifndef MULTDISPLAY_H
 #define MULTDISPLAY_H
 
+#include <QAbstractScrollArea>
+#include <QBitArray>
 #include <QByteArray>
+#include <QHash>
 #include <QList>
-#include <QTextEdit>
+#include <QRect>
+#include <QVector>
 #include <QWidget>
 
+class QMouseEvent;
+class QPainter;
+class QPaintEvent;
+class QResizeEvent;
+
+/*! margin around mult display contents in pixels */
+const int MULT_DISPLAY_MARGIN=4;
+
+/*! one grid square shown in grid mode. mult is the index in the mult list, or -1
+ *  if the grid is not a mult
+ */
+typedef struct MultGridCell {
+    QByteArray grid;
+    QRect rect;
+    int mult;
+} MultGridCell;
+
 /*! widget to display multipliers. Has extra features for grid square display
  *
+ * Mults are painted directly from the list of names and a bit array of needed
+ * flags. Only visible cells are painted, and when only the needed flags change
+ * only the cells that changed are repainted.
  */
-class MultDisplay : public QTextEdit
+class MultDisplay : public QAbstractScrollArea
 {
     Q_OBJECT
 
 public:
     MultDisplay(QWidget *parent = Q_NULLPTR);
+    void clear();
     void setGridMode(bool);
     void drawGrids();
-    void updateMults();
 public slots:
     void setCenterGrid(QByteArray);
-    void setMults(QList<QByteArray> list) {mults=list;}
-    void setNeededMults(QList<QByteArray> list) {neededMults=list;}
+    void setMults(const QList<QByteArray> &list, const QBitArray &neededList);
 protected:
-    bool eventFilter(QObject*, QEvent* e);
+    void mousePressEvent(QMouseEvent *e);
+    void paintEvent(QPaintEvent *e);
+    void resizeEvent(QResizeEvent *e);
+    void scrollContentsBy(int dx, int dy);
 private:
     bool gridMode;
     QByteArray centerGrid;
     QList<QByteArray> mults;
-    QList<QByteArray> neededMults;
+    QBitArray needed;
+    QHash<QByteArray,int> multIndex;
+    QVector<QRect> multRects;
+    QVector<int> rowStart;
+    QVector<MultGridCell> gridCells;
     char centerField1;
     char centerField2;
     char centerNr1;
     char centerNr2;
     char upperLeft[4];
+
+    void layoutMults();
+    void paintCell(QPainter &p, const QByteArray &name, const QRect &r, bool need);
+    void updateCell(int i);
 };
 
 #endif // MULTDISPLAY_H
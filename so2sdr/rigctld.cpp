@@ -0,0 +1,107 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <ctype.h>
+#include "rigctld.h"
+
+RigctldParser::RigctldParser()
+{
+    scanPos=0;
+}
+
+/*! add data read from the socket
+ */
+void RigctldParser::append(const QByteArray &data)
+{
+    buffer.append(data);
+}
+
+/*! discard any partial reply (used on reconnect)
+ */
+void RigctldParser::clear()
+{
+    buffer.clear();
+    scanPos=0;
+}
+
+/*! extract the next complete reply from the buffer
+
+   returns false if no complete reply is available yet
+ */
+bool RigctldParser::next(RigctldReply &reply)
+{
+    int i=buffer.indexOf("RPRT ",scanPos);
+    if (i==-1) {
+        // "RPRT " may be split across two reads: back up a little for next scan
+        scanPos=qMax(0,buffer.size()-4);
+        return false;
+    }
+    int j=i+5;
+    if (j<buffer.size() && buffer.at(j)=='-') j++;
+    while (j<buffer.size() && isdigit(buffer.at(j))) j++;
+    if (j>=buffer.size()) {
+        // return code not terminated yet
+        scanPos=i;
+        return false;
+    }
+    parseFrame(buffer.left(j),reply);
+
+    // j is the terminator (newline or separator)
+    buffer.remove(0,j+1);
+    scanPos=0;
+    return true;
+}
+
+/*! parse one complete reply frame
+ */
+void RigctldParser::parseFrame(const QByteArray &frame, RigctldReply &reply)
+{
+    reply.cmd.clear();
+    reply.arg.clear();
+    reply.values.clear();
+    reply.status=0;
+
+    QByteArray f=frame;
+    f.replace('\n',';');
+    QList<QByteArray> fields=f.split(';');
+    bool first=true;
+    for (int i=0;i<fields.size();i++) {
+        QByteArray field=fields.at(i).trimmed();
+        if (field.isEmpty()) continue;
+        if (field.startsWith("RPRT ")) {
+            reply.status=field.mid(5).toInt();
+            break;
+        }
+        int k=field.indexOf(':');
+        if (first) {
+            first=false;
+            if (k!=-1) {
+                // command echo, for example "get_freq:" or "get_level: ifctr"
+                reply.cmd=field.left(k);
+                reply.arg=field.mid(k+1).trimmed();
+                continue;
+            }
+        }
+        // values are either "Key: value" or plain values
+        if (k!=-1) {
+            reply.values.append(field.mid(k+1).trimmed());
+        } else {
+            reply.values.append(field);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef RIGCTLD_H
+#define RIGCTLD_H
+
+#include <QByteArray>
+#include <QList>
+
+/*!
+   One reply from rigctld in extended response mode (commands prefixed with ";\").
+
+   "get_freq:;Frequency: 28009360;RPRT 0" gives cmd="get_freq", values={"28009360"}, status=0
+   "get_level: ifctr;8212940.000000;RPRT 0" gives cmd="get_level", arg="ifctr", values={"8212940.000000"}
+ */
+class RigctldReply
+{
+public:
+    QByteArray        cmd;
+    QByteArray        arg;
+    QList<QByteArray> values;
+    int               status;
+};
+
+/*!
+   Splits the rigctld byte stream into replies.
+
+   Data arrives in arbitrary chunks: a read may hold part of a reply or several
+   pipelined replies. Every extended reply ends with a "RPRT n" line, which is
+   used as the frame terminator.
+ */
+class RigctldParser
+{
+public:
+    RigctldParser();
+    void append(const QByteArray &data);
+    void clear();
+    bool next(RigctldReply &reply);
+
+private:
+    QByteArray buffer;
+    int        scanPos;
+
+    static void parseFrame(const QByteArray &frame, RigctldReply &reply);
+};
+
+#endif // RIGCTLD_H
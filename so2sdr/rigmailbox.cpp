@@ -0,0 +1,161 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <string.h>
+#include "rigmailbox.h"
+
+/*
+   The queue is the intrusive MPSC queue of D. Vyukov: producers exchange the head
+   pointer and then link the previous head to the new node. The consumer follows
+   next pointers from tail. A stub node keeps the list from ever being empty.
+ */
+RigMailbox::RigMailbox()
+{
+    stub.next.storeRelease(nullptr);
+    head.storeRelease(&stub);
+    tail=&stub;
+    wake.storeRelease(0);
+}
+
+RigMailbox::~RigMailbox()
+{
+    Node *n;
+    while ((n=pop())) delete n;
+}
+
+void RigMailbox::push(Node *n)
+{
+    n->next.storeRelease(nullptr);
+    Node *prev=head.fetchAndStoreOrdered(n);
+    prev->next.storeRelease(n);
+}
+
+/*! remove one node. Returns null if empty, or if a producer is between the two
+ * steps of push (that producer will wake the consumer again)
+ */
+RigMailbox::Node *RigMailbox::pop()
+{
+    Node *t=tail;
+    Node *next=t->next.loadAcquire();
+    if (t==&stub) {
+        if (!next) return nullptr;
+        tail=next;
+        t=next;
+        next=next->next.loadAcquire();
+    }
+    if (next) {
+        tail=next;
+        return t;
+    }
+    if (t!=head.loadAcquire()) return nullptr;
+    push(&stub);
+    next=t->next.loadAcquire();
+    if (next) {
+        tail=next;
+        return t;
+    }
+    return nullptr;
+}
+
+/*! queue a command. Safe to call from any thread.
+
+  returns true if the consumer needs to be woken up
+ */
+bool RigMailbox::post(const RigCommand &cmd)
+{
+    Node *n=new Node;
+    n->cmd=cmd;
+    push(n);
+    return wake.testAndSetOrdered(0,1);
+}
+
+/*! take all queued commands. Radio thread only.
+
+   A command that directly follows one of the same type is merged into it: the
+   later qsy or mode change replaces the earlier one, and repeated PTT or RIT
+   requests are dropped. Commands are never moved past a different command, so a
+   qsy queued before PTT is still done before the rig is keyed.
+ */
+void RigMailbox::take(QList<RigCommand> &cmds)
+{
+    cmds.clear();
+    wake.storeRelease(0);
+    Node *n;
+    while ((n=pop())) {
+        const RigCommand cmd=n->cmd;
+        delete n;
+        if (cmds.isEmpty() || cmds.last().type!=cmd.type) {
+            cmds.append(cmd);
+            continue;
+        }
+        switch (cmd.type) {
+        case RigQsy:
+        case RigMode:
+            cmds.last()=cmd;
+            break;
+        case RigClearRit:
+        case RigPttOn:
+        case RigPttOff:
+            break;
+        }
+    }
+}
+
+RigStateSnapshot::RigStateSnapshot()
+{
+    seq.storeRelease(0);
+    freq.storeRelease(0);
+    mode.storeRelease(RIG_MODE_NONE);
+    ifFreq.storeRelease(0);
+    time.storeRelease(0);
+}
+
+/*! publish new state. Must only be called from one thread
+ */
+void RigStateSnapshot::publish(const RigState &state)
+{
+    // double is stored by bit pattern so the value is exact
+    qint64 f;
+    memcpy(&f,&state.freq,sizeof(f));
+
+    seq.fetchAndAddOrdered(1);
+    freq.storeRelease(f);
+    mode.storeRelease((quint64)state.mode);
+    ifFreq.storeRelease(state.ifFreq);
+    time.storeRelease(state.time);
+    seq.fetchAndAddOrdered(1);
+}
+
+/*! returns a consistent copy of the last published state
+ */
+RigState RigStateSnapshot::read() const
+{
+    RigState state;
+    int s1,s2;
+    qint64 f;
+    do {
+        s1=seq.loadAcquire();
+        f=freq.loadAcquire();
+        state.mode=(rmode_t)mode.loadAcquire();
+        state.ifFreq=ifFreq.loadAcquire();
+        state.time=time.loadAcquire();
+        s2=seq.loadAcquire();
+    } while ((s1&1) || s1!=s2);
+    memcpy(&state.freq,&f,sizeof(f));
+    return state;
+}
@@ -0,0 +1,108 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef RIGMAILBOX_H
+#define RIGMAILBOX_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QList>
+#include <hamlib/rig.h>
+
+typedef enum RigCommandType {
+    RigQsy      = 0,
+    RigMode     = 1,
+    RigPttOn    = 2,
+    RigPttOff   = 3,
+    RigClearRit = 4
+} RigCommandType;
+
+/*!
+   one command for a radio
+ */
+typedef struct RigCommand {
+    RigCommandType type;
+    double         freq;
+    rmode_t        mode;
+    pbwidth_t      passband;
+} RigCommand;
+Q_DECLARE_TYPEINFO(RigCommand, Q_PRIMITIVE_TYPE);
+
+/*!
+   radio state published by the radio thread
+ */
+typedef struct RigState {
+    double  freq;
+    rmode_t mode;
+    int     ifFreq;
+    qint64  time;
+} RigState;
+Q_DECLARE_TYPEINFO(RigState, Q_PRIMITIVE_TYPE);
+
+/*!
+   Lock-free multiple producer/single consumer command queue
+
+   Any thread may post(); only the radio thread calls take(). post() returns true
+   when the consumer has to be woken up, so at most one wakeup is pending at a time.
+ */
+class RigMailbox
+{
+public:
+    RigMailbox();
+    ~RigMailbox();
+    bool post(const RigCommand &cmd);
+    void take(QList<RigCommand> &cmds);
+
+private:
+    class Node
+    {
+    public:
+        QAtomicPointer<Node> next;
+        RigCommand           cmd;
+    };
+
+    Node                 stub;
+    Node                 *tail;
+    QAtomicPointer<Node> head;
+    QAtomicInt           wake;
+
+    Node *pop();
+    void push(Node *n);
+};
+
+/*!
+   Radio state snapshot with one writer (the radio thread) and any number of
+   readers. Readers never block; a read that overlaps a write is retried.
+ */
+class RigStateSnapshot
+{
+public:
+    RigStateSnapshot();
+    void publish(const RigState &state);
+    RigState read() const;
+
+private:
+    QAtomicInt              seq;
+    QAtomicInteger<qint64>  freq;
+    QAtomicInteger<quint64> mode;
+    QAtomicInt              ifFreq;
+    QAtomicInteger<qint64>  time;
+};
+
+#endif // RIGMAILBOX_H
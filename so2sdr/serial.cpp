@@ -19,6 +19,7 @@
 #include "defines.h"
 #include "serial.h"
 #include <stdio.h>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
@@ -76,23 +77,25 @@ RigSerial::RigSerial(int nr,QString s)
         }
     }
     settings=0;
-    for (int i=0;i<nRigSerialTimers;i++) timerId[i]=0;
+    pollTimerId=0;
+    changeTimerId=0;
+    changedFreq=0;
+    changedMode=RIG_MODE_NONE;
+    changedTime=0;
+    changeDetected=0;
+    pollInterval=0;
+    slowPollInterval=0;
+    pollsPending=0;
+    lastFreqChange=0;
+    useRigctld=false;
     rig=0;
     socket=0;
-    pttOffFlag=    false;
-    pttOnFlag=     false;
-    clearRitFlag = 0;
-    qsyFreq      = 0;
-    chgMode      = RIG_MODE_NONE;
-    radioOK      = false;
+    radioOK.storeRelease(0);
     ifFreq_      = 0;
-    passBW      = 0;
     Mode=RIG_MODE_NONE;
     rigFreq=0;
     model=1;
-    lock.unlock();
-    pttMutex.unlock();
-    lock.unlock();
+    publishState();
 }
 
 /*! static function passed to rig_list_foreach
@@ -218,18 +221,33 @@ RigSerial::~RigSerial()
 void RigSerial::run()
 {
     if (!settings) settings=new QSettings(settingsFile,QSettings::IniFormat);
+    clock.start();
+    lastFreqChange=-RIG_FAST_POLL_HOLD;
     openRig();
     openSocket();
-    timerId[0] = startTimer(settings->value(s_radios_poll[nrig],500).toInt());
-    timerId[1] = startTimer(RIG_SEND_TIMER);
+    if (pollTimerId) killTimer(pollTimerId);
+    slowPollInterval=settings->value(s_radios_poll[nrig],s_radios_poll_def[nrig]).toInt();
+    pollInterval=slowPollInterval;
+    pollTimerId=startTimer(pollInterval);
+
+    // send anything requested before the radio was opened
+    processCommands();
 }
 
 /*! stop timers
  */
 void RigSerial::stopSerial()
 {
-    for (int i = 0; i < nRigSerialTimers; i++) {
-        killTimer(timerId[i]);
+    if (pollTimerId) {
+        killTimer(pollTimerId);
+        pollTimerId=0;
+    }
+    if (changeTimerId) {
+        killTimer(changeTimerId);
+        changeTimerId=0;
+    }
+    if (cmdLatency.count()) {
+        qDebug("%s",latencySummary().toLatin1().data());
     }
 }
 
@@ -238,213 +256,321 @@ void RigSerial::stopSerial()
  */
 void RigSerial::setPtt(int state)
 {
-    pttMutex.lock();
-    if (state) {
-        pttOnFlag=true;
+    RigCommand cmd;
+    cmd.type=state ? RigPttOn : RigPttOff;
+    post(cmd);
+}
+
+/*! queue a command and make sure processCommands runs in the radio thread.
+ * Commands are sent as soon as they are requested rather than waiting for a timer
+ */
+void RigSerial::post(const RigCommand &cmd)
+{
+    if (mailbox.post(cmd)) {
+        QMetaObject::invokeMethod(this,"processCommands",Qt::QueuedConnection);
+    }
+}
+
+/*! publish freq, mode, and IF offset for readers in other threads. Radio thread only
+ */
+void RigSerial::publishState()
+{
+    RigState state;
+    state.freq=rigFreq;
+    state.mode=Mode;
+    state.ifFreq=ifFreq_;
+    state.time=QDateTime::currentMSecsSinceEpoch();
+    snapshot.publish(state);
+    checkChanged();
+}
+
+/*! emit rigChanged if frequency or mode changed. While the radio is being tuned the
+ * signal is sent at most every RIG_CHANGE_DEBOUNCE ms; the final value is always sent
+ */
+void RigSerial::checkChanged()
+{
+    if (rigFreq==changedFreq && Mode==changedMode) return;
+    if (!clock.isValid()) return;
+    if (!changeDetected) changeDetected=monotonicUsec();
+    if (changeTimerId) return;
+    qint64 dt=clock.elapsed()-changedTime;
+    if (dt>=RIG_CHANGE_DEBOUNCE) {
+        emitChanged();
     } else {
-        pttOffFlag=true;
+        changeTimerId=startTimer(RIG_CHANGE_DEBOUNCE-dt);
     }
-    pttMutex.unlock();
+}
+
+void RigSerial::emitChanged()
+{
+    changedFreq=rigFreq;
+    changedMode=Mode;
+    changedTime=clock.elapsed();
+    qint64 t=changeDetected;
+    changeDetected=0;
+    emit(rigChanged(nrig,rigFreq,(quint64)Mode,t));
 }
 
 /*!
-   process timer events
+   process timer events: radio poll and debounce of rigChanged
  */
 void RigSerial::timerEvent(QTimerEvent *event)
 {
-    // using rigctld for this radio
-    if (settings->value(s_radios_rigctld_enable[nrig],s_radios_rigctld_enable_def[nrig]).toBool() &&
-            socket->isOpen()) {
+    if (event->timerId()==pollTimerId) {
+        pollRig();
+        updatePollInterval();
+    } else if (event->timerId()==changeTimerId) {
+        killTimer(changeTimerId);
+        changeTimerId=0;
+        if (rigFreq!=changedFreq || Mode!=changedMode) emitChanged();
+    }
+}
 
-        if (event->timerId() == timerId[0]) {
-            socket->write(";\\get_freq\n");
-            socket->write(";\\get_mode\n");
-            if (model==229) {
-                socket->write(";\\get_level ifctr\n");
-            }
+/*! poll the radio every RIG_FAST_POLL ms while the frequency is changing, otherwise
+ * at the poll rate set in the radio dialog
+ */
+void RigSerial::updatePollInterval()
+{
+    if (!pollTimerId) return;
+    int t=slowPollInterval;
+    if ((clock.elapsed()-lastFreqChange)<RIG_FAST_POLL_HOLD) {
+        t=qMin(RIG_FAST_POLL,slowPollInterval);
+    }
+    if (t!=pollInterval) {
+        killTimer(pollTimerId);
+        pollInterval=t;
+        pollTimerId=startTimer(pollInterval);
+    }
+}
+
+/*! write one command to rigctld and add it to the list of requests awaiting a reply.
+ *
+ * Requests are pipelined: rigctld answers in order, so replies are matched against
+ * the head of the outstanding queue
+ */
+void RigSerial::sendRigctld(const QByteArray &cmd, const QByteArray &args, bool poll)
+{
+    QByteArray out=";\\"+cmd;
+    if (!args.isEmpty()) out=out+" "+args;
+    out=out+"\n";
+    RigctldRequest req;
+    req.cmd=cmd;
+    req.t0=clock.nsecsElapsed();
+    req.poll=poll;
+    outstanding.enqueue(req);
+    if (poll) pollsPending++;
+    socket->write(out);
+}
+
+/*! poll frequency, mode, and IF freq from radio
+ */
+void RigSerial::pollRig()
+{
+    if (useRigctld) {
+        if (!socket || !socket->isOpen()) return;
+        if (!outstanding.isEmpty() &&
+                (clock.nsecsElapsed()-outstanding.head().t0)>RIG_REPLY_TIMEOUT*1000000LL) {
+            // rigctld stopped answering; start over
+            outstanding.clear();
+            pollsPending=0;
+            parser.clear();
         }
-        if (event->timerId() == timerId[1]) {
-            // clear RIT if flag set
-            // behavior of hamlib over serial and via rigctld is different. At least with hamlib/rigctld
-            // v 3.0.1, set_rit 0 does not turn off RIT like docs say.
-            lock.lockForWrite();
-            if (clearRitFlag) {
-                clearRitFlag = false;
-                lock.unlock();
-                socket->write(";\\set_rit 0\n");
-            }
-            lock.unlock();
-            pttMutex.lock();
-            if (pttOnFlag) {
-                pttOnFlag=false;
-                pttMutex.unlock();
-                socket->write(";\\set_ptt 1\n");
-            }
-            pttMutex.unlock();
+        // previous poll not answered yet; don't pile up more
+        if (pollsPending) return;
 
-            pttMutex.lock();
-            if (pttOffFlag) {
-                pttOffFlag=false;
-                pttMutex.unlock();
-                socket->write(";\\set_ptt 0\n");
-            }
-            pttMutex.unlock();
-
-            lock.lockForWrite();
-            if (qsyFreq) {
-                rigFreq = qsyFreq;
-                qsyFreq = 0;
-                lock.unlock();
-                QByteArray cmd=";\\set_freq "+QByteArray::number(rigFreq)+"\n";
-                socket->write(cmd);
-            }
-            lock.lockForWrite();
-            if ((chgMode > RIG_MODE_NONE) && (chgMode < RIG_MODE_TESTS_MAX)) {
-                int j=chgMode;
-                chgMode=RIG_MODE_NONE;
-                lock.unlock();
-                QByteArray width=QByteArray::number((int)passBW)+"\n";
-                switch (j) {
-                case RIG_MODE_CW:
-                    socket->write(";\\set_mode CW "+width);
-                    Mode=RIG_MODE_CW;
-                    break;
-                case RIG_MODE_CWR:
-                    socket->write(";\\set_mode CWR "+width);
-                    Mode=RIG_MODE_CWR;
-                    break;
-                case RIG_MODE_USB:
-                    socket->write(";\\set_mode USB "+width);
-                    Mode=RIG_MODE_USB;
-                    break;
-                case RIG_MODE_LSB:
-                    socket->write(";\\set_mode LSB "+width);
-                    Mode=RIG_MODE_LSB;
-                    break;
-                case RIG_MODE_RTTY:
-                    socket->write(";\\set_mode RTTY "+width);
-                    Mode=RIG_MODE_RTTY;
-                    break;
-                case RIG_MODE_RTTYR:
-                    socket->write(";\\set_mode RTTYR "+width);
-                    Mode=RIG_MODE_RTTYR;
-                    break;
-                case RIG_MODE_FM:
-                    socket->write(";\\set_mode FM "+width);
-                    Mode=RIG_MODE_FM;
-                    break;
-                case RIG_MODE_AM:
-                    socket->write(";\\set_mode AM "+width);
-                    Mode=RIG_MODE_AM;
-                    break;
-                case RIG_MODE_AMS:
-                    socket->write(";\\set_mode AMS "+width);
-                    Mode=RIG_MODE_AMS;
-                    break;
-                case RIG_MODE_DSB:
-                    socket->write(";\\set_mode DSB "+width);
-                    Mode=RIG_MODE_DSB;
-                    break;
-                default:
-                    break;
-                }
-            }
-            lock.unlock();
+        sendRigctld("get_freq",QByteArray(),true);
+        sendRigctld("get_mode",QByteArray(),true);
+        if (model==229) {
+            sendRigctld("get_level","ifctr",true);
+        }
+        return;
+    }
+
+    // using hamlib over serial port
+    if (!radioOK.loadAcquire()) return;
+    freq_t freq;
+    qint64 t0=clock.nsecsElapsed();
+    int    status = rig_get_freq(rig, RIG_VFO_CURR, &freq);
+    if (status == RIG_OK) {
+        cmdLatency.add((clock.nsecsElapsed()-t0)/1000);
+        double ff = Hz(freq);
+        if (ff != 0.0) {
+            if (ff!=rigFreq) lastFreqChange=clock.elapsed();
+            rigFreq = ff;
+        }
+    }
+
+    rmode_t   m;
+    pbwidth_t width;
+    status = rig_get_mode(rig, RIG_VFO_CURR, &m, &width);
+    if (status == RIG_OK) {
+        Mode = m;
+    }
+
+    // if using K3, get IF center frequency
+    if (model == 229) {
+        value_t val;
+        int     status = rig_get_ext_level(rig, RIG_VFO_CURR, confParamsIF->token, &val);
+        if (status == RIG_OK) {
+            ifFreq_ = (int) (val.f - 8210000.0);
         }
+    }
+    publishState();
+}
+
+/*! rigctld mode name for hamlib mode. Returns empty string if mode not supported here
+ */
+static QByteArray rigctldModeName(rmode_t m)
+{
+    switch (m) {
+    case RIG_MODE_CW: return "CW";
+    case RIG_MODE_CWR: return "CWR";
+    case RIG_MODE_USB: return "USB";
+    case RIG_MODE_LSB: return "LSB";
+    case RIG_MODE_RTTY: return "RTTY";
+    case RIG_MODE_RTTYR: return "RTTYR";
+    case RIG_MODE_FM: return "FM";
+    case RIG_MODE_AM: return "AM";
+    case RIG_MODE_AMS: return "AMS";
+    case RIG_MODE_DSB: return "DSB";
+    default: return QByteArray();
+    }
+}
+
+/*!
+   send pending qsy, mode, PTT and RIT commands to the radio. Runs in the radio
+   thread; called whenever a new command is posted
+ */
+void RigSerial::processCommands()
+{
+    if (!settings) return;
+
+    QList<RigCommand> cmds;
+    mailbox.take(cmds);
+
+    // while the radio is not ready only the last qsy and mode change are kept. PTT
+    // and RIT commands are dropped so they are never replayed after a reconnect
+    bool ready;
+    if (useRigctld) {
+        ready=(socket && socket->state()==QAbstractSocket::ConnectedState);
     } else {
-        // using hamlib over serial port
-
-        // timers for sending data to radios (change freq, RIT clear,...)
-        // timerID[1] is polled more frequently than the regular
-        // radio poll timer
-        if (radioOK && event->timerId() == timerId[1]) {
-            // set PTT on
-            pttMutex.lock();
-            if (pttOnFlag) {
-                pttOnFlag=false;
-                pttMutex.unlock();
-                rig_set_ptt(rig,RIG_VFO_CURR,RIG_PTT_ON);
-            }
-            pttMutex.unlock();
-
-            // set PTT off
-            pttMutex.lock();
-            if (pttOffFlag) {
-                pttOffFlag=false;
-                pttMutex.unlock();
-                rig_set_ptt(rig,RIG_VFO_CURR,RIG_PTT_OFF);
-            }
-            pttMutex.unlock();
-
-            // clear RIT if flag set
-            lock.lockForWrite();
-            if (clearRitFlag) {
-                clearRitFlag=false;
-                lock.unlock();
-                if (confParamsRIT) {
-                    value_t val;
-                    val.i = 0;
-                    rig_set_ext_level(rig, RIG_VFO_CURR, confParamsRIT->token, val);
-                } else {
-                    // not preferred, as this turns RIT off completely
-                    rig_set_rit(rig, RIG_VFO_CURR, 0);
-                }
-            }
-            lock.unlock();
-
-            // qsy radio
-            lock.lockForWrite();
-            if (qsyFreq) {
-                double f=qsyFreq;
-                qsyFreq=0;
-                lock.unlock();
-                int status = rig_set_freq(rig, RIG_VFO_CURR, f);
-                if (status == RIG_OK) {
-                    rigFreq = f;
-                }
-            }
-            lock.unlock();
-
-            // change mode on radio
-            lock.lockForWrite();
-            if ((chgMode > RIG_MODE_NONE) && (chgMode < RIG_MODE_TESTS_MAX)) {
-                int status = rig_set_mode(rig, RIG_VFO_CURR, chgMode, passBW);
-                if (status == RIG_OK) {
-                    Mode = chgMode;
-                }
-                chgMode = RIG_MODE_NONE; // reset for next change
-            }
-            lock.unlock();
+        ready=radioOK.loadAcquire();
+    }
+    if (!ready) {
+        holdCommands(cmds);
+        return;
+    }
+    if (!heldCmds.isEmpty()) {
+        cmds=heldCmds+cmds;
+        heldCmds.clear();
+    }
+    if (cmds.isEmpty()) return;
+
+    for (int i=0;i<cmds.size();i++) {
+        const RigCommand &cmd=cmds.at(i);
+
+        // poll fast to follow the radio after a qsy
+        if (cmd.type==RigQsy) lastFreqChange=clock.elapsed();
+        if (useRigctld) {
+            sendCommandRigctld(cmd);
+        } else {
+            sendCommandHamlib(cmd);
         }
+    }
+    publishState();
+    updatePollInterval();
+}
 
-        // poll frequency, mode, and IF freq from radio
-        if (radioOK && event->timerId() == timerId[0]) {
-            freq_t freq;
+/*! keep the last qsy and mode command of cmds in heldCmds, replacing older ones
+ */
+void RigSerial::holdCommands(const QList<RigCommand> &cmds)
+{
+    for (int i=0;i<cmds.size();i++) {
+        const RigCommand &cmd=cmds.at(i);
+        if (cmd.type!=RigQsy && cmd.type!=RigMode) continue;
 
-            int    status = rig_get_freq(rig, RIG_VFO_CURR, &freq);
-            if (status == RIG_OK) {
-                double ff = Hz(freq);
-                if (ff != 0.0) rigFreq = ff;
+        for (int j=0;j<heldCmds.size();j++) {
+            if (heldCmds.at(j).type==cmd.type) {
+                heldCmds.removeAt(j);
+                break;
             }
+        }
+        heldCmds.append(cmd);
+    }
+}
 
-            rmode_t   m;
-            pbwidth_t width;
-            status = rig_get_mode(rig, RIG_VFO_CURR, &m, &width);
-            if (status == RIG_OK) {
-                Mode = m;
+/*! send one command to rigctld
+ */
+void RigSerial::sendCommandRigctld(const RigCommand &cmd)
+{
+    QByteArray name;
+    switch (cmd.type) {
+    case RigClearRit:
+        // behavior of hamlib over serial and via rigctld is different. At least with hamlib/rigctld
+        // v 3.0.1, set_rit 0 does not turn off RIT like docs say.
+        sendRigctld("set_rit","0");
+        break;
+    case RigPttOn:
+        sendRigctld("set_ptt","1");
+        break;
+    case RigPttOff:
+        sendRigctld("set_ptt","0");
+        break;
+    case RigQsy:
+        rigFreq=cmd.freq;
+        sendRigctld("set_freq",QByteArray::number(cmd.freq,'f',0));
+        break;
+    case RigMode:
+        if ((cmd.mode > RIG_MODE_NONE) && (cmd.mode < RIG_MODE_TESTS_MAX)) {
+            name=rigctldModeName(cmd.mode);
+            if (!name.isEmpty()) {
+                sendRigctld("set_mode",name+" "+QByteArray::number((int)cmd.passband));
+                Mode=cmd.mode;
             }
+        }
+        break;
+    }
+}
 
-            // if using K3, get IF center frequency
-            if (model == 229) {
-                value_t val;
-                int     status = rig_get_ext_level(rig, RIG_VFO_CURR, confParamsIF->token, &val);
-                if (status == RIG_OK) {
-                    // no mutex protection since ifFreq is read-only from outside class
-                    ifFreq_ = (int) (val.f - 8210000.0);
-                }
+/*! send one command through hamlib
+ */
+void RigSerial::sendCommandHamlib(const RigCommand &cmd)
+{
+    qint64 t0=clock.nsecsElapsed();
+    int status=RIG_OK;
+    switch (cmd.type) {
+    case RigPttOn:
+        status=rig_set_ptt(rig,RIG_VFO_CURR,RIG_PTT_ON);
+        break;
+    case RigPttOff:
+        status=rig_set_ptt(rig,RIG_VFO_CURR,RIG_PTT_OFF);
+        break;
+    case RigClearRit:
+        if (confParamsRIT) {
+            value_t val;
+            val.i = 0;
+            status=rig_set_ext_level(rig, RIG_VFO_CURR, confParamsRIT->token, val);
+        } else {
+            // not preferred, as this turns RIT off completely
+            status=rig_set_rit(rig, RIG_VFO_CURR, 0);
+        }
+        break;
+    case RigQsy:
+        status = rig_set_freq(rig, RIG_VFO_CURR, cmd.freq);
+        if (status == RIG_OK) {
+            rigFreq = cmd.freq;
+        }
+        break;
+    case RigMode:
+        if ((cmd.mode > RIG_MODE_NONE) && (cmd.mode < RIG_MODE_TESTS_MAX)) {
+            status = rig_set_mode(rig, RIG_VFO_CURR, cmd.mode, cmd.passband);
+            if (status == RIG_OK) {
+                Mode = cmd.mode;
             }
         }
+        break;
     }
+    if (status==RIG_OK) cmdLatency.add((clock.nsecsElapsed()-t0)/1000);
 }
 
 /*!
@@ -452,39 +578,45 @@ void RigSerial::timerEvent(QTimerEvent *event)
  */
 void RigSerial::clearRIT()
 {
-    lock.lockForWrite();
-    clearRitFlag = true;
-    lock.unlock();
+    RigCommand cmd;
+    cmd.type=RigClearRit;
+    post(cmd);
 }
 
 /*! returns true if radio opened successfully
  */
 bool RigSerial::radioOpen()
 {
-    lock.lockForRead();
-    bool b = radioOK;
-    lock.unlock();
-    return(b);
+    return radioOK.loadAcquire();
 }
 
 /*! returns current radio frequency in Hz
  */
 double RigSerial::getRigFreq()
 {
-    lock.lockForRead();
-    double f = rigFreq;
-    lock.unlock();
-    return(f);
+    return snapshot.read().freq;
 }
 
 /*! returns current radio IF frequency (K3 only, others return 0)
  */
 int RigSerial::ifFreq()
 {
-    lock.lockForRead();
-    int f=ifFreq_;
-    lock.unlock();
-    return f;
+    return snapshot.read().ifFreq;
+}
+
+/*! returns freq, mode, IF offset and time of last update in one consistent copy.
+ * Does not block
+ */
+RigState RigSerial::state() const
+{
+    return snapshot.read();
+}
+
+/*! one-line summary of command-to-acknowledge latency for this radio
+ */
+QString RigSerial::latencySummary() const
+{
+    return cmdLatency.summary("radio "+QString::number(nrig+1)+(useRigctld ? " rigctld" : " hamlib"));
 }
 
 /*! returns current radio mode
@@ -493,10 +625,7 @@ int RigSerial::ifFreq()
  */
 rmode_t RigSerial::mode()
 {
-    lock.lockForRead();
-    rmode_t m=Mode;
-    lock.unlock();
-    return m;
+    return snapshot.read().mode;
 }
 
 /*! return string describing the current mode for
@@ -504,9 +633,7 @@ rmode_t RigSerial::mode()
  */
 QString RigSerial::modeStr()
 {
-    lock.lockForRead();
-    rmode_t m=Mode;
-    lock.unlock();
+    rmode_t m=snapshot.read().mode;
     switch (m) {
     case RIG_MODE_NONE: return modes[0];
     case RIG_MODE_AM: return modes[1];
@@ -538,10 +665,7 @@ QString RigSerial::modeStr()
  */
 ModeTypes RigSerial::modeType()
 {
-    lock.lockForRead();
-    rmode_t m=Mode;
-    lock.unlock();
-    return getModeType(m);
+    return getModeType(snapshot.read().mode);
 }
 
 /*! initialize TcpSocket for rigctld
@@ -552,8 +676,12 @@ void RigSerial::openSocket()
         if (socket->isOpen()) socket->close();
         disconnect(socket,0,0,0);
     }
-    if (settings->value(s_radios_rigctld_enable[nrig],s_radios_rigctld_enable_def[nrig]).toBool()) {
-        radioOK=true;
+    parser.clear();
+    outstanding.clear();
+    pollsPending=0;
+    useRigctld=settings->value(s_radios_rigctld_enable[nrig],s_radios_rigctld_enable_def[nrig]).toBool();
+    if (useRigctld) {
+        radioOK.storeRelease(1);
         if (!socket) socket=new QTcpSocket();
 
         // QHostAddress doesn't understand "localhost"
@@ -564,6 +692,7 @@ void RigSerial::openSocket()
             socket->connectToHost(QHostAddress(settings->value(s_radios_rigctld_ip[nrig],s_radios_rigctld_ip_def[nrig]).toString()).toString(),
                                   settings->value(s_radios_rigctld_port[nrig],s_radios_rigctld_port_def[nrig]).toInt());
         }
+        connect(socket,SIGNAL(connected()),this,SLOT(processCommands()));
         connect(socket,SIGNAL(readyRead()),this,SLOT(rxSocket()));
         connect(socket,SIGNAL(error(QAbstractSocket::SocketError)),this,SLOT(tcpError(QAbstractSocket::SocketError)));
     }
@@ -575,12 +704,7 @@ void RigSerial::openSocket()
  */
 void RigSerial::openRig()
 {
-    pttOffFlag=    false;
-    pttOnFlag=     false;
-    clearRitFlag = 0;
-    qsyFreq      = 0;
-    chgMode      = RIG_MODE_NONE;
-    radioOK      = false;
+    radioOK.storeRelease(0);
     ifFreq_      = 0;
     model=settings->value(s_radios_rig[nrig],RIG_MODEL_DUMMY).toInt();
     if (rig) {
@@ -613,6 +737,7 @@ void RigSerial::openRig()
     if (rigFreq==0 && nrig==0) rigFreq = 14000000;
     if (rigFreq==0 && nrig==1) rigFreq = 7000000;
     if (Mode==RIG_MODE_NONE)   Mode = RIG_MODE_CW;
+    publishState();
 
     int r = rig_open(rig);
     if (model == RIG_MODEL_DUMMY) {
@@ -621,7 +746,7 @@ void RigSerial::openRig()
         rig_set_mode(rig, RIG_VFO_A, Mode, RIG_PASSBAND_NORMAL);
     }
     if (r == RIG_OK) {
-        radioOK = true;
+        radioOK.storeRelease(1);
         // get ext params struct for K3 in order to get IF center freq
         if (model == 229) {
             confParamsIF = rig_ext_lookup(rig, "ifctr");
@@ -631,7 +756,7 @@ void RigSerial::openRig()
         confParamsRIT = rig_ext_lookup(rig, "ritclr");
     } else {
         emit(radioError("ERROR: radio "+QString::number(nrig+1)+" could not be opened"));
-        radioOK = false;
+        radioOK.storeRelease(0);
         rig_close(rig);
     }
 }
@@ -641,9 +766,10 @@ void RigSerial::openRig()
  */
 void RigSerial::qsyExact(double f)
 {
-    lock.lockForWrite();
-    qsyFreq = f;
-    lock.unlock();
+    RigCommand cmd;
+    cmd.type=RigQsy;
+    cmd.freq=f;
+    post(cmd);
 }
 
 /*! Set radio mode
@@ -653,10 +779,11 @@ void RigSerial::qsyExact(double f)
  */
 void RigSerial::setRigMode(rmode_t m, pbwidth_t pb)
 {
-    lock.lockForWrite();
-    chgMode = m;
-    passBW = pb;
-    lock.unlock();
+    RigCommand cmd;
+    cmd.type=RigMode;
+    cmd.mode=m;
+    cmd.passband=pb;
+    post(cmd);
 }
 
 /*! shut down radio interface
@@ -664,7 +791,7 @@ void RigSerial::setRigMode(rmode_t m, pbwidth_t pb)
 void RigSerial::closeRig()
 {
     rig_close(rig);
-    radioOK = false;
+    radioOK.storeRelease(0);
 }
 
 /*! send a raw byte string to the radio: careful, there is no checking here!
@@ -704,16 +831,36 @@ void RigSerial::sendRaw(QByteArray cmd)
 
 /*!
  * \brief RigSerial::rxSocket
- * \param nrig
  *
- * Parse data coming from rigctld
+ * Read data coming from rigctld. Data may arrive split or with several pipelined
+ * replies in one read; the parser returns complete replies only.
  */
 void RigSerial::rxSocket()
 {
-    const QByteArray cmdNames[] = { "get_freq:",
-                                    "get_mode:",
-                                    "get_level: ifctr"};
-    const int nCmdNames=3;
+    radioOK.storeRelease(1);
+    parser.append(socket->readAll());
+    RigctldReply reply;
+    while (parser.next(reply)) {
+        // rigctld answers in order. Anything ahead of the matching request was lost
+        while (!outstanding.isEmpty() && outstanding.head().cmd!=reply.cmd) {
+            if (outstanding.dequeue().poll) pollsPending--;
+        }
+        if (outstanding.isEmpty()) continue;
+        RigctldRequest req=outstanding.dequeue();
+        if (req.poll) pollsPending--;
+        cmdLatency.add((clock.nsecsElapsed()-req.t0)/1000);
+        if (reply.status==0) handleReply(reply);
+    }
+}
+
+/*!
+ * \brief RigSerial::handleReply
+ * \param reply parsed reply from rigctld
+ *
+ * Update radio state from get_freq, get_mode and get_level replies
+ */
+void RigSerial::handleReply(const RigctldReply &reply)
+{
     const QByteArray modeNames[]= { "USB",
                                     "LSB",
                                     "CW",
@@ -742,72 +889,52 @@ void RigSerial::rxSocket()
                             RIG_MODE_PKTFM,RIG_MODE_ECSSUSB,RIG_MODE_ECSSLSB,RIG_MODE_FAX,RIG_MODE_SAM,
                             RIG_MODE_SAL,RIG_MODE_SAH,RIG_MODE_DSB};
 
-    radioOK=true;
-    lock.lockForWrite();
-    while (socket->bytesAvailable()) {
-        QByteArray data=socket->readAll();
-        QList<QByteArray> cmdList=data.split(';');
-        bool ok;
-        double f;
-        double iff;
-        for (int i = 0; i < nCmdNames; i++) {
-            if (cmdList.at(0)==cmdNames[i]) {
-                switch (i) {
-                case 0: // get_freq. Response looks like "get_freq:;Frequency: 28009360;RPRT 0"
-                    cmdList[1].remove(0,10);
-                    f=cmdList[1].toDouble(&ok);
-                    if (ok) rigFreq=f;
-                    break;
-                case 1: // get_mode. Response looks like "get_mode:;Mode: CW;Passband: 600;RPRT 0"
-                    cmdList[1].remove(0,5);
-                    cmdList[1]=cmdList[1].simplified();
-                    for (int j=0;j<nModeNames;j++) {
-                        if (cmdList.at(1)==modeNames[j]) {
-                            Mode=modes[j];
-                            break;
-                        }
-                    }
-                    break;
-                case 2: // get IF center (K3). Response looks like "get_level: ifctr;8212940.000000\nRPRT 0"
-                    cmdList[1].truncate(14);
-                    iff=cmdList.at(1).toDouble(&ok);
-                    if (ok) {
-                        ifFreq_ = (int) (iff - 8210000.0);
-                    }
-                    break;
-                }
+    if (reply.values.isEmpty()) return;
+    bool ok;
+    if (reply.cmd=="get_freq") {
+        // "get_freq:;Frequency: 28009360;RPRT 0"
+        double f=reply.values.at(0).toDouble(&ok);
+        if (ok && f!=0.0) {
+            if (f!=rigFreq) lastFreqChange=clock.elapsed();
+            rigFreq=f;
+            publishState();
+        }
+    } else if (reply.cmd=="get_mode") {
+        // "get_mode:;Mode: CW;Passband: 600;RPRT 0"
+        for (int j=0;j<nModeNames;j++) {
+            if (reply.values.at(0)==modeNames[j]) {
+                Mode=modes[j];
+                publishState();
+                break;
             }
         }
+    } else if (reply.cmd=="get_level" && reply.arg=="ifctr") {
+        // get IF center (K3). "get_level: ifctr;8212940.000000;RPRT 0"
+        double iff=reply.values.at(0).toDouble(&ok);
+        if (ok) {
+            ifFreq_ = (int) (iff - 8210000.0);
+            publishState();
+        }
     }
-    lock.unlock();
 }
 
 /*! Slot called on error of tcpsocket of radio 1 (rigctld) */
 void RigSerial::tcpError(QAbstractSocket::SocketError e)
 {
     Q_UNUSED(e)
-    radioOK=false;
+    radioOK.storeRelease(0);
     emit(radioError("ERROR: Rigctld radio "+QString::number(nrig+1)+" "+ socket->errorString().toLatin1()));
 }
 
 
 int RigSerial::band() const
 {
-    // in case caught in the middle of a qsy
-    double f=qsyFreq;
-    if (f!=0) {
-        return getBand(f);
-    } else {
-        return getBand(rigFreq);
-    }
+    return getBand(snapshot.read().freq);
 }
 
 QString RigSerial::bandName()
 {
-    double f=qsyFreq;
-    if (f!=0) {
-        return bandNames[getBand(f)];
-    } else {
-        return bandNames[getBand(rigFreq)];
-    }
+    int b=band();
+    if (b==BAND_NONE) return "";
+    return bandNames[b];
 }
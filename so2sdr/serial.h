@@ -20,15 +20,19 @@
 #define SERIAL_H
 #include <QAbstractSocket>
 #include <QByteArray>
+#include <QElapsedTimer>
 #include <QString>
 #include <QList>
 #include <QObject>
+#include <QQueue>
 #include <QString>
 #include <QTimer>
 #include <QTimerEvent>
-#include <QMutex>
-#include <QReadWriteLock>
+#include <QAtomicInt>
 #include "defines.h"
+#include "latency.h"
+#include "rigctld.h"
+#include "rigmailbox.h"
 #include "utils.h"
 
 // using C rather than C++ bindings for hamlib because I don't
@@ -36,9 +40,28 @@
 #include <hamlib/rig.h>
 #include <hamlib/riglist.h>
 
-// how often to check for commands to be sent to radios
-// Note: setting this to zero will cause 100% CPU when using hamlib dummy rig
-const int RIG_SEND_TIMER=2;
+// radio poll interval (ms) used while the radio is being tuned. When idle the
+// poll interval from the radio dialog is used
+const int RIG_FAST_POLL=50;
+
+// time (ms) to keep polling fast after the last frequency change
+const int RIG_FAST_POLL_HOLD=2000;
+
+// minimum time (ms) between rigChanged signals while tuning
+const int RIG_CHANGE_DEBOUNCE=25;
+
+// time (ms) to wait for rigctld to answer before outstanding requests are dropped
+const int RIG_REPLY_TIMEOUT=2000;
+
+/*!
+   a command sent to rigctld that has not been answered yet
+ */
+typedef struct RigctldRequest {
+    QByteArray cmd;
+    qint64     t0;
+    bool       poll;
+} RigctldRequest;
+Q_DECLARE_TYPEINFO(RigctldRequest, Q_MOVABLE_TYPE);
 
 class hamlibModel
 {
@@ -68,7 +91,9 @@ class QTcpSocket;
 /*!
    Radio serial communications for both radios using Hamlib library.
 
-   note that this class will run in its own QThread
+   note that this class will run in its own QThread. Commands from other threads
+   go through a lock-free mailbox; radio state is read from an atomically
+   published snapshot, so the GUI never waits on the radio thread.
  */
 class RigSerial : public QObject
 {
@@ -88,16 +113,19 @@ public:
     void hamlibModelLookup(int, int&, int&) const;
     QString hamlibMfgName(int i) const;
     int ifFreq();
+    QString latencySummary() const;
     rmode_t mode();
     QString modeStr();
     ModeTypes modeType();
     bool radioOpen();
     void sendRaw(QByteArray cmd);
+    RigState state() const;
 
     static QList<hamlibmfg>        mfg;
     static QList<QByteArray>       mfgName;
 signals:
     void radioError(const QString &);
+    void rigChanged(int nrig, double freq, quint64 mode, qint64 t);
 
 public slots:
     void setPtt(int state);
@@ -110,37 +138,55 @@ protected:
     void timerEvent(QTimerEvent *event);
 
 private slots:
+    void processCommands();
     void rxSocket();
     void tcpError(QAbstractSocket::SocketError e);
 
 private:
     static int list_caps(const struct rig_caps *caps, void *data);
 
-    // number of timers
-    const static int nRigSerialTimers=2;
-
+    void checkChanged();
     void closeRig();
+    void emitChanged();
+    void handleReply(const RigctldReply &reply);
+    void holdCommands(const QList<RigCommand> &cmds);
     void openRig();
     void openSocket();
+    void pollRig();
+    void post(const RigCommand &cmd);
+    void publishState();
+    void sendCommandHamlib(const RigCommand &cmd);
+    void sendCommandRigctld(const RigCommand &cmd);
+    void sendRigctld(const QByteArray &cmd, const QByteArray &args=QByteArray(), bool poll=false);
+    void updatePollInterval();
 
-    bool                    clearRitFlag;
-    bool                    pttOnFlag;
-    bool                    pttOffFlag;
     const struct confparams *confParamsIF;
     const struct confparams *confParamsRIT;
-    double                     qsyFreq;
-    rmode_t                 chgMode;
-    pbwidth_t               passBW;
-    bool                    radioOK;
-    double                     rigFreq;
+    bool                    useRigctld;
+    double                  rigFreq;
     int                     model;
     int                     ifFreq_;
     int                     nrig;
+    int                     pollInterval;
+    int                     slowPollInterval;
+    int                     pollsPending;
+    int                     pollTimerId;
+    int                     changeTimerId;
+    double                  changedFreq;
+    rmode_t                 changedMode;
+    qint64                  changedTime;
+    qint64                  changeDetected;
+    qint64                  lastFreqChange;
     rmode_t                 Mode;
-    QMutex                  pttMutex;
-    QReadWriteLock          lock;
+    LatencyStats            cmdLatency;
+    QAtomicInt              radioOK;
+    QElapsedTimer           clock;
+    QList<RigCommand>       heldCmds;
+    QQueue<RigctldRequest>  outstanding;
     RIG                     *rig;
-    int                     timerId[nRigSerialTimers];
+    RigctldParser           parser;
+    RigMailbox              mailbox;
+    RigStateSnapshot        snapshot;
     QSettings              *settings;
     QString                 settingsFile;
     QTcpSocket             *socket;
@@ -16,6 +16,7 @@
     along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
 
  */
+#include <QBitArray>
 #include <QByteArray>
 #include <QChar>
 #include <QColor>
@@ -23,6 +24,7 @@
 #include <QDebug>
 #include <QDialog>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QErrorMessage>
 #include <QEvent>
 #include <QFile>
@@ -37,6 +39,8 @@
 #include <QMessageBox>
 #include <QPalette>
 #include <QQueue>
+#include <QSaveFile>
+#include <QScrollBar>
 #include <QSettings>
 #include <QSize>
 #include <QStringList>
@@ -49,12 +53,14 @@
 #include "bandmapinterface.h"
 #include "cabrillodialog.h"
 #include "contestoptdialog.h"
+#include "ctyupdater.h"
 #include "cwmessagedialog.h"
 #include "defines.h"
 #include "dupesheet.h"
 #include "filedownloader.h"
 #include "helpdialog.h"
 #include "history.h"
+#include "historybuilder.h"
 #include "keyboardhandler.h"
 #include "log.h"
 #include "master.h"
@@ -81,9 +87,11 @@ So2sdr::So2sdr(QStringList args, QWidget *parent) : QMainWindow(parent)
     initPointers();
     initVariables();
     setUiSize();
+    startup.mark("main window setup");
 
     qRegisterMetaType<rmode_t>("rmode_t");
     qRegisterMetaType<pbwidth_t>("pbwidth_t");
+    qRegisterMetaType<qint64>("qint64");
     qRegisterMetaType<Qso>("Qso");
 
     // check to see if user directory exists
@@ -136,12 +144,17 @@ So2sdr::So2sdr(QStringList args, QWidget *parent) : QMainWindow(parent)
     for (int i=0;i<NRIG;i++) {
         clearWorked(i);
     }
-    MultTextEdit->setReadOnly(true);
-    MultTextEdit->setTextInteractionFlags(Qt::NoTextInteraction);
     MasterTextEdit->setReadOnly(true);
     MasterTextEdit->setDisabled(true);
     TimeDisplay->setText(QDateTime::currentDateTimeUtc().toString("MM-dd hh:mm:ss"));
     updateNrDisplay();
+    ctyUpdater = new CtyUpdater();
+    ctyUpdater->moveToThread(&ctyThread);
+    connect(this, SIGNAL(checkCty(const QByteArray &, const QString &)), ctyUpdater, SLOT(check(const QByteArray &, const QString &)));
+    connect(ctyUpdater, SIGNAL(newVersion(const QString &)), this, SLOT(ctyVersionAvailable(const QString &)));
+    connect(this, SIGNAL(installCty(Cty *)), ctyUpdater, SLOT(install(Cty *)));
+    connect(ctyUpdater, SIGNAL(installed(Cty *, bool, const QString &)), this, SLOT(ctyInstalled(Cty *, bool, const QString &)));
+    ctyThread.start();
     updateCty();
 
     // start radio 1; radio 2 will be started after radiodialog mfg and model info is filled out
@@ -181,6 +194,7 @@ So2sdr::So2sdr(QStringList args, QWidget *parent) : QMainWindow(parent)
     connect(radios, SIGNAL(accepted()), this, SLOT(regrab()));
     connect(radios, SIGNAL(rejected()), this, SLOT(regrab()));
     radios->hide();
+    startup.mark("dialogs");
 
     // move radio 1 to its thread and connect signals
     cat[0]->moveToThread(&catThread[0]);
@@ -188,6 +202,7 @@ So2sdr::So2sdr(QStringList args, QWidget *parent) : QMainWindow(parent)
     connect(cat[0], SIGNAL(radioError(const QString &)), errorBox, SLOT(showMessage(const QString &)));
     connect(this, SIGNAL(qsyExact1(double)), cat[0], SLOT(qsyExact(double)));
     connect(this, SIGNAL(setRigMode1(rmode_t, pbwidth_t)), cat[0], SLOT(setRigMode(rmode_t, pbwidth_t)));
+    connect(cat[0], SIGNAL(rigChanged(int,double,quint64,qint64)), this, SLOT(rigChanged(int,double,quint64,qint64)));
 
     // start radio 2
     cat[1] = new RigSerial(1,settingsFile);
@@ -196,6 +211,7 @@ So2sdr::So2sdr(QStringList args, QWidget *parent) : QMainWindow(parent)
     connect(cat[1], SIGNAL(radioError(const QString &)), errorBox, SLOT(showMessage(const QString &)));
     connect(this, SIGNAL(qsyExact2(double)), cat[1], SLOT(qsyExact(double)));
     connect(this, SIGNAL(setRigMode2(rmode_t, pbwidth_t)), cat[1], SLOT(setRigMode(rmode_t, pbwidth_t)));
+    connect(cat[1], SIGNAL(rigChanged(int,double,quint64,qint64)), this, SLOT(rigChanged(int,double,quint64,qint64)));
 
     wsjtxUDP=new UDPReader(*settings,this);
     connect(wsjtxUDP,SIGNAL(wsjtxQso(Qso *)),this,SLOT(logWsjtx(Qso *)));
@@ -338,8 +354,11 @@ So2sdr::So2sdr(QStringList args, QWidget *parent) : QMainWindow(parent)
     connect(winkey,SIGNAL(cwCanceled()),So2sdrStatusBar,SLOT(clearMessage()));
     connect(winkey,SIGNAL(winkeyError(const QString &)), errorBox, SLOT(showMessage(const QString &)));
     connect(winkey,SIGNAL(finished()),this,SLOT(messageFinished()));
+    connect(winkey,SIGNAL(portWritten()),this,SLOT(cwWritten()));
+    connect(winkey,SIGNAL(echoReceived()),this,SLOT(cwEchoed()));
     startWinkey();
     openRadios();
+    startup.mark("winkey and radios");
     switchAudio(activeRadio);
     switchTransmit(activeRadio);
     callFocus[activeRadio]=true;
@@ -362,6 +381,7 @@ So2sdr::So2sdr(QStringList args, QWidget *parent) : QMainWindow(parent)
     move(settings->value("pos", QPoint(200, 200)).toPoint());
     settings->endGroup();
     show();
+    startup.mark("window shown");
 }
 
 So2sdr::~So2sdr()
@@ -376,11 +396,20 @@ So2sdr::~So2sdr()
         catThread[1].quit();
         catThread[1].wait();
     }
+    if (ctyThread.isRunning()) {
+        ctyThread.quit();
+        ctyThread.wait();
+    }
+    delete ctyUpdater;
+    if (historyBuildThread.isRunning()) {
+        historyBuildThread.quit();
+        historyBuildThread.wait();
+    }
+    if (historyBuilder) delete historyBuilder;
     cat[0]->deleteLater();
     cat[1]->deleteLater();
     stopTwokeyboard();
-    if (kbdHandler[0]) kbdHandler[0]->deleteLater();
-    if (kbdHandler[1]) kbdHandler[1]->deleteLater();
+    if (kbdHandler) kbdHandler->deleteLater();
     delete cabrillo;
     delete radios;
     delete cwMessage;
@@ -420,6 +449,7 @@ void So2sdr::addQso(Qso *qso)
 {
     log->addQso(qso);
     LogTableView->scrollToBottom();
+    if (qso->valid) updateDupesheet(qso->call,qso->band);
 }
 
 /*! updates things depending on contents of Station dialog
@@ -459,6 +489,7 @@ void So2sdr::stationUpdate()
  */
 void So2sdr::settingsUpdate()
 {
+    if (log) log->updateConfig();
     switchAudio(activeRadio);
     switchTransmit(activeRadio);
     if (autoSend) {
@@ -483,6 +514,14 @@ void So2sdr::settingsUpdate()
  */
 void So2sdr::cleanup()
 {
+    if (rigEventLatency.count()) {
+        qDebug("%s",rigEventLatency.summary("radio change to display").toLatin1().data());
+        qDebug("%s",rigEventLatency.histogramSummary("radio change to display").toLatin1().data());
+    }
+    QString trace=cwTrace.summary();
+    if (!trace.isEmpty()) {
+        qDebug("%s",trace.toLatin1().data());
+    }
     saveSpots();
     quit();
 }
@@ -632,6 +671,8 @@ void So2sdr::disableUI()
     actionADIF->setEnabled(false);
     actionCabrillo->setEnabled(false);
     actionHistory->setEnabled(false);
+    actionBuildHistory->setEnabled(false);
+    actionLogBenchmark->setEnabled(false);
     actionHistory->setText("Update history from log");
     grabAction->setEnabled(false);
     actionImport_Cabrillo->setEnabled(false);
@@ -664,6 +705,7 @@ void So2sdr::enableUI()
     actionContestOptions->setEnabled(true);
     actionSave->setEnabled(true);
     actionADIF->setEnabled(true);
+    actionLogBenchmark->setEnabled(true);
     actionCabrillo->setEnabled(true);
     grabAction->setEnabled(true);
     actionImport_Cabrillo->setEnabled(true);
@@ -748,6 +790,10 @@ void So2sdr::setupNewContest(int result)
  */
 void So2sdr::updateOptions()
 {
+    log->updateConfig();
+    // cached log rows show dupe status, which depends on the mobile dupe setting
+    log->delegate()->invalidateCache();
+    LogTableView->viewport()->update();
     if (csettings->value(c_showmode,c_showmode_def).toBool()) {
         LogTableView->setColumnHidden(SQL_COL_MODE, false);
     } else {
@@ -757,18 +803,24 @@ void So2sdr::updateOptions()
     updateMults(activeRadio);
     setEntryFocus();
     startMaster();
-    if (csettings->value(c_historymode,c_historymode_def).toBool()) {
+    if (historyBuilder) {
+        // history file is being rebuilt; historyBuilt reopens or closes it when done
+        actionBuildHistory->setEnabled(false);
+    } else if (csettings->value(c_historymode,c_historymode_def).toBool()) {
         history->startHistory();
         if (history->isOpen()) {
             actionHistory->setEnabled(true);
+            actionBuildHistory->setEnabled(true);
             actionHistory->setText("Update History (" + csettings->value(c_historyfile,c_historyfile_def).toString() + ") from Log");
         } else {
             actionHistory->setEnabled(false);
+            actionBuildHistory->setEnabled(false);
             actionHistory->setText("Update History from Log");
         }
     } else {
         history->stopHistory();
         actionHistory->setEnabled(false);
+        actionBuildHistory->setEnabled(false);
         actionHistory->setText("Update History from Log");
     }
 }
@@ -783,6 +835,7 @@ bool So2sdr::setupContest()
     if (!info.exists()) return false;
     csettings=new QSettings(fileName,QSettings::IniFormat);
     if (!QFile::exists(fileName)) return(false);
+    startup.begin();
 
     // construct dialogs that depend on contest ini file settings
     QString cname=csettings->value(c_contestname,c_contestname_def).toString().toUpper();
@@ -799,10 +852,12 @@ bool So2sdr::setupContest()
     connect(log,SIGNAL(errorMessage(QString)),errorBox,SLOT(showMessage(QString)));
     connect(log,SIGNAL(progressCnt(int)),&progress,SLOT(setValue(int)));
     connect(log,SIGNAL(progressMax(int)),&progress,SLOT(setMaximum(int)));
+    connect(log,SIGNAL(importFinished(int,qint64)),this,SLOT(importFinished(int,qint64)));
     connect(log,SIGNAL(multByBandEnabled(bool)),options->MultsByBandCheckBox,SLOT(setEnabled(bool)));
     connect(log,SIGNAL(update()),this,SLOT(rescore()));
     connect(log,SIGNAL(update()),So2sdrStatusBar,SLOT(clearMessage()));
     log->initializeContest();
+    startup.mark("contest rules and cty");
     // make extra exchange fields inactive/hidden. Focus sent exchange entry
     for (int i=log->nExch();i<4;i++) {
         options->sent[i]->setEnabled(false);
@@ -832,14 +887,18 @@ bool So2sdr::setupContest()
     }
     history = new History(*csettings,this);
     connect(history,SIGNAL(message(const QString&,int)),So2sdrStatusBar,SLOT(showMessage(const QString&,int)));
+    connect(history,SIGNAL(errorMessage(const QString&)),errorBox,SLOT(showMessage(const QString&)));
     connect(log,SIGNAL(addQsoHistory(const Qso*)),history,SLOT(addQso(const Qso*)));
+    connect(history,SIGNAL(ready()),this,SLOT(historyReady()));
     if (csettings->value(c_historymode,c_historymode_def).toBool()) {
         history->startHistory();
         if (history->isOpen()) {
             actionHistory->setEnabled(true);
+            actionBuildHistory->setEnabled(true);
             actionHistory->setText("Update History (" + csettings->value(c_historyfile,c_historyfile_def).toString() + ") from Log");
         } else {
             actionHistory->setEnabled(false);
+            actionBuildHistory->setEnabled(false);
             actionHistory->setText("Update History from Log");
         }
     }
@@ -850,7 +909,9 @@ bool So2sdr::setupContest()
     station->SunLabel->setText("Sunrise/Sunset: " +log->ctyPtr()->mySunTimes() + " z");
     master = new Master();
     connect(master, SIGNAL(masterError(const QString &)), errorBox, SLOT(showMessage(const QString &)));
+    connect(master, SIGNAL(ready()), this, SLOT(masterReady()));
     startMaster();
+    startup.mark("history and master started");
     qso[0] = new Qso(log->nExch());
     qso[1] = new Qso(log->nExch());
     for (int i = 0; i < log->nExch(); i++) {
@@ -859,6 +920,7 @@ bool So2sdr::setupContest()
     }
     QDir::setCurrent(contestDirectory);
     log->openLogFile(fileName,false);
+    startup.mark("log file read");
     QString name=csettings->value(c_contestname,c_contestname_def).toString().toUpper();
     int     indx = fileName.lastIndexOf("/");
     QString tmp  = fileName.mid(indx + 1, fileName.size() - indx);
@@ -874,8 +936,10 @@ bool So2sdr::setupContest()
     callFocus[activeRadio]=true;
     setEntryFocus();
     initLogView();
+    startup.mark("log view");
     loadSpots();
     rescore();
+    startup.mark("rescore");
     connect(actionADIF, SIGNAL(triggered()), this, SLOT(exportADIF()));
     connect(actionCabrillo, SIGNAL(triggered()), this, SLOT(showCabrillo()));
     connect(actionCabrillo,SIGNAL(triggered()),this,SLOT(ungrab()));
@@ -884,6 +948,10 @@ bool So2sdr::setupContest()
     connect(cabrillo,SIGNAL(accepted()),this,SLOT(regrab()));
     connect(cabrillo,SIGNAL(rejected()),this,SLOT(regrab()));
     connect(actionHistory, SIGNAL(triggered()), this, SLOT(updateHistory()));
+    connect(actionBuildHistory, SIGNAL(triggered()), this, SLOT(buildHistory()));
+    connect(actionLogBenchmark, SIGNAL(triggered()), this, SLOT(logScrollBenchmark()));
+    connect(actionStartupPerformance, SIGNAL(triggered()), this, SLOT(showPerformance()));
+    connect(actionCwLatency, SIGNAL(triggered()), this, SLOT(showCwLatency()));
     nrSent = log->rowCount()+1;
     updateNrDisplay();
     updateBreakdown();
@@ -898,6 +966,7 @@ bool So2sdr::setupContest()
     // now allow log columns to be resized
     LogTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
     enableUI();
+    startup.mark("contest ready");
     emit(contestReady());
     return(true);
 }
@@ -910,15 +979,112 @@ bool So2sdr::setupContest()
 void So2sdr::startMaster()
 {
     if (csettings->value(c_mastermode,c_mastermode_def).toBool()) {
-        QDir::setCurrent(dataDirectory());
+        // file is read in the background; errors are reported by Master::masterError
         QString filename=csettings->value(c_masterfile,c_masterfile_def).toString();
-        QFile file(filename);
-        if (file.open(QIODevice::ReadOnly)) {
-            master->initialize(file);
-        } else {
-            errorBox->showMessage("ERROR: can't open file " + filename);
+        master->load(QDir(dataDirectory()).absoluteFilePath(filename));
+    }
+}
+
+/*!
+ * \brief So2sdr::buildHistory
+ * rebuild the history file from past logs, call history files, etc. The files
+ * are read in historyBuildThread; historyBuilt is called when done
+ */
+void So2sdr::buildHistory()
+{
+    if (historyBuilder) {
+        So2sdrStatusBar->showMessage("History is already being built", 3000);
+        return;
+    }
+    QStringList files = QFileDialog::getOpenFileNames(this, tr("Build history from logs"), contestDirectory,
+                                                      tr("Logs (*.log *.cbr *.adi *.adif *.txt *.csv);;All Files (*)"));
+    if (files.isEmpty()) return;
+
+    // received fields of so2sdr and Cabrillo logs are taken to match the current contest
+    QList<FieldTypes> types;
+    for (int i = 0; i < log->nExch(); i++) {
+        types.append(log->exchType(i));
+    }
+    historyBuilder = new HistoryBuilder();
+    historyBuilder->setExchange(types);
+    for (int i = 0; i < files.size(); i++) {
+        historyBuilder->addFile(files.at(i));
+    }
+    historyBuilder->moveToThread(&historyBuildThread);
+    connect(this,SIGNAL(buildHistoryFile(const QString&)),historyBuilder,SLOT(build(const QString&)));
+    connect(historyBuilder,SIGNAL(progressCnt(int)),&progress,SLOT(setValue(int)));
+    connect(historyBuilder,SIGNAL(progressMax(int)),&progress,SLOT(setMaximum(int)));
+    connect(historyBuilder,SIGNAL(message(const QString&)),So2sdrStatusBar,SLOT(showMessage(const QString&)));
+    connect(historyBuilder,SIGNAL(finished(bool)),this,SLOT(historyBuilt(bool)));
+    progress.setLabelText("Building history");
+    progress.setWindowModality(Qt::NonModal);
+    progress.setMinimumDuration(1000);
+    progress.setValue(0);
+    actionBuildHistory->setEnabled(false);
+
+    // history file is closed while it is rewritten; qsos logged meanwhile are kept
+    history->pauseHistory();
+    historyBuildThread.start();
+    emit(buildHistoryFile(userDirectory() + "/" + csettings->value(c_historyfile,c_historyfile_def).toString()));
+}
+
+/*!
+ * \brief So2sdr::historyBuilt history file build finished: reopen the history file, or
+ * close it if history was turned off during the build
+ */
+void So2sdr::historyBuilt(bool ok)
+{
+    Q_UNUSED(ok)
+    historyBuildThread.quit();
+    historyBuildThread.wait();
+    delete historyBuilder;
+    historyBuilder = 0;
+    progress.reset();
+    if (!history || !csettings) return;
+
+    // history options may have changed during the build
+    if (csettings->value(c_historymode,c_historymode_def).toBool()) {
+        history->startHistory();
+        actionHistory->setEnabled(history->isOpen());
+        if (history->isOpen()) {
+            actionHistory->setText("Update History (" + csettings->value(c_historyfile,c_historyfile_def).toString() + ") from Log");
+        }
+    } else {
+        history->stopHistory();
+        actionHistory->setEnabled(false);
+        actionHistory->setText("Update History from Log");
+    }
+    actionBuildHistory->setEnabled(true);
+}
+
+/*!
+ * \brief So2sdr::logScrollBenchmark
+ * page through the whole log display, first with the display cache empty and
+ * then with it filled, and report the time per page
+ */
+void So2sdr::logScrollBenchmark()
+{
+    QScrollBar *bar=LogTableView->verticalScrollBar();
+    const int start=bar->value();
+    qint64 ns[2];
+    int pages=0;
+    for (int pass=0;pass<2;pass++) {
+        if (pass==0) log->delegate()->invalidateCache();
+        QElapsedTimer timer;
+        timer.start();
+        pages=0;
+        for (int v=bar->minimum();;v+=qMax(1,bar->pageStep())) {
+            bar->setValue(qMin(v,bar->maximum()));
+            LogTableView->viewport()->repaint();
+            pages++;
+            if (v>=bar->maximum()) break;
         }
+        ns[pass]=timer.nsecsElapsed();
     }
+    bar->setValue(start);
+    const QString msg=QString("Log display: %1 rows, %2 pages, %3 ms/page uncached, %4 ms/page cached").arg(
+                log->rowCount()).arg(pages).arg(ns[0]/1.0e6/pages,0,'f',2).arg(ns[1]/1.0e6/pages,0,'f',2);
+    So2sdrStatusBar->showMessage(msg,10000);
 }
 
 /*!
@@ -962,10 +1128,11 @@ void So2sdr::exportADIF()
         }
         msg->deleteLater();
     }
-    if (!adifFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    QSaveFile adifOut(afname);
+    if (!adifOut.open(QIODevice::WriteOnly | QIODevice::Text)) {
         return;
     }
-    if (log->exportADIF(&adifFile)) {
+    if (log->exportADIF(&adifOut) && adifOut.commit()) {
         So2sdrStatusBar->showMessage("Saved ADIF " + afname, 3000);
     } else {
         So2sdrStatusBar->showMessage("error creating ADIF " + afname, 3000);
@@ -1026,36 +1193,63 @@ void So2sdr::exportCabrillo()
         }
         msg->deleteLater();
     }
-    if (!cbrFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    // write to a temporary file which replaces the old one only if the export succeeds
+    QSaveFile cbrOut(cfname);
+    if (!cbrOut.open(QIODevice::WriteOnly | QIODevice::Text)) {
         So2sdrStatusBar->showMessage("Can't write Cabrillo file " + cfname, 3000);
         return;
     }
-    cabrillo->writeHeader(&cbrFile,log->score());
-    log->exportCabrillo(&cbrFile,settings->value(s_call,s_call_def).toString(),
+    cabrillo->writeHeader(&cbrOut,log->score());
+    if (log->exportCabrillo(&cbrOut,settings->value(s_call,s_call_def).toString(),
                           csettings->value(c_sentexch1,c_sentexch1_def).toString(),
                           csettings->value(c_sentexch2,c_sentexch2_def).toString(),
                           csettings->value(c_sentexch3,c_sentexch3_def).toString(),
-                          csettings->value(c_sentexch4,c_sentexch4_def).toString());
-    So2sdrStatusBar->showMessage("Saved Cabrillo " + cfname, 3000);
+                          csettings->value(c_sentexch4,c_sentexch4_def).toString()) && cbrOut.commit()) {
+        So2sdrStatusBar->showMessage("Saved Cabrillo " + cfname, 3000);
+    } else {
+        So2sdrStatusBar->showMessage("error creating Cabrillo " + cfname, 3000);
+    }
 }
 
 
-/*! import a Cabrillo log
+/*! import a Cabrillo or ADIF log
+
+  the file is read in a separate thread; importFinished is called when done
  */
 void So2sdr::importCabrillo()
 {
     QDir::setCurrent(contestDirectory);
-    QString cabFile = QFileDialog::getOpenFileName(this,tr("Import Cabrillo log"), contestDirectory, tr("Cabrillo Files (*.cbr)"));
+    QString cabFile = QFileDialog::getOpenFileName(this,tr("Import log"), contestDirectory,
+                                                   tr("Cabrillo Files (*.cbr);;ADIF Files (*.adi *.adif)"));
     if (cabFile.isEmpty()) return;
 
-    progress.setLabelText("Importing Cabrillo");
+    progress.setLabelText("Importing log");
     progress.setWindowModality(Qt::WindowModal);
     progress.setMinimumDuration(1000);
     progress.setValue(0);
 
-    log->importCabrillo(cabFile);
+    log->importLog(cabFile);
+}
+
+/*! update display after log import
+
+  nqso is the number of qsos imported, ms the time taken by the whole import
+ */
+void So2sdr::importFinished(int nqso, qint64 ms)
+{
+    if (nqso) {
+        So2sdrStatusBar->showMessage("Imported " + QString::number(nqso) + " qsos in " + QString::number(ms / 1000.0, 'f', 1) +
+                                     " s (" + QString::number(ms ? qRound64(nqso * 1000.0 / ms) : 0) + " qsos/s)", 5000);
+    }
     LogTableView->scrollToBottom();
     nrSent = log->rowCount()+1;
+    updateNrDisplay();
+    updateBreakdown();
+    updateMults(activeRadio);
+    if (nDupesheet()) {
+        for (int i=0;i<NRIG;i++) dupesheet[i]->setBand(BAND_NONE);
+        populateDupesheet();
+    }
 }
 
 
@@ -1229,6 +1423,62 @@ void So2sdr::about()
     regrab();
 }
 
+/*!
+ * \brief So2sdr::showPerformance show time taken by each phase of startup
+ */
+void So2sdr::showPerformance()
+{
+    ungrab();
+    aboutOn=true;
+    QMessageBox::information(this, "Startup Performance", startup.report());
+    aboutOn=false;
+    regrab();
+}
+
+/*!
+ * \brief So2sdr::showCwLatency show latency of each stage of CW sent from the keyboard
+ */
+void So2sdr::showCwLatency()
+{
+    ungrab();
+    aboutOn=true;
+    QMessageBox::information(this, "CW Latency", "<p>Time from key press to each stage (ms)</p>" + cwTrace.report());
+    aboutOn=false;
+    regrab();
+}
+
+/*!
+ * \brief So2sdr::cwWritten bytes have been written to the Winkey port
+ */
+void So2sdr::cwWritten()
+{
+    cwTrace.mark(CwTraceWritten);
+}
+
+/*!
+ * \brief So2sdr::cwEchoed Winkey has echoed a character
+ */
+void So2sdr::cwEchoed()
+{
+    cwTrace.mark(CwTraceEcho);
+}
+
+/*!
+ * \brief So2sdr::masterReady master file has been read in the background
+ */
+void So2sdr::masterReady()
+{
+    startup.markBackground("master file");
+}
+
+/*!
+ * \brief So2sdr::historyReady history file has been read in the background
+ */
+void So2sdr::historyReady()
+{
+    startup.markBackground("history file");
+}
+
 /*! update rate display.
  */
 void So2sdr::updateRate()
@@ -1286,11 +1536,11 @@ void So2sdr::timerEvent(QTimerEvent *event)
         if (duelingCQMode) duelingCQ();
         if (autoSend) autoSendExch();
     } else if (event->timerId() == timerId[1]) {
-        // radio updates; every 300 mS
-        // (the actual serial poll time is set in serial.cpp and may be different)
+        // radio status; freq and mode changes are handled in rigChanged as
+        // soon as the radio reports them
         updateRadioFreq();
 
-        // check bandmap
+        // check bandmap for spots added while the radio is not moving
         checkSpot(0);
         checkSpot(1);
     } else if (event->timerId() == timerId[0]) {
@@ -1303,11 +1553,6 @@ void So2sdr::timerEvent(QTimerEvent *event)
         // check bandmap tcp connection
         bandmap->connectTcp();
 
-        // update dupsheet
-        if (nDupesheet()) {
-            populateDupesheet();
-        }
-
         // update bandmap calls
         decaySpots();
     }
@@ -1654,6 +1899,7 @@ void So2sdr::switchTransmit(int r, int CWspeed)
         autoSendPause=false;
         winkey->switchTransmit(r);
         so2r->switchTransmit(r);
+        if (keyTime) cwTrace.mark(CwTraceRadio,keyTime);
     }
     so2r->updateIndicators(activeRadio);
     activeTxRadio = r;
@@ -1688,6 +1934,10 @@ void So2sdr::switchRadios(bool switchcw)
     MasterTextEdit->clear();
     updateRadioFreq();
     updateBreakdown();
+    // a single dupesheet follows the active radio
+    if (nDupesheet()==1) {
+        populateDupesheet();
+    }
     /*!
        @todo Implement option of mults display following non-active radio
      */
@@ -2148,9 +2398,10 @@ void So2sdr::updateBreakdown()
         n+=log->columnCount(i);
         qsoLabel[i]->setNum(log->columnCount(i));
     }
+    const ContestConfig &cfg=log->contestConfig();
     int nm[2]={0,0};
     int nb[2]={0,0};
-    for (int ii = 0; ii < csettings->value(c_nmulttypes,c_nmulttypes_def).toInt(); ii++) {
+    for (int ii = 0; ii < cfg.nMultTypes; ii++) {
         for (int i = 0; i < N_BANDS; i++) {
             int m=log->nMultsColumn(i,ii);
             nm[ii] += m;
@@ -2161,14 +2412,14 @@ void So2sdr::updateBreakdown()
 
         // for contests where mults are not per-band
         nb[ii] += log->nMultsBWorked(ii, N_BANDS);
-        if (csettings->value(c_multsband,c_multsband_def).toBool()) {
+        if (cfg.multsBand) {
             multTotal[ii]->setNum(nm[ii]);
         } else {
             multTotal[ii]->setNum(nb[ii]);
         }
     }
     TotalQsoLabel->setNum(n);
-    ScoreLabel->setText(QString::number(log->score()) + " pts");
+    ScoreLabel->setText(QString::number(log->scoreSummary().score) + " pts");
 }
 
 
@@ -2186,45 +2437,36 @@ void So2sdr::updateMults(int ir,int bandOverride)
     // in case tuned out of a ham band
     if (band==BAND_NONE) return;
 
-    MultTextEdit->clear();
-    if (!csettings->value(c_showmults,c_showmults_def).toBool()) return;
+    if (!csettings->value(c_showmults,c_showmults_def).toBool()) {
+        MultTextEdit->clear();
+        return;
+    }
 
-    QList<QByteArray> neededMults;
+    const ContestConfig &cfg=log->contestConfig();
+    const int n=log->nMults(multMode);
     QList<QByteArray> mults;
-    mults.clear();
-    neededMults.clear();
-    for (int i = 0; i < log->nMults(multMode); i++) {
+    QBitArray neededMults(n);
+    mults.reserve(n);
+    for (int i = 0; i < n; i++) {
         bool needed_band, needed;
         QByteArray mult;
-        if (csettings->value(c_multsmode,c_multsmode_def).toBool()) {
+        if (cfg.multsMode) {
             // per-mode mults
             mult=log->neededMultNameMode(multMode, band,cat[ir]->modeType(), i, needed_band, needed);
         } else {
             mult = log->neededMultName(multMode, band, i, needed_band, needed);
         }
         if (excludeMults[multMode].contains(mult)) continue;
-        mults.append(mult);
-        if (csettings->value(c_multsband,c_multsband_def).toBool()) {
-            if (needed_band) {
-              //  tmp = tmp + "<font color=#FF0000>" + mult + "</font> "; // red=needed
-                neededMults.append(mult);
-            } else {
-                //tmp = tmp + "<font color=#AAAAAA>" + mult + "</font> "; // grey=worked
-
-            }
+        if (cfg.multsBand) {
+            if (needed_band) neededMults.setBit(mults.size());
         } else {
-            if (needed) {
-                //tmp = tmp + "<font color=#FF0000>" + mult + "</font> "; // red=needed
-                neededMults.append(mult);
-            } else {
-                //tmp = tmp + "<font color=#AAAAAA>" + mult + "</font> "; // grey=worked
-            }
+            if (needed) neededMults.setBit(mults.size());
         }
+        mults.append(mult);
     }
-    MultTextEdit->setMults(mults);
-    MultTextEdit->setNeededMults(neededMults);
-    MultTextEdit->updateMults();
-    if (csettings->value(c_multsmode,c_multsmode_def).toBool()) {
+    neededMults.resize(mults.size());
+    MultTextEdit->setMults(mults,neededMults);
+    if (cfg.multsMode) {
         // per-mode mults
         MultGroupBox->setTitle("Mults: Radio " + QString::number(ir + 1) + ": " + bandName[band]+
                 " "+modeNames[cat[ir]->modeType()]);
@@ -2234,73 +2476,105 @@ void So2sdr::updateMults(int ir,int bandOverride)
 }
 
 /*!
-   update radio frequency/mode display
+   update radio displays for both radios. Called from a timer as a fallback; changes
+   reported by the radios are handled in rigChanged
  */
 void So2sdr::updateRadioFreq()
 {
-    static ModeTypes oldModeType[2]={CWType,CWType};
-    static bool init=false;
-    static int previousBand[2]={BAND_NONE,BAND_NONE};
-
-    if (!init) {
-        oldModeType[0]=cat[0]->modeType();
-        oldModeType[1]=cat[1]->modeType();
-        init=true;
+    for (int i = 0; i < NRIG; i++) {
+        updateRadioDisplay(i);
+        if (cat[i]->radioOpen()) {
+            rLabelPtr[i]->setText("R" + QString::number(i + 1) + ":ON");
+        } else {
+            rLabelPtr[i]->setText("<font color=#FF0000>R" + QString::number(i + 1) + ":OFF </font>");
+        }
+    }
+    updateBandLabels();
+    if (winkey->winkeyIsOpen()) {
+        winkeyLabel->setText("WK:ON");
     } else {
+        winkeyLabel->setText("<font color=#FF0000>WK:OFF </font>");
+    }
+}
+
+/*!
+   slot called from RigSerial when frequency or mode of radio nr changes.
+
+   t is the time (monotonicUsec) the change was seen in the radio thread
+ */
+void So2sdr::rigChanged(int nr, double f, quint64 mode, qint64 t)
+{
+    Q_UNUSED(f)
+    Q_UNUSED(mode)
+    int b=rigBand[nr];
+    updateRadioDisplay(nr);
+    if (rigBand[nr]!=b) {
+        updateBandLabels();
+        if (nDupesheet()) {
+            populateDupesheet();
+        }
+    }
+    checkSpot(nr);
+    if (t) rigEventLatency.add(monotonicUsec()-t);
+}
+
+/*!
+   update frequency and mode display of radio nr, and send freq to bandmap. Updates
+   mult display on band change, or mode change if mults are counted by mode
+ */
+void So2sdr::updateRadioDisplay(int nr)
+{
+    double rigFreq = cat[nr]->getRigFreq();
+    int band = getBand(rigFreq);
+    ModeTypes modeType = cat[nr]->modeType();
+    if (bandmap->bandmapon(nr)) {
+        bandmap->bandmapSetFreq(rigFreq,nr);
+        // add additional offset if specified by radio (like K3)
+        bandmap->setAddOffset((double)cat[nr]->ifFreq(),nr);
+        // sync bandmap if band change
+        if (band!=BAND_NONE && band!=rigBand[nr]) {
+            bandmap->syncCalls(nr,spotList[band]);
+        }
+    }
+    if (log && nr==activeRadio) {
         // for per-mode multipliers, need to switch mult display if the mode has changed
-        if (log && csettings->value(c_multsmode,c_multsmode_def).toBool() && cat[activeRadio]->modeType()!=oldModeType[activeRadio]) {
-            updateMults(activeRadio);
-            oldModeType[activeRadio]=cat[activeRadio]->modeType();
+        if ((band!=rigBand[nr] && band!=BAND_NONE) ||
+            (modeType!=rigModeType[nr] && csettings->value(c_multsmode,c_multsmode_def).toBool())) {
+            updateMults(nr);
         }
     }
+    rigBand[nr]=band;
+    rigModeType[nr]=modeType;
+
+    double f = rigFreq / 1000.0;
+    if (nr == activeRadio) {
+        freqDisplayPtr[nr]->setText("<b>" + QString::number(f, 'f', 1) + "</b>");
+        modeDisplayPtr[nr]->setText("<b>" + cat[nr]->modeStr() + "</b>");
+    } else {
+        freqDisplayPtr[nr]->setText(QString::number(f, 'f', 1));
+        modeDisplayPtr[nr]->setText(cat[nr]->modeStr());
+    }
+}
 
+/*!
+   highlight the active bands
+ */
+void So2sdr::updateBandLabels()
+{
     for (int i=0;i<6;i++) {
         bandLabel[i]->setStyleSheet("QLabel { background-color : palette(Background); color : black; }");
     }
-    double rigFreq[NRIG];
     for (int i = 0; i < NRIG; i++) {
-        rigFreq[i] = cat[i]->getRigFreq();
-        if (bandmap->bandmapon(i)) {
-            bandmap->bandmapSetFreq(rigFreq[i],i);
-            // add additional offset if specified by radio (like K3)
-            bandmap->setAddOffset((double)cat[i]->ifFreq(),i);
-            // sync bandmap if band change
-            if (cat[i]->band()!=BAND_NONE && cat[i]->band()!=previousBand[i]) {
-                bandmap->syncCalls(i,spotList[cat[i]->band()]);
-                previousBand[i]=cat[i]->band();
-            }
-        }
-        double f = rigFreq[i] / 1000.0;
-        if (cat[i]->radioOpen()) {
-            rLabelPtr[i]->setText("R" + QString::number(i + 1) + ":ON");
-        } else {
-            rLabelPtr[i]->setText("<font color=#FF0000>R" + QString::number(i + 1) + ":OFF </font>");
-        }
-        // highlight the active bands
         int t;
         if (!log) {
-            t=cat[i]->band();
-        } else if (log->bandLabelEnable(cat[i]->band()) && cat[i]->band()!=BAND_NONE) {
-            t=log->highlightBand(cat[i]->band(),cat[i]->modeType());
+            t=rigBand[i];
+        } else if (log->bandLabelEnable(rigBand[i]) && rigBand[i]!=BAND_NONE) {
+            t=log->highlightBand(rigBand[i],rigModeType[i]);
         } else {
             t=BAND_NONE;
         }
         if (t>=0 && t<6) bandLabel[t]->setStyleSheet("QLabel { background-color : grey; color : white; }");
-
-        if (i == activeRadio) {
-            freqDisplayPtr[i]->setText("<b>" + QString::number(f, 'f', 1) + "</b>");
-            modeDisplayPtr[i]->setText("<b>" + cat[i]->modeStr() + "</b>");
-        } else {
-            freqDisplayPtr[i]->setText(QString::number(f, 'f', 1));
-            modeDisplayPtr[i]->setText(cat[i]->modeStr());
-        }
-    }
-    if (winkey->winkeyIsOpen()) {
-        winkeyLabel->setText("WK:ON");
-    } else {
-        winkeyLabel->setText("<font color=#FF0000>WK:OFF </font>");
     }
-
 }
 
 /*!
@@ -2530,10 +2804,12 @@ void So2sdr::send(QByteArray text, bool stopcw)
 {
     if (cat[activeTxRadio]->modeType()!=CWType) return;
     if (!settings->value(s_winkey_cwon,s_winkey_cwon_def).toBool()) return;
+    if (keyTime) cwTrace.mark(CwTraceMacro,keyTime);
 
     if (winkey->isSending() && stopcw) {
         winkey->cancelcw();       // cancel any cw in progress
     }
+    if (keyTime) cwTrace.mark(CwTraceLoaded,keyTime);
     winkey->loadbuff(text);
     winkey->sendcw();
 }
@@ -3076,7 +3352,10 @@ void So2sdr::openFile()
  */
 void So2sdr::rescore()
 {
+    // options dialog requests a rescore before updateOptions is called
+    log->updateConfig();
     log->rescore();
+    LogTableView->viewport()->update();
     updateBreakdown();
     updateMults(activeRadio);
 }
@@ -3435,7 +3714,9 @@ void So2sdr::initPointers()
     cat[0]        = 0;
     cat[1]        = 0;
     cabrillo      = 0;
+    ctyUpdater    = 0;
     downloader    = 0;
+    historyBuilder = 0;
     log         = 0;
     cwMessage     = 0;
     ssbMessage    = 0;
@@ -3456,8 +3737,7 @@ void So2sdr::initPointers()
     bandmap      = 0;
     scriptProcess = 0;
     telnet            = 0;
-    kbdHandler[0]  = 0;
-    kbdHandler[1]  = 0;
+    kbdHandler    = 0;
     wpmLineEditPtr[0] = WPMLineEdit;
     wpmLineEditPtr[1] = WPMLineEdit2;
     lineEditCall[0] = lineEditCall1;
@@ -3538,6 +3818,7 @@ void So2sdr::initVariables()
 {
     initialized = true;
     uiEnabled   = false;
+    keyTime     = 0;
     labelCountry1->clear();
     labelCountry2->clear();
     labelBearing1->clear();
@@ -3554,6 +3835,11 @@ void So2sdr::initVariables()
     for (int i = 0; i < N_BANDS; i++) spotList[i].clear();
     spotListPopUp[0] = false;
     spotListPopUp[1] = false;
+    for (int i = 0; i < NRIG; i++) {
+        lastSpotFreq[i] = 0;
+        rigBand[i] = BAND_NONE;
+        rigModeType[i] = CWType;
+    }
     callSent[0]    = false;
     callSent[1]    = false;
     logSearchFlag  = false;
@@ -3737,98 +4023,54 @@ void So2sdr::updateCty()
     connect(downloader,SIGNAL(downloaded()),this,SLOT(checkCtyVersion()));
 }
 
-/*! Slot called when CTY file has been downloaded. Checks version to see if
- * newer than current version, prompts user for update */
+/*! Slot called when CTY file has been downloaded. The version check is done
+ * in the CTY updater thread, which calls ctyVersionAvailable if it is newer than the
+ * current version */
 void So2sdr::checkCtyVersion()
 {
     QByteArray newCty=downloader->downloadedData();
-    if (newCty.contains("=VER")) {
-        // extract version string
-        int indx=newCty.indexOf("=VER");
-        if (newCty.mid(indx+1,7)=="VERSION") {
-            indx=newCty.indexOf("=VER",indx+1);
-        }
-        QString newVer=newCty.mid(indx+4,8);
-        QDate newDate=QDate(newVer.left(4).toInt(),newVer.mid(4,2).toInt(),newVer.right(2).toInt());
-
-        // get current CTY file version
-        QDir dir;
-        dir.setCurrent(userDirectory());
-        QFileInfo oldInfo("wl_cty.dat");
-        bool oldExists=false;
-        QDate oldDate;
-        if (oldInfo.exists()) {
-            QFile oldCty("wl_cty.dat");
-            if (!oldCty.open(QIODevice::ReadOnly | QIODevice::Text))
-            {
-                downloader->deleteLater();
-                downloader = 0;
-                return;
-            }
-            while (!oldCty.atEnd()) {
-                QByteArray line=oldCty.readLine();
-                int indx=line.indexOf("=VER");
-                if (indx==-1 || line.mid(indx+1,7)=="VERSION") continue;
-                QString oldVer=line.mid(indx+4,8);
-                oldDate=QDate(oldVer.left(4).toInt(),oldVer.mid(4,2).toInt(),oldVer.right(2).toInt());
-                oldExists=true;
-            }
-            oldCty.close();
-        }
-
-        // compare dates
-        if (!oldExists || newDate>oldDate) {
-            QMessageBox *msg= new QMessageBox(this);
-            msg->setText("New CTY file version "+newVer+" is available.");
-            msg->setInformativeText("Install it?");
-            msg->setStandardButtons(QMessageBox::Yes | QMessageBox::Cancel);
-            msg->setDefaultButton(QMessageBox::Yes);
-            msg->setModal(true);
-            int ret = msg->exec();
-            switch (ret) {
-            case QMessageBox::Yes:
-            {
-                // save new CTY file
-                QFile save("wl_cty.dat");
-                if (!save.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                    downloader->deleteLater();
-                    downloader = 0;
-                    return;
-                }
-                save.write(newCty);
-                save.close();
-                // save new NCCC Sprint CTY file with some countries changed from SA to NA
-                newCty.replace("Trinidad & Tobago:        09:  11:  SA","Trinidad & Tobago:        09:  11:  NA");
-                newCty.replace("Aruba:                    09:  11:  SA","Aruba:                    09:  11:  NA");
-                newCty.replace("Curacao:                  09:  11:  SA","Curacao:                  09:  11:  NA");
-                newCty.replace("Bonaire:                  09:  11:  SA","Bonaire:                  09:  11:  NA");
-                save.setFileName("wl_cty-ns.dat");
-                if (!save.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                    downloader->deleteLater();
-                    downloader = 0;
-                    return;
-                }
-                save.write(newCty);
-                save.close();
-                break;
-            }
-            case QMessageBox::Cancel:
-                msg->deleteLater();
-                downloader->deleteLater();
-                downloader = 0;
-                return;
-                break;
-            default:  // never reached
-                break;
-            }
-            msg->deleteLater();
-        }
-    } else {
-        // CTY download failed (incomplete), missing version string
-        downloader->deleteLater();
-        downloader = 0;
+    downloader->deleteLater();
+    downloader = 0;
+    emit(checkCty(newCty,userDirectory()));
+}
+
+/*! Slot called when a newer CTY file is available; prompts user for update. The file is
+ * saved and the country tables rebuilt in the CTY updater thread */
+void So2sdr::ctyVersionAvailable(const QString &newVer)
+{
+    QMessageBox *msg= new QMessageBox(this);
+    msg->setText("New CTY file version "+newVer+" is available.");
+    msg->setInformativeText("Install it?");
+    msg->setStandardButtons(QMessageBox::Yes | QMessageBox::Cancel);
+    msg->setDefaultButton(QMessageBox::Yes);
+    msg->setModal(true);
+    int ret = msg->exec();
+    msg->deleteLater();
+    if (ret==QMessageBox::Yes) {
+        emit(installCty(log ? log->newCty() : 0));
+    }
+}
+
+/*! Slot called when the new CTY file has been saved and c (if not null) built from it.
+ * The new tables are swapped into the log and the log rescored */
+void So2sdr::ctyInstalled(Cty *c, bool ok, const QString &msg)
+{
+    if (!ok) {
+        if (c) delete c;
+        errorBox->showMessage(msg);
+        return;
+    }
+    if (!c || !log) {
+        if (c) delete c;
+        So2sdrStatusBar->showMessage(msg,3000);
         return;
     }
+    if (log->setCty(c)) {
+        rescore();
+        So2sdrStatusBar->showMessage(msg,3000);
+    } else {
+        So2sdrStatusBar->showMessage("CTY file updated: country list changed, reopen contest to use it",5000);
+    }
 }
 
 /*! add a wsjtx qso to log.
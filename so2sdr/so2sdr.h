@@ -32,16 +32,22 @@
 
 #include "ui_so2sdr.h"
 #include "bandmapentry.h"
+#include "cwtrace.h"
+#include "latency.h"
+#include "startupprofiler.h"
 #include "utils.h"
 
 class BandmapInterface;
 class CabrilloDialog;
 class ContestOptionsDialog;
 class CWMessageDialog;
+class Cty;
+class CtyUpdater;
 class DupeSheet;
 class FileDownloader;
 class HelpDialog;
 class History;
+class HistoryBuilder;
 class KeyboardHandler;
 class Log;
 class Master;
@@ -96,7 +102,10 @@ public slots:
     void updateSpotlistEdit(QSqlRecord origRecord, QSqlRecord r);
 
 signals:
+    void buildHistoryFile(const QString &);
+    void checkCty(const QByteArray &, const QString &);
     void contestReady();
+    void installCty(Cty *);
     void qsyExact1(double);
     void qsyExact2(double);
     void setRigMode1(rmode_t, pbwidth_t);
@@ -104,26 +113,38 @@ signals:
 
 private slots:
     void about();
+    void buildHistory();
     void checkCtyVersion();
     void cleanup();
     void clearEditSelection(QWidget *);
+    void ctyInstalled(Cty *c, bool ok, const QString &msg);
+    void ctyVersionAvailable(const QString &newVer);
+    void cwEchoed();
+    void cwWritten();
     void enterCWSpeed(int nrig, const QString & text);
     void exchCheck1(const QString &exch);
     void exchCheck2(const QString &exch);
     void exportADIF();
     void exportCabrillo();
+    void historyBuilt(bool ok);
+    void historyReady();
     void importCabrillo();
-    void kbd1(int code, bool shift, bool ctrl, bool alt);
-    void kbd2(int code, bool shift, bool ctrl, bool alt);
+    void importFinished(int nqso, qint64 ms);
+    void kbd(int nr, int code, bool shift, bool ctrl, bool alt, qint64 t);
+    void kbd1(int code, bool shift, bool ctrl, bool alt, qint64 t);
+    void kbd2(int code, bool shift, bool ctrl, bool alt, qint64 t);
     void launch_enterCWSpeed0(const QString &text);
     void launch_enterCWSpeed1(const QString &text);
+    void logScrollBenchmark();
     void logWsjtx(Qso *qso);
+    void masterReady();
     void openFile();
     void openRadios();
     void prefixCheck1(const QString &call);
     void prefixCheck2(const QString &call);
     void quit();
     void regrab();
+    void rigChanged(int nr, double f, quint64 mode, qint64 t);
     void screenShot();
     void send(QByteArray text, bool stopcw = true);
     void sendCalls1(bool);
@@ -134,9 +155,11 @@ private slots:
     void showBandmap1(bool);
     void showBandmap2(bool);
     void showCabrillo();
+    void showCwLatency();
     void showDupesheet1(bool checkboxState);
     void showDupesheet2(bool checkboxState);
     void showHelp();
+    void showPerformance();
     void showRecordingStatus(bool);
     void showTelnet(bool checkboxState);
     void speedDn(int nrig);
@@ -208,17 +231,25 @@ private:
     int                  nrSent;
     int                  rateCount[60];
     int                  ratePtr;
+    int                  rigBand[NRIG];
     int                  timerId[N_TIMERS];
     int                  wpm[NRIG];
+    CtyUpdater           *ctyUpdater;
     FileDownloader       *downloader;
-    KeyboardHandler      *kbdHandler[NRIG];
-    QThread              kbdThread[NRIG];
+    HistoryBuilder       *historyBuilder;
+    KeyboardHandler      *kbdHandler;
+    QThread              kbdThread;
+    qint64               keyTime;
+    CwTrace              cwTrace;
+    LatencyStats         rigEventLatency;
     Log                  *log;
     Master               *master;
     ModeTypes             modeTypeShown;
+    ModeTypes             rigModeType[NRIG];
     NewDialog            *newContest;
     NoteDialog           *notes;
     So2r                 *so2r;
+    StartupProfiler      startup;
     QByteArray           lastMsg;
     QByteArray           origCallEntered[NRIG];
     QErrorMessage        *errorBox;
@@ -250,6 +281,7 @@ private:
     QLabel               *twoKeyboardStatus;
     QLabel               *validLabel[NRIG];
     QLabel               *winkeyLabel;
+    double               lastSpotFreq[NRIG];
     QLineEdit            *lineEditCall[NRIG];
     QLineEdit            *lineEditExchange[NRIG];
     QLineEdit            *wpmLineEditPtr[NRIG];
@@ -269,6 +301,8 @@ private:
     QString              settingsFile;
     QString              autoSendCall;
     QThread              catThread[NRIG];
+    QThread              ctyThread;
+    QThread              historyBuildThread;
     QTime                cqTimer;
     QWidget              *grabWidget;
     RadioDialog          *radios;
@@ -350,11 +384,13 @@ private:
     void tab(int kbdNr);
     void twoKeyboard();
     void up();
+    void updateBandLabels();
     void updateBandmapDupes(const Qso *qso);
     void updateBreakdown();
-    void updateDupesheet(QByteArray call,int nr);
+    void updateDupesheet(const QByteArray &call,int band);
     void updateMults(int ir, int bandOverride=-1);
     void updateNrDisplay();
+    void updateRadioDisplay(int nr);
     void updateRate();
     void updateWorkedDisplay(int nr,unsigned int worked);
     void updateWorkedMult(int nr);
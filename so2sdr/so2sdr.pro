@@ -25,16 +25,22 @@ HEADERS += cwmessagedialog.h \
     log.h \
     radiodialog.h \
     cty.h \
+    cwtrace.h \
+    ctyupdater.h \
     contest.h \
+    exchtokenizer.h \
     contest_cq160.h \
     contest_sprint.h \
     sdrdialog.h \
     contestoptdialog.h \
     newcontestdialog.h \
     notedialog.h \
+    dupecolumn.h \
     dupesheet.h \
     winkey.h \
+    winkeyloopback.h \
     contest_wpx.h \
+    wpxprefix.h \
     master.h \
     defines.h \
     contest_naqp.h \
@@ -56,15 +62,18 @@ HEADERS += cwmessagedialog.h \
     contest_arrldx.h \
     contest_dxped.h \
     logedit.h \
+    logimporter.h \
     detailededit.h \
     mytableview.h \
     contest_cqp.h \
     contest_kqp.h \
+    contest_rules.h \
     otrsp.h \
     ssbmessagedialog.h \
     settingsdialog.h \
     microham.h \
     history.h \
+    historybuilder.h \
     bandmapinterface.h \
     contest_paqp.h \
     logdelegate.h \
@@ -77,7 +86,11 @@ HEADERS += cwmessagedialog.h \
     multdisplay.h \
     centergriddialog.h \
     adifparse.h \
-    keyboardhandler.h
+    keyboardhandler.h \
+    latency.h \
+    startupprofiler.h \
+    rigctld.h \
+    rigmailbox.h
 
 FORMS += cwmessagedialog.ui \
     so2sdr.ui \
@@ -106,7 +119,10 @@ SOURCES += cwmessagedialog.cpp \
     log.cpp \
     radiodialog.cpp \
     cty.cpp \
+    cwtrace.cpp \
+    ctyupdater.cpp \
     contest.cpp \
+    exchtokenizer.cpp \
     so2sdr_keys.cpp \
     contest_cq160.cpp \
     contest_sprint.cpp \
@@ -114,10 +130,13 @@ SOURCES += cwmessagedialog.cpp \
     contestoptdialog.cpp \
     newcontestdialog.cpp \
     notedialog.cpp \
+    dupecolumn.cpp \
     dupesheet.cpp \
     so2sdr_dupesheet.cpp \
     winkey.cpp \
+    winkeyloopback.cpp \
     contest_wpx.cpp \
+    wpxprefix.cpp \
     master.cpp \
     contest_naqp.cpp \
     contest_iaru.cpp \
@@ -139,15 +158,18 @@ SOURCES += cwmessagedialog.cpp \
     utils.cpp \
     contest_dxped.cpp \
     logedit.cpp \
+    logimporter.cpp \
     detailededit.cpp \
     mytableview.cpp \
     contest_cqp.cpp \
     contest_kqp.cpp \
+    contest_rules.cpp \
     otrsp.cpp \
     ssbmessagedialog.cpp \
     settingsdialog.cpp \
     microham.cpp \
     history.cpp \
+    historybuilder.cpp \
     bandmapinterface.cpp \
     contest_paqp.cpp \
     logdelegate.cpp \
@@ -160,7 +182,11 @@ SOURCES += cwmessagedialog.cpp \
     multdisplay.cpp \
     centergriddialog.cpp \
     adifparse.cpp \
-    keyboardhandler.cpp
+    keyboardhandler.cpp \
+    latency.cpp \
+    startupprofiler.cpp \
+    rigctld.cpp \
+    rigmailbox.cpp
 
  unix { 
     include (../common.pri)
@@ -17,7 +17,8 @@
 
  */
 #include <QDebug>
-#include <QSqlQueryModel>
+#include <QList>
+#include <QSqlQuery>
 #include "dupesheet.h"
 #include "log.h"
 #include "so2sdr.h"
@@ -94,7 +95,7 @@ int So2sdr::nDupesheet() const
 
 /*! populates dupe sheet. Needs to be called when switching bands
  or first turning on the dupesheet. If band has not changed, will do
- nothing.
+ nothing. New qsos are added by updateDupesheet
  */
 void So2sdr::populateDupesheet()
 {
@@ -123,18 +124,28 @@ void So2sdr::populateDupesheet()
         int b=cat[ib]->band();
         if (b==BAND_NONE || b==dupesheet[id]->band()) continue;
 
-        dupesheet[id]->clear();
         dupesheet[id]->setBand(b);
-        QSqlQueryModel m;
-        m.setQuery("SELECT * FROM log WHERE valid=1 and BAND=" + QString::number(b), log->dataBase());
-
-        while (m.canFetchMore()) {
-            m.fetchMore();
-        }
-        for (int i = 0; i < m.rowCount(); i++) {
-            QByteArray tmp = m.record(i).value("call").toString().toLatin1();
-            dupesheet[id]->updateDupesheet(tmp);
+        QList<QByteArray> calls;
+        QSqlQuery query(log->dataBase());
+        query.setForwardOnly(true);
+        query.prepare("SELECT call FROM log WHERE valid=1 and band=?");
+        query.addBindValue(b);
+        if (query.exec()) {
+            while (query.next()) {
+                calls.append(query.value(0).toByteArray());
+            }
         }
+        dupesheet[id]->setCalls(calls);
         dupesheet[id]->setWindowTitle("Dupesheet " + bandName[b]);
     }
 }
+
+/*! adds a newly logged call to each visible dupesheet showing band
+ */
+void So2sdr::updateDupesheet(const QByteArray &call,int band)
+{
+    for (int id=0;id<NRIG;id++) {
+        if (!dupesheet[id] || !dupesheet[id]->isVisible()) continue;
+        if (dupesheet[id]->band()==band) dupesheet[id]->updateDupesheet(call);
+    }
+}
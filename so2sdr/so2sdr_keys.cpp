@@ -39,6 +39,33 @@
 #include "stationdialog.h"
 #include "winkeydialog.h"
 
+/*!
+   sets a key press time for as long as the key press is being handled, then restores
+   the previous value. Events handled during the key press leave it unchanged
+ */
+class KeyTimeGuard
+{
+public:
+    KeyTimeGuard(qint64 &k, qint64 t) : key(k), old(k) { if (t) key = t; }
+    ~KeyTimeGuard() { key = old; }
+
+private:
+    qint64 &key;
+    qint64 old;
+};
+
+/*!
+   key press from the two keyboard handler, carrying the time the kernel read the key
+ */
+class KbdKeyEvent : public QKeyEvent
+{
+public:
+    KbdKeyEvent(int key, Qt::KeyboardModifiers mod, const QString &text, qint64 t) :
+        QKeyEvent(QEvent::KeyPress, key, mod, text), time(t) {}
+
+    const qint64 time;
+};
+
 /*! event filter handling key presses. This gets installed in
    -main window
    -both call entry windows
@@ -73,6 +100,19 @@ bool So2sdr::eventFilter(QObject* o, QEvent* e)
             return true;
         }
     }
+    // CW sent while handling a key press is traced from the key event. Keys from the
+    // two keyboard handler carry the time the kernel read them
+    qint64 t = 0;
+    if (e->type()==QEvent::KeyPress) {
+        const KbdKeyEvent *ev = dynamic_cast<const KbdKeyEvent*>(e);
+        if (ev) {
+            t = ev->time;
+        } else {
+            t = monotonicUsec();
+        }
+    }
+    KeyTimeGuard keyTimeGuard(keyTime,t);
+
     // set r true if this completely handles the key. Otherwise
     // it will be passed on to other widgets
     bool r   = false;
@@ -838,11 +878,6 @@ void So2sdr::backSlash(int kbdNr)
         fillSentExch(qso[activeRadio],nrReserved[activeRadio]);
         qso[activeRadio]->time = QDateTime::currentDateTimeUtc(); // update time just before logging qso
         addQso(qso[activeRadio]);
-        if (nDupesheet()==1) {
-            populateDupesheet();
-        } else {
-            dupesheet[activeRadio]->updateDupesheet(qso[activeRadio]->call);
-        }
         updateMults(activeRadio);
         rateCount[ratePtr]++;
         exchangeSent[activeRadio] = false;
@@ -1449,11 +1484,6 @@ void So2sdr::enter(Qt::KeyboardModifiers mod,int kbdNr)
                 removeSpotFreq(qso[activeRadio]->freq, cat[activeRadio]->band());
             updateBandmapDupes(qso[activeRadio]);
         }
-        if (nDupesheet()==1) {
-            populateDupesheet();
-        } else {
-            dupesheet[activeRadio]->updateDupesheet(qso[activeRadio]->call);
-        }
         updateMults(activeRadio);
         rateCount[ratePtr]++;
         exchangeSent[activeRadio] = false;
@@ -2082,46 +2112,56 @@ void So2sdr::clearDisplays(int nr)
 void So2sdr::twoKeyboard()
 {
     if (settings->value(s_twokeyboard_enable,s_twokeyboard_enable_def).toBool()) {
-        if (kbdHandler[0] || kbdHandler[1]) {
+        if (kbdHandler) {
             stopTwokeyboard();
-            kbdHandler[0]->setDevice(settings->value(s_twokeyboard_device[0],s_twokeyboard_device_def[0]).toString());
-            kbdHandler[1]->setDevice(settings->value(s_twokeyboard_device[1],s_twokeyboard_device_def[1]).toString());
         } else {
-            for (int i=0;i<NRIG;i++) {
-                if (!kbdHandler[i]) {
-                    kbdHandler[i]=new KeyboardHandler(settings->value(s_twokeyboard_device[i],s_twokeyboard_device_def[i]).toString());
-                }
-            }
-            connect(kbdHandler[0],SIGNAL(readKey(int,bool,bool,bool)),this,SLOT(kbd1(int,bool,bool,bool)));
-            connect(kbdHandler[1],SIGNAL(readKey(int,bool,bool,bool)),this,SLOT(kbd2(int,bool,bool,bool)));
-            for (int i=0;i<NRIG;i++) {
-                kbdHandler[i]->moveToThread(&kbdThread[i]);
-                connect(&kbdThread[i], SIGNAL(started()), kbdHandler[i], SLOT(run()));
-            }
+            kbdHandler=new KeyboardHandler();
+            connect(kbdHandler,SIGNAL(readKey(int,int,bool,bool,bool,qint64)),this,SLOT(kbd(int,int,bool,bool,bool,qint64)));
+            kbdHandler->moveToThread(&kbdThread);
+            connect(&kbdThread, SIGNAL(started()), kbdHandler, SLOT(run()));
         }
+        // both keyboards are read by one thread
+        QStringList devices;
         for (int i=0;i<NRIG;i++) {
-            kbdThread[i].start();
+            devices << settings->value(s_twokeyboard_device[i],s_twokeyboard_device_def[i]).toString();
         }
+        kbdHandler->setDevices(devices);
+        kbdThread.start();
         if (toggleMode) {
             toggleMode=false;
             toggleStatus->clear();
         }
         twoKeyboardStatus->setText("<font color=#0000FF>2KB</font>");
     } else {
-        if (kbdHandler[0] || kbdHandler[1]) {
+        if (kbdHandler) {
             stopTwokeyboard();
         }
         twoKeyboardStatus->clear();
     }
 }
 
+/*!
+ * \brief So2sdr::kbd slot connected to KeyboardHandler, used in two keyboard mode
+ * \param nr keyboard number
+ * \param t time of key press, used to measure key to CW latency
+ */
+void So2sdr::kbd(int nr, int code, bool shift, bool ctrl, bool alt, qint64 t)
+{
+    if (nr==0) {
+        kbd1(code,shift,ctrl,alt,t);
+    } else if (nr==1) {
+        kbd2(code,shift,ctrl,alt,t);
+    }
+}
+
 /*!
  * \brief So2sdr::slot connected to KeyboardHandler for keyboard 1
  *   used in two keyboard mode
  * \param code
  * \param shift
+ * \param t time of key press
  */
-void So2sdr::kbd1(int code,bool shift,bool ctrl,bool alt)
+void So2sdr::kbd1(int code,bool shift,bool ctrl,bool alt,qint64 t)
 {
     if (code<NKEYS) {
         QString key=keys[code];
@@ -2137,7 +2177,7 @@ void So2sdr::kbd1(int code,bool shift,bool ctrl,bool alt)
         if (alt) {
             mod.setFlag(Qt::AltModifier,true);
         }
-        QKeyEvent *ev = new QKeyEvent (QEvent::KeyPress,qtkeys[code],mod,key);
+        QKeyEvent *ev = new KbdKeyEvent(qtkeys[code],mod,key,t);
         if (errorBox->isVisible() || cabrillo->isVisible() || options->isVisible() || cwMessage->isVisible() || ssbMessage->isVisible()
                 || winkeyDialog->isVisible() || sdr->isVisible() || radios->isVisible() || progsettings->isVisible() || station->isVisible()
                 || so2r->isVisible() || aboutOn || help->isVisible()) {
@@ -2200,8 +2240,9 @@ void So2sdr::kbd1(int code,bool shift,bool ctrl,bool alt)
  *   used in two keyboard mode
  * \param code
  * \param shift
+ * \param t time of key press
  */
-void So2sdr::kbd2(int code, bool shift, bool ctrl, bool alt)
+void So2sdr::kbd2(int code, bool shift, bool ctrl, bool alt, qint64 t)
 {
     if (code<NKEYS) {
         QString key=keys[code];
@@ -2217,7 +2258,7 @@ void So2sdr::kbd2(int code, bool shift, bool ctrl, bool alt)
         if (alt) {
             mod.setFlag(Qt::AltModifier,true);
         }
-        QKeyEvent * ev = new QKeyEvent (QEvent::KeyPress,qtkeys[code],mod,key);
+        QKeyEvent * ev = new KbdKeyEvent(qtkeys[code],mod,key,t);
         if (errorBox->isVisible() || cabrillo->isVisible() || options->isVisible() || cwMessage->isVisible() || ssbMessage->isVisible()
                 || winkeyDialog->isVisible() || sdr->isVisible() || radios->isVisible() || progsettings->isVisible() || station->isVisible()
                 || so2r->isVisible() || aboutOn || help->isVisible()) {
@@ -2266,13 +2307,11 @@ void So2sdr::kbd2(int code, bool shift, bool ctrl, bool alt)
  */
 void So2sdr::stopTwokeyboard()
 {
-    for (int i=0;i<NRIG;i++) {
-        if (kbdHandler[i]) {
-            kbdHandler[i]->quitHandler();
-            if (kbdThread[i].isRunning()) {
-                kbdThread[i].quit();
-                kbdThread[i].wait();
-            }
+    if (kbdHandler) {
+        kbdHandler->quitHandler();
+        if (kbdThread.isRunning()) {
+            kbdThread.quit();
+            kbdThread.wait();
         }
     }
     // delay is necessary to prevent issues when switch to/from two keyboard mode
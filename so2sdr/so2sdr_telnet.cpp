@@ -146,6 +146,14 @@ void So2sdr::addSpot(QByteArray call, double f)
         d        = log->isDupe(&tmp, log->dupeCheckingByBand(), false);
     }
     addSpot(call, f, d);
+
+    // pop up the spot right away if a radio is already sitting on it
+    int b = getBand(f);
+    for (int nr = 0; nr < NRIG; nr++) {
+        if (cat[nr]->band() == b && abs(cat[nr]->getRigFreq() - f) < SIG_MIN_FREQ_DIFF) {
+            checkSpot(nr);
+        }
+    }
 }
 
 
@@ -238,10 +246,9 @@ void So2sdr::addSpot(QByteArray call, double f, bool d)
  */
 void So2sdr::checkSpot(int nr)
 {
-    static double lastFreq[2] = { 0, 0 };
     // initialize last freq
-    if (lastFreq[nr] == 0) {
-        lastFreq[nr] = cat[nr]->getRigFreq();
+    if (lastSpotFreq[nr] == 0) {
+        lastSpotFreq[nr] = cat[nr]->getRigFreq();
         return;
     }
     double f = cat[nr]->getRigFreq();
@@ -249,11 +256,11 @@ void So2sdr::checkSpot(int nr)
 
     // freq changed, so recheck spot list
     // @todo move to double freqs; should this have some tolerance?
-    if (f != lastFreq[nr] ) spotListPopUp[nr] = false;
+    if (f != lastSpotFreq[nr] ) spotListPopUp[nr] = false;
 
     // currently have a call from list shown. Don't do anything
     if (spotListPopUp[nr]) {
-        lastFreq[nr] = f;
+        lastSpotFreq[nr] = f;
         return;
     }
     // search list of spots for one matching current freq
@@ -277,7 +284,7 @@ void So2sdr::checkSpot(int nr)
     if (found) {
         prefixCheck(nr, lineEditCall[nr]->text());
         spotListPopUp[nr] = true;
-    } else if (abs(lastFreq[nr] - f) > SIG_MIN_FREQ_DIFF && log) {
+    } else if (abs(lastSpotFreq[nr] - f) > SIG_MIN_FREQ_DIFF && log) {
         if (cat[nr]->modeType()==CWType && winkey->isSending() && nr == activeTxRadio)
         {
             winkey->cancelcw();
@@ -369,7 +376,11 @@ void So2sdr::checkSpot(int nr)
             }
         }
     }
-    lastFreq[nr] = f;
+    // called on every (debounced) frequency change: small steps while tuning slowly
+    // must add up, so only move the reference once past SIG_MIN_FREQ_DIFF
+    if (found || abs(lastSpotFreq[nr] - f) > SIG_MIN_FREQ_DIFF) {
+        lastSpotFreq[nr] = f;
+    }
 }
 
 /*! remove a spot
@@ -0,0 +1,78 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QDebug>
+#include "startupprofiler.h"
+
+StartupProfiler::StartupProfiler()
+{
+    timer.start();
+    last = 0;
+}
+
+void StartupProfiler::add(const QString &name, qint64 start, qint64 end)
+{
+    StartupPhase p;
+    p.name   = name;
+    p.start  = start;
+    p.length = end - start;
+    phases.append(p);
+    qDebug("startup: %-32s %6lld ms (at %lld ms)", name.toLatin1().data(), p.length, end);
+}
+
+/*!
+   start a new phase without recording the time since the last mark
+ */
+void StartupProfiler::begin()
+{
+    last = timer.elapsed();
+}
+
+/*!
+   end the current phase
+ */
+void StartupProfiler::mark(const QString &name)
+{
+    const qint64 t = timer.elapsed();
+    add(name, last, t);
+    last = t;
+}
+
+/*!
+   record completion of background work; does not end the current phase
+ */
+void StartupProfiler::markBackground(const QString &name)
+{
+    const qint64 t = timer.elapsed();
+    add(name + " (background)", 0, t);
+}
+
+/*!
+   phase times as an html table
+ */
+QString StartupProfiler::report() const
+{
+    QString s = "<table><tr><th align=left>Phase</th><th align=right>ms</th><th align=right>done at ms</th></tr>";
+    for (int i = 0; i < phases.size(); i++) {
+        const StartupPhase &p = phases.at(i);
+        s += "<tr><td>" + p.name + "</td><td align=right>" + QString::number(p.length) +
+             "</td><td align=right>" + QString::number(p.start + p.length) + "</td></tr>";
+    }
+    s += "</table>";
+    return s;
+}
@@ -0,0 +1,59 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+
+/*!
+   time of one startup phase
+ */
+typedef struct StartupPhase {
+    QString name;
+    qint64  start;
+    qint64  length;
+} StartupPhase;
+
+/*!
+   records how long each phase of program startup and contest loading takes.
+
+   mark() ends the phase that started at the previous mark. Work done in the
+   background is recorded with markBackground(), which gives the time since
+   the program started
+ */
+class StartupProfiler
+{
+public:
+    StartupProfiler();
+    void begin();
+    void mark(const QString &name);
+    void markBackground(const QString &name);
+    QString report() const;
+
+private:
+    QElapsedTimer       timer;
+    qint64              last;
+    QList<StartupPhase> phases;
+
+    void add(const QString &name, qint64 start, qint64 end);
+};
+
+#endif // STARTUPPROFILER_H
@@ -70,21 +70,18 @@ void UDPReader::enable(bool b)
 
 void UDPReader::readDatagram()
 {
-    qint64 udp_size;
-    char *data;
-
-    udp_size=usocket.pendingDatagramSize();
-    data=new char[udp_size];
-    if (usocket.readDatagram((char*)data,udp_size)==-1) {
+    qint64 udp_size=usocket.pendingDatagramSize();
+    if (udp_size<0) return;
+    // datagram buffer is reused; the parser reads it in place
+    if (datagram.size()<udp_size) datagram.resize(udp_size);
+    qint64 n=usocket.readDatagram(datagram.data(),udp_size);
+    if (n==-1) {
         emit(error("UDPReader: UDP read failed"));
-        delete data;
         return;
     }
     Qso qso;
-    QByteArray tmp=data;
-    parser->parse(tmp,&qso);
+    parser->parse(datagram.constData(),(int) n,&qso);
     emit(wsjtxQso(&qso));
-    delete[] data;
 }
 
 void UDPReader::tcpError(QAbstractSocket::SocketError err)
@@ -50,6 +50,7 @@ private slots:
 
 private:
     ADIFParse *parser;
+    QByteArray datagram;
     QUdpSocket usocket;
     bool isOpen;
     QSettings&   settings;
@@ -16,6 +16,7 @@
     along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
 
  */
+#include <QElapsedTimer>
 #include <QString>
 #include "defines.h"
 #include "utils.h"
@@ -179,3 +180,19 @@ ModeTypes getModeType(rmode_t mode)
     default:return CWType;
     }
 }
+
+static QElapsedTimer startMonotonic()
+{
+    QElapsedTimer t;
+    t.start();
+    return t;
+}
+
+/*! monotonic time in microseconds since the first call. Comparable between threads,
+ * used for latency measurements
+ */
+qint64 monotonicUsec()
+{
+    static const QElapsedTimer timer=startMonotonic();
+    return timer.nsecsElapsed()/1000;
+}
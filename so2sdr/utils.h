@@ -48,5 +48,6 @@ int getBand(double f);
 QString dataDirectory();
 QString userDirectory();
 ModeTypes getModeType(rmode_t mode);
+qint64 monotonicUsec();
 
 #endif // UTILS_H
@@ -20,6 +20,7 @@
 #include <QTimer>
 #include "defines.h"
 #include "winkey.h"
+#include "winkeyloopback.h"
 
 #include <QSerialPort>
 #include <QSerialPortInfo>
@@ -32,6 +33,8 @@ Winkey::Winkey(QSettings &s, QObject *parent) : QObject(parent), settings(s)
 {
     QSerialPortInfo info(settings.value(s_winkey_device,s_winkey_device_def).toString());
     winkeyPort = new QSerialPort(info);
+    connect(winkeyPort,SIGNAL(bytesWritten(qint64)),this,SIGNAL(portWritten()));
+    loopback   = 0;
 
     txPtr=0;
     ignoreEcho=false;
@@ -52,6 +55,12 @@ Winkey::~Winkey()
 {
     closeWinkey();
     delete winkeyPort;
+    if (loopback) {
+        QMetaObject::invokeMethod(loopback,"stop",Qt::BlockingQueuedConnection);
+        loopbackThread.quit();
+        loopbackThread.wait();
+        delete loopback;
+    }
 }
 
 /*!
@@ -109,6 +118,7 @@ void Winkey::receive()
                     ignoreEcho=false;
                     return;
                 }
+                emit(echoReceived());
                 if (echoMode) processEcho(wkbyte);
             }
         }
@@ -264,7 +274,18 @@ void Winkey::openWinkey()
         winkeyOpen = false;
     }
 
-    winkeyPort->setPortName(settings.value(s_winkey_device,s_winkey_device_def).toString());
+    QString device=settings.value(s_winkey_device,s_winkey_device_def).toString();
+    if (device==WINKEY_LOOPBACK) {
+        // no hardware: use the loopback stand-in, running in its own thread like a real device
+        if (!loopback) {
+            loopback=new WinkeyLoopback();
+            loopback->moveToThread(&loopbackThread);
+            connect(&loopbackThread,SIGNAL(started()),loopback,SLOT(start()));
+            loopbackThread.start();
+        }
+        device=loopback->portName();
+    }
+    winkeyPort->setPortName(device);
 
     winkeyPort->setBaudRate(QSerialPort::Baud1200);
     winkeyPort->setDataBits(QSerialPort::Data8);
@@ -21,9 +21,12 @@
 #include <QByteArray>
 #include <QSettings>
 #include <QString>
+#include <QThread>
 #include "defines.h"
 #include <QSerialPort>
 
+class WinkeyLoopback;
+
 /*!
    Winkey support class
  */
@@ -44,7 +47,9 @@ public:
 
 signals:
     void cwCanceled();
+    void echoReceived();
     void finished();
+    void portWritten();
     void textSent(const QString& t,int);
     void version(int ver);
     void winkeyTx(bool, int);
@@ -60,6 +65,8 @@ private slots:
 
 private:
     QSerialPort *winkeyPort;
+    QThread    loopbackThread;
+    WinkeyLoopback *loopback;
     bool       echoMode;
     bool       ignoreEcho;
     bool       sending;
@@ -0,0 +1,158 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <QDebug>
+#include <QSocketNotifier>
+#include "winkeyloopback.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+// version byte returned on host open (WK2.3)
+const unsigned char WINKEY_LOOPBACK_VERSION=23;
+
+WinkeyLoopback::WinkeyLoopback(QObject *parent) : QObject(parent)
+{
+    admin    = false;
+    args     = 0;
+    echoNext = false;
+    notifier = nullptr;
+    slaveFd  = -1;
+    fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd == -1 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        qDebug("WinkeyLoopback: can't create pseudo-terminal");
+        if (fd != -1) close(fd);
+        fd = -1;
+        return;
+    }
+    char name[64];
+    if (ptsname_r(fd, name, sizeof(name)) == 0) {
+        slaveName = QString::fromLatin1(name);
+        // keep the slave open so the master does not see a hangup while Winkey has it closed
+        slaveFd = open(name, O_RDWR | O_NOCTTY);
+        if (slaveFd != -1) {
+            struct termios t;
+            tcgetattr(slaveFd, &t);
+            cfmakeraw(&t);
+            tcsetattr(slaveFd, TCSANOW, &t);
+        }
+    }
+}
+
+WinkeyLoopback::~WinkeyLoopback()
+{
+    if (slaveFd != -1) close(slaveFd);
+    if (fd != -1) close(fd);
+}
+
+/*!
+   name of the serial device Winkey should open
+ */
+QString WinkeyLoopback::portName() const
+{
+    return slaveName;
+}
+
+void WinkeyLoopback::start()
+{
+    if (fd == -1 || notifier) return;
+    notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(notifier, SIGNAL(activated(int)), this, SLOT(receive()));
+}
+
+void WinkeyLoopback::stop()
+{
+    delete notifier;
+    notifier = nullptr;
+}
+
+void WinkeyLoopback::reply(const QByteArray &data)
+{
+    if (write(fd, data.constData(), data.size()) != data.size()) {
+        qDebug("WinkeyLoopback: write error");
+    }
+}
+
+/*!
+   number of argument bytes following Winkey command cmd (0x01-0x1f)
+ */
+int WinkeyLoopback::commandArgs(unsigned char cmd)
+{
+    switch (cmd) {
+    case 0x04:case 0x1b:
+        return 2;
+    case 0x05:
+        return 3;
+    case 0x0f:
+        return 15;
+    case 0x07:case 0x08:case 0x0a:case 0x13:case 0x15:case 0x1e:case 0x1f:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+/*!
+   handle bytes sent by Winkey
+ */
+void WinkeyLoopback::receive()
+{
+    unsigned char buff[256];
+    ssize_t n = read(fd, buff, sizeof(buff));
+    if (n <= 0) {
+        if (n < 0 && errno != EAGAIN) qDebug("WinkeyLoopback: read error %d", errno);
+        return;
+    }
+    QByteArray out;
+    bool cw = false;
+    for (int i = 0; i < n; i++) {
+        const unsigned char c = buff[i];
+        if (echoNext) {
+            // admin echo test
+            out.append(c);
+            echoNext = false;
+        } else if (args) {
+            args--;
+        } else if (admin) {
+            admin = false;
+            switch (c) {
+            case 0x02: // host open
+                out.append(WINKEY_LOOPBACK_VERSION);
+                break;
+            case 0x04: // echo test
+                echoNext = true;
+                break;
+            default:
+                break;
+            }
+        } else if (c == 0x00) {
+            admin = true;
+        } else if (c < 0x20) {
+            args = commandArgs(c);
+        } else {
+            // Morse character: report busy, then echo it
+            if (!cw) out.append((char) 0xc4);
+            cw = true;
+            if (c != '|') out.append(c);
+        }
+    }
+    if (cw) out.append((char) 0xc0);
+    if (!out.isEmpty()) reply(out);
+}
@@ -0,0 +1,69 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#ifndef WINKEYLOOPBACK_H
+#define WINKEYLOOPBACK_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+class QSocketNotifier;
+
+/*! Winkey device name that selects the loopback stand-in */
+const QString WINKEY_LOOPBACK="loopback";
+
+/*!
+   stand-in for a Winkey, used to measure the CW path without hardware.
+
+   Creates a pseudo-terminal; Winkey opens the slave side (portName()) as
+   its serial port. Commands written to it are parsed and skipped, the echo
+   test and host open are answered, and Morse characters are echoed back at
+   once, bracketed by busy and idle status bytes. No CW timing is simulated.
+
+   Runs in its own thread: start() and stop() must be called in that thread
+ */
+class WinkeyLoopback : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WinkeyLoopback(QObject *parent = nullptr);
+    ~WinkeyLoopback();
+    QString portName() const;
+
+public slots:
+    void start();
+    void stop();
+
+private slots:
+    void receive();
+
+private:
+    bool            echoNext;
+    int             args;
+    int             fd;
+    int             slaveFd;
+    bool            admin;
+    QString         slaveName;
+    QSocketNotifier *notifier;
+
+    void reply(const QByteArray &data);
+    static int commandArgs(unsigned char cmd);
+};
+
+#endif // WINKEYLOOPBACK_H
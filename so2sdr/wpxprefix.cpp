@@ -0,0 +1,116 @@
+/*! Copyright 2010-2020 R. Torsten Clay N4OGW
+
+   This file is part of so2sdr.
+
+    so2sdr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    so2sdr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with so2sdr.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+#include <string.h>
+#include <QByteArray>
+#include "wpxprefix.h"
+
+/*!
+ determines prefix from call, writing it to pfx (at least n+2 chars). Returns
+ length of prefix
+ rewritten 05/30/2019
+  -may not correctly handle callsigns with two /'s: will assume pfx before FIRST / is correct
+ */
+int wpxPrefix(const char *call, int n, char *pfx)
+{
+    static const char * const ignorePfx[]={"P","M","QRP","AE","AG","KT","MM","AM"};
+    const int nIgnorePfx=sizeof(ignorePfx)/sizeof(ignorePfx[0]);
+    bool changeDigit=false;
+    const char *port = call;
+    int portLen = 0;
+    bool addZero = false;
+
+    // is it a portable?
+    int slash = -1;
+    for (int i = 0; i < n; i++) {
+        if (call[i] == '/') {
+            slash = i;
+            break;
+        }
+    }
+    if (slash != -1) {
+        // the longer one is probably the call, the other the port pfx
+        // tmp1/tmp2
+        const int len1 = slash;
+        const int len2 = n - slash - 1;
+        if (len2 > len1) {
+            port    = call;
+            portLen = len1;
+            call    = call + slash + 1;
+            n       = len2;
+        } else {
+            port    = call + slash + 1;
+            portLen = len2;
+            n       = len1;
+        }
+
+        // certain portable prefixes do not count as new pfx
+        bool ignore=false;
+        for (int i=0;i<nIgnorePfx;i++) {
+            if ((int) qstrlen(ignorePfx[i]) == portLen && qstrncmp(port, ignorePfx[i], portLen) == 0) {
+                portLen = 0;
+                ignore  = true;
+                break;
+            }
+        }
+        if (!ignore && portLen == 1) {
+            if (port[0] >= '0' && port[0] <= '9') {
+                // if the port Pfx is 1 character and a digit, it will modify the main pfx
+                changeDigit=true;
+            } else {
+                // single character pfx: must add '0' to form pfx
+                addZero = true;
+            }
+        }
+    }
+    if (addZero) {
+        pfx[0] = port[0];
+        pfx[1] = '0';
+        return 2;
+    }
+    if (portLen > 1 && !changeDigit) {
+        memcpy(pfx, port, portLen);
+        return portLen;
+    }
+
+    // is there a digit in the call? Find LAST digit
+    int j = -1;
+    for (int k = n - 1; k >= 0; k--) {
+        if (call[k] >= '0' && call[k] <= '9') {
+            j = k;
+            break;
+        }
+    }
+    int len;
+    if (j != -1) {
+        // take up to the last digit in the call
+        len = j + 1;
+        memcpy(pfx, call, len);
+    } else {
+        // take first 2 letters and add zero
+        len = qMin(n, 2);
+        memcpy(pfx, call, len);
+        pfx[len++] = '0';
+    }
+
+    // apply change from portable digit
+    if (changeDigit) {
+        pfx[len - 1] = port[0];
+    }
+    return len;
+}